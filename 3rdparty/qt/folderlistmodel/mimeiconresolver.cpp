@@ -0,0 +1,267 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+
+#include "mimeiconresolver.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegExp>
+#include <QThread>
+#include <QTimer>
+#include <QtDebug>
+
+#include <freedesktopmime.h>
+
+#ifdef Q_OS_UNIX
+#include <sys/types.h>
+#include <sys/stat.h>
+#endif
+
+static const int BatchSize = 32;
+
+MimeIconWorker::MimeIconWorker(QObject *parent) : QObject(parent), mMime(0)
+{
+    mIcons.setMaxCost(8192);
+}
+
+MimeIconWorker::~MimeIconWorker()
+{
+    delete mMime;
+}
+
+void MimeIconWorker::stop()
+{
+    // the database belongs to this thread, drop it here
+    delete mMime;
+    mMime = 0;
+}
+
+QString MimeIconWorker::fileKey(const QString &path) const
+{
+#ifdef Q_OS_UNIX
+    struct stat buf;
+    if (::stat(QFile::encodeName(path).constData(), &buf) == 0)
+        return QString("%1:%2:%3").arg(qulonglong(buf.st_dev))
+            .arg(qulonglong(buf.st_ino)).arg(qlonglong(buf.st_mtime));
+#endif
+    QFileInfo info(path);
+    return path + QLatin1Char(':') + QString::number(info.lastModified().toTime_t());
+}
+
+void MimeIconWorker::resolve(const QStringList &paths)
+{
+    // parsing freedesktop.org.xml is the expensive part, do it once and off the gui thread
+    if (!mMime)
+        mMime = new QFreeDesktopMime();
+
+    QStringList donePaths;
+    QStringList doneIcons;
+
+    Q_FOREACH(const QString &path, paths) {
+        const QString key = fileKey(path);
+        QString icon;
+        if (QString *cached = mIcons.object(key)) {
+            icon = *cached;
+        } else {
+            icon = iconForMimeType(mMime->fromFile(path));
+            mIcons.insert(key, new QString(icon));
+        }
+
+        donePaths << path;
+        doneIcons << icon;
+        if (donePaths.count() >= BatchSize) {
+            Q_EMIT resolved(donePaths, doneIcons);
+            donePaths.clear();
+            doneIcons.clear();
+        }
+    }
+
+    if (!donePaths.isEmpty())
+        Q_EMIT resolved(donePaths, doneIcons);
+}
+
+QString MimeIconWorker::iconForMimeType(const QString &mimeType)
+{
+    if (mimeType.contains("inode/directory", Qt::CaseInsensitive))
+        return "folder";
+
+    /* Executables */
+    else if (mimeType.contains("ms-dos", Qt::CaseInsensitive))
+        return "exe";
+    else if (mimeType.contains("x-executable", Qt::CaseInsensitive))
+        return "obj";
+    else if (mimeType.contains("sharedlib", Qt::CaseInsensitive))
+        return "so";
+    else if (mimeType.contains("library-la", Qt::CaseInsensitive))
+        return "la";
+    else if(mimeType.contains("shellscript", Qt::CaseInsensitive))
+        return "script";
+    else if(mimeType.contains("x-desktop", Qt::CaseInsensitive))
+        return "exec";
+
+    /* Sources */
+    else if (mimeType.contains("x-c++src", Qt::CaseInsensitive))
+        return "cpp";
+    else if (mimeType.contains("x-csrc", Qt::CaseInsensitive))
+        return "c";
+    else if (mimeType.contains("x-chdr", Qt::CaseInsensitive))
+        return "h";
+    else if (mimeType.contains("x-object", Qt::CaseInsensitive))
+        return "obj";
+
+    /* Int. Lang. */
+    else if (mimeType.contains("x-php", Qt::CaseInsensitive))
+        return "php";
+    else if (mimeType.contains("x-perl", Qt::CaseInsensitive))
+        return "pl";
+    else if (mimeType.contains("x-python", Qt::CaseInsensitive))
+        return "py";
+    else if (mimeType.contains("x-java", Qt::CaseInsensitive))
+        return "java";
+    else if (mimeType.contains("javascript", Qt::CaseInsensitive))
+        return "js";
+    else if (mimeType.contains("x-ruby", Qt::CaseInsensitive))
+        return "rb";
+    else if (mimeType.contains("application/xml", Qt::CaseInsensitive))
+        return "xml";
+
+    /* Documents */
+    else if(mimeType.contains("pdf", Qt::CaseInsensitive))
+        return "pdf";
+    else if(mimeType.contains("text/plain", Qt::CaseInsensitive))
+        return "txt";
+    else if(mimeType.contains(QRegExp("rtf|msword|wordprocessing|opendocument.text", Qt::CaseInsensitive)))
+        return "doc";
+    else if(mimeType.contains(QRegExp("ms-excel|spreadsheet", Qt::CaseInsensitive)))
+        return "xls";
+    else if(mimeType.contains(QRegExp("ms-powerpoint|presentation", Qt::CaseInsensitive)))
+        return "ppt";
+    else if(mimeType.contains("database", Qt::CaseInsensitive))
+        return "odb";
+    else if (mimeType.contains("html", Qt::CaseInsensitive))
+        return "html";
+    else if (mimeType.contains("x-uri", Qt::CaseInsensitive))
+        return "url";
+
+    /* Images */
+    else if (mimeType.contains("image/svg", Qt::CaseInsensitive))
+        return "svg";
+    else if (mimeType.contains("image/", Qt::CaseInsensitive))
+        return "img";
+
+    /* Archives */
+    else if (mimeType.contains(QRegExp("ms-cab|stuffit|/zip|x-(compressed|(r|t)ar|7z|(g|b)zip)", Qt::CaseInsensitive)))
+        return "archive";
+
+    /* Video */
+    else if (mimeType.contains("video/", Qt::CaseInsensitive))
+        return "video";
+
+    /* Audio */
+    else if (mimeType.contains("audio/", Qt::CaseInsensitive))
+        return "audio";
+
+    /* Disc Images */
+    else if (mimeType.contains("cd-image", Qt::CaseInsensitive))
+        return "iso";
+
+    /* Packages */
+    else if (mimeType.contains(QRegExp("x-(apple-diskimage|rpm|deb|msi)", Qt::CaseInsensitive)))
+        return "package";
+
+    /* Misc */
+    else if (mimeType.contains("bittorrent", Qt::CaseInsensitive))
+        return "torrent";
+
+    /* Unknown */
+    return "unknown";
+}
+
+MimeIconResolver *MimeIconResolver::mInstance = 0;
+
+MimeIconResolver *MimeIconResolver::getInstance()
+{
+    if (!mInstance)
+        mInstance = new MimeIconResolver(QCoreApplication::instance());
+    return mInstance;
+}
+
+MimeIconResolver::MimeIconResolver(QObject *parent) : QObject(parent)
+{
+    mEntries.setMaxCost(8192);
+
+    mThread = new QThread(this);
+    mWorker = new MimeIconWorker();
+    mWorker->moveToThread(mThread);
+    connect(mWorker, SIGNAL(resolved(QStringList, QStringList)),
+            this, SLOT(onResolved(QStringList, QStringList)));
+    mThread->start(QThread::LowPriority);
+}
+
+MimeIconResolver::~MimeIconResolver()
+{
+    if (mInstance == this)
+        mInstance = 0;
+
+    QMetaObject::invokeMethod(mWorker, "stop", Qt::BlockingQueuedConnection);
+    mThread->quit();
+    mThread->wait();
+    delete mWorker;
+}
+
+QString MimeIconResolver::icon(const QString &path, const QDateTime &modified)
+{
+    if (Entry *entry = mEntries.object(path)) {
+        if (entry->modified == modified)
+            return entry->icon;
+    }
+
+    if (!mPending.contains(path)) {
+        mPending.insert(path, modified);
+        mQueue.append(path);
+
+        // a view asks for every visible row in one go, send them as one request
+        if (mQueue.count() == 1)
+            QTimer::singleShot(0, this, SLOT(flush()));
+    }
+
+    return QString();
+}
+
+void MimeIconResolver::flush()
+{
+    if (mQueue.isEmpty())
+        return;
+
+    QMetaObject::invokeMethod(mWorker, "resolve", Qt::QueuedConnection, Q_ARG(QStringList, mQueue));
+    mQueue.clear();
+}
+
+void MimeIconResolver::onResolved(const QStringList &paths, const QStringList &icons)
+{
+    for (int i = 0; i < paths.count(); i++) {
+        Entry *entry = new Entry;
+        entry->modified = mPending.take(paths.at(i));
+        entry->icon = icons.at(i);
+        mEntries.insert(paths.at(i), entry);
+    }
+
+    Q_EMIT iconsResolved(paths);
+}
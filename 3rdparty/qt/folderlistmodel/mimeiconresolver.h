@@ -0,0 +1,98 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+
+#ifndef MIME_ICON_RESOLVER_H
+#define MIME_ICON_RESOLVER_H
+
+#include <QCache>
+#include <QDateTime>
+#include <QHash>
+#include <QObject>
+#include <QStringList>
+
+class QFreeDesktopMime;
+class QThread;
+
+/* Runs on the resolver thread. Owns the only parsed copy of the
+   freedesktop mime database and remembers the result per
+   (device, inode, mtime) so renamed or re-listed files are not sniffed
+   again. */
+class MimeIconWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    MimeIconWorker(QObject *parent = 0);
+    virtual ~MimeIconWorker();
+
+    /* maps a mime type to the name of a themepack resource */
+    static QString iconForMimeType(const QString &mimeType);
+
+public Q_SLOTS:
+    void resolve(const QStringList &paths);
+    void stop();
+
+Q_SIGNALS:
+    void resolved(const QStringList &paths, const QStringList &icons);
+
+private:
+    QString fileKey(const QString &path) const;
+
+    QFreeDesktopMime *mMime;
+    QCache<QString, QString> mIcons;
+};
+
+/* Hands out the mime icon for a file without blocking the caller. Unknown
+   files are queued for the worker thread and reported through
+   iconsResolved() in batches, until then icon() returns an empty string
+   and views show a placeholder. One resolver is shared by every model. */
+class MimeIconResolver : public QObject
+{
+    Q_OBJECT
+
+public:
+    static MimeIconResolver *getInstance();
+    virtual ~MimeIconResolver();
+
+    QString icon(const QString &path, const QDateTime &modified);
+
+Q_SIGNALS:
+    void iconsResolved(const QStringList &paths);
+
+private Q_SLOTS:
+    void flush();
+    void onResolved(const QStringList &paths, const QStringList &icons);
+
+private:
+    MimeIconResolver(QObject *parent = 0);
+
+    struct Entry {
+        QDateTime modified;
+        QString icon;
+    };
+
+    QThread *mThread;
+    MimeIconWorker *mWorker;
+    QCache<QString, Entry> mEntries;
+    QHash<QString, QDateTime> mPending;
+    QStringList mQueue;
+    static MimeIconResolver *mInstance;
+};
+
+#endif
@@ -41,13 +41,11 @@
 
 #include <QFileSystemModel>
 #include <QDesktopServices>
-#include <QCryptographicHash>
 #include <QDebug>
 #include <qdeclarativecontext.h>
 
 #include "qdeclarativefolderlistmodel.h"
-#include <freedesktopmime.h>
-#include <plexyqmlglue.h>
+#include "mimeiconresolver.h"
 
 #ifndef QT_NO_DIRMODEL
 
@@ -162,8 +160,6 @@ public:
 QDeclarativeFolderListModel::QDeclarativeFolderListModel(QObject *parent)
     : QAbstractListModel(parent)
 {
-    mImageCache = dynamic_cast<PlexyDesk::ImageCache *>(PlexyDesk::PlexyQmlGlue::qmlEngine()->imageProvider("plexydesk"));
-
     QHash<int, QByteArray> roles;
     roles[FileNameRole] = "fileName";
     roles[FilePathRole] = "filePath";
@@ -182,6 +178,8 @@ QDeclarativeFolderListModel::QDeclarativeFolderListModel(QObject *parent)
             , this, SLOT(handleDataChanged(const QModelIndex&,const QModelIndex&)));
     connect(&d->model, SIGNAL(modelReset()), this, SLOT(refresh()));
     connect(&d->model, SIGNAL(layoutChanged()), this, SLOT(refresh()));
+    connect(MimeIconResolver::getInstance(), SIGNAL(iconsResolved(QStringList)),
+            this, SLOT(iconsResolved(QStringList)));
 
 
     SetToHome();
@@ -205,125 +203,20 @@ void QDeclarativeFolderListModel::SetToHome()
     setFolder(QUrl(path));
 }
 
-QVariant QDeclarativeFolderListModel::getMimeTypeImagePath(const QString file) const
+QVariant QDeclarativeFolderListModel::getMimeTypeImagePath(const QModelIndex &modelIndex) const
 {
-    QString fileLocal = file;
-
-    QString filenameMD5 = QString(QCryptographicHash::hash(fileLocal.toUtf8(), QCryptographicHash::Md5)
-                                        .toHex().toUpper());
-
-    if (mImageCache->isCached(filenameMD5))
-        return QVariant("image://plexydesk/" + filenameMD5);
-
-    QFreeDesktopMime mime;
-    QString mimeType = mime.fromFile(fileLocal);
-
-//    qDebug() << "Requested mime info for: " << fileLocal << " -> " << mimeType;
-
-    QString imgfile;
-    QString theme = PlexyDesk::Config::getInstance()->themepackName();
-
-    if (mimeType.isNull())
-        mimeType = "";
-
-    if (mimeType.contains("inode/directory", Qt::CaseInsensitive))
-        imgfile = "folder.png";
-
-    /* Executables */
-    else if (mimeType.contains("ms-dos", Qt::CaseInsensitive))
-        imgfile = "exe.png";
-    else if (mimeType.contains("x-executable", Qt::CaseInsensitive))
-        imgfile = "obj.png";
-    else if (mimeType.contains("sharedlib", Qt::CaseInsensitive))
-        imgfile = "so.png";
-    else if (mimeType.contains("library-la", Qt::CaseInsensitive))
-        imgfile = "la.png";
-    else if(mimeType.contains("shellscript", Qt::CaseInsensitive))
-        imgfile = "script.png";
-    else if(mimeType.contains("x-desktop", Qt::CaseInsensitive))
-        imgfile = "exec.png";
-
-    /* Sources */
-    else if (mimeType.contains("x-c++src", Qt::CaseInsensitive))
-        imgfile = "cpp.png";
-    else if (mimeType.contains("x-csrc", Qt::CaseInsensitive))
-        imgfile = "c.png";
-    else if (mimeType.contains("x-chdr", Qt::CaseInsensitive))
-        imgfile = "h.png";
-    else if (mimeType.contains("x-object", Qt::CaseInsensitive))
-        imgfile = "obj.png";
-
-    /* Int. Lang. */
-    else if (mimeType.contains("x-php", Qt::CaseInsensitive))
-        imgfile = "php.png";
-    else if (mimeType.contains("x-perl", Qt::CaseInsensitive))
-        imgfile = "pl.png";
-    else if (mimeType.contains("x-python", Qt::CaseInsensitive))
-        imgfile = "py.png";
-    else if (mimeType.contains("x-java", Qt::CaseInsensitive))
-        imgfile = "java.png";
-    else if (mimeType.contains("javascript", Qt::CaseInsensitive))
-        imgfile = "js.png";
-    else if (mimeType.contains("x-ruby", Qt::CaseInsensitive))
-        imgfile = "rb.png";
-    else if (mimeType.contains("application/xml", Qt::CaseInsensitive))
-        imgfile = "xml.png";
-
-    /* Documents */
-    else if(mimeType.contains("pdf", Qt::CaseInsensitive))
-        imgfile = "pdf.png";
-    else if(mimeType.contains("text/plain", Qt::CaseInsensitive))
-        imgfile = "txt.png";
-    else if(mimeType.contains(QRegExp("rtf|msword|wordprocessing|opendocument.text", Qt::CaseInsensitive)))
-        imgfile = "doc.png";
-    else if(mimeType.contains(QRegExp("ms-excel|spreadsheet", Qt::CaseInsensitive)))
-        imgfile = "xls.png";
-    else if(mimeType.contains(QRegExp("ms-powerpoint|presentation", Qt::CaseInsensitive)))
-        imgfile = "ppt.png";
-    else if(mimeType.contains("database", Qt::CaseInsensitive))
-        imgfile = "odb.png";
-    else if (mimeType.contains("html", Qt::CaseInsensitive))
-        imgfile = "html.png";
-    else if (mimeType.contains("x-uri", Qt::CaseInsensitive))
-        imgfile = "url.png";
-
-    /* Images */
-    else if (mimeType.contains("image/svg", Qt::CaseInsensitive))
-        imgfile = "svg.png";
-    else if (mimeType.contains("image/", Qt::CaseInsensitive))
-        imgfile = "img.png";
-
-    /* Archives */
-    else if (mimeType.contains(QRegExp("ms-cab|stuffit|/zip|x-(compressed|(r|t)ar|7z|(g|b)zip)", Qt::CaseInsensitive)))
-        imgfile = "archive.png";
+    // folders need no sniffing
+    if (d->model.isDir(modelIndex))
+        return QVariant("image://plexydesk/folder");
 
-    /* Video */
-    else if (mimeType.contains("video/", Qt::CaseInsensitive))
-        imgfile = "video.png";
-
-    /* Audio */
-    else if (mimeType.contains("audio/", Qt::CaseInsensitive))
-        imgfile = "audio.png";
+    QString icon = MimeIconResolver::getInstance()->icon(d->model.filePath(modelIndex),
+            d->model.lastModified(modelIndex));
 
-    /* Disc Images */
-    else if (mimeType.contains("cd-image", Qt::CaseInsensitive))
-        imgfile = "iso.png";
-
-    /* Packages */
-    else if (mimeType.contains(QRegExp("x-(apple-diskimage|rpm|deb|msi)", Qt::CaseInsensitive)))
-        imgfile = "package.png";
-
-    /* Misc */
-    else if (mimeType.contains("bittorrent", Qt::CaseInsensitive))
-        imgfile = "torrent.png";
-
-    /* Unknown */
-    else
-        imgfile = "unknown.png";
+    // not known yet, iconsResolved() refreshes the row once the worker is done
+    if (icon.isEmpty())
+        icon = QLatin1String("unknown");
 
-    mImageCache->addToCached(imgfile, filenameMD5, theme);
-
-    return QVariant("image://plexydesk/" + filenameMD5);
+    return QVariant("image://plexydesk/" + icon);
 }
 
 QVariant QDeclarativeFolderListModel::getFileTypeImagePath(const QString file) const
@@ -459,7 +352,7 @@ QVariant QDeclarativeFolderListModel::data(const QModelIndex &index, int role) c
         else if (role == FileIconRole)
             rv = d->model.data(modelIndex, QFileSystemModel::FileIconRole);
         else if (role == FileMimeIconRole)
-            rv = getMimeTypeImagePath(d->model.data(modelIndex, QFileSystemModel::FilePathRole).toString());
+            rv = getMimeTypeImagePath(modelIndex);
         else if (role == FileTypeIconRole)
             rv = getFileTypeImagePath(d->model.type(modelIndex));
     }
@@ -680,6 +573,33 @@ void QDeclarativeFolderListModel::handleDataChanged(const QModelIndex &start, co
         emit dataChanged(index(start.row(),0), index(end.row(),0));
 }
 
+void QDeclarativeFolderListModel::iconsResolved(const QStringList &paths)
+{
+    QList<int> rows;
+    Q_FOREACH(const QString &path, paths) {
+        QModelIndex modelIndex = d->model.index(path);
+        if (modelIndex.isValid() && modelIndex.parent() == d->folderIndex && modelIndex.row() < d->count)
+            rows.append(modelIndex.row());
+    }
+
+    if (rows.isEmpty())
+        return;
+
+    // one signal per run of neighbouring rows rather than one per file
+    qSort(rows);
+    int first = rows.first();
+    int last = first;
+    for (int i = 1; i < rows.count(); i++) {
+        if (rows.at(i) <= last + 1) {
+            last = rows.at(i);
+            continue;
+        }
+        emit dataChanged(index(first, 0), index(last, 0));
+        first = last = rows.at(i);
+    }
+    emit dataChanged(index(first, 0), index(last, 0));
+}
+
 /*!
     \qmlproperty bool FolderListModel::showDirs
 
@@ -48,8 +48,6 @@
 #include <QAbstractListModel>
 #include <QDeclarativeImageProvider>
 
-#include <imagecache.h>
-
 #ifndef QT_NO_DIRMODEL
 
 #define FOLDERLISTMODEL_EXPORT Q_DECL_EXPORT
@@ -131,12 +129,12 @@ private Q_SLOTS:
     void inserted(const QModelIndex &index, int start, int end);
     void removed(const QModelIndex &index, int start, int end);
     void handleDataChanged(const QModelIndex &start, const QModelIndex &end);
+    void iconsResolved(const QStringList &paths);
 
 private:
     Q_DISABLE_COPY(QDeclarativeFolderListModel)
     QDeclarativeFolderListModelPrivate *d;
-    PlexyDesk::ImageCache *mImageCache ;
-    QVariant getMimeTypeImagePath(const QString file) const;
+    QVariant getMimeTypeImagePath(const QModelIndex &modelIndex) const;
     QVariant getFileTypeImagePath(const QString file) const;
 };
 
@@ -28,6 +28,7 @@
 #include <QGraphicsGridLayout>
 #include <QGraphicsDropShadowEffect>
 #include <QDomDocument>
+#include <QTimer>
 
 #include <abstractdesktopwidget.h>
 #include <controllerinterface.h>
@@ -35,6 +36,7 @@
 
 #include "controllerinterface.h"
 #include "abstractdesktopview.h"
+#include "paintprofiler.h"
 
 /**
   \class PlexyDesk::AbstractDesktopView
@@ -79,10 +81,18 @@ public:
 
     QMap<QString, ControllerPtr > mControllerMap;
     AbstractDesktopWidget *mBackgroundItem;
+    ControllerPtr mBackgroundController;
+    QMap<int, AbstractDesktopWidget *> mScreenBackgrounds;
     QDomDocument *mSessionTree;
     QDomElement mRootElement;
     QDesktopWidget *mDesktopWidget;
     QString mBackgroundControllerName;
+
+    AbstractDesktopView::IndexMethod mIndexMethod;
+    QSet<QObject *> mItemsInMotion;
+    QTimer *mIndexRestoreTimer;
+    /* where the paint profile overlay was last asked to draw, null while hidden */
+    QRect mOverlayRect;
 };
 
 AbstractDesktopView::AbstractDesktopView(QGraphicsScene *scene, QWidget *parent) :
@@ -104,7 +114,19 @@ AbstractDesktopView::AbstractDesktopView(QGraphicsScene *scene, QWidget *parent)
     setViewportUpdateMode(QGraphicsView::SmartViewportUpdate);
     setFrameStyle(QFrame::NoFrame);
     scene->setStickyFocus(false);
-    scene->setItemIndexMethod(QGraphicsScene::NoIndex);
+
+    // rebuilding the tree after every frame of a drag costs more than it saves,
+    // so wait until things settle before going back to the index
+    d->mIndexRestoreTimer = new QTimer(this);
+    d->mIndexRestoreTimer->setSingleShot(true);
+    d->mIndexRestoreTimer->setInterval(250);
+    connect(d->mIndexRestoreTimer, SIGNAL(timeout()), this, SLOT(restoreIndex()));
+
+    d->mIndexMethod = AdaptiveIndex;
+    applyIndexMethod();
+
+    connect(PaintProfiler::getInstance(), SIGNAL(updated()), this, SLOT(onPaintProfileUpdated()));
+
     setFocusPolicy(Qt::StrongFocus);
     if(viewport()) {
         viewport()->setFocusPolicy(Qt::StrongFocus);
@@ -146,25 +168,61 @@ bool AbstractDesktopView::setBackgroundController(const QString &controllerName)
         return false;
     }
 
-    for (int i = 0 ; i < d->mDesktopWidget->screenCount() ; i++) {
-        //qDebug() << Q_FUNC_INFO << i;
-        d->mBackgroundItem = (AbstractDesktopWidget*) controller->defaultView();
+    d->mBackgroundController = controller;
+    controller->setViewport(this);
+    controller->setControllerName(controllerName);
+
+    for (int i = 0 ; i < d->mDesktopWidget->screenCount() ; i++)
+        addScreenBackground(i);
+
+    return true;
+}
+
+void AbstractDesktopView::addScreenBackground(int screen)
+{
+    d->mBackgroundItem = (AbstractDesktopWidget*) d->mBackgroundController->defaultView();
+    d->mScreenBackgrounds[screen] = d->mBackgroundItem;
+
+    scene()->addItem(d->mBackgroundItem);
+
+    d->mBackgroundItem->setContentRect(d->mDesktopWidget->screenGeometry(screen));
 
-        scene()->addItem(d->mBackgroundItem);
+    d->mBackgroundItem->show();
+    d->mBackgroundItem->setZValue(-1);
 
-        d->mBackgroundItem->setContentRect(d->mDesktopWidget->screenGeometry(i));
+    if(scene()) {
+        scene()->setFocusItem(d->mBackgroundItem, Qt::MouseFocusReason);
+    }
+}
 
-        d->mBackgroundItem->show();
-        d->mBackgroundItem->setZValue(-1);
+AbstractDesktopWidget *AbstractDesktopView::backgroundItem(int screen) const
+{
+    return d->mScreenBackgrounds.value(screen);
+}
 
-        controller->setViewport(this);
-        controller->setControllerName(controllerName);
+void AbstractDesktopView::updateScreenBackgrounds()
+{
+    if (!d->mBackgroundController)
+        return;
 
-        if(scene()) {
-            scene()->setFocusItem(d->mBackgroundItem, Qt::MouseFocusReason);
+    const int count = d->mDesktopWidget->screenCount();
+    for (int i = 0; i < count; i++) {
+        AbstractDesktopWidget *background = d->mScreenBackgrounds.value(i);
+        if (!background) {
+            addScreenBackground(i);
+            continue;
         }
+
+        background->setContentRect(d->mDesktopWidget->screenGeometry(i));
+        background->show();
+    }
+
+    // the controller owns the surfaces, keep them around in case the screen comes back
+    QMap<int, AbstractDesktopWidget *>::const_iterator it = d->mScreenBackgrounds.constBegin();
+    for (; it != d->mScreenBackgrounds.constEnd(); ++it) {
+        if (it.key() >= count)
+            it.value()->hide();
     }
-    return true;
 }
 
 void AbstractDesktopView::addController(const QString &controllerName, bool firstRun)
@@ -242,10 +300,120 @@ QSharedPointer<ControllerInterface> AbstractDesktopView::controllerByName(const
     return d->mControllerMap[name];
 }
 
+void AbstractDesktopView::setIndexMethod(IndexMethod method)
+{
+    if (d->mIndexMethod == method)
+        return;
+
+    d->mIndexMethod = method;
+    applyIndexMethod();
+}
+
+AbstractDesktopView::IndexMethod AbstractDesktopView::indexMethod() const
+{
+    return d->mIndexMethod;
+}
+
+void AbstractDesktopView::setBspTreeDepth(int depth)
+{
+    if (scene())
+        scene()->setBspTreeDepth(qMax(0, depth));
+}
+
+int AbstractDesktopView::bspTreeDepth() const
+{
+    return scene() ? scene()->bspTreeDepth() : 0;
+}
+
+void AbstractDesktopView::applyIndexMethod()
+{
+    if (!scene())
+        return;
+
+    bool useTree = d->mIndexMethod == BspTreeIndex;
+    if (d->mIndexMethod == AdaptiveIndex)
+        useTree = d->mItemsInMotion.isEmpty() && !d->mIndexRestoreTimer->isActive();
+
+    const QGraphicsScene::ItemIndexMethod method =
+        useTree ? QGraphicsScene::BspTreeIndex : QGraphicsScene::NoIndex;
+    if (scene()->itemIndexMethod() != method)
+        scene()->setItemIndexMethod(method);
+}
+
+void AbstractDesktopView::beginItemMotion(QGraphicsObject *item)
+{
+    if (!item || d->mItemsInMotion.contains(item))
+        return;
+
+    d->mItemsInMotion.insert(item);
+    connect(item, SIGNAL(destroyed(QObject*)), this, SLOT(onMotionItemDestroyed(QObject*)));
+
+    d->mIndexRestoreTimer->stop();
+    applyIndexMethod();
+}
+
+void AbstractDesktopView::endItemMotion(QGraphicsObject *item)
+{
+    if (!item || !d->mItemsInMotion.remove(item))
+        return;
+
+    disconnect(item, SIGNAL(destroyed(QObject*)), this, SLOT(onMotionItemDestroyed(QObject*)));
+
+    if (d->mItemsInMotion.isEmpty() && d->mIndexMethod == AdaptiveIndex)
+        d->mIndexRestoreTimer->start();
+}
+
+int AbstractDesktopView::itemsInMotion() const
+{
+    return d->mItemsInMotion.count();
+}
+
+void AbstractDesktopView::onMotionItemDestroyed(QObject *item)
+{
+    if (d->mItemsInMotion.remove(item) && d->mItemsInMotion.isEmpty() &&
+            d->mIndexMethod == AdaptiveIndex)
+        d->mIndexRestoreTimer->start();
+}
+
+void AbstractDesktopView::restoreIndex()
+{
+    applyIndexMethod();
+}
+
+void AbstractDesktopView::onPaintProfileUpdated()
+{
+    // profiling without the overlay must not repaint the view every second
+    PaintProfiler *profiler = PaintProfiler::getInstance();
+    const bool visible = profiler->isOverlayVisible();
+    if (!visible && d->mOverlayRect.isNull())
+        return;
+
+    // erase the last overlay too, it may have had more rows or just got hidden
+    viewport()->update(d->mOverlayRect);
+    d->mOverlayRect = visible ? profiler->overlayRect() : QRect();
+    viewport()->update(d->mOverlayRect);
+}
+
+void AbstractDesktopView::drawForeground(QPainter *painter, const QRectF &rect)
+{
+    QGraphicsView::drawForeground(painter, rect);
+
+    PaintProfiler *profiler = PaintProfiler::getInstance();
+    if (!profiler->isOverlayVisible())
+        return;
+
+    // the overlay sticks to the corner of the viewport, not to the scene
+    painter->save();
+    painter->resetTransform();
+    profiler->paintOverlay(painter);
+    painter->restore();
+}
+
 void AbstractDesktopView::dropEvent(QDropEvent *event)
 {
     if (this->scene()) {
-        QList<QGraphicsItem *> items = scene()->items(event->pos());
+        // the view maps the point and asks the scene index, not a walk over every item
+        QList<QGraphicsItem *> items = this->items(event->pos());
 
         Q_FOREACH(QGraphicsItem *item, items) {
 
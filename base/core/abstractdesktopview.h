@@ -30,8 +30,21 @@ namespace PlexyDesk
 class PLEXYDESKCORE_EXPORT AbstractDesktopView : public QGraphicsView
 {
     Q_OBJECT
+    Q_ENUMS(IndexMethod)
 
 public:
+    /*
+     * How the scene finds items for hit tests and exposed regions.
+     * AdaptiveIndex keeps a BSP tree while the desktop is still and
+     * drops it while widgets are dragged or animated, so moving items
+     * don't force the tree to be rebuilt every frame.
+     */
+    enum IndexMethod {
+        NoIndex,
+        BspTreeIndex,
+        AdaptiveIndex
+    };
+
     AbstractDesktopView(QGraphicsScene *scene = new QGraphicsScene(), QWidget *parent = 0);
 
     virtual ~AbstractDesktopView();
@@ -40,6 +53,10 @@ public:
 
     virtual bool setBackgroundController(const QString &controllerName);
 
+    /* every screen gets its own wallpaper surface from the background controller */
+    AbstractDesktopWidget *backgroundItem(int screen) const;
+    void updateScreenBackgrounds();
+
     virtual void addController(const QString &controllerName, bool firstRun = 0);
 
     virtual QStringList currentControllers() const;
@@ -62,6 +79,18 @@ public:
 
     virtual void saveItemStateToSession(const QString &controllerName, const QString &widgetId, bool state);
 
+    void setIndexMethod(IndexMethod method);
+    IndexMethod indexMethod() const;
+
+    /* 0 lets the scene pick a depth from the number of items */
+    void setBspTreeDepth(int depth);
+    int bspTreeDepth() const;
+
+    /* items report drags and animations here, see AbstractDesktopWidget::setInMotion() */
+    void beginItemMotion(QGraphicsObject *item);
+    void endItemMotion(QGraphicsObject *item);
+    int itemsInMotion() const;
+
 Q_SIGNALS:
 
     void closeApplication();
@@ -71,10 +100,20 @@ Q_SIGNALS:
 public:
     virtual void onWidgetClosed(PlexyDesk::AbstractDesktopWidget *);
 
+private Q_SLOTS:
+    void onMotionItemDestroyed(QObject *item);
+    void restoreIndex();
+    void onPaintProfileUpdated();
+
 private:
+    void applyIndexMethod();
+    void addScreenBackground(int screen);
+
 
     virtual void dropEvent(QDropEvent *event);
 
+    virtual void drawForeground(QPainter *painter, const QRectF &rect);
+
     virtual void dragEnterEvent(QDragEnterEvent *event);
 
     virtual void dragMoveEvent(QDragMoveEvent *event);
@@ -18,17 +18,20 @@
 *******************************************************************************/
 
 #include <QCoreApplication>
+#include <QElapsedTimer>
 #include <QGraphicsObject>
 #include <QGraphicsScene>
 #include <QGraphicsSceneMouseEvent>
 #include <QStyleOptionGraphicsItem>
 #include <QGraphicsProxyWidget>
 #include <QPainter>
+#include <QPointer>
 #include <QtDebug>
 
 #include "controllerinterface.h"
 #include "abstractdesktopwidget.h"
 #include "abstractdesktopview.h"
+#include "paintprofiler.h"
 
 /**
  * \class PlexyDesk::AbstractDesktopWidget
@@ -103,7 +106,8 @@ namespace PlexyDesk
 class AbstractDesktopWidget::PrivateAbstractDesktopWidget
 {
 public:
-    PrivateAbstractDesktopWidget() : mController(0) {
+    PrivateAbstractDesktopWidget() : mController(0), mInMotion(false), mDragging(false),
+        mProfileRow(-1) {
     }
     ~PrivateAbstractDesktopWidget() {
     }
@@ -120,7 +124,13 @@ public:
     QRectF mContentRect;
     QRectF mBoundingRect;
 
-    ControllerInterface *mController;
+    QPointer<ControllerInterface> mController;
+
+    bool mInMotion;
+    bool mDragging;
+    QList<QPointer<AbstractDesktopView> > mMotionViews;
+
+    int mProfileRow;
 };
 
 
@@ -149,6 +159,10 @@ AbstractDesktopWidget::AbstractDesktopWidget(const QRectF &rect, QGraphicsObject
 AbstractDesktopWidget::~AbstractDesktopWidget()
 {
     qDebug() << Q_FUNC_INFO;
+    if (d->mController)
+        d->mController->setViewActive(this, false);
+    setInMotion(false);
+    PaintProfiler::removeWidget(d->mProfileRow);
     delete d;
 }
 
@@ -212,6 +226,7 @@ void AbstractDesktopWidget::setContentRect(const QRectF &rect)
     setTransform(mat);
     resetMatrix();
     update();
+    Q_EMIT rectChanged();
 }
 
 QRectF AbstractDesktopWidget::contentRect() const
@@ -231,6 +246,7 @@ void AbstractDesktopWidget::setRect(const QRectF &rect)
     setTransform(mat);
     resetMatrix();
     update();
+    Q_EMIT rectChanged();
 }
 
 AbstractDesktopWidget::State AbstractDesktopWidget::state()
@@ -242,6 +258,7 @@ void AbstractDesktopWidget::setState(AbstractDesktopWidget::State s)
 {
     d->mWidgetState = s;
     show();
+    updateViewActivity();
     Q_EMIT stateChanged();
 }
 
@@ -261,6 +278,11 @@ void AbstractDesktopWidget::paint(QPainter *painter, const QStyleOptionGraphicsI
     if (isObscured())
         return;
 
+    const bool profile = PaintProfiler::isEnabled();
+    QElapsedTimer timer;
+    if (profile)
+        timer.start();
+
     painter->setOpacity(d->mOpacity);
     painter->setClipRect(option->exposedRect);
     if (d->mWidgetState == VIEW) {
@@ -274,10 +296,64 @@ void AbstractDesktopWidget::paint(QPainter *painter, const QStyleOptionGraphicsI
     if (d->mEditMode) {
         this->paintEditMode(painter, option->exposedRect);
     }
+
+    if (profile) {
+        PaintProfiler *profiler = PaintProfiler::getInstance();
+        if (d->mProfileRow < 0)
+            d->mProfileRow = profiler->addWidget(this);
+        profiler->record(d->mProfileRow, timer, option->exposedRect);
+    }
+}
+
+void AbstractDesktopWidget::setInMotion(bool moving)
+{
+    if (d->mInMotion == moving)
+        return;
+
+    d->mInMotion = moving;
+
+    if (moving) {
+        if (!scene())
+            return;
+        Q_FOREACH(QGraphicsView *view, scene()->views()) {
+            AbstractDesktopView *desktopView = qobject_cast<AbstractDesktopView *>(view);
+            if (!desktopView)
+                continue;
+            desktopView->beginItemMotion(this);
+            d->mMotionViews.append(desktopView);
+        }
+    } else {
+        // tell the views we told before, the item may have changed scenes since
+        Q_FOREACH(const QPointer<AbstractDesktopView> &view, d->mMotionViews) {
+            if (view)
+                view->endItemMotion(this);
+        }
+        d->mMotionViews.clear();
+    }
+}
+
+bool AbstractDesktopWidget::isInMotion() const
+{
+    return d->mInMotion;
+}
+
+void AbstractDesktopWidget::mouseMoveEvent(QGraphicsSceneMouseEvent *event)
+{
+    if (!d->mDragging && (event->buttons() & Qt::LeftButton) && (flags() & ItemIsMovable)) {
+        d->mDragging = true;
+        setInMotion(true);
+    }
+
+    QGraphicsObject::mouseMoveEvent(event);
 }
 
 void AbstractDesktopWidget::mouseReleaseEvent(QGraphicsSceneMouseEvent *event)
 {
+    if (d->mDragging) {
+        d->mDragging = false;
+        setInMotion(false);
+    }
+
     if (controller() && controller()->viewport()) {
         controller()->viewport()->saveItemLocationToSession(controller()->controllerName(), pos(), this->widgetID());
     }
@@ -326,7 +402,34 @@ void AbstractDesktopWidget::setChildWidetVisibility(bool show)
 
 void AbstractDesktopWidget::setController(ControllerInterface *view_controller)
 {
+    if (d->mController && d->mController != view_controller)
+        d->mController->setViewActive(this, false);
+
     d->mController = view_controller;
+    updateViewActivity();
+}
+
+void AbstractDesktopWidget::updateViewActivity()
+{
+    // hidden and docked views don't need their data source ticking
+    const bool active = isVisible() && d->mWidgetState != DOCKED;
+    if (d->mController)
+        d->mController->setViewActive(this, active);
+    viewActivityChanged(active);
+}
+
+void AbstractDesktopWidget::viewActivityChanged(bool /*active*/)
+{
+}
+
+QVariant AbstractDesktopWidget::itemChange(GraphicsItemChange change, const QVariant &value)
+{
+    if (change == ItemVisibleHasChanged)
+        updateViewActivity();
+    else if (change == ItemSceneChange)
+        setInMotion(false);
+
+    return QGraphicsObject::itemChange(change, value);
 }
 
 ControllerInterface *AbstractDesktopWidget::controller() const
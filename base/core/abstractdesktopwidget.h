@@ -81,6 +81,14 @@ public :
     bool editMode() const;
     void setState(State s);
 
+    /*
+     * Marks the widget as being dragged or animated. The desktop views
+     * showing it keep moving items out of their scene index until
+     * the motion stops. Dragging with the mouse is reported automatically.
+     */
+    void setInMotion(bool moving);
+    bool isInMotion() const;
+
 Q_SIGNALS:
     void closed(PlexyDesk::AbstractDesktopWidget *widget);
     void rectChanged();
@@ -95,9 +103,17 @@ protected:
     virtual void paintDockView(QPainter *painter, const QRectF &rect) = 0;
     virtual void paintEditMode(QPainter *painter, const QRectF &rect) = 0;
 
+    virtual QVariant itemChange(GraphicsItemChange change, const QVariant &value);
+
+    /* widgets feeding themselves without a controller pause their sources here */
+    virtual void viewActivityChanged(bool active);
+
     //virtual void mousePressEvent(QGraphicsSceneMouseEvent *event);
+    virtual void mouseMoveEvent(QGraphicsSceneMouseEvent *event);
     virtual void mouseReleaseEvent(QGraphicsSceneMouseEvent *event);
 private:
+    void updateViewActivity();
+
     class PrivateAbstractDesktopWidget;
     PrivateAbstractDesktopWidget *const d;
 };
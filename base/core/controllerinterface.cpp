@@ -1,6 +1,8 @@
 #include <controllerinterface.h>
 #include <pluginloader.h>
+#include <tickscheduler.h>
 #include <QDropEvent>
+#include <QSet>
 #include <QDebug>
 
 namespace PlexyDesk
@@ -14,11 +16,14 @@ public:
     QSharedPointer<DataSource> mDataSource;
     AbstractDesktopView *mViewport;
     QString mName;
+    QSet<AbstractDesktopWidget *> mActiveViews;
+    bool mHasViews;
 };
 
 ControllerInterface::ControllerInterface(QObject *parent) : QObject(parent), d(new PrivateViewControllerPlugin)
 {
     d->mViewport = 0;
+    d->mHasViews = false;
 }
 
 ControllerInterface::~ControllerInterface()
@@ -74,6 +79,20 @@ QString ControllerInterface::controllerName() const
     return d->mName;
 }
 
+/* the data source only ticks while at least one of our views is on screen and not docked */
+void ControllerInterface::setViewActive(AbstractDesktopWidget *widget, bool active)
+{
+    d->mHasViews = true;
+
+    if (active)
+        d->mActiveViews.insert(widget);
+    else
+        d->mActiveViews.remove(widget);
+
+    if (d->mDataSource)
+        TickScheduler::getInstance()->setPaused(d->mDataSource.data(), d->mActiveViews.isEmpty());
+}
+
 bool ControllerInterface::connectToDataSource(const QString &source)
 {
    d->mDataSource = PluginLoader::getInstance()->engine(source);
@@ -81,6 +100,9 @@ bool ControllerInterface::connectToDataSource(const QString &source)
    if (!d->mDataSource.data())
        return 0;
 
+   if (d->mHasViews && d->mActiveViews.isEmpty())
+       TickScheduler::getInstance()->setPaused(d->mDataSource.data(), true);
+
    connect(d->mDataSource.data(), SIGNAL(ready()), this, SLOT(onReady()));
 
    return true;
@@ -80,6 +80,8 @@ public:
 
     virtual QString controllerName() const;
 
+    void setViewActive(AbstractDesktopWidget *widget, bool active);
+
 protected:
     virtual bool connectToDataSource(const QString &source);
 
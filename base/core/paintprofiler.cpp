@@ -0,0 +1,370 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+
+#include "paintprofiler.h"
+
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFontMetrics>
+#include <QHash>
+#include <QPainter>
+#include <QTextStream>
+#include <QVector>
+#include <QtDebug>
+
+#ifdef Q_WS_X11
+#include <QtDBus/QDBusConnection>
+#endif
+
+#include <abstractdesktopwidget.h>
+#include <tickscheduler.h>
+
+static const int OverlayRows = 8;
+static const int OverlayMargin = 8;
+static const int OverlayWidth = 420;
+
+static bool sEnabled = !qgetenv("PLEXY_PAINT_PROFILE").isEmpty();
+
+namespace PlexyDesk
+{
+
+PaintProfiler *PaintProfiler::mInstance = 0;
+
+/* nanoseconds where Qt can measure them, milliseconds scaled up before 4.8 */
+static inline qint64 nsecsElapsed(const QElapsedTimer &timer)
+{
+#if QT_VERSION >= 0x040800
+    return timer.nsecsElapsed();
+#else
+    return timer.elapsed() * 1000000;
+#endif
+}
+
+static bool slowerThan(const PaintProfiler::Entry &a, const PaintProfiler::Entry &b)
+{
+    return a.nsecs > b.nsecs;
+}
+
+static bool slowerLastSecond(const PaintProfiler::Entry &a, const PaintProfiler::Entry &b)
+{
+    return a.nsecsPerSecond > b.nsecsPerSecond;
+}
+
+class PaintProfiler::Private
+{
+public:
+    Private() : mOverlay(false), mTick(0), mRegistered(false) {}
+    ~Private() {}
+
+    // what the current second has collected so far
+    struct Second {
+        int paints;
+        qint64 nsecs;
+        qint64 area;
+    };
+
+    QVector<Entry> mEntries;
+    QVector<Second> mSeconds;
+    // rows of destroyed widgets, handed to the next widget that paints
+    QVector<int> mFreeRows;
+    // totals of destroyed widgets by name, for the dump
+    QHash<QString, Entry> mRetired;
+    bool mOverlay;
+    int mTick;
+    bool mRegistered;
+};
+
+PaintProfiler *PaintProfiler::getInstance()
+{
+    if (!mInstance)
+        mInstance = new PaintProfiler(QCoreApplication::instance());
+    return mInstance;
+}
+
+PaintProfiler::PaintProfiler(QObject *parent) : QObject(parent), d(new Private)
+{
+    d->mEntries.reserve(256);
+    d->mSeconds.reserve(256);
+
+    const QByteArray mode = qgetenv("PLEXY_PAINT_PROFILE");
+    d->mOverlay = mode == "overlay";
+    if (sEnabled) {
+        d->mTick = TickScheduler::getInstance()->schedule(this, "onSecond", 1000);
+        registerOnBus();
+    }
+}
+
+/* only a profiling session claims the bus name, every view creates us */
+void PaintProfiler::registerOnBus()
+{
+    if (d->mRegistered)
+        return;
+    d->mRegistered = true;
+
+#ifdef Q_WS_X11
+    QDBusConnection bus = QDBusConnection::sessionBus();
+    if (bus.registerService(QLatin1String("org.plexydesk.PaintProfiler")))
+        bus.registerObject(QLatin1String("/PaintProfiler"), this, QDBusConnection::ExportScriptableSlots);
+#endif
+}
+
+PaintProfiler::~PaintProfiler()
+{
+    const QString fileName = QFile::decodeName(qgetenv("PLEXY_PAINT_PROFILE_DUMP"));
+    if (!fileName.isEmpty())
+        dump(fileName);
+
+    if (mInstance == this)
+        mInstance = 0;
+    delete d;
+}
+
+bool PaintProfiler::isEnabled()
+{
+    return sEnabled;
+}
+
+bool PaintProfiler::isOverlayVisible() const
+{
+    return sEnabled && d->mOverlay;
+}
+
+void PaintProfiler::setEnabled(bool enabled)
+{
+    if (sEnabled == enabled)
+        return;
+
+    sEnabled = enabled;
+    if (enabled) {
+        d->mTick = TickScheduler::getInstance()->schedule(this, "onSecond", 1000);
+        registerOnBus();
+    } else {
+        TickScheduler::getInstance()->cancel(d->mTick);
+        d->mTick = 0;
+    }
+
+    Q_EMIT updated();
+}
+
+void PaintProfiler::setOverlayVisible(bool visible)
+{
+    if (visible)
+        setEnabled(true);
+
+    if (d->mOverlay == visible)
+        return;
+
+    d->mOverlay = visible;
+    Q_EMIT updated();
+}
+
+int PaintProfiler::addWidget(AbstractDesktopWidget *widget)
+{
+    Entry entry;
+    entry.name = QString::fromLatin1(widget->metaObject()->className());
+    if (!widget->label().isEmpty())
+        entry.name += QLatin1Char(' ') + widget->label();
+    entry.alive = true;
+    entry.paints = entry.nsecs = entry.area = 0;
+    entry.paintsPerSecond = 0;
+    entry.nsecsPerSecond = entry.areaPerSecond = 0;
+
+    Private::Second second = { 0, 0, 0 };
+
+    if (!d->mFreeRows.isEmpty()) {
+        const int row = d->mFreeRows.last();
+        d->mFreeRows.pop_back();
+        d->mEntries[row] = entry;
+        d->mSeconds[row] = second;
+        return row;
+    }
+
+    d->mEntries.append(entry);
+    d->mSeconds.append(second);
+    return d->mEntries.count() - 1;
+}
+
+void PaintProfiler::removeWidget(int row)
+{
+    // widgets can outlive the profiler on shutdown
+    if (!mInstance || row < 0 || row >= mInstance->d->mEntries.count())
+        return;
+
+    Private *d = mInstance->d;
+    Entry &entry = d->mEntries[row];
+    if (!entry.alive)
+        return;
+
+    // the totals are still worth a dump, the row goes to the next widget
+    if (entry.paints > 0) {
+        QHash<QString, Entry>::iterator retired = d->mRetired.find(entry.name);
+        if (retired == d->mRetired.end()) {
+            retired = d->mRetired.insert(entry.name, entry);
+            retired.value().paintsPerSecond = 0;
+            retired.value().nsecsPerSecond = retired.value().areaPerSecond = 0;
+        } else {
+            retired.value().paints += entry.paints;
+            retired.value().nsecs += entry.nsecs;
+            retired.value().area += entry.area;
+        }
+        retired.value().alive = false;
+    }
+
+    entry.alive = false;
+    entry.paints = entry.nsecs = entry.area = 0;
+    entry.paintsPerSecond = 0;
+    entry.nsecsPerSecond = entry.areaPerSecond = 0;
+    d->mFreeRows.append(row);
+}
+
+void PaintProfiler::record(int row, const QElapsedTimer &timer, const QRectF &exposed)
+{
+    const qint64 nsecs = nsecsElapsed(timer);
+    const qint64 area = qint64(exposed.width() * exposed.height());
+
+    Entry &entry = d->mEntries[row];
+    entry.paints++;
+    entry.nsecs += nsecs;
+    entry.area += area;
+
+    Private::Second &second = d->mSeconds[row];
+    second.paints++;
+    second.nsecs += nsecs;
+    second.area += area;
+}
+
+void PaintProfiler::onSecond()
+{
+    for (int i = 0; i < d->mEntries.count(); i++) {
+        Entry &entry = d->mEntries[i];
+        Private::Second &second = d->mSeconds[i];
+        entry.paintsPerSecond = second.paints;
+        entry.nsecsPerSecond = second.nsecs;
+        entry.areaPerSecond = second.area;
+        second.paints = 0;
+        second.nsecs = second.area = 0;
+    }
+
+    Q_EMIT updated();
+}
+
+void PaintProfiler::reset()
+{
+    for (int i = 0; i < d->mEntries.count(); i++) {
+        Entry &entry = d->mEntries[i];
+        entry.paints = entry.nsecs = entry.area = 0;
+        entry.paintsPerSecond = 0;
+        entry.nsecsPerSecond = entry.areaPerSecond = 0;
+
+        Private::Second &second = d->mSeconds[i];
+        second.paints = 0;
+        second.nsecs = second.area = 0;
+    }
+    d->mRetired.clear();
+
+    Q_EMIT updated();
+}
+
+QList<PaintProfiler::Entry> PaintProfiler::entries() const
+{
+    QList<Entry> rv;
+    Q_FOREACH(const Entry &entry, d->mEntries) {
+        if (entry.alive)
+            rv.append(entry);
+    }
+    return rv + d->mRetired.values();
+}
+
+QList<PaintProfiler::Entry> PaintProfiler::topOffenders(int count) const
+{
+    QList<Entry> rv;
+    Q_FOREACH(const Entry &entry, d->mEntries) {
+        if (entry.alive && entry.paintsPerSecond > 0)
+            rv.append(entry);
+    }
+
+    qSort(rv.begin(), rv.end(), slowerLastSecond);
+    return rv.mid(0, count);
+}
+
+bool PaintProfiler::dump(const QString &fileName) const
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qWarning() << Q_FUNC_INFO << "Can not write" << fileName;
+        return false;
+    }
+
+    QList<Entry> rows = entries();
+    qSort(rows.begin(), rows.end(), slowerThan);
+
+    QTextStream out(&file);
+    out << "widget\tpaints\ttotal_ms\tavg_us\tavg_area\tpaints_per_second\tms_per_second\talive\n";
+    Q_FOREACH(const Entry &entry, rows) {
+        const qint64 paints = qMax(qint64(1), entry.paints);
+        out << entry.name << '\t'
+            << entry.paints << '\t'
+            << entry.nsecs / 1000000.0 << '\t'
+            << entry.nsecs / 1000.0 / paints << '\t'
+            << entry.area / paints << '\t'
+            << entry.paintsPerSecond << '\t'
+            << entry.nsecsPerSecond / 1000000.0 << '\t'
+            << (entry.alive ? 1 : 0) << '\n';
+    }
+
+    return true;
+}
+
+QRect PaintProfiler::overlayRect() const
+{
+    const QFontMetrics metrics(QApplication::font());
+    return QRect(OverlayMargin, OverlayMargin, OverlayWidth,
+            (OverlayRows + 1) * metrics.lineSpacing() + 2 * OverlayMargin);
+}
+
+void PaintProfiler::paintOverlay(QPainter *painter) const
+{
+    const QRect rect = overlayRect();
+    const QFontMetrics metrics(QApplication::font());
+
+    painter->fillRect(rect, QColor(0, 0, 0, 180));
+    painter->setFont(QApplication::font());
+    painter->setPen(Qt::white);
+
+    const int nameWidth = rect.width() - 3 * 70 - 2 * OverlayMargin;
+    int y = rect.top() + OverlayMargin + metrics.ascent();
+    int x = rect.left() + OverlayMargin;
+
+    painter->drawText(x, y, QLatin1String("widget"));
+    painter->drawText(x + nameWidth, y, QLatin1String("ms/s"));
+    painter->drawText(x + nameWidth + 70, y, QLatin1String("paints/s"));
+    painter->drawText(x + nameWidth + 140, y, QLatin1String("kpx/paint"));
+
+    Q_FOREACH(const Entry &entry, topOffenders(OverlayRows)) {
+        y += metrics.lineSpacing();
+        painter->drawText(x, y, metrics.elidedText(entry.name, Qt::ElideRight, nameWidth - 4));
+        painter->drawText(x + nameWidth, y, QString::number(entry.nsecsPerSecond / 1000000.0, 'f', 2));
+        painter->drawText(x + nameWidth + 70, y, QString::number(entry.paintsPerSecond));
+        painter->drawText(x + nameWidth + 140, y,
+                QString::number(entry.areaPerSecond / qMax(1, entry.paintsPerSecond) / 1000.0, 'f', 1));
+    }
+}
+
+} // namespace PlexyDesk
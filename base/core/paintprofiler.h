@@ -0,0 +1,125 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+
+#ifndef PLEXY_PAINT_PROFILER_H
+#define PLEXY_PAINT_PROFILER_H
+
+#include <plexy.h>
+#include <QList>
+#include <QObject>
+#include <QRect>
+#include <QString>
+
+class QElapsedTimer;
+class QPainter;
+
+/*!
+   \class PlexyDesk::PaintProfiler
+
+   \brief Opt-in paint counters for desktop widgets
+
+   \paragraph While enabled, AbstractDesktopWidget::paint() records how long
+   every widget took, how much it painted and how often. Each widget owns a
+   row of a flat table that only the gui thread writes, so recording is a
+   few additions without a lookup, a lock or an allocation.
+
+   \paragraph PLEXY_PAINT_PROFILE=1 turns recording on at startup, "overlay"
+   also draws the widgets that spent the most time painting over the last
+   second in the corner of every view. PLEXY_PAINT_PROFILE_DUMP=file writes
+   the table to that file on exit. Rows of destroyed widgets are reused,
+   their totals are kept per widget name. Once profiling is on, on X11 the
+   same switches are reachable on the session bus:
+
+    @verbatim
+        qdbus org.plexydesk.PaintProfiler /PaintProfiler setOverlayVisible true
+        qdbus org.plexydesk.PaintProfiler /PaintProfiler dump /tmp/paint.tsv
+    @endverbatim
+ **/
+namespace PlexyDesk
+{
+
+class AbstractDesktopWidget;
+
+class PLEXYDESKCORE_EXPORT PaintProfiler : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "org.plexydesk.PaintProfiler")
+
+public:
+    struct Entry {
+        QString name;
+        bool alive;
+        qint64 paints;
+        qint64 nsecs;
+        qint64 area;
+        // the last complete second, what the overlay shows
+        int paintsPerSecond;
+        qint64 nsecsPerSecond;
+        qint64 areaPerSecond;
+    };
+
+    static PaintProfiler *getInstance();
+
+    virtual ~PaintProfiler();
+
+    /* checked on every paint, cheap when profiling is off */
+    static bool isEnabled();
+
+    bool isOverlayVisible() const;
+
+    int addWidget(AbstractDesktopWidget *widget);
+    static void removeWidget(int row);
+
+    void record(int row, const QElapsedTimer &timer, const QRectF &exposed);
+
+    QList<Entry> entries() const;
+    QList<Entry> topOffenders(int count) const;
+
+    /* in viewport coordinates */
+    QRect overlayRect() const;
+    void paintOverlay(QPainter *painter) const;
+
+public Q_SLOTS:
+    Q_SCRIPTABLE void setEnabled(bool enabled);
+    Q_SCRIPTABLE void setOverlayVisible(bool visible);
+    Q_SCRIPTABLE bool dump(const QString &fileName) const;
+    Q_SCRIPTABLE void reset();
+
+Q_SIGNALS:
+    void updated();
+
+private Q_SLOTS:
+    void onSecond();
+
+private:
+    PaintProfiler(QObject *parent = 0);
+    void registerOnBus();
+
+    class Private;
+    Private *const d;
+#ifdef Q_WS_WIN
+    static PaintProfiler *mInstance;
+#else
+    static PLEXYDESKCORE_EXPORT PaintProfiler *mInstance;
+#endif
+};
+
+} // namespace PlexyDesk
+
+#endif
@@ -0,0 +1,191 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+
+#include "testsceneindex.h"
+
+#include <abstractdesktopview.h>
+#include <abstractdesktopwidget.h>
+
+using namespace PlexyDesk;
+
+static const QRectF DesktopRect(0, 0, 1920, 1080);
+static const int HitTestsPerRun = 100;
+static const int DragFrames = 60;
+
+class BenchView : public AbstractDesktopView
+{
+public:
+    BenchView(QGraphicsScene *scene) : AbstractDesktopView(scene) {}
+    void layout(const QRectF &) {}
+};
+
+class BenchWidget : public AbstractDesktopWidget
+{
+public:
+    BenchWidget() : AbstractDesktopWidget(QRectF(0, 0, 120, 120)) {
+        // most desktop widgets carry a few children, the index has to see them too
+        QGraphicsRectItem *label = new QGraphicsRectItem(10, 90, 100, 20, this);
+        label->setBrush(Qt::white);
+    }
+
+protected:
+    void paintRotatedView(QPainter *p, const QRectF &rect) { p->fillRect(rect, Qt::darkGray); }
+    void paintFrontView(QPainter *p, const QRectF &rect) { p->fillRect(rect, Qt::gray); }
+    void paintDockView(QPainter *p, const QRectF &rect) { p->fillRect(rect, Qt::lightGray); }
+    void paintEditMode(QPainter *, const QRectF &) {}
+};
+
+class BenchDesktop
+{
+public:
+    BenchDesktop(int count, AbstractDesktopView::IndexMethod method) {
+        scene.setSceneRect(DesktopRect);
+        view = new BenchView(&scene);
+        view->setIndexMethod(method);
+
+        qsrand(42);
+        for (int i = 0; i < count; i++) {
+            BenchWidget *widget = new BenchWidget;
+            scene.addItem(widget);
+            widget->setPos(qrand() % int(DesktopRect.width() - 120),
+                    qrand() % int(DesktopRect.height() - 120));
+            widgets.append(widget);
+        }
+
+        for (int i = 0; i < HitTestsPerRun; i++)
+            points.append(QPointF(qrand() % int(DesktopRect.width()),
+                        qrand() % int(DesktopRect.height())));
+
+        // the tree is built lazily, keep that out of the measurement
+        scene.items(points.first());
+    }
+
+    ~BenchDesktop() {
+        delete view;
+    }
+
+    QGraphicsScene scene;
+    BenchView *view;
+    QList<BenchWidget *> widgets;
+    QList<QPointF> points;
+};
+
+void TestSceneIndex::addRows()
+{
+    QTest::addColumn<int>("count");
+    QTest::addColumn<int>("method");
+
+    const int counts[] = { 50, 200, 1000 };
+    for (int i = 0; i < 3; i++) {
+        const QByteArray count = QByteArray::number(counts[i]);
+        QTest::newRow(count + " none") << counts[i] << int(AbstractDesktopView::NoIndex);
+        QTest::newRow(count + " bsp") << counts[i] << int(AbstractDesktopView::BspTreeIndex);
+        QTest::newRow(count + " adaptive") << counts[i] << int(AbstractDesktopView::AdaptiveIndex);
+    }
+}
+
+void TestSceneIndex::adaptiveIndexFollowsMotion()
+{
+    BenchDesktop desktop(10, AbstractDesktopView::AdaptiveIndex);
+    QCOMPARE(desktop.scene.itemIndexMethod(), QGraphicsScene::BspTreeIndex);
+
+    desktop.widgets.first()->setInMotion(true);
+    QCOMPARE(desktop.view->itemsInMotion(), 1);
+    QCOMPARE(desktop.scene.itemIndexMethod(), QGraphicsScene::NoIndex);
+
+    desktop.widgets.first()->setInMotion(false);
+    QCOMPARE(desktop.view->itemsInMotion(), 0);
+
+    // the tree comes back once things have been still for a moment
+    QTest::qWait(400);
+    QCOMPARE(desktop.scene.itemIndexMethod(), QGraphicsScene::BspTreeIndex);
+
+    // a widget deleted mid drag must not pin the view on the linear scan
+    desktop.widgets.last()->setInMotion(true);
+    delete desktop.widgets.takeLast();
+    QCOMPARE(desktop.view->itemsInMotion(), 0);
+}
+
+void TestSceneIndex::hitTest_data()
+{
+    addRows();
+}
+
+void TestSceneIndex::hitTest()
+{
+    QFETCH(int, count);
+    QFETCH(int, method);
+
+    BenchDesktop desktop(count, AbstractDesktopView::IndexMethod(method));
+
+    int hits = 0;
+    QBENCHMARK {
+        Q_FOREACH(const QPointF &point, desktop.points)
+            hits += desktop.scene.items(point).count();
+    }
+    QVERIFY(hits > 0);
+}
+
+void TestSceneIndex::repaint_data()
+{
+    addRows();
+}
+
+void TestSceneIndex::repaint()
+{
+    QFETCH(int, count);
+    QFETCH(int, method);
+
+    BenchDesktop desktop(count, AbstractDesktopView::IndexMethod(method));
+
+    // a small exposed region, the common case when one widget updates
+    const QRectF exposed(800, 400, 200, 200);
+    QImage target(exposed.size().toSize(), QImage::Format_ARGB32_Premultiplied);
+
+    QBENCHMARK {
+        QPainter painter(&target);
+        desktop.scene.render(&painter, QRectF(QPointF(0, 0), exposed.size()), exposed);
+    }
+}
+
+void TestSceneIndex::drag_data()
+{
+    addRows();
+}
+
+void TestSceneIndex::drag()
+{
+    QFETCH(int, count);
+    QFETCH(int, method);
+
+    BenchDesktop desktop(count, AbstractDesktopView::IndexMethod(method));
+    BenchWidget *widget = desktop.widgets.first();
+
+    // every frame moves the widget and then hit tests under the cursor
+    QBENCHMARK {
+        widget->setInMotion(true);
+        for (int i = 0; i < DragFrames; i++) {
+            widget->moveBy(i % 2 ? 3 : -3, 2);
+            desktop.scene.items(widget->scenePos() + QPointF(5, 5));
+        }
+        widget->setInMotion(false);
+    }
+}
+
+QTEST_MAIN(TestSceneIndex)
@@ -0,0 +1,45 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+
+#include <QtTest/QtTest>
+
+/*
+ * Hit test, repaint and drag cost of the desktop scene with 50, 200
+ * and 1000 widgets for each index method. Run with -tickcounter or
+ * -callgrind for numbers that are stable across machines.
+ */
+class TestSceneIndex: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void adaptiveIndexFollowsMotion();
+
+    void hitTest_data();
+    void hitTest();
+
+    void repaint_data();
+    void repaint();
+
+    void drag_data();
+    void drag();
+
+private:
+    void addRows();
+};
@@ -0,0 +1,118 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+#include "testtickscheduler.h"
+
+#include <tickscheduler.h>
+
+using namespace PlexyDesk;
+
+void TestTickScheduler::init()
+{
+    TickScheduler *scheduler = TickScheduler::getInstance();
+    scheduler->setWallClockSkew(0);
+    scheduler->resetStatistics();
+}
+
+void TestTickScheduler::cleanup()
+{
+    TickScheduler::getInstance()->setWallClockSkew(0);
+}
+
+void TestTickScheduler::coalescesIntervals()
+{
+    TickScheduler *scheduler = TickScheduler::getInstance();
+    TickCounter fast, slow;
+
+    scheduler->schedule(&fast, "onTick", 100);
+    scheduler->schedule(&slow, "onTick", 200);
+
+    QTest::qWait(1050);
+
+    QVERIFY(fast.ticks >= 8);
+    QVERIFY(slow.ticks >= 4);
+
+    // every slow tick is aligned with a fast one, they share the wake up
+    const QVariantMap stats = scheduler->statistics();
+    QVERIFY(stats["wakeups"].toULongLong() < stats["ticks"].toULongLong());
+    QVERIFY(stats["ticksPerWakeup"].toDouble() > 1.2);
+
+    scheduler->cancelAll(&fast);
+    scheduler->cancelAll(&slow);
+}
+
+void TestTickScheduler::cancelStopsTicks()
+{
+    TickScheduler *scheduler = TickScheduler::getInstance();
+    TickCounter counter;
+
+    const int id = scheduler->schedule(&counter, "onTick", 50);
+    QTest::qWait(230);
+    QVERIFY(counter.ticks > 0);
+
+    scheduler->cancel(id);
+    const int ticks = counter.ticks;
+    QTest::qWait(200);
+    QCOMPARE(counter.ticks, ticks);
+    QCOMPARE(scheduler->statistics()["scheduled"].toInt(), 0);
+}
+
+void TestTickScheduler::pausedReceiverCatchesUp()
+{
+    TickScheduler *scheduler = TickScheduler::getInstance();
+    TickCounter counter;
+
+    scheduler->schedule(&counter, "onTick", 50);
+    scheduler->setPaused(&counter, true);
+    QTest::qWait(200);
+    QCOMPARE(counter.ticks, 0);
+
+    // one catch up tick right after resuming, then the usual interval
+    scheduler->setPaused(&counter, false);
+    QTest::qWait(20);
+    QCOMPARE(counter.ticks, 1);
+
+    scheduler->cancelAll(&counter);
+}
+
+void TestTickScheduler::survivesClockStep()
+{
+    TickScheduler *scheduler = TickScheduler::getInstance();
+    TickCounter counter;
+
+    scheduler->schedule(&counter, "onTick", 100);
+    QTest::qWait(250);
+    const int before = counter.ticks;
+    QVERIFY(before > 0);
+
+    // the wall clock jumps back an hour, deadlines must keep running
+    scheduler->setWallClockSkew(-3600 * 1000);
+    QTest::qWait(350);
+    QVERIFY(counter.ticks >= before + 2);
+
+    // and forward again, no burst of missed ticks either
+    const int afterBack = counter.ticks;
+    scheduler->setWallClockSkew(3600 * 1000);
+    QTest::qWait(350);
+    QVERIFY(counter.ticks >= afterBack + 2);
+    QVERIFY(counter.ticks <= afterBack + 5);
+
+    scheduler->cancelAll(&counter);
+}
+
+QTEST_MAIN(TestTickScheduler)
@@ -0,0 +1,302 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+#include "tickscheduler.h"
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMetaObject>
+#include <QPointer>
+#include <QSet>
+#include <QTimer>
+#include <QtDebug>
+
+namespace PlexyDesk
+{
+
+TickScheduler *TickScheduler::mInstance = 0;
+
+class TickScheduler::Private
+{
+public:
+    Private() : mNextId(1), mDefaultSlack(50), mWallClockSkew(0), mWakeups(0), mTickCount(0) {
+        mClock.start();
+    }
+    ~Private() {}
+
+    struct Tick {
+        QPointer<QObject> receiver;
+        QByteArray member;
+        int interval;
+        int requestedSlack;
+        int slack;
+        qint64 due;
+    };
+
+    /* deadlines live on the monotonic clock, a wall clock step can't freeze them */
+    qint64 now() const {
+        return mClock.elapsed();
+    }
+
+    /* the next multiple of interval on the wall clock, shared by every source
+       with that interval; the wall clock only decides the phase */
+    qint64 alignedAfter(qint64 time, int interval) const {
+        const qint64 phase = QDateTime::currentMSecsSinceEpoch() + mWallClockSkew - mClock.elapsed();
+        qint64 offset = (time + phase) % interval;
+        if (offset < 0)
+            offset += interval;
+        return time + interval - offset;
+    }
+
+    int slackFor(int interval, int slack) const {
+        if (slack >= 0)
+            return slack;
+        return qMin(mDefaultSlack, interval / 4);
+    }
+
+    QHash<int, Tick> mTicks;
+    QSet<QObject *> mPaused;
+    QTimer mTimer;
+    int mNextId;
+    int mDefaultSlack;
+    qint64 mWallClockSkew;
+    QElapsedTimer mClock;
+
+    quint64 mWakeups;
+    quint64 mTickCount;
+    QElapsedTimer mStatsClock;
+};
+
+TickScheduler::TickScheduler(QObject *parent) : QObject(parent), d(new Private)
+{
+    d->mTimer.setSingleShot(true);
+    d->mStatsClock.start();
+    connect(&d->mTimer, SIGNAL(timeout()), this, SLOT(onTimeout()));
+}
+
+TickScheduler::~TickScheduler()
+{
+    if (mInstance == this)
+        mInstance = 0;
+    delete d;
+}
+
+TickScheduler *TickScheduler::getInstance()
+{
+    if (!mInstance) {
+        mInstance = new TickScheduler();
+    }
+    return mInstance;
+}
+
+int TickScheduler::schedule(QObject *receiver, const char *member, int interval, int slack)
+{
+    if (!receiver || !member || interval <= 0)
+        return 0;
+
+    Private::Tick tick;
+    tick.receiver = receiver;
+    tick.member = member;
+    tick.interval = interval;
+    tick.requestedSlack = slack;
+    tick.slack = d->slackFor(interval, slack);
+    tick.due = d->alignedAfter(d->now(), interval);
+
+    const int id = d->mNextId++;
+    d->mTicks[id] = tick;
+
+    connect(receiver, SIGNAL(destroyed(QObject *)), this, SLOT(onReceiverDestroyed(QObject *)),
+            Qt::UniqueConnection);
+
+    rearm();
+    return id;
+}
+
+void TickScheduler::setInterval(int id, int interval)
+{
+    if (!d->mTicks.contains(id) || interval <= 0)
+        return;
+
+    Private::Tick &tick = d->mTicks[id];
+    if (tick.interval == interval)
+        return;
+
+    tick.interval = interval;
+    tick.slack = d->slackFor(interval, tick.requestedSlack);
+    tick.due = d->alignedAfter(d->now(), interval);
+    rearm();
+}
+
+void TickScheduler::cancel(int id)
+{
+    if (d->mTicks.remove(id))
+        rearm();
+}
+
+void TickScheduler::cancelAll(QObject *receiver)
+{
+    QHash<int, Private::Tick>::iterator it = d->mTicks.begin();
+    while (it != d->mTicks.end()) {
+        if (it.value().receiver == receiver)
+            it = d->mTicks.erase(it);
+        else
+            ++it;
+    }
+    rearm();
+}
+
+void TickScheduler::setPaused(QObject *receiver, bool paused)
+{
+    if (!receiver || paused == d->mPaused.contains(receiver))
+        return;
+
+    if (paused) {
+        d->mPaused.insert(receiver);
+        connect(receiver, SIGNAL(destroyed(QObject *)), this, SLOT(onReceiverDestroyed(QObject *)),
+                Qt::UniqueConnection);
+    } else {
+        d->mPaused.remove(receiver);
+
+        /* one catch up tick, the data went stale while nobody looked */
+        const qint64 now = d->now();
+        QHash<int, Private::Tick>::iterator it;
+        for (it = d->mTicks.begin(); it != d->mTicks.end(); ++it) {
+            if (it.value().receiver == receiver)
+                it.value().due = now;
+        }
+    }
+
+    rearm();
+    Q_EMIT pausedChanged(receiver, paused);
+}
+
+bool TickScheduler::isPaused(QObject *receiver) const
+{
+    return d->mPaused.contains(receiver);
+}
+
+void TickScheduler::setDefaultSlack(int msecs)
+{
+    d->mDefaultSlack = qMax(0, msecs);
+}
+
+int TickScheduler::defaultSlack() const
+{
+    return d->mDefaultSlack;
+}
+
+void TickScheduler::setWallClockSkew(qint64 msecs)
+{
+    d->mWallClockSkew = msecs;
+}
+
+QVariantMap TickScheduler::statistics() const
+{
+    QVariantMap stats;
+    const qint64 elapsed = d->mStatsClock.elapsed();
+
+    int paused = 0;
+    Q_FOREACH(const Private::Tick &tick, d->mTicks) {
+        if (d->mPaused.contains(tick.receiver))
+            paused++;
+    }
+
+    stats["wakeups"] = d->mWakeups;
+    stats["ticks"] = d->mTickCount;
+    stats["elapsed"] = elapsed;
+    stats["wakeupsPerSecond"] = elapsed > 0 ? (1000.0 * d->mWakeups) / elapsed : 0.0;
+    stats["ticksPerWakeup"] = d->mWakeups ? double(d->mTickCount) / d->mWakeups : 0.0;
+    stats["scheduled"] = d->mTicks.count();
+    stats["paused"] = paused;
+
+    return stats;
+}
+
+void TickScheduler::resetStatistics()
+{
+    d->mWakeups = 0;
+    d->mTickCount = 0;
+    d->mStatsClock.restart();
+}
+
+void TickScheduler::rearm()
+{
+    qint64 fireAt = -1;
+    Q_FOREACH(const Private::Tick &tick, d->mTicks) {
+        if (d->mPaused.contains(tick.receiver))
+            continue;
+        const qint64 latest = tick.due + tick.slack;
+        if (fireAt < 0 || latest < fireAt)
+            fireAt = latest;
+    }
+
+    if (fireAt < 0) {
+        d->mTimer.stop();
+        return;
+    }
+
+    d->mTimer.start(int(qMax(qint64(0), fireAt - d->now())));
+}
+
+void TickScheduler::onTimeout()
+{
+    const qint64 now = d->now();
+    QList<QPair<QPointer<QObject>, QByteArray> > due;
+
+    /* everything whose window has opened rides along with this wake up */
+    QHash<int, Private::Tick>::iterator it;
+    for (it = d->mTicks.begin(); it != d->mTicks.end(); ++it) {
+        Private::Tick &tick = it.value();
+        if (tick.due > now || d->mPaused.contains(tick.receiver))
+            continue;
+        tick.due = d->alignedAfter(now, tick.interval);
+        due.append(qMakePair(tick.receiver, tick.member));
+    }
+
+    /* an early timer still woke the cpu, count it */
+    d->mWakeups++;
+    d->mTickCount += due.count();
+
+    rearm();
+
+    // slots may schedule or cancel, the bookkeeping above is already done
+    for (int i = 0; i < due.count(); i++) {
+        if (due.at(i).first)
+            QMetaObject::invokeMethod(due.at(i).first, due.at(i).second.constData());
+    }
+
+    if (!due.isEmpty())
+        Q_EMIT woke(due.count());
+}
+
+void TickScheduler::onReceiverDestroyed(QObject *receiver)
+{
+    d->mPaused.remove(receiver);
+
+    QHash<int, Private::Tick>::iterator it = d->mTicks.begin();
+    while (it != d->mTicks.end()) {
+        if (!it.value().receiver || it.value().receiver == receiver)
+            it = d->mTicks.erase(it);
+        else
+            ++it;
+    }
+    rearm();
+}
+
+} // namespace PlexyDesk
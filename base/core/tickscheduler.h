@@ -0,0 +1,121 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+#ifndef PLEXY_TICK_SCHEDULER_H
+#define PLEXY_TICK_SCHEDULER_H
+
+#include <plexy.h>
+#include <QObject>
+#include <QVariantMap>
+
+/*!
+   \class PlexyDesk::TickScheduler
+
+   \brief Shared, coalescing timer for periodic data sources
+
+   \paragraph Instead of running a QTimer each, periodic sources register
+   a slot with the scheduler. Deadlines are aligned to multiples of their
+   interval on the wall clock, so every one second source lands on the same
+   boundary, and each deadline may be deferred by a slack window so that
+   sources with different intervals share a single wake up. All the slots
+   that are due are invoked from that one wake.
+
+   \paragraph Sources can be paused as a whole, for instance while every view
+   showing them is hidden or docked, see PlexyDesk::ControllerInterface.
+   Paused receivers get one catch up tick as soon as they are resumed.
+
+    @verbatim
+        mTick = PlexyDesk::TickScheduler::getInstance()->schedule(this, "onTick", 1000);
+    @endverbatim
+
+   \fn PlexyDesk::TickScheduler::schedule()
+   \brief Invokes \a member on \a receiver every \a interval milliseconds
+   \param slack How long the tick may be deferred to share a wake up,
+   -1 uses defaultSlack() capped to a quarter of the interval
+   \returns An id to be used with cancel() and setInterval()
+
+   \fn PlexyDesk::TickScheduler::setWallClockSkew()
+   \brief Offsets the wall clock used for alignment by \a msecs, for tests
+   simulating a clock step. Deadlines themselves run on a monotonic clock.
+
+   \fn PlexyDesk::TickScheduler::pausedChanged()
+   \brief Emitted when \a receiver is paused or resumed with setPaused()
+
+   \fn PlexyDesk::TickScheduler::statistics()
+   \brief Wake up counters since the last resetStatistics()
+
+   \paragraph Keys are "wakeups", "ticks", "elapsed" (ms), "wakeupsPerSecond",
+   "ticksPerWakeup", "scheduled" and "paused".
+ **/
+namespace PlexyDesk
+{
+
+class PLEXYDESKCORE_EXPORT TickScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    static TickScheduler *getInstance();
+
+    virtual ~TickScheduler();
+
+    int schedule(QObject *receiver, const char *member, int interval, int slack = -1);
+
+    void setInterval(int id, int interval);
+
+    void cancel(int id);
+
+    void cancelAll(QObject *receiver);
+
+    void setPaused(QObject *receiver, bool paused);
+
+    bool isPaused(QObject *receiver) const;
+
+    void setDefaultSlack(int msecs);
+
+    int defaultSlack() const;
+
+    void setWallClockSkew(qint64 msecs);
+
+    QVariantMap statistics() const;
+
+    void resetStatistics();
+
+Q_SIGNALS:
+    void woke(int ticks);
+    void pausedChanged(QObject *receiver, bool paused);
+
+private Q_SLOTS:
+    void onTimeout();
+    void onReceiverDestroyed(QObject *receiver);
+
+private:
+    TickScheduler(QObject *parent = 0);
+    void rearm();
+
+    class Private;
+    Private *const d;
+#ifdef Q_WS_WIN
+    static TickScheduler *mInstance;
+#else
+    static PLEXYDESKCORE_EXPORT TickScheduler *mInstance;
+#endif
+};
+
+} // namespace PlexyDesk
+#endif
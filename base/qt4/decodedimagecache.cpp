@@ -0,0 +1,183 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+
+#include <QCache>
+#include <QHash>
+#include <QImageReader>
+#include <QtDebug>
+
+#include <decodedimagecache.h>
+
+namespace PlexyDesk
+{
+
+class DecodedImageCache::Private
+{
+public:
+    Private() : mDecodes(0) {
+        mImages.setMaxCost(32 * 1024 * 1024);
+    }
+    ~Private() {
+    }
+
+    static QString key(const QString &path, const QSize &size, Qt::AspectRatioMode mode) {
+        if (!size.isValid())
+            return path;
+        return QString("%1@%2x%3:%4").arg(path).arg(size.width())
+            .arg(size.height()).arg(int(mode));
+    }
+
+    QCache<QString, QImage> mImages;
+    QHash<QString, QSize> mSizes;
+    int mDecodes;
+};
+
+DecodedImageCache *DecodedImageCache::mInstance = 0;
+
+DecodedImageCache *DecodedImageCache::getInstance()
+{
+    if (!mInstance)
+        mInstance = new DecodedImageCache();
+    return mInstance;
+}
+
+DecodedImageCache::DecodedImageCache() : d(new Private)
+{
+}
+
+DecodedImageCache::~DecodedImageCache()
+{
+    if (mInstance == this)
+        mInstance = 0;
+    delete d;
+}
+
+QImage DecodedImageCache::image(const QString &path)
+{
+    return scaled(path, QSize());
+}
+
+QImage DecodedImageCache::scaled(const QString &path, const QSize &size, Qt::AspectRatioMode mode)
+{
+    if (path.isEmpty())
+        return QImage();
+
+    const QString key = Private::key(path, size, mode);
+    if (QImage *cached = d->mImages.object(key))
+        return *cached;
+
+    const QImage result = decode(path, size, mode);
+
+    // failures are cached too, a missing icon must not hit the disk on every paint
+    d->mImages.insert(key, new QImage(result), qMax(1, result.byteCount()));
+    return result;
+}
+
+QSize DecodedImageCache::imageSize(const QString &path)
+{
+    QHash<QString, QSize>::const_iterator it = d->mSizes.constFind(path);
+    if (it != d->mSizes.constEnd())
+        return it.value();
+
+    QSize size;
+    if (QImage *cached = d->mImages.object(path)) {
+        size = cached->size();
+    } else {
+        QImageReader reader(path);
+        size = reader.size();
+    }
+
+    d->mSizes.insert(path, size);
+    return size;
+}
+
+QImage DecodedImageCache::decode(const QString &path, const QSize &size, Qt::AspectRatioMode mode)
+{
+    d->mDecodes++;
+
+    QImageReader reader(path);
+    const QSize original = reader.size();
+    if (original.isValid())
+        d->mSizes.insert(path, original);
+
+    if (size.isValid() && original.isValid()) {
+        const QSize target = original.scaled(size, mode);
+        // let the codec scale while decoding, jpeg can skip most of the work
+        if (reader.supportsOption(QImageIOHandler::ScaledSize))
+            reader.setScaledSize(target);
+
+        QImage image = reader.read();
+        if (!image.isNull() && image.size() != target)
+            image = image.scaled(target, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+        return image;
+    }
+
+    QImage image = reader.read();
+    if (image.isNull())
+        qDebug() << Q_FUNC_INFO << path << reader.errorString();
+    else if (size.isValid())
+        image = image.scaled(size, mode, Qt::SmoothTransformation);
+    return image;
+}
+
+bool DecodedImageCache::contains(const QString &path, const QSize &size) const
+{
+    return d->mImages.contains(Private::key(path, size, Qt::KeepAspectRatio));
+}
+
+void DecodedImageCache::remove(const QString &path)
+{
+    d->mSizes.remove(path);
+    Q_FOREACH(const QString &key, d->mImages.keys()) {
+        if (key == path || key.startsWith(path + QLatin1Char('@')))
+            d->mImages.remove(key);
+    }
+}
+
+void DecodedImageCache::clear()
+{
+    d->mImages.clear();
+    d->mSizes.clear();
+}
+
+void DecodedImageCache::setMaxCost(int bytes)
+{
+    d->mImages.setMaxCost(bytes);
+}
+
+int DecodedImageCache::maxCost() const
+{
+    return d->mImages.maxCost();
+}
+
+int DecodedImageCache::totalCost() const
+{
+    return d->mImages.totalCost();
+}
+
+int DecodedImageCache::decodeCount() const
+{
+    return d->mDecodes;
+}
+
+void DecodedImageCache::resetDecodeCount()
+{
+    d->mDecodes = 0;
+}
+} //namespace
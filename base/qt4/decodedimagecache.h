@@ -0,0 +1,76 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+
+#ifndef DECODED_IMAGE_CACHE_H
+#define DECODED_IMAGE_CACHE_H
+
+#include <QImage>
+#include <QSize>
+#include <QString>
+
+#include "plexydeskuicore_global.h"
+
+namespace PlexyDesk
+{
+/*
+ * Process wide cache of decoded images, shared by widgets that draw
+ * files from disk. Images are kept decoded (and optionally pre-scaled)
+ * so a paint never has to touch the file system. The cache is bounded
+ * by the number of bytes the decoded images use, least recently used
+ * entries are dropped first.
+ */
+class PLEXYDESKUICORE_EXPORT DecodedImageCache
+{
+public:
+    static DecodedImageCache *getInstance();
+    virtual ~DecodedImageCache();
+
+    /* the decoded image at full size, a null image if it can't be read */
+    QImage image(const QString &path);
+
+    /* the image scaled to fit size, decoded straight to that size */
+    QImage scaled(const QString &path, const QSize &size,
+            Qt::AspectRatioMode mode = Qt::KeepAspectRatio);
+
+    /* the size stored in the file header, without decoding the pixels */
+    QSize imageSize(const QString &path);
+
+    bool contains(const QString &path, const QSize &size = QSize()) const;
+    void remove(const QString &path);
+    void clear();
+
+    void setMaxCost(int bytes);
+    int maxCost() const;
+    int totalCost() const;
+
+    /* test hook, the number of times a file was actually decoded */
+    int decodeCount() const;
+    void resetDecodeCount();
+
+private:
+    DecodedImageCache();
+    QImage decode(const QString &path, const QSize &size, Qt::AspectRatioMode mode);
+
+    class Private;
+    Private *const d;
+    static DecodedImageCache *mInstance;
+};
+}
+
+#endif
@@ -6,17 +6,21 @@
 #include <QGraphicsSceneMouseEvent>
 #include <QStyleOptionGraphicsItem>
 #include <QGraphicsProxyWidget>
+#include <QGraphicsView>
 #include <QPainter>
+#include <QPointer>
 #include <QTimeLine>
 #include <QTimer>
 #include <QDir>
 #include <QDeclarativeEngine>
 #include <QDeclarativeComponent>
+#include <qmath.h>
 
 #include <imagecache.h>
-#include <svgprovider.h>
+#include <ninepatch.h>
 #include <nativestyle.h>
 #include <windowbutton.h>
+#include <shadowitem.h>
 
 namespace PlexyDesk
 {
@@ -29,12 +33,14 @@ public:
     }
     ~PrivateDesktopWidget()
     {
+        // a sibling, not a child, nobody else deletes it
+        delete mShadowItem;
     }
 
     QRectF mBoundingRect;
     QTimer *mPressHoldTimer;
     AbstractDesktopWidget::State mWidgetState;
-    QPixmap mDefaultBackgroundPixmap;
+    NinePatch mFrame;
 
     QRectF saveRect;
     QPointF clickPos;
@@ -44,16 +50,22 @@ public:
     bool mWindowMode;
     bool mEditMode;
 
-    // image cache
-    SvgProvider *mSvgRender;
-
     QPropertyAnimation *mPropertyAnimationForZoom;
     QPropertyAnimation *mPropertyAnimationForRotation;
 
+    ShadowMode mShadowMode;
     QGraphicsDropShadowEffect *mShadowEffect;
+    QPointer<ShadowItem> mShadowItem;
     Style *mStyle;
     QString mWindowTitle;
     WindowButton *mCloseButton;
+
+    // faces captured when a flip or zoom starts, painted instead of the live view
+    bool mSnapshots;
+    bool mShowingBack;
+    AbstractDesktopWidget::State mSnapshotState;
+    QImage mFrontSnapshot;
+    QImage mBackSnapshot;
 };
 
 DesktopWidget::DesktopWidget(const QRectF &rect, QGraphicsObject *parent)
@@ -68,6 +80,11 @@ DesktopWidget::DesktopWidget(const QRectF &rect, QGraphicsObject *parent)
     d->mStyle = 0;
     d->mDockMode = true;
     d->mWindowMode = true;
+    d->mShadowMode = NoShadow;
+    d->mShadowEffect = 0;
+    d->mSnapshots = false;
+    d->mShowingBack = false;
+    d->mSnapshotState = VIEW;
 
     setStyle(new NativeStyle(this));
 
@@ -84,15 +101,15 @@ DesktopWidget::DesktopWidget(const QRectF &rect, QGraphicsObject *parent)
 
     connect(d->mPropertyAnimationForZoom, SIGNAL(finished()), this, SLOT(propertyAnimationForZoomDone()));
     connect(d->mPropertyAnimationForRotation, SIGNAL(finished()), this, SLOT(propertyAnimationForRotationDone()));
+    connect(this, SIGNAL(rectChanged()), this, SLOT(syncShadowGeometry()));
 
-    d->mSvgRender = new SvgProvider();
     //setDefaultImages();
 
-    //setCacheMode(QGraphicsItem::ItemCoordinateCache, d->mDefaultBackgroundPixmap.size());
     setCacheMode(DeviceCoordinateCache);
     setAcceptedMouseButtons(Qt::LeftButton | Qt::RightButton);
     setFlag(QGraphicsItem::ItemIsMovable, true);
     setFlag(QGraphicsItem::ItemClipsChildrenToShape, true);
+    setFlag(QGraphicsItem::ItemSendsGeometryChanges, true);
     setAcceptsHoverEvents(true);
 
     //presshold
@@ -100,12 +117,7 @@ DesktopWidget::DesktopWidget(const QRectF &rect, QGraphicsObject *parent)
     connect(d->mPressHoldTimer, SIGNAL(timeout()), this, SLOT(pressHoldTimeOut()));
 
     //dropshadow
-    d->mShadowEffect = new QGraphicsDropShadowEffect(this);
-    d->mShadowEffect->setBlurRadius(16);
-    d->mShadowEffect->setXOffset(0);
-    d->mShadowEffect->setYOffset(0);
-    d->mShadowEffect->setColor(QColor(0.0, 0.0, 0.0));
-    this->setGraphicsEffect(d->mShadowEffect);
+    setShadowMode(CachedShadow);
 
     //window buttons
     d->mCloseButton = new WindowButton(this);
@@ -131,125 +143,124 @@ void DesktopWidget::enableDefaultBackground(bool enable)
         d->mCloseButton->hide();
     }
     d->mDefaultBackground = enable;
+    syncShadow();
 }
 
 void DesktopWidget::enableShadow(bool enable)
 {
-    if(!enable) {
-        d->mShadowEffect->setBlurRadius(0);
-    } else {
-        d->mShadowEffect->setBlurRadius(16);
+    if (!enable) {
+        setShadowMode(NoShadow);
+    } else if (d->mShadowMode == NoShadow) {
+        setShadowMode(CachedShadow);
     }
 }
 
-void DesktopWidget::enableDockMode(bool enable)
+void DesktopWidget::setShadowMode(ShadowMode mode)
 {
-    d->mDockMode = enable;
-}
+    if (mode == d->mShadowMode)
+        return;
 
-void DesktopWidget::enableWindowMode(bool enable)
-{
-    d->mWindowMode = enable;
+    d->mShadowMode = mode;
 
-    if (enable && d->mCloseButton) {
-        d->mCloseButton->show();
-    } else if (d->mCloseButton) {
-        d->mCloseButton->hide();
+    if (mode == EffectShadow) {
+        d->mShadowEffect = new QGraphicsDropShadowEffect(this);
+        d->mShadowEffect->setBlurRadius(16);
+        d->mShadowEffect->setXOffset(0);
+        d->mShadowEffect->setYOffset(0);
+        d->mShadowEffect->setColor(QColor(0.0, 0.0, 0.0));
+        this->setGraphicsEffect(d->mShadowEffect);
+    } else if (d->mShadowEffect) {
+        // deletes the effect
+        this->setGraphicsEffect(0);
+        d->mShadowEffect = 0;
     }
-}
 
-void DesktopWidget::setDefaultImages()
-{
-    if (boundingRect().width() == 0 || boundingRect().height() == 0) {
-        d->mHasDefaultBackground = false;
-        return;
+    if (mode == CachedShadow) {
+        if (!d->mShadowItem) {
+            d->mShadowItem = new ShadowItem();
+            d->mShadowItem->setBlurRadius(16);
+            d->mShadowItem->setCornerRadius(4);
+        }
+        syncShadow();
+    } else {
+        delete d->mShadowItem;
     }
-    d->mDefaultBackgroundPixmap = genDefaultBackground(boundingRect().width(), boundingRect().height());
-    d->mHasDefaultBackground = true;
 }
 
-QPixmap DesktopWidget::genDefaultBackground(int w, int h)
+DesktopWidget::ShadowMode DesktopWidget::shadowMode() const
 {
-    if (w == 0 || h == 0) {
-        return QPixmap();
-    }
-
-    /* widget top */
-    QRect dock_rect (0, 0, w, h);
-    QRect dock_topleft(0, 0, 10, 10);
-    QRect dock_topright((dock_rect.width() - 10), 0, 10, 10);
-    QRect dock_top(10, 0, (dock_rect.width() - 20), 10);
-
-    QRect dock_right((dock_rect.width() - 10), 10, 10, (dock_rect.height() - 10));
-
-    QRect dock_bottomright((dock_rect.width() - 10), (dock_rect.height() - 10), 10, 10);
-    QRect dock_bottom(10, (dock_rect.height() - 10), (dock_rect.width() - 20), 10);
-    QRect dock_bottomleft(0, (dock_rect.height() - 10), 10, 10);
-
-    QRect dock_left (0, 10, 10, (dock_rect.height() - 20));
-
-    QImage canvas (dock_rect.width(), dock_rect.height(), QImage::Format_ARGB32_Premultiplied);
+    return d->mShadowMode;
+}
 
-    QPainter svg_painter(&canvas);
-    svg_painter.setCompositionMode(QPainter::CompositionMode_Source);
-    svg_painter.setBackgroundMode(Qt::TransparentMode);
-    svg_painter.setRenderHint(QPainter::SmoothPixmapTransform);
-    svg_painter.fillRect(dock_rect, Qt::transparent);
+void DesktopWidget::syncShadow()
+{
+    if (!d->mShadowItem)
+        return;
 
-    svg_painter.save();
-    svg_painter.setPen (Qt::black);
-    svg_painter.drawRect(dock_rect);
-    svg_painter.restore();
+    ShadowItem *shadow = d->mShadowItem;
 
-    svg_painter.save();
-    svg_painter.drawPixmap(dock_rect,
-            d->mSvgRender->get(QLatin1String("background#center"), dock_rect.size()));
-    svg_painter.restore();
+    // the shadow lives next to the widget so the widget's own clip
+    // does not cut it off, and stacks right below it
+    if (shadow->parentItem() != parentItem())
+        shadow->setParentItem(parentItem());
 
-    svg_painter.save();
-    svg_painter.drawPixmap(dock_topleft,
-            d->mSvgRender->get(QLatin1String("background#topleft"), dock_topleft.size()));
-    svg_painter.restore();
+    if (shadow->scene() != scene()) {
+        if (shadow->scene())
+            shadow->scene()->removeItem(shadow);
+        if (scene())
+            scene()->addItem(shadow);
+    }
 
-    svg_painter.save();
-    svg_painter.drawPixmap(dock_topright,
-            d->mSvgRender->get(QLatin1String("background#topright"), dock_topleft.size()));
-    svg_painter.restore();
+    if (!scene())
+        return;
 
-    svg_painter.save();
-    svg_painter.drawPixmap(dock_top,
-            d->mSvgRender->get(QLatin1String("background#top"), dock_top.size()));
-    svg_painter.restore();
+    shadow->setZValue(zValue());
+    shadow->stackBefore(this);
+    shadow->setOpacity(opacity());
+    // only the default frame is known to be a rounded rect
+    shadow->setVisible(isVisible() && d->mDefaultBackground);
 
-    svg_painter.save();
-    svg_painter.drawPixmap(dock_right,
-            d->mSvgRender->get(QLatin1String("background#right"), dock_right.size()));
-    svg_painter.restore();
+    syncShadowGeometry();
+}
 
-    svg_painter.save();
-    svg_painter.drawPixmap(dock_bottomright,
-            d->mSvgRender->get(QLatin1String("background#bottomright"), dock_bottomright.size()));
-    svg_painter.restore();
+void DesktopWidget::syncShadowGeometry()
+{
+    if (!d->mShadowItem || !scene())
+        return;
 
-    svg_painter.save();
-    svg_painter.drawPixmap(dock_bottom,
-            d->mSvgRender->get(QLatin1String("background#bottom"), dock_bottom.size()));
-    svg_painter.restore();
+    d->mShadowItem->setTransform(parentItem() ? itemTransform(parentItem()) : sceneTransform());
+    d->mShadowItem->setTargetRect(boundingRect());
+}
 
-    svg_painter.save(); svg_painter.drawPixmap(dock_bottomleft,
-            d->mSvgRender->get(QLatin1String("background#bottomleft"), dock_bottomleft.size()));
-    svg_painter.restore();
+void DesktopWidget::enableDockMode(bool enable)
+{
+    d->mDockMode = enable;
+}
 
-    svg_painter.save();
-    svg_painter.drawPixmap(dock_left,
-            d->mSvgRender->get(QLatin1String("background#left"), dock_left.size()));
-    svg_painter.restore();
+void DesktopWidget::enableWindowMode(bool enable)
+{
+    d->mWindowMode = enable;
 
-    svg_painter.end();
+    if (enable && d->mCloseButton) {
+        d->mCloseButton->show();
+    } else if (d->mCloseButton) {
+        d->mCloseButton->hide();
+    }
+}
 
-    return QPixmap::fromImage(canvas);
+void DesktopWidget::setDefaultImages()
+{
+    // shared by every widget, drawn straight into the rect it is given
+    d->mFrame = NinePatch::fromTheme(QLatin1String("background"), 10);
+    d->mHasDefaultBackground = !d->mFrame.isNull();
 }
 
+void DesktopWidget::paintDefaultFrame(QPainter *p, const QRectF &rect)
+{
+    if (!d->mHasDefaultBackground)
+        setDefaultImages();
+    d->mFrame.draw(p, rect);
+}
 
 void DesktopWidget::paintRotatedView(QPainter *p, const QRectF &rect)
 {
@@ -258,10 +269,7 @@ void DesktopWidget::paintRotatedView(QPainter *p, const QRectF &rect)
     }
 
     if (!d->mStyle) {
-        p->save();
-        p->setRenderHints(QPainter::SmoothPixmapTransform);
-        p->drawPixmap(QRect(rect.x() , rect.y() , d->mDefaultBackgroundPixmap.width() / scaleFactorForWidth(), d->mDefaultBackgroundPixmap.height() / scaleFactorForHeight()), d->mDefaultBackgroundPixmap);
-        p->restore();
+        paintDefaultFrame(p, boundingRect());
     } else {
         StyleFeatures feature;
         feature.exposeRect = rect;
@@ -276,10 +284,7 @@ void DesktopWidget::paintFrontView(QPainter *p, const QRectF &rect)
         return;
 
     if (!d->mStyle) {
-        p->save();
-        p->setRenderHints(QPainter::SmoothPixmapTransform);
-        p->drawPixmap(QRect(rect.x() , rect.y() , d->mDefaultBackgroundPixmap.width() / scaleFactorForWidth(), d->mDefaultBackgroundPixmap.height() / scaleFactorForHeight()), d->mDefaultBackgroundPixmap);
-        p->restore();
+        paintDefaultFrame(p, boundingRect());
     } else {
         StyleFeatures feature;
         feature.exposeRect = rect;
@@ -297,10 +302,7 @@ void DesktopWidget::paintDockView(QPainter *p, const QRectF &rect)
         ///p->drawPixmap(QRect(rect.x(), rect.y(), rect.width(), rect.height()), d->mDefaultBackgroundPixmap);
 
         if (!d->mStyle) {
-            p->save();
-            p->setRenderHints(QPainter::SmoothPixmapTransform);
-            p->drawPixmap(QRect(rect.x() , rect.y() , d->mDefaultBackgroundPixmap.width() / scaleFactorForWidth(), d->mDefaultBackgroundPixmap.height() / scaleFactorForHeight()), d->mDefaultBackgroundPixmap);
-            p->restore();
+            paintDefaultFrame(p, boundingRect());
         } else {
             StyleFeatures feature;
             feature.exposeRect = rect;
@@ -319,13 +321,115 @@ void DesktopWidget::paintEditMode(QPainter *p, const QRectF &rect)
     if (d->mEditMode) {
         p->save();
         p->setRenderHints(QPainter::SmoothPixmapTransform);
-        p->drawPixmap(QRect(0, 0, rect.width(), rect.height()), d->mDefaultBackgroundPixmap);
+        paintDefaultFrame(p, QRectF(0, 0, rect.width(), rect.height()));
         p->setPen(QColor(255, 255, 255));
         p->drawText(QRect(8, 5, 64, 64), Qt::AlignCenter, QLatin1String ("Close"));
         p->restore();
     }
 }
 
+void DesktopWidget::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+{
+    if (!d->mSnapshots) {
+        AbstractDesktopWidget::paint(painter, option, widget);
+        return;
+    }
+
+    if (!painter->isActive() || isObscured())
+        return;
+
+    const QRectF rect = boundingRect();
+    painter->setRenderHint(QPainter::SmoothPixmapTransform);
+
+    if (!showsBackSnapshot()) {
+        painter->drawImage(rect, d->mFrontSnapshot);
+        return;
+    }
+
+    // past the half turn the Y rotation mirrors the item, undo that for the back face
+    const bool mirrored = state() == d->mSnapshotState;
+    painter->save();
+    if (mirrored) {
+        painter->translate(rect.center());
+        painter->scale(-1, 1);
+        painter->translate(-rect.center());
+    }
+    painter->drawImage(rect, d->mBackSnapshot);
+    painter->restore();
+}
+
+bool DesktopWidget::showsBackSnapshot()
+{
+    if (d->mBackSnapshot.isNull())
+        return false;
+
+    // setRotation() swaps the state once it reaches the half turn
+    return state() != d->mSnapshotState || qAbs(rotation()) > 90;
+}
+
+QImage DesktopWidget::renderFace(AbstractDesktopWidget::State face)
+{
+    const QRectF rect = boundingRect();
+
+    // render at the resolution the views show the item with
+    qreal scale = 1.0;
+    if (scene() && !scene()->views().isEmpty()) {
+        const QTransform transform = deviceTransform(scene()->views().first()->viewportTransform());
+        scale = qMax(qreal(0.1), qSqrt(qAbs(transform.determinant())));
+    }
+
+    const QSize size = (rect.size() * scale).toSize();
+    if (size.isEmpty())
+        return QImage();
+
+    QImage image(size, QImage::Format_ARGB32_Premultiplied);
+    image.fill(0);
+
+    QPainter painter(&image);
+    painter.setRenderHints(QPainter::Antialiasing | QPainter::SmoothPixmapTransform);
+    painter.scale(scale, scale);
+    painter.translate(-rect.topLeft());
+    painter.setClipRect(rect);
+
+    if (face == ROTATED)
+        paintRotatedView(&painter, rect);
+    else if (face == DOCKED)
+        paintDockView(&painter, rect);
+    else
+        paintFrontView(&painter, rect);
+
+    return image;
+}
+
+void DesktopWidget::beginSnapshotTransition(bool flip)
+{
+    d->mSnapshotState = state();
+    d->mFrontSnapshot = renderFace(d->mSnapshotState);
+    if (flip)
+        d->mBackSnapshot = renderFace(d->mSnapshotState == ROTATED ? VIEW : ROTATED);
+    else
+        d->mBackSnapshot = QImage();
+
+    d->mSnapshots = !d->mFrontSnapshot.isNull();
+    d->mShowingBack = false;
+    update();
+}
+
+void DesktopWidget::endSnapshotTransition()
+{
+    if (!d->mSnapshots)
+        return;
+
+    d->mSnapshots = false;
+    d->mShowingBack = false;
+    d->mFrontSnapshot = QImage();
+    d->mBackSnapshot = QImage();
+
+    // setRotation() switched to the item cache for the flip, live content wants the device cache back
+    setCacheMode(DeviceCoordinateCache);
+    update();
+}
+
 void DesktopWidget::pressHoldTimeOut()
 {
     d->mEditMode = true;
@@ -348,6 +452,9 @@ void DesktopWidget::zoomDone()
 
 void DesktopWidget::propertyAnimationForZoomDone()
 {
+    endSnapshotTransition();
+    setInMotion(false);
+
     if (state() == DOCKED) {
         setState (VIEW);
     } else {
@@ -359,6 +466,8 @@ void DesktopWidget::propertyAnimationForZoomDone()
 
 void DesktopWidget::propertyAnimationForRotationDone()
 {
+    endSnapshotTransition();
+    setInMotion(false);
     setChildWidetVisibility(true);
 }
 
@@ -400,6 +509,36 @@ void DesktopWidget::setWindowTitle(const QString &title)
     d->mWindowTitle = title;
 }
 
+QVariant DesktopWidget::itemChange(GraphicsItemChange change, const QVariant &value)
+{
+    switch (change) {
+    case ItemTransformHasChanged:
+        // the flip crossed the half turn, the cached item shows the wrong face
+        if (d->mSnapshots && showsBackSnapshot() != d->mShowingBack) {
+            d->mShowingBack = !d->mShowingBack;
+            update();
+        }
+        syncShadowGeometry();
+        break;
+    case ItemPositionHasChanged:
+    case ItemRotationHasChanged:
+    case ItemScaleHasChanged:
+        syncShadowGeometry();
+        break;
+    case ItemSceneHasChanged:
+    case ItemParentHasChanged:
+    case ItemZValueHasChanged:
+    case ItemVisibleHasChanged:
+    case ItemOpacityHasChanged:
+        syncShadow();
+        break;
+    default:
+        break;
+    }
+
+    return AbstractDesktopWidget::itemChange(change, value);
+}
+
 void DesktopWidget::mouseReleaseEvent(QGraphicsSceneMouseEvent *event)
 {
     qDebug() << Q_FUNC_INFO << event->pos();
@@ -411,7 +550,15 @@ void DesktopWidget::mouseReleaseEvent(QGraphicsSceneMouseEvent *event)
 void DesktopWidget::mousePressEvent(QGraphicsSceneMouseEvent *event)
 {
     if (event->buttons() == Qt::RightButton && (state() == VIEW || state() == ROTATED)) {
+        // still flipping or zooming, a new snapshot would catch the widget half way
+        if (d->mSnapshots || d->mPropertyAnimationForRotation->state() == QAbstractAnimation::Running) {
+            event->accept();
+            return;
+        }
+
         this->setChildWidetVisibility(false);
+        setInMotion(true);
+        beginSnapshotTransition(true);
         d->mPropertyAnimationForRotation->start();
         AbstractDesktopWidget::mousePressEvent(event);
         //QGraphicsItem::mousePressEvent(event);
@@ -460,6 +607,8 @@ void DesktopWidget::mouseDoubleClickEvent(QGraphicsSceneMouseEvent *event)
         d->mPropertyAnimationForZoom->setEndValue(contentRect());
         d->mPropertyAnimationForZoom->setEasingCurve (QEasingCurve::InQuart);
 
+        // undocking only grows the dock face, a frame and a label, and stays live
+        setInMotion(true);
         d->mPropertyAnimationForZoom->start();
         setChildWidetVisibility(true);
 
@@ -475,6 +624,9 @@ void DesktopWidget::mouseDoubleClickEvent(QGraphicsSceneMouseEvent *event)
         d->mPropertyAnimationForZoom->setStartValue(contentRect());
         d->mPropertyAnimationForZoom->setEasingCurve (QEasingCurve::OutQuart);
         this->setVisible(true);
+        setInMotion(true);
+        // the full face shrinks away, animate a snapshot of it
+        beginSnapshotTransition(false);
         d->mPropertyAnimationForZoom->start();
         setChildWidetVisibility(false);
     }
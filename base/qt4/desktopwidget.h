@@ -16,6 +16,15 @@ class PLEXYDESKUICORE_EXPORT DesktopWidget : public AbstractDesktopWidget
     Q_OBJECT
 
 public:
+    /* NoShadow, the shared nine-patch shadow (default) or the exact but
+       expensive QGraphicsDropShadowEffect for widgets that are not a
+       rounded rect */
+    enum ShadowMode {
+        NoShadow,
+        CachedShadow,
+        EffectShadow
+    };
+
     DesktopWidget(const QRectF &rect, QGraphicsObject *parent = 0);
 
     virtual ~DesktopWidget();
@@ -24,6 +33,9 @@ public:
 
     void enableShadow(bool enable);
 
+    void setShadowMode(ShadowMode mode);
+    ShadowMode shadowMode() const;
+
     void enableDockMode(bool enable = true);
 
     void enableWindowMode(bool enable = true);
@@ -46,6 +58,7 @@ Q_SIGNALS:
     void clicked();
 
 protected:
+    virtual void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget = 0);
     virtual void paintRotatedView(QPainter *painter, const QRectF &rect);
     virtual void paintFrontView(QPainter *painter, const QRectF &rect);
     virtual void paintDockView(QPainter *painter, const QRectF &rect);
@@ -55,9 +68,21 @@ protected:
     virtual void mousePressEvent(QGraphicsSceneMouseEvent *event);
     virtual void mouseReleaseEvent(QGraphicsSceneMouseEvent *event);
 
+    virtual QVariant itemChange(GraphicsItemChange change, const QVariant &value);
+
+private Q_SLOTS:
+    void syncShadowGeometry();
+
 private:
+    void syncShadow();
     void setDefaultImages();
-    QPixmap genDefaultBackground(int width, int height);
+    void paintDefaultFrame(QPainter *painter, const QRectF &rect);
+
+    /* flips and zooms animate snapshots of the faces instead of the live paint path */
+    void beginSnapshotTransition(bool flip);
+    void endSnapshotTransition();
+    bool showsBackSnapshot();
+    QImage renderFace(AbstractDesktopWidget::State face);
 
     class PrivateDesktopWidget;
     PrivateDesktopWidget *const d;
@@ -0,0 +1,126 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+
+#include "ninepatch.h"
+
+#include <QPainter>
+#include <QPixmapCache>
+#include <qdrawutil.h>
+
+#include <plexyconfig.h>
+#include <svgprovider.h>
+
+namespace PlexyDesk
+{
+
+/* length the edges and the middle are rendered at before stretching */
+static const int StretchTile = 32;
+
+static int sThemeRenders = 0;
+
+NinePatch::NinePatch()
+{
+}
+
+NinePatch::NinePatch(const QPixmap &pixmap, const QMargins &margins) :
+    mPixmap(pixmap),
+    mMargins(margins)
+{
+}
+
+bool NinePatch::isNull() const
+{
+    return mPixmap.isNull();
+}
+
+QPixmap NinePatch::pixmap() const
+{
+    return mPixmap;
+}
+
+QMargins NinePatch::margins() const
+{
+    return mMargins;
+}
+
+void NinePatch::draw(QPainter *painter, const QRectF &rect) const
+{
+    if (isNull() || rect.isEmpty())
+        return;
+
+    const bool smooth = painter->testRenderHint(QPainter::SmoothPixmapTransform);
+    painter->setRenderHint(QPainter::SmoothPixmapTransform, true);
+    qDrawBorderPixmap(painter, rect.toRect(), mMargins, mPixmap);
+    painter->setRenderHint(QPainter::SmoothPixmapTransform, smooth);
+}
+
+NinePatch NinePatch::fromTheme(const QString &prefix, int border)
+{
+    const QMargins margins(border, border, border, border);
+
+    /* keyed by theme, a theme switch renders the new frames and the old
+       ones age out of the cache; nothing outlives QApplication */
+    const QString key = QString("plexy-ninepatch:%1:%2:%3")
+        .arg(Config::getInstance()->themepackName()).arg(prefix).arg(border);
+
+    QPixmap pixmap;
+    if (QPixmapCache::find(key, &pixmap))
+        return NinePatch(pixmap, margins);
+
+    sThemeRenders++;
+
+    const int size = 2 * border + StretchTile;
+    const int far = border + StretchTile;
+
+    struct Tile {
+        const char *element;
+        QRect rect;
+    } tiles[] = {
+        { "center", QRect(border, border, StretchTile, StretchTile) },
+        { "topleft", QRect(0, 0, border, border) },
+        { "top", QRect(border, 0, StretchTile, border) },
+        { "topright", QRect(far, 0, border, border) },
+        { "right", QRect(far, border, border, StretchTile) },
+        { "bottomright", QRect(far, far, border, border) },
+        { "bottom", QRect(border, far, StretchTile, border) },
+        { "bottomleft", QRect(0, far, border, border) },
+        { "left", QRect(0, border, border, StretchTile) }
+    };
+
+    pixmap = QPixmap(size, size);
+    pixmap.fill(Qt::transparent);
+
+    SvgProvider svg;
+    QPainter painter(&pixmap);
+    for (unsigned int i = 0; i < sizeof(tiles) / sizeof(tiles[0]); i++) {
+        const QString element = prefix + QLatin1Char('#') + QLatin1String(tiles[i].element);
+        painter.drawPixmap(tiles[i].rect, svg.get(element, tiles[i].rect.size()));
+    }
+    painter.end();
+
+    QPixmapCache::insert(key, pixmap);
+    return NinePatch(pixmap, margins);
+}
+
+int NinePatch::themeRenderCount()
+{
+    return sThemeRenders;
+}
+
+} // PlexyDesk
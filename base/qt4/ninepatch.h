@@ -0,0 +1,64 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+
+#ifndef PLEXY_NINE_PATCH_H
+#define PLEXY_NINE_PATCH_H
+
+#include <QMargins>
+#include <QPixmap>
+#include <QString>
+
+#include "plexydeskuicore_global.h"
+
+class QPainter;
+
+namespace PlexyDesk
+{
+/*
+ * A frame that stretches to any size without a buffer of that size.
+ * The source pixmap holds the four corners, the four edges and the
+ * middle; draw() blits the corners as they are and stretches the rest
+ * into the target rect. Copies share the pixmap, and frames built from
+ * the theme are shared through QPixmapCache by every widget using them.
+ */
+class PLEXYDESKUICORE_EXPORT NinePatch
+{
+public:
+    NinePatch();
+    NinePatch(const QPixmap &pixmap, const QMargins &margins);
+
+    bool isNull() const;
+    QPixmap pixmap() const;
+    QMargins margins() const;
+
+    void draw(QPainter *painter, const QRectF &rect) const;
+
+    /* the frame made of the "<prefix>#topleft" ... "<prefix>#center" svg
+       elements of the current theme, with border wide edges */
+    static NinePatch fromTheme(const QString &prefix, int border);
+
+    /* test hook, how many theme frames were rendered since start up */
+    static int themeRenderCount();
+
+private:
+    QPixmap mPixmap;
+    QMargins mMargins;
+};
+} // PlexyDesk
+#endif // PLEXY_NINE_PATCH_H
@@ -16,6 +16,8 @@ SOURCES = viewlayer.cpp \
         svgprovider.cpp \
         style.cpp \
         scrollwidget.cpp \
+        shadowitem.cpp \
+        ninepatch.cpp \
         qmlsvgprovider.cpp \
         qmlpixmapprovider.cpp \
         qmldesktopwidget.cpp \
@@ -24,6 +26,7 @@ SOURCES = viewlayer.cpp \
         nativestyle.cpp \
         lineedit.cpp \
         imagecache.cpp \
+        decodedimagecache.cpp \
         extensionfactory.cpp \
         desktopwidget.cpp \
         button.cpp \
@@ -36,6 +39,8 @@ HEADERS = viewlayer.h \
         socialplugin.h \
         socialinterface.h \
         scrollwidget.h \
+        shadowitem.h \
+        ninepatch.h \
         qmlsvgprovider.h \
         qmlpixmapprovider.h \
         qmldesktopwidget.h \
@@ -44,6 +49,7 @@ HEADERS = viewlayer.h \
         nativestyle.h \
         lineedit.h \
         imagecache.h \
+        decodedimagecache.h \
         extensionfactory.h \
         desktopwidget.h \
         button.h \
@@ -30,12 +30,14 @@ public:
     ~Private() {}
 
     QGraphicsItem *mChildItem;
+    qreal mChildTop;
 };
 
 ScrollWidget::ScrollWidget(const QRectF &rect, QGraphicsObject *parent)
     : DesktopWidget(rect,parent), d (new Private)
 {
     d->mChildItem = 0;
+    d->mChildTop = 0.0;
     setCacheMode(QGraphicsItem::ItemCoordinateCache);
 }
 
@@ -61,6 +63,8 @@ void ScrollWidget::addWidget(QGraphicsItem *widget)
    if (widget) {
        widget->setParentItem(this);
        d->mChildItem = widget;
+       // where the child sits unscrolled, it may leave room for a title
+       d->mChildTop = widget->y();
    }
 }
 
@@ -68,14 +72,12 @@ void ScrollWidget::scrollBy(int x, int y)
 {
     if (d->mChildItem) {
         //resetric to viewport
-        int y_pos = d->mChildItem->y() + y;
-        int view_height = this->boundingRect().height();
-        int y_max = (-1) * (d->mChildItem->boundingRect().height() - view_height);
-
-        if (y_pos < (this->y()) && y_pos > y_max)
-            d->mChildItem->setPos(d->mChildItem->x() + x, d->mChildItem->y() + y);
-        else if ( !(y_pos < (this->y())) )
-            d->mChildItem->setPos(d->mChildItem->x() + x, this->y());
+        const qreal view_height = this->boundingRect().height() - d->mChildTop;
+        const qreal overflow = d->mChildItem->boundingRect().height() - view_height;
+        const qreal y_min = d->mChildTop - qMax(qreal(0.0), overflow);
+        const qreal y_pos = qBound(y_min, d->mChildItem->y() + y, d->mChildTop);
+
+        d->mChildItem->setPos(d->mChildItem->x() + x, y_pos);
     }
 }
 
@@ -83,9 +83,11 @@ void ShaderEffect::draw (QPainter *painter)
 
     if (context) {
         updateRenderTargets();
+    } else {
+        updateSoftwareTargets();
     }
 
-    if (!context || m_renderTargets.count() == 0 || !hideOriginal())
+    if (m_renderTargets.count() == 0 || !hideOriginal(context != 0))
         drawSource(painter);
 }
 
@@ -159,6 +161,33 @@ void ShaderEffect::updateRenderTargets()
     }
 }
 
+void ShaderEffect::updateSoftwareTargets()
+{
+    if (!m_changed)
+        return;
+
+    m_changed = false;
+
+    // grabbed once through the effect source, which keeps its own cache
+    QImage image;
+    int count = m_renderTargets.count();
+    for (int i = 0; i < count; i++) {
+        ShaderEffectSource *target = m_renderTargets[i];
+        if (!target->isSoftwareRendered())
+            continue;
+        if (!target->isLive() && !target->isDirtyTexture())
+            continue;
+
+        if (image.isNull()) {
+            QPoint offset;
+            image = sourcePixmap(Qt::LogicalCoordinates, &offset, QGraphicsEffect::NoPad).toImage()
+                .convertToFormat(QImage::Format_ARGB32_Premultiplied);
+        }
+
+        target->setSoftwareImage(image);
+    }
+}
+
 void ShaderEffect::sourceChanged (ChangeFlags flags)
 {
     Q_UNUSED(flags);
@@ -180,7 +209,7 @@ void ShaderEffect::removeRenderTarget(ShaderEffectSource *target)
         qWarning() << "ShaderEffect::removeRenderTarget - did not find target.";
 }
 
-bool ShaderEffect::hideOriginal() const
+bool ShaderEffect::hideOriginal(bool gl) const
 {
     if (m_renderTargets.count() == 0)
         return false;
@@ -188,7 +217,8 @@ bool ShaderEffect::hideOriginal() const
     // Just like scenegraph version, if there is even one source that says "hide original" we hide it.
     int count = m_renderTargets.count();
     for (int i = 0; i < count; i++) {
-        if (m_renderTargets[i]->hideSource())
+        // without gl only targets feeding a software effect replace the original
+        if (m_renderTargets[i]->hideSource() && (gl || m_renderTargets[i]->isSoftwareRendered()))
             return true;
     }
     return false;
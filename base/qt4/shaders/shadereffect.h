@@ -68,7 +68,8 @@ protected:
 private:
     void prepareBufferedDraw(QPainter *painter);
     void updateRenderTargets();
-    bool hideOriginal() const;
+    void updateSoftwareTargets();
+    bool hideOriginal(bool gl) const;
 
 public:
     QVector<ShaderEffectSource*> m_renderTargets;
@@ -42,6 +42,7 @@
 #include "shadereffectitem.h"
 #include "shadereffect.h"
 #include "glfunctions.h"
+#include "softwarekernels.h"
 
 #include <QPainter>
 #include <QtOpenGL>
@@ -205,6 +206,8 @@ ShaderEffectItem::ShaderEffectItem(QDeclarativeItem *parent)
     : QDeclarativeItem(parent)
     , m_meshResolution(1, 1)
     , m_geometry(QSGGeometry::defaultAttributes_TexturedPoint2D(), 4)
+    , m_softwareEffect(NoSoftwareEffect)
+    , m_softwareSourceKey(0)
     , m_blending(true)
     , m_program_dirty(true)
     , m_active(true)
@@ -216,6 +219,7 @@ ShaderEffectItem::ShaderEffectItem(QDeclarativeItem *parent)
     , m_hasShaderPrograms(false)
     , m_mirrored(false)
     , m_defaultVertexShader(true)
+    , m_softwareDirty(true)
 {
     setFlag(QGraphicsItem::ItemHasNoContents, false);
     connect(this, SIGNAL(visibleChanged()), this, SLOT(handleVisibilityChange()));
@@ -415,6 +419,8 @@ void ShaderEffectItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *
         renderEffect(painter, combinedMatrix);
         painter->endNativePainting();
         painter->restore();
+    } else if (m_softwareEffect != NoSoftwareEffect) {
+        renderSoftwareEffect(painter);
     } else {
         if (!m_checkedOpenGL) {
             qWarning() << "ShaderEffectItem::paint - OpenGL not available";
@@ -423,6 +429,108 @@ void ShaderEffectItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *
     }
 }
 
+/*!
+    \qmlproperty enumeration ShaderEffectItem::softwareEffect
+    The effect drawn on the CPU when no OpenGL context is available, for
+    example on the raster graphics system. The shaders are not run then;
+    the first source is processed by the matching image kernel instead,
+    with parameters read from the item's properties:
+
+    \list
+    \o Blur - radius (default 8)
+    \o Desaturate - amount, 0.0 to 1.0 (default 1.0)
+    \o OpacityMask - the second source is the mask
+    \o ColorOverlay - color
+    \o Wave - amplitude, frequency and time
+    \endlist
+
+    The default is NoSoftwareEffect, which draws nothing without OpenGL.
+*/
+
+void ShaderEffectItem::setSoftwareEffect(SoftwareEffect effect)
+{
+    if (effect == m_softwareEffect)
+        return;
+
+    m_softwareEffect = effect;
+    m_softwareDirty = true;
+    update();
+    emit softwareEffectChanged();
+}
+
+void ShaderEffectItem::renderSoftwareEffect(QPainter *painter)
+{
+    if (m_sources.isEmpty())
+        return;
+
+    // the sources switch to images on first use, the content follows with
+    // their next repaint
+    bool ready = true;
+    for (int i = 0; i < m_sources.size() && i < 2; ++i) {
+        ShaderEffectSource *source = m_sources.at(i).source;
+        if (source && !source->isSoftwareRendered()) {
+            source->setSoftwareRendered(true);
+            ready = false;
+        }
+    }
+
+    ShaderEffectSource *source = m_sources.at(0).source;
+    if (!ready || !source || source->softwareImage().isNull())
+        return;
+
+    const QImage image = source->softwareImage();
+    QImage mask;
+    if (m_sources.size() > 1 && m_sources.at(1).source)
+        mask = m_sources.at(1).source->softwareImage();
+
+    const qint64 key = image.cacheKey() ^ (mask.cacheKey() << 1);
+    if (m_softwareDirty || key != m_softwareSourceKey || m_softwareResult.isNull()) {
+        m_softwareResult = applySoftwareEffect(image, mask);
+        m_softwareSourceKey = key;
+        m_softwareDirty = false;
+    }
+
+    painter->save();
+    painter->setRenderHint(QPainter::SmoothPixmapTransform, smooth());
+    painter->drawImage(boundingRect(), m_softwareResult);
+    painter->restore();
+}
+
+QImage ShaderEffectItem::applySoftwareEffect(const QImage &source, const QImage &mask)
+{
+    QImage result = source;
+
+    switch (m_softwareEffect) {
+    case Blur: {
+        const QVariant radius = property("radius");
+        SoftwareKernels::blur(result, radius.isValid() ? radius.toInt() : 8);
+        break;
+    }
+    case Desaturate: {
+        const QVariant amount = property("amount");
+        SoftwareKernels::desaturate(result, amount.isValid() ? amount.toReal() : 1.0);
+        break;
+    }
+    case OpacityMask:
+        SoftwareKernels::opacityMask(result, mask);
+        break;
+    case ColorOverlay:
+        SoftwareKernels::colorOverlay(result, qvariant_cast<QColor>(property("color")));
+        break;
+    case Wave: {
+        const QVariant amplitude = property("amplitude");
+        const QVariant frequency = property("frequency");
+        result = SoftwareKernels::wave(source, amplitude.isValid() ? amplitude.toReal() : 4.0,
+                frequency.isValid() ? frequency.toReal() : 2.0, property("time").toReal());
+        break;
+    }
+    default:
+        break;
+    }
+
+    return result;
+}
+
 void ShaderEffectItem::renderEffect(QPainter *painter, const QMatrix4x4 &matrix)
 {
     if (!painter || !painter->device())
@@ -691,6 +799,8 @@ void ShaderEffectItem::changeSource(int index)
 }
 
 void ShaderEffectItem::markDirty() {
+    // a source or one of the effect's properties changed
+    m_softwareDirty = true;
     update();
 }
 
@@ -60,8 +60,20 @@ class SHADERSSHARED_EXPORT  ShaderEffectItem : public QDeclarativeItem {
     Q_PROPERTY(QString vertexShader READ vertexShader WRITE setVertexShader NOTIFY vertexShaderChanged)
     Q_PROPERTY(bool blending READ blending WRITE setBlending NOTIFY blendingChanged)
     Q_PROPERTY(QSize meshResolution READ meshResolution WRITE setMeshResolution NOTIFY meshResolutionChanged)
+    Q_PROPERTY(SoftwareEffect softwareEffect READ softwareEffect WRITE setSoftwareEffect NOTIFY softwareEffectChanged)
+    Q_ENUMS(SoftwareEffect)
 
 public:
+    /* what to draw instead of the shaders when there is no gl context */
+    enum SoftwareEffect {
+        NoSoftwareEffect,
+        Blur,
+        Desaturate,
+        OpacityMask,
+        ColorOverlay,
+        Wave
+    };
+
     ShaderEffectItem(QDeclarativeItem* parent = 0);
     ~ShaderEffectItem();
 
@@ -80,6 +92,9 @@ public:
     QSize meshResolution() const { return m_meshResolution; }
     void setMeshResolution(const QSize &size);
 
+    SoftwareEffect softwareEffect() const { return m_softwareEffect; }
+    void setSoftwareEffect(SoftwareEffect effect);
+
     void preprocess();
 
 Q_SIGNALS:
@@ -88,6 +103,7 @@ Q_SIGNALS:
     void blendingChanged();
     void activeChanged();
     void meshResolutionChanged();
+    void softwareEffectChanged();
 
 protected:
     virtual void geometryChanged(const QRectF &newGeometry, const QRectF &oldGeometry);
@@ -100,6 +116,8 @@ private Q_SLOTS:
 private:
     void checkViewportUpdateMode();
     void renderEffect(QPainter *painter, const QMatrix4x4 &matrix);
+    void renderSoftwareEffect(QPainter *painter);
+    QImage applySoftwareEffect(const QImage &source, const QImage &mask);
     void updateEffectState(const QMatrix4x4 &matrix);
     void updateGeometry();
     void bindGeometry();
@@ -121,6 +139,9 @@ private:
     QSet<QByteArray> m_uniformNames;
     QSize m_meshResolution;
     QSGGeometry m_geometry;
+    SoftwareEffect m_softwareEffect;
+    QImage m_softwareResult;
+    qint64 m_softwareSourceKey;
 
     struct SourceData
     {
@@ -144,6 +165,7 @@ private:
     bool m_hasShaderPrograms : 1;
     bool m_mirrored : 1;
     bool m_defaultVertexShader : 1;
+    bool m_softwareDirty : 1;
 };
 
 } // namespace PlexyDesk
@@ -87,6 +87,7 @@ ShaderEffectSource::ShaderEffectSource(QDeclarativeItem *parent)
     , m_live(true)
     , m_hideSource(false)
     , m_mirrored(false)
+    , m_software(false)
 {
 }
 
@@ -385,6 +386,32 @@ void ShaderEffectSource::updateBackbuffer()
     m_dirtyTexture = false;
 }
 
+void ShaderEffectSource::setSoftwareRendered(bool enable)
+{
+    if (m_software == enable)
+        return;
+
+    m_software = enable;
+    if (!enable)
+        m_softwareImage = QImage();
+
+    m_dirtyTexture = true;
+    if (m_sourceItem)
+        m_sourceItem->update();
+}
+
+void ShaderEffectSource::setSoftwareImage(const QImage &image)
+{
+    if (!m_textureSize.isEmpty() && image.size() != m_textureSize)
+        m_softwareImage = image.scaled(m_textureSize, Qt::IgnoreAspectRatio,
+                smooth() ? Qt::SmoothTransformation : Qt::FastTransformation);
+    else
+        m_softwareImage = image;
+
+    m_dirtyTexture = false;
+    markSceneGraphDirty();
+}
+
 void ShaderEffectSource::markSceneGraphDirty()
 {
     m_dirtySceneGraph = true;
@@ -471,6 +498,7 @@ void ShaderEffectSource::detachSourceItem()
     delete m_multisampledFbo;
     m_multisampledFbo = 0;
 
+    m_softwareImage = QImage();
     m_dirtyTexture = true;
 }
 
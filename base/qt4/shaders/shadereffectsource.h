@@ -108,6 +108,13 @@ public:
     void updateBackbuffer();
 
     ShaderEffectBuffer* fbo() { return m_fbo; }
+
+    /* without gl the source content is kept in an image instead of the fbo */
+    bool isSoftwareRendered() const { return m_software; }
+    void setSoftwareRendered(bool enable);
+    QImage softwareImage() const { return m_softwareImage; }
+    void setSoftwareImage(const QImage &image);
+
     bool isDirtyTexture() { return m_dirtyTexture; }
     bool isMirrored() { return m_mirrored; }
 
@@ -143,6 +150,7 @@ private:
 
     ShaderEffectBuffer *m_fbo;
     ShaderEffectBuffer *m_multisampledFbo;
+    QImage m_softwareImage;
     int m_refs;
     bool m_dirtyTexture : 1;
     bool m_dirtySceneGraph : 1;
@@ -151,6 +159,7 @@ private:
     bool m_live : 1;
     bool m_hideSource : 1;
     bool m_mirrored : 1;
+    bool m_software : 1;
 };
 
 }
@@ -15,6 +15,7 @@ SOURCES += \
     shadereffect.cpp \
     shadereffectitem.cpp \
     shadereffectsource.cpp \
+    softwarekernels.cpp \
     scenegraph/qsggeometry.cpp \
     shadereffectbuffer.cpp
 
@@ -24,6 +25,7 @@ HEADERS += \
     shadereffect.h \
     shadereffectitem.h \
     shadereffectsource.h \
+    softwarekernels.h \
     scenegraph/qsggeometry.h \
     shadereffectbuffer.h \
     shaders_global.h
@@ -0,0 +1,390 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+
+#include "softwarekernels.h"
+
+#include <QList>
+#include <QThread>
+#include <QVector>
+#include <QtConcurrentMap>
+
+#include <qmath.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define PLEXY_HAVE_SSE2
+#endif
+
+namespace PlexyDesk
+{
+
+static bool sThreading = true;
+
+/* below this many pixels the work is done before the pool wakes up */
+static const int MinParallelPixels = 64 * 1024;
+
+struct Band {
+    int first;
+    int last;
+};
+
+template <typename Kernel>
+static void runBands(int lines, int pixelsPerLine, const Kernel &kernel)
+{
+    const int threads = QThread::idealThreadCount();
+    if (!sThreading || threads <= 1 || lines * pixelsPerLine < MinParallelPixels) {
+        Band all = { 0, lines };
+        kernel(all);
+        return;
+    }
+
+    // a few bands per core so one preempted thread does not hold up the frame
+    const int count = qMin(lines, threads * 2);
+    QList<Band> bands;
+    for (int i = 0; i < count; i++) {
+        const Band band = { lines * i / count, lines * (i + 1) / count };
+        bands.append(band);
+    }
+    QtConcurrent::blockingMap(bands, kernel);
+}
+
+static void ensurePremultiplied(QImage &image)
+{
+    if (image.format() != QImage::Format_ARGB32_Premultiplied)
+        image = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    // detach here, the kernels write to the bits from several threads
+    image.bits();
+}
+
+/* x * a / 255 for every channel of a premultiplied pixel */
+static inline quint32 byteMul(quint32 x, uint a)
+{
+    quint32 t = (x & 0xff00ff) * a;
+    t = (t + ((t >> 8) & 0xff00ff) + 0x800080) >> 8;
+    t &= 0xff00ff;
+
+    x = ((x >> 8) & 0xff00ff) * a;
+    x = (x + ((x >> 8) & 0xff00ff) + 0x800080);
+    x &= 0xff00ff00;
+    return x | t;
+}
+
+#ifdef PLEXY_HAVE_SSE2
+/* the same on eight 16 bit channels */
+static inline __m128i byteMul16(__m128i x, __m128i a)
+{
+    __m128i t = _mm_mullo_epi16(x, a);
+    t = _mm_add_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), _mm_set1_epi16(128));
+    return _mm_srli_epi16(t, 8);
+}
+
+/* the alpha of four pixels, each repeated in both 16 bit halves */
+static inline __m128i alphaPairs(__m128i pixels)
+{
+    const __m128i alpha = _mm_srli_epi32(pixels, 24);
+    return _mm_or_si128(alpha, _mm_slli_epi32(alpha, 16));
+}
+
+static inline __m128i desaturate16(__m128i pixels, __m128i amount)
+{
+    // qGray weights on B G R, alpha is kept
+    const __m128i weights = _mm_setr_epi16(5, 16, 11, 0, 5, 16, 11, 0);
+    const __m128i alphaMask = _mm_setr_epi16(0, 0, 0, -1, 0, 0, 0, -1);
+
+    __m128i sum = _mm_madd_epi16(pixels, weights);
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    sum = _mm_srli_epi32(sum, 5);
+
+    __m128i gray = _mm_or_si128(sum, _mm_slli_epi32(sum, 16));
+    gray = _mm_or_si128(_mm_andnot_si128(alphaMask, gray), _mm_and_si128(alphaMask, pixels));
+
+    const __m128i diff = _mm_mullo_epi16(_mm_sub_epi16(gray, pixels), amount);
+    return _mm_add_epi16(pixels, _mm_srai_epi16(diff, 7));
+}
+#endif
+
+static void maskLine(quint32 *line, const quint32 *mask, int length)
+{
+    int i = 0;
+#ifdef PLEXY_HAVE_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 4 <= length; i += 4) {
+        const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(line + i));
+        const __m128i alpha = alphaPairs(_mm_loadu_si128(reinterpret_cast<const __m128i *>(mask + i)));
+        const __m128i lo = byteMul16(_mm_unpacklo_epi8(pixels, zero), _mm_unpacklo_epi32(alpha, alpha));
+        const __m128i hi = byteMul16(_mm_unpackhi_epi8(pixels, zero), _mm_unpackhi_epi32(alpha, alpha));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(line + i), _mm_packus_epi16(lo, hi));
+    }
+#endif
+    for (; i < length; i++)
+        line[i] = byteMul(line[i], qAlpha(mask[i]));
+}
+
+static void overlayLine(quint32 *line, quint32 color, int length)
+{
+    int i = 0;
+#ifdef PLEXY_HAVE_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i color16 = _mm_unpacklo_epi8(_mm_set1_epi32(color), zero);
+    for (; i + 4 <= length; i += 4) {
+        const __m128i alpha = alphaPairs(_mm_loadu_si128(reinterpret_cast<const __m128i *>(line + i)));
+        const __m128i lo = byteMul16(color16, _mm_unpacklo_epi32(alpha, alpha));
+        const __m128i hi = byteMul16(color16, _mm_unpackhi_epi32(alpha, alpha));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(line + i), _mm_packus_epi16(lo, hi));
+    }
+#endif
+    for (; i < length; i++)
+        line[i] = byteMul(color, qAlpha(line[i]));
+}
+
+static void desaturateLine(quint32 *line, int amount, int length)
+{
+    int i = 0;
+#ifdef PLEXY_HAVE_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i amount16 = _mm_set1_epi16(amount);
+    for (; i + 4 <= length; i += 4) {
+        const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(line + i));
+        const __m128i lo = desaturate16(_mm_unpacklo_epi8(pixels, zero), amount16);
+        const __m128i hi = desaturate16(_mm_unpackhi_epi8(pixels, zero), amount16);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(line + i), _mm_packus_epi16(lo, hi));
+    }
+#endif
+    for (; i < length; i++) {
+        const int r = qRed(line[i]);
+        const int g = qGreen(line[i]);
+        const int b = qBlue(line[i]);
+        const int gray = (r * 11 + g * 16 + b * 5) >> 5;
+        line[i] = qRgba(r + (((gray - r) * amount) >> 7), g + (((gray - g) * amount) >> 7),
+                b + (((gray - b) * amount) >> 7), qAlpha(line[i]));
+    }
+}
+
+/* running sum box filter over one row or column, step is in pixels */
+static void boxBlurLine(quint32 *line, int length, int step, int radius, quint32 *scratch)
+{
+    for (int i = 0; i < length; i++)
+        scratch[i] = line[i * step];
+
+    // 8.24 reciprocal of the window, rounded so a flat 255 stays 255 over
+    // every pass; 255 * window * scale still fits in 32 bits. everything
+    // outside the line is transparent
+    const uint scale = (1 << 24) / (2 * radius + 1);
+    const uint half = 1 << 23;
+    uint a = 0, r = 0, g = 0, b = 0;
+    for (int i = 0; i <= radius && i < length; i++) {
+        a += qAlpha(scratch[i]); r += qRed(scratch[i]);
+        g += qGreen(scratch[i]); b += qBlue(scratch[i]);
+    }
+
+    for (int i = 0; i < length; i++) {
+        line[i * step] = qRgba((r * scale + half) >> 24, (g * scale + half) >> 24,
+                               (b * scale + half) >> 24, (a * scale + half) >> 24);
+
+        if (i + radius + 1 < length) {
+            const quint32 in = scratch[i + radius + 1];
+            a += qAlpha(in); r += qRed(in); g += qGreen(in); b += qBlue(in);
+        }
+        if (i - radius >= 0) {
+            const quint32 out = scratch[i - radius];
+            a -= qAlpha(out); r -= qRed(out); g -= qGreen(out); b -= qBlue(out);
+        }
+    }
+}
+
+struct BlurRows {
+    uchar *bits;
+    int bytesPerLine;
+    int width;
+    int radius;
+
+    void operator()(Band &band) const {
+        QVector<quint32> scratch(width);
+        for (int y = band.first; y < band.last; y++)
+            boxBlurLine(reinterpret_cast<quint32 *>(bits + y * bytesPerLine), width, 1, radius, scratch.data());
+    }
+};
+
+struct BlurColumns {
+    uchar *bits;
+    int bytesPerLine;
+    int height;
+    int radius;
+
+    void operator()(Band &band) const {
+        QVector<quint32> scratch(height);
+        for (int x = band.first; x < band.last; x++)
+            boxBlurLine(reinterpret_cast<quint32 *>(bits) + x, height, bytesPerLine / 4, radius, scratch.data());
+    }
+};
+
+struct MaskRows {
+    uchar *bits;
+    const uchar *maskBits;
+    int bytesPerLine;
+    int maskBytesPerLine;
+    int width;
+
+    void operator()(Band &band) const {
+        for (int y = band.first; y < band.last; y++)
+            maskLine(reinterpret_cast<quint32 *>(bits + y * bytesPerLine),
+                    reinterpret_cast<const quint32 *>(maskBits + y * maskBytesPerLine), width);
+    }
+};
+
+struct OverlayRows {
+    uchar *bits;
+    int bytesPerLine;
+    int width;
+    quint32 color;
+
+    void operator()(Band &band) const {
+        for (int y = band.first; y < band.last; y++)
+            overlayLine(reinterpret_cast<quint32 *>(bits + y * bytesPerLine), color, width);
+    }
+};
+
+struct DesaturateRows {
+    uchar *bits;
+    int bytesPerLine;
+    int width;
+    int amount;
+
+    void operator()(Band &band) const {
+        for (int y = band.first; y < band.last; y++)
+            desaturateLine(reinterpret_cast<quint32 *>(bits + y * bytesPerLine), amount, width);
+    }
+};
+
+struct WaveRows {
+    const uchar *source;
+    uchar *bits;
+    int sourceBytesPerLine;
+    int bytesPerLine;
+    int width;
+    int height;
+    qreal amplitude;
+    qreal frequency;
+    qreal phase;
+
+    void operator()(Band &band) const {
+        for (int y = band.first; y < band.last; y++) {
+            const quint32 *in = reinterpret_cast<const quint32 *>(source + y * sourceBytesPerLine);
+            quint32 *out = reinterpret_cast<quint32 *>(bits + y * bytesPerLine);
+            const int shift = qRound(amplitude * qSin(2 * M_PI * frequency * y / height + phase));
+
+            memset(out, 0, width * sizeof(quint32));
+            if (shift >= 0 && shift < width)
+                memcpy(out + shift, in, (width - shift) * sizeof(quint32));
+            else if (shift < 0 && -shift < width)
+                memcpy(out, in - shift, (width + shift) * sizeof(quint32));
+        }
+    }
+};
+
+void SoftwareKernels::blur(QImage &image, int radius)
+{
+    if (image.isNull() || radius <= 0)
+        return;
+
+    ensurePremultiplied(image);
+
+    const int box = qMax(1, radius / 3);
+    const BlurRows rows = { image.bits(), image.bytesPerLine(), image.width(), box };
+    const BlurColumns columns = { image.bits(), image.bytesPerLine(), image.height(), box };
+
+    for (int pass = 0; pass < 3; pass++) {
+        runBands(image.height(), image.width(), rows);
+        runBands(image.width(), image.height(), columns);
+    }
+}
+
+void SoftwareKernels::desaturate(QImage &image, qreal amount)
+{
+    if (image.isNull() || amount <= 0)
+        return;
+
+    ensurePremultiplied(image);
+
+    const DesaturateRows rows = { image.bits(), image.bytesPerLine(), image.width(),
+        qRound(qMin(amount, qreal(1.0)) * 128) };
+    runBands(image.height(), image.width(), rows);
+}
+
+void SoftwareKernels::opacityMask(QImage &image, const QImage &mask)
+{
+    if (image.isNull())
+        return;
+
+    ensurePremultiplied(image);
+
+    QImage alpha = mask;
+    if (alpha.isNull()) {
+        image.fill(0);
+        return;
+    }
+    if (alpha.size() != image.size())
+        alpha = alpha.scaled(image.size(), Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    if (alpha.format() != QImage::Format_ARGB32_Premultiplied)
+        alpha = alpha.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+
+    const MaskRows rows = { image.bits(), alpha.constBits(), image.bytesPerLine(),
+        alpha.bytesPerLine(), image.width() };
+    runBands(image.height(), image.width(), rows);
+}
+
+void SoftwareKernels::colorOverlay(QImage &image, const QColor &color)
+{
+    if (image.isNull())
+        return;
+
+    ensurePremultiplied(image);
+
+    const OverlayRows rows = { image.bits(), image.bytesPerLine(), image.width(),
+        qPremultiply(color.rgba()) };
+    runBands(image.height(), image.width(), rows);
+}
+
+QImage SoftwareKernels::wave(const QImage &image, qreal amplitude, qreal frequency, qreal phase)
+{
+    if (image.isNull())
+        return image;
+
+    const QImage source = image.format() == QImage::Format_ARGB32_Premultiplied ?
+        image : image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    QImage result(source.size(), QImage::Format_ARGB32_Premultiplied);
+
+    const WaveRows rows = { source.constBits(), result.bits(), source.bytesPerLine(),
+        result.bytesPerLine(), source.width(), source.height(), amplitude, frequency, phase };
+    runBands(source.height(), source.width(), rows);
+    return result;
+}
+
+void SoftwareKernels::setThreadingEnabled(bool enable)
+{
+    sThreading = enable;
+}
+
+bool SoftwareKernels::threadingEnabled()
+{
+    return sThreading;
+}
+
+} // namespace PlexyDesk
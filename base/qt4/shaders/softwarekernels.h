@@ -0,0 +1,60 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+
+#ifndef SOFTWARE_KERNELS_H
+#define SOFTWARE_KERNELS_H
+
+#include <QColor>
+#include <QImage>
+
+#include "shaders_global.h"
+
+namespace PlexyDesk
+{
+/*
+ * CPU versions of the effects ShaderEffectItem is most often used for,
+ * run when no GL context is around. They work in place on premultiplied
+ * ARGB32 images, split the rows over QThreadPool when the image is big
+ * enough to pay for it and use SSE2 for the per pixel arithmetic where
+ * the compiler targets it.
+ */
+class SHADERSSHARED_EXPORT SoftwareKernels
+{
+public:
+    /* three box passes, close to a gaussian of the same radius */
+    static void blur(QImage &image, int radius);
+
+    /* amount 0 leaves the colors alone, 1 is fully grey */
+    static void desaturate(QImage &image, qreal amount);
+
+    /* scales every pixel by the alpha of the mask at the same position */
+    static void opacityMask(QImage &image, const QImage &mask);
+
+    /* replaces the colors by color, keeping the shape of the image */
+    static void colorOverlay(QImage &image, const QColor &color);
+
+    /* rows shifted sideways along a sine, the mesh wave of the gl path */
+    static QImage wave(const QImage &image, qreal amplitude, qreal frequency, qreal phase);
+
+    /* on by default, the benchmark turns it off to compare */
+    static void setThreadingEnabled(bool enable);
+    static bool threadingEnabled();
+};
+} // namespace PlexyDesk
+#endif // SOFTWARE_KERNELS_H
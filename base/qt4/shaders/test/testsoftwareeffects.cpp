@@ -0,0 +1,170 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+
+#include "testsoftwareeffects.h"
+
+#include <softwarekernels.h>
+
+using namespace PlexyDesk;
+
+enum Effect {
+    Raster,
+    Blur,
+    Desaturate,
+    OpacityMask,
+    ColorOverlay,
+    Wave
+};
+
+static QImage sourceImage(const QSize &size)
+{
+    QImage image(size, QImage::Format_ARGB32_Premultiplied);
+    image.fill(0);
+
+    QPainter painter(&image);
+    QLinearGradient gradient(0, 0, size.width(), size.height());
+    gradient.setColorAt(0, QColor(200, 40, 40));
+    gradient.setColorAt(1, QColor(40, 40, 200, 128));
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setBrush(gradient);
+    painter.drawRoundedRect(QRectF(QPointF(0, 0), size).adjusted(8, 8, -8, -8), 12, 12);
+    return image;
+}
+
+void TestSoftwareEffects::kernels()
+{
+    // seven pixels wide, four go through sse2 and three through the tail
+    QImage image(7, 2, QImage::Format_ARGB32_Premultiplied);
+    image.fill(qRgba(255, 0, 0, 255));
+
+    QImage grey = image;
+    SoftwareKernels::desaturate(grey, 1.0);
+    for (int x = 0; x < 7; x++) {
+        const QRgb pixel = grey.pixel(x, 1);
+        QCOMPARE(qRed(pixel), qGreen(pixel));
+        QCOMPARE(qGreen(pixel), qBlue(pixel));
+        QCOMPARE(qAlpha(pixel), 255);
+    }
+
+    QImage mask(7, 2, QImage::Format_ARGB32_Premultiplied);
+    mask.fill(qRgba(0, 0, 0, 0));
+    mask.setPixel(0, 0, qRgba(0, 0, 0, 255));
+    mask.setPixel(6, 0, qRgba(0, 0, 0, 255));
+    QImage masked = image;
+    SoftwareKernels::opacityMask(masked, mask);
+    QCOMPARE(qAlpha(masked.pixel(0, 0)), 255);
+    QCOMPARE(qAlpha(masked.pixel(6, 0)), 255);
+    QCOMPARE(qAlpha(masked.pixel(3, 0)), 0);
+    QCOMPARE(qRed(masked.pixel(5, 1)), 0);
+
+    QImage tinted = masked;
+    SoftwareKernels::colorOverlay(tinted, QColor(0, 0, 255));
+    QCOMPARE(tinted.pixel(0, 0), qRgba(0, 0, 255, 255));
+    QCOMPARE(tinted.pixel(3, 0), qRgba(0, 0, 0, 0));
+
+    const QImage shifted = SoftwareKernels::wave(image, 2.0, 0.0, M_PI / 2);
+    QCOMPARE(qAlpha(shifted.pixel(0, 0)), 0);
+    QCOMPARE(qAlpha(shifted.pixel(2, 0)), 255);
+
+    QImage blurred = image;
+    SoftwareKernels::blur(blurred, 3);
+    QVERIFY(qAlpha(blurred.pixel(0, 0)) < 255);
+}
+
+void TestSoftwareEffects::opaqueBlur_data()
+{
+    QTest::addColumn<int>("radius");
+
+    QTest::newRow("small") << 3;
+    QTest::newRow("medium") << 8;
+    QTest::newRow("large") << 48;
+}
+
+void TestSoftwareEffects::opaqueBlur()
+{
+    QFETCH(int, radius);
+
+    // away from the transparent border a flat opaque image must come out unchanged
+    const QRgb color = qRgba(200, 120, 40, 255);
+    QImage image(128, 128, QImage::Format_ARGB32_Premultiplied);
+    image.fill(color);
+    SoftwareKernels::blur(image, radius);
+
+    const int border = 3 * qMax(1, radius / 3);
+    for (int y = border; y < image.height() - border; y++) {
+        for (int x = border; x < image.width() - border; x++) {
+            if (image.pixel(x, y) != color)
+                QFAIL(qPrintable(QString("pixel %1,%2 is %3").arg(x).arg(y).arg(image.pixel(x, y), 8, 16)));
+        }
+    }
+}
+
+void TestSoftwareEffects::frame_data()
+{
+    QTest::addColumn<int>("effect");
+    QTest::addColumn<QSize>("size");
+    QTest::addColumn<bool>("threaded");
+
+    const char *names[] = { "raster", "blur", "desaturate", "opacitymask", "coloroverlay", "wave" };
+    const QSize sizes[] = { QSize(256, 256), QSize(1024, 768) };
+
+    for (int s = 0; s < 2; s++) {
+        const QByteArray size = QByteArray::number(sizes[s].width()) + "x"
+            + QByteArray::number(sizes[s].height());
+        for (int e = Raster; e <= Wave; e++) {
+            QTest::newRow(size + " " + names[e]) << e << sizes[s] << true;
+            if (e != Raster)
+                QTest::newRow(size + " " + names[e] + " single") << e << sizes[s] << false;
+        }
+    }
+}
+
+void TestSoftwareEffects::frame()
+{
+    QFETCH(int, effect);
+    QFETCH(QSize, size);
+    QFETCH(bool, threaded);
+
+    const QImage source = sourceImage(size);
+    const QImage mask = sourceImage(size).mirrored(true, false);
+    QImage target(size, QImage::Format_ARGB32_Premultiplied);
+
+    SoftwareKernels::setThreadingEnabled(threaded);
+
+    // a frame is the effect on the cached source plus the blit to the screen
+    QBENCHMARK {
+        QImage result = source;
+        switch (effect) {
+        case Blur: SoftwareKernels::blur(result, 8); break;
+        case Desaturate: SoftwareKernels::desaturate(result, 1.0); break;
+        case OpacityMask: SoftwareKernels::opacityMask(result, mask); break;
+        case ColorOverlay: SoftwareKernels::colorOverlay(result, QColor(20, 120, 220)); break;
+        case Wave: result = SoftwareKernels::wave(source, 4.0, 2.0, 0.5); break;
+        default: break;
+        }
+
+        QPainter painter(&target);
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        painter.drawImage(0, 0, result);
+    }
+
+    SoftwareKernels::setThreadingEnabled(true);
+}
+
+QTEST_MAIN(TestSoftwareEffects)
@@ -0,0 +1,38 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+
+#include <QtTest/QtTest>
+
+/*
+ * Frame cost of the CPU shader effects against drawing the same source
+ * image straight onto a raster target, at a widget sized and a screen
+ * sized source, with and without the thread pool.
+ */
+class TestSoftwareEffects: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void kernels();
+    void opaqueBlur_data();
+    void opaqueBlur();
+
+    void frame_data();
+    void frame();
+};
@@ -0,0 +1,270 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+
+#include "shadowitem.h"
+
+#include <QImage>
+#include <QPainter>
+#include <QPainterPath>
+#include <QPixmapCache>
+#include <QVector>
+
+namespace PlexyDesk
+{
+
+static int sTileRenders = 0;
+
+/* one box blur pass along rows (step 1) or columns (step width) */
+static void boxBlurPass(QVector<int> &alpha, int lines, int length,
+        int lineStep, int step, int radius)
+{
+    const int window = 2 * radius + 1;
+    QVector<int> line(length);
+
+    for (int l = 0; l < lines; l++) {
+        int *base = alpha.data() + l * lineStep;
+        for (int i = 0; i < length; i++)
+            line[i] = base[i * step];
+
+        // everything outside the image is transparent
+        int sum = 0;
+        for (int i = 0; i <= radius && i < length; i++)
+            sum += line[i];
+
+        for (int i = 0; i < length; i++) {
+            base[i * step] = sum / window;
+            if (i + radius + 1 < length)
+                sum += line[i + radius + 1];
+            if (i - radius >= 0)
+                sum -= line[i - radius];
+        }
+    }
+}
+
+/*
+ * The nine-patch is a rounded rect blurred with three box passes, close
+ * enough to a gaussian. Each corner tile is k = 2 * radius + corner wide:
+ * the blur spill outside the rect, the rounded corner and the distance
+ * the kernel reaches inwards. Past that the edge profile no longer
+ * changes, so the one pixel wide middle row and column stretch to any
+ * size.
+ */
+static QPixmap shadowTiles(int radius, int corner, const QColor &color)
+{
+    const QString key = QString("plexy-shadow:%1:%2:%3")
+        .arg(radius).arg(corner).arg(color.rgba(), 0, 16);
+
+    QPixmap pixmap;
+    if (QPixmapCache::find(key, &pixmap))
+        return pixmap;
+
+    sTileRenders++;
+
+    const int tile = 2 * radius + corner;
+    const int size = 2 * tile + 1;
+
+    QImage mask(size, size, QImage::Format_ARGB32_Premultiplied);
+    mask.fill(0);
+    QPainter painter(&mask);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(Qt::black);
+    painter.drawRoundedRect(QRectF(radius, radius, size - 2 * radius, size - 2 * radius),
+            corner, corner);
+    painter.end();
+
+    QVector<int> alpha(size * size);
+    for (int y = 0; y < size; y++) {
+        const QRgb *line = reinterpret_cast<const QRgb *>(mask.constScanLine(y));
+        for (int x = 0; x < size; x++)
+            alpha[y * size + x] = qAlpha(line[x]);
+    }
+
+    const int box = qMax(1, radius / 3);
+    for (int pass = 0; pass < 3; pass++) {
+        boxBlurPass(alpha, size, size, size, 1, box);
+        boxBlurPass(alpha, size, size, 1, size, box);
+    }
+
+    QImage image(size, size, QImage::Format_ARGB32_Premultiplied);
+    for (int y = 0; y < size; y++) {
+        QRgb *line = reinterpret_cast<QRgb *>(image.scanLine(y));
+        for (int x = 0; x < size; x++) {
+            const int a = alpha[y * size + x] * color.alpha() / 255;
+            line[x] = qPremultiply(qRgba(color.red(), color.green(), color.blue(), a));
+        }
+    }
+
+    pixmap = QPixmap::fromImage(image);
+    QPixmapCache::insert(key, pixmap);
+    return pixmap;
+}
+
+class ShadowItem::PrivateShadowItem
+{
+public:
+    PrivateShadowItem() : mRadius(16), mCorner(4), mColor(0, 0, 0) {}
+    ~PrivateShadowItem() {}
+
+    QRectF mTargetRect;
+    int mRadius;
+    int mCorner;
+    QColor mColor;
+    QPointF mOffset;
+};
+
+ShadowItem::ShadowItem(QGraphicsItem *parent) :
+    QGraphicsObject(parent),
+    d(new PrivateShadowItem)
+{
+    setAcceptedMouseButtons(Qt::NoButton);
+    setAcceptsHoverEvents(false);
+}
+
+ShadowItem::~ShadowItem()
+{
+    delete d;
+}
+
+void ShadowItem::setTargetRect(const QRectF &rect)
+{
+    if (rect == d->mTargetRect)
+        return;
+
+    prepareGeometryChange();
+    d->mTargetRect = rect;
+}
+
+QRectF ShadowItem::targetRect() const
+{
+    return d->mTargetRect;
+}
+
+void ShadowItem::setBlurRadius(int radius)
+{
+    prepareGeometryChange();
+    d->mRadius = qMax(0, radius);
+}
+
+int ShadowItem::blurRadius() const
+{
+    return d->mRadius;
+}
+
+void ShadowItem::setCornerRadius(int radius)
+{
+    d->mCorner = qMax(0, radius);
+    update();
+}
+
+int ShadowItem::cornerRadius() const
+{
+    return d->mCorner;
+}
+
+void ShadowItem::setColor(const QColor &color)
+{
+    d->mColor = color;
+    update();
+}
+
+QColor ShadowItem::color() const
+{
+    return d->mColor;
+}
+
+void ShadowItem::setOffset(const QPointF &offset)
+{
+    prepareGeometryChange();
+    d->mOffset = offset;
+}
+
+QPointF ShadowItem::offset() const
+{
+    return d->mOffset;
+}
+
+QRectF ShadowItem::boundingRect() const
+{
+    if (d->mTargetRect.isEmpty())
+        return QRectF();
+
+    return d->mTargetRect.translated(d->mOffset)
+        .adjusted(-d->mRadius, -d->mRadius, d->mRadius, d->mRadius);
+}
+
+QPainterPath ShadowItem::shape() const
+{
+    return QPainterPath();
+}
+
+void ShadowItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *, QWidget *)
+{
+    if (d->mTargetRect.isEmpty() || d->mRadius == 0)
+        return;
+
+    paintShadow(painter, d->mTargetRect.translated(d->mOffset), d->mRadius, d->mCorner, d->mColor);
+}
+
+void ShadowItem::paintShadow(QPainter *painter, const QRectF &rect, int radius,
+        int corner, const QColor &color)
+{
+    if (radius <= 0 || rect.isEmpty())
+        return;
+
+    const QPixmap tiles = shadowTiles(radius, corner, color);
+    const QRectF outer = rect.adjusted(-radius, -radius, radius, radius);
+    const qreal tile = 2 * radius + corner;
+
+    // small rects get their corners trimmed rather than overlapping
+    const qreal tw = qMin(tile, outer.width() / 2);
+    const qreal th = qMin(tile, outer.height() / 2);
+    const qreal far = 2 * tile + 1;
+
+    const qreal left = outer.left();
+    const qreal top = outer.top();
+    const qreal right = outer.right() - tw;
+    const qreal bottom = outer.bottom() - th;
+    const qreal midWidth = outer.width() - 2 * tw;
+    const qreal midHeight = outer.height() - 2 * th;
+
+    painter->drawPixmap(QRectF(left, top, tw, th), tiles, QRectF(0, 0, tw, th));
+    painter->drawPixmap(QRectF(right, top, tw, th), tiles, QRectF(far - tw, 0, tw, th));
+    painter->drawPixmap(QRectF(left, bottom, tw, th), tiles, QRectF(0, far - th, tw, th));
+    painter->drawPixmap(QRectF(right, bottom, tw, th), tiles, QRectF(far - tw, far - th, tw, th));
+
+    if (midWidth > 0) {
+        painter->drawPixmap(QRectF(left + tw, top, midWidth, th), tiles, QRectF(tile, 0, 1, th));
+        painter->drawPixmap(QRectF(left + tw, bottom, midWidth, th), tiles, QRectF(tile, far - th, 1, th));
+    }
+
+    if (midHeight > 0) {
+        painter->drawPixmap(QRectF(left, top + th, tw, midHeight), tiles, QRectF(0, tile, tw, 1));
+        painter->drawPixmap(QRectF(right, top + th, tw, midHeight), tiles, QRectF(far - tw, tile, tw, 1));
+    }
+
+    // the middle is covered by the widget itself, no need to fill it
+}
+
+int ShadowItem::tileRenderCount()
+{
+    return sTileRenders;
+}
+
+} // PlexyDesk
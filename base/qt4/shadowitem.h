@@ -0,0 +1,79 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+
+#ifndef PLEXY_SHADOW_ITEM_H
+#define PLEXY_SHADOW_ITEM_H
+
+#include <QColor>
+#include <QGraphicsObject>
+
+#include "plexydeskuicore_global.h"
+
+namespace PlexyDesk
+{
+/*
+ * A soft drop shadow drawn behind a rounded rectangle. The blur is
+ * rendered once per (radius, corner, color) into a small nine-patch
+ * that every shadow on the desktop shares; painting only blits the
+ * eight border tiles, so moving or resizing the shadow never blurs
+ * anything again. DesktopWidget keeps one of these as a sibling that
+ * follows the widget's geometry.
+ */
+class PLEXYDESKUICORE_EXPORT ShadowItem : public QGraphicsObject
+{
+    Q_OBJECT
+public:
+    explicit ShadowItem(QGraphicsItem *parent = 0);
+    virtual ~ShadowItem();
+
+    /* the rect casting the shadow, in this item's coordinates */
+    void setTargetRect(const QRectF &rect);
+    QRectF targetRect() const;
+
+    void setBlurRadius(int radius);
+    int blurRadius() const;
+
+    void setCornerRadius(int radius);
+    int cornerRadius() const;
+
+    void setColor(const QColor &color);
+    QColor color() const;
+
+    void setOffset(const QPointF &offset);
+    QPointF offset() const;
+
+    virtual QRectF boundingRect() const;
+    /* empty, clicks and item lookups go to the widget underneath */
+    virtual QPainterPath shape() const;
+    virtual void paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
+            QWidget *widget = 0);
+
+    /* draws a shadow for rect without an item, used by custom painted views */
+    static void paintShadow(QPainter *painter, const QRectF &rect, int radius,
+            int corner, const QColor &color);
+
+    /* test hook, how many nine-patches were blurred since start up */
+    static int tileRenderCount();
+
+private:
+    class PrivateShadowItem;
+    PrivateShadowItem *const d;
+};
+} // PlexyDesk
+#endif // PLEXY_SHADOW_ITEM_H
@@ -0,0 +1,131 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+
+#include "testshadow.h"
+
+#include <desktopwidget.h>
+#include <shadowitem.h>
+
+using namespace PlexyDesk;
+
+static const int WidgetCount = 20;
+static const int DragFrames = 30;
+
+class ShadowDesktop
+{
+public:
+    ShadowDesktop(DesktopWidget::ShadowMode mode) {
+        scene.setSceneRect(0, 0, 1024, 768);
+        view.setScene(&scene);
+        view.resize(1024, 768);
+
+        for (int i = 0; i < WidgetCount; i++) {
+            DesktopWidget *widget = new DesktopWidget(QRectF(0, 0, 200, 150));
+            widget->setShadowMode(mode);
+            scene.addItem(widget);
+            widget->setPos(40 + (i % 5) * 190, 40 + (i / 5) * 170);
+            widgets.append(widget);
+        }
+
+        view.show();
+        QTest::qWaitForWindowShown(&view);
+        frame();
+    }
+
+    /* the scene hands its damage to the view in a queued call, the view
+       then posts the paint, run both */
+    void frame() {
+        QApplication::processEvents();
+        QApplication::processEvents();
+    }
+
+    ShadowItem *shadowOf(DesktopWidget *widget) {
+        Q_FOREACH(QGraphicsItem *item, scene.items()) {
+            ShadowItem *shadow = qobject_cast<ShadowItem *>(item->toGraphicsObject());
+            if (shadow && shadow->parentItem() == widget->parentItem()
+                    && shadow->zValue() == widget->zValue()
+                    && shadow->sceneBoundingRect().contains(widget->sceneBoundingRect()))
+                return shadow;
+        }
+        return 0;
+    }
+
+    QGraphicsScene scene;
+    QGraphicsView view;
+    QList<DesktopWidget *> widgets;
+};
+
+void TestShadow::tilesRenderedOnce()
+{
+    const int before = ShadowItem::tileRenderCount();
+    ShadowDesktop desktop(DesktopWidget::CachedShadow);
+
+    // twenty widgets with the same frame share one blurred nine-patch
+    QVERIFY(ShadowItem::tileRenderCount() - before <= 1);
+
+    desktop.widgets.first()->moveBy(25, 25);
+    desktop.frame();
+    QVERIFY(ShadowItem::tileRenderCount() - before <= 1);
+}
+
+void TestShadow::shadowFollowsWidget()
+{
+    ShadowDesktop desktop(DesktopWidget::CachedShadow);
+    DesktopWidget *widget = desktop.widgets.first();
+
+    widget->setPos(300, 300);
+    QVERIFY(desktop.shadowOf(widget));
+
+    widget->setShadowMode(DesktopWidget::EffectShadow);
+    QVERIFY(!desktop.shadowOf(widget));
+    QVERIFY(widget->graphicsEffect());
+
+    widget->setShadowMode(DesktopWidget::CachedShadow);
+    QVERIFY(!widget->graphicsEffect());
+    QVERIFY(desktop.shadowOf(widget));
+}
+
+void TestShadow::drag_data()
+{
+    QTest::addColumn<int>("mode");
+
+    QTest::newRow("none") << int(DesktopWidget::NoShadow);
+    QTest::newRow("nine-patch") << int(DesktopWidget::CachedShadow);
+    QTest::newRow("effect") << int(DesktopWidget::EffectShadow);
+}
+
+void TestShadow::drag()
+{
+    QFETCH(int, mode);
+
+    ShadowDesktop desktop(DesktopWidget::ShadowMode(mode));
+    DesktopWidget *widget = desktop.widgets.at(WidgetCount / 2);
+
+    // one iteration is a short drag, divide by DragFrames for a frame
+    QBENCHMARK {
+        widget->setInMotion(true);
+        for (int i = 0; i < DragFrames; i++) {
+            widget->moveBy(i % 2 ? 4 : -4, 3);
+            desktop.frame();
+        }
+        widget->setInMotion(false);
+    }
+}
+
+QTEST_MAIN(TestShadow)
@@ -0,0 +1,37 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+
+#include <QtTest/QtTest>
+
+/*
+ * Drag frame cost with 20 desktop widgets on screen, with no shadow,
+ * the shared nine-patch shadow and QGraphicsDropShadowEffect. Needs a
+ * display, the frames go through a real view so item caches are used.
+ */
+class TestShadow: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void tilesRenderedOnce();
+    void shadowFollowsWidget();
+
+    void drag_data();
+    void drag();
+};
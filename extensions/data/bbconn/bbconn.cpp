@@ -53,6 +53,13 @@ BBConnData::~BBConnData()
 
 void BBConnData::setArguments(QVariant arg)
 {
+    QVariantMap args = arg.toMap();
+
+    if (args.contains("multicast_group"))
+        d->mClient->setMulticastGroup(QHostAddress(args["multicast_group"].toString()));
+
+    if (args.contains("message"))
+        d->mClient->sendMessage(args["message"].toString());
 }
 
 QVariantMap BBConnData::readAll()
@@ -61,9 +61,22 @@ void Client::sendMessage(const QString &message)
     if (message.isEmpty())
         return;
 
-    QList<Connection *> connections = peers.values();
-    foreach (Connection *connection, connections)
-        connection->sendMessage(message);
+    /* encode once, every connection writes the same shared buffer */
+    const QByteArray frame = Connection::encodeMessage(message);
+    QHash<PeerKey, Connection *>::const_iterator it = peers.constBegin();
+    for (; it != peers.constEnd(); ++it)
+        it.value()->sendFrame(frame);
+}
+
+void Client::sendBinary(const QByteArray &data)
+{
+    const QByteArray frame = Connection::encodeBinary(data);
+    if (frame.isEmpty())
+        return;
+
+    QHash<PeerKey, Connection *>::const_iterator it = peers.constBegin();
+    for (; it != peers.constEnd(); ++it)
+        it.value()->sendFrame(frame);
 }
 
 QString Client::nickName() const
@@ -75,23 +88,35 @@ QString Client::nickName() const
 bool Client::hasConnection(const QHostAddress &senderIp, int senderPort) const
 {
     if (senderPort == -1)
-        return peers.contains(senderIp);
+        return peerAddresses.contains(senderIp);
 
-    if (!peers.contains(senderIp))
-        return false;
+    return peers.contains(PeerKey(senderIp, senderPort));
+}
 
-    QList<Connection *> connections = peers.values(senderIp);
-    foreach (Connection *connection, connections) {
-        if (connection->peerPort() == senderPort)
-            return true;
-    }
+int Client::peerCount() const
+{
+    return peers.count();
+}
+
+quint16 Client::serverPort() const
+{
+    return server.serverPort();
+}
+
+quint16 Client::discoveryPort() const
+{
+    return peerManager->discoveryPort();
+}
 
-    return false;
+void Client::setMulticastGroup(const QHostAddress &group)
+{
+    peerManager->setMulticastGroup(group);
 }
 
 void Client::newConnection(Connection *connection)
 {
     connection->setGreetingMessage(peerManager->userName());
+    connection->setAnnouncedServerPort(server.serverPort());
 
     connect(connection, SIGNAL(error(QAbstractSocket::SocketError)),
             this, SLOT(connectionError(QAbstractSocket::SocketError)));
@@ -102,14 +127,21 @@ void Client::newConnection(Connection *connection)
 void Client::readyForUse()
 {
     Connection *connection = qobject_cast<Connection *>(sender());
-    if (!connection || hasConnection(connection->peerAddress(),
-                                     connection->peerPort()))
+    if (!connection)
+        return;
+
+    const PeerKey key = connection->peerKey();
+    if (peers.contains(key))
         return;
 
     connect(connection, SIGNAL(newMessage(QString,QString)),
             this, SIGNAL(newMessage(QString,QString)));
+    connect(connection, SIGNAL(newBinaryMessage(QString,QByteArray)),
+            this, SIGNAL(newBinaryMessage(QString,QByteArray)));
+
+    peers.insert(key, connection);
+    peerAddresses[key.address]++;
 
-    peers.insert(connection->peerAddress(), connection);
     QString nick = connection->name();
     if (!nick.isEmpty())
         emit newParticipant(nick);
@@ -129,8 +161,12 @@ void Client::connectionError(QAbstractSocket::SocketError /* socketError */)
 
 void Client::removeConnection(Connection *connection)
 {
-    if (peers.contains(connection->peerAddress())) {
-        peers.remove(connection->peerAddress());
+    const PeerKey key = connection->peerKey();
+    if (peers.value(key) == connection) {
+        peers.remove(key);
+        if (--peerAddresses[key.address] <= 0)
+            peerAddresses.remove(key.address);
+
         QString nick = connection->name();
         if (!nick.isEmpty())
             emit participantLeft(nick);
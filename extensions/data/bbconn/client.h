@@ -45,6 +45,7 @@
 #include <QHash>
 #include <QHostAddress>
 
+#include "connection.h"
 #include "server.h"
 
 class PeerManager;
@@ -57,11 +58,17 @@ public:
     Client();
 
     void sendMessage(const QString &message);
+    void sendBinary(const QByteArray &data);
     QString nickName() const;
     bool hasConnection(const QHostAddress &senderIp, int senderPort = -1) const;
+    int peerCount() const;
+    quint16 serverPort() const;
+    quint16 discoveryPort() const;
+    void setMulticastGroup(const QHostAddress &group);
 
 signals:
     void newMessage(const QString &from, const QString &message);
+    void newBinaryMessage(const QString &from, const QByteArray &data);
     void newParticipant(const QString &nick);
     void participantLeft(const QString &nick);
 
@@ -76,7 +83,9 @@ private:
 
     PeerManager *peerManager;
     Server server;
-    QMultiHash<QHostAddress, Connection *> peers;
+    QHash<PeerKey, Connection *> peers;
+    /* number of peers per address, answers hasConnection() without a port */
+    QHash<QHostAddress, int> peerAddresses;
 };
 
 #endif
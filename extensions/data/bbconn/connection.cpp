@@ -42,22 +42,50 @@
 
 #include <QtNetwork>
 
+#include <string.h>
+
 static const int TransferTimeout = 30 * 1000;
 static const int PongTimeout = 60 * 1000;
 static const int PingInterval = 5 * 1000;
 static const char SeparatorToken = ' ';
+/* longest header is "GREETING " followed by a 10 digit length and a separator */
+static const int MaxHeaderSize = 24;
+/* the receive buffer keeps this much allocated between frames */
+static const int InitialBufferSize = 64 * 1024;
+
+struct HeaderToken {
+    const char *name;
+    int length;
+    Connection::DataType type;
+};
+
+static const HeaderToken headerTokens[] = {
+    { "MESSAGE", 7, Connection::PlainText },
+    { "PING", 4, Connection::Ping },
+    { "PONG", 4, Connection::Pong },
+    { "BINARY", 6, Connection::Binary },
+    { "GREETING", 8, Connection::Greeting }
+};
+
+static const int headerTokenCount = sizeof(headerTokens) / sizeof(headerTokens[0]);
 
 Connection::Connection(QObject *parent)
     : QTcpSocket(parent)
 {
     greetingMessage = tr("0009098");
+    announcedServerPort = 0;
+    portInGreeting = false;
     username = tr("unknown");
+    serverPort = 0;
     state = WaitingForGreeting;
     currentDataType = Undefined;
     numBytesForCurrentDataType = -1;
     transferTimerId = 0;
+    bufferPos = 0;
+    bufferEnd = 0;
     isGreetingMessageSent = false;
     pingTimer.setInterval(PingInterval);
+    buffer.resize(InitialBufferSize);
 
     QObject::connect(this, SIGNAL(readyRead()), this, SLOT(processReadyRead()));
     QObject::connect(this, SIGNAL(disconnected()), &pingTimer, SLOT(stop()));
@@ -76,14 +104,70 @@ void Connection::setGreetingMessage(const QString &message)
     greetingMessage = message;
 }
 
+void Connection::setAnnouncedServerPort(quint16 port)
+{
+    announcedServerPort = port;
+}
+
+void Connection::setPortInGreeting(bool enabled)
+{
+    portInGreeting = enabled;
+}
+
 bool Connection::sendMessage(const QString &message)
 {
     if (message.isEmpty())
         return false;
 
+    return sendFrame(encodeMessage(message));
+}
+
+bool Connection::sendFrame(const QByteArray &frame)
+{
+    if (frame.isEmpty())
+        return false;
+
+    return write(frame) == frame.size();
+}
+
+QByteArray Connection::encodeMessage(const QString &message)
+{
+    if (message.isEmpty())
+        return QByteArray();
+
     QByteArray msg = message.toUtf8();
-    QByteArray data = "MESSAGE " + QByteArray::number(msg.size()) + ' ' + msg;
-    return write(data) == data.size();
+    return "MESSAGE " + QByteArray::number(msg.size()) + ' ' + msg;
+}
+
+QByteArray Connection::encodeBinary(const QByteArray &data)
+{
+    if (data.isEmpty() || data.size() > MaxBinarySize)
+        return QByteArray();
+
+    return "BINARY " + QByteArray::number(data.size()) + ' ' + data;
+}
+
+quint16 Connection::peerServerPort() const
+{
+    return serverPort ? serverPort : peerPort();
+}
+
+PeerKey Connection::peerKey() const
+{
+    if (key.port)
+        return key;
+
+    return PeerKey(peerAddress(), peerServerPort());
+}
+
+bool Connection::sendBinary(const QByteArray &data)
+{
+    if (data.isEmpty() || data.size() > MaxBinarySize)
+        return false;
+
+    /* two writes so a large payload is not copied into a temporary frame */
+    QByteArray header = "BINARY " + QByteArray::number(data.size()) + ' ';
+    return write(header) == header.size() && write(data) == data.size();
 }
 
 void Connection::timerEvent(QTimerEvent *timerEvent)
@@ -97,55 +181,37 @@ void Connection::timerEvent(QTimerEvent *timerEvent)
 
 void Connection::processReadyRead()
 {
-    if (state == WaitingForGreeting) {
-        if (!readProtocolHeader())
-            return;
-        if (currentDataType != Greeting) {
-            abort();
-            return;
-        }
-        state = ReadingGreeting;
-    }
-
-    if (state == ReadingGreeting) {
-        if (!hasEnoughData())
-            return;
-
-        buffer = read(numBytesForCurrentDataType);
-        if (buffer.size() != numBytesForCurrentDataType) {
-            abort();
-            return;
+    while (readDataIntoBuffer() > 0) {
+        while (bufferPos < bufferEnd) {
+            if (currentDataType == Undefined && !readProtocolHeader())
+                break;
+
+            if (state == WaitingForGreeting) {
+                if (currentDataType != Greeting) {
+                    abort();
+                    return;
+                }
+                state = ReadingGreeting;
+            }
+
+            if (!hasEnoughData())
+                break;
+
+            if (!processData())
+                return;
         }
 
-        username = QString(buffer) + '@' + peerAddress().toString() + ':'
-                   + QString::number(peerPort());
-        currentDataType = Undefined;
-        numBytesForCurrentDataType = 0;
-        buffer.clear();
-
-        if (!isValid()) {
-            abort();
-            return;
+        /* everything consumed, start over at the front of the buffer; only
+           give back what a large binary frame made us allocate */
+        if (bufferPos == bufferEnd) {
+            bufferPos = 0;
+            bufferEnd = 0;
+            if (buffer.size() > InitialBufferSize)
+                buffer.resize(InitialBufferSize);
         }
-
-        if (!isGreetingMessageSent)
-            sendGreetingMessage();
-
-        pingTimer.start();
-        pongTime.start();
-        state = ReadyForUse;
-        emit readyForUse();
     }
 
-    do {
-        if (currentDataType == Undefined) {
-            if (!readProtocolHeader())
-                return;
-        }
-        if (!hasEnoughData())
-            return;
-        processData();
-    } while (bytesAvailable() > 0);
+    resetTransferTimer(bufferPos < bufferEnd || currentDataType != Undefined);
 }
 
 void Connection::sendPing()
@@ -161,103 +227,119 @@ void Connection::sendPing()
 void Connection::sendGreetingMessage()
 {
     QByteArray greeting = greetingMessage.toUtf8();
+    if (portInGreeting && announcedServerPort)
+        greeting += '@' + QByteArray::number(announcedServerPort);
     QByteArray data = "GREETING " + QByteArray::number(greeting.size()) + ' ' + greeting;
     if (write(data) == data.size())
         isGreetingMessageSent = true;
 }
 
-int Connection::readDataIntoBuffer(int maxSize)
+int Connection::readDataIntoBuffer()
 {
-    if (maxSize > MaxBufferSize)
+    const qint64 available = bytesAvailable();
+    if (available <= 0)
         return 0;
 
-    int numBytesBeforeRead = buffer.size();
-    if (numBytesBeforeRead == MaxBufferSize) {
+    /* a frame may not be larger than MaxBufferSize unless it is a binary
+       payload whose announced size we already know */
+    int limit = MaxBufferSize;
+    if (currentDataType == Binary)
+        limit = qMax(limit, numBytesForCurrentDataType);
+
+    const int unread = bufferEnd - bufferPos;
+    if (unread >= limit) {
         abort();
         return 0;
     }
 
-    while (bytesAvailable() > 0 && buffer.size() < maxSize) {
-        buffer.append(read(1));
-        if (buffer.endsWith(SeparatorToken))
-            break;
+    const int toRead = int(qMin<qint64>(available, limit - unread));
+
+    /* slide the unparsed tail to the front instead of growing the buffer */
+    if (bufferPos > 0 && bufferEnd + toRead > buffer.size()) {
+        memmove(buffer.data(), buffer.constData() + bufferPos, unread);
+        bufferEnd = unread;
+        bufferPos = 0;
     }
-    return buffer.size() - numBytesBeforeRead;
-}
 
-int Connection::dataLengthForCurrentDataType()
-{
-    if (bytesAvailable() <= 0 || readDataIntoBuffer() <= 0
-            || !buffer.endsWith(SeparatorToken))
+    /* the buffer only ever grows here, the used length is bufferEnd */
+    if (bufferEnd + toRead > buffer.size())
+        buffer.resize(qMin(limit, qMax(bufferEnd + toRead, buffer.size() * 2)));
+
+    const qint64 numRead = read(buffer.data() + bufferEnd, toRead);
+    if (numRead <= 0)
         return 0;
 
-    buffer.chop(1);
-    int number = buffer.toInt();
-    buffer.clear();
-    return number;
+    bufferEnd += int(numRead);
+    return int(numRead);
 }
 
 bool Connection::readProtocolHeader()
 {
-    if (transferTimerId) {
-        killTimer(transferTimerId);
-        transferTimerId = 0;
-    }
+    const char *data = buffer.constData() + bufferPos;
+    const int length = bufferEnd - bufferPos;
+    const int scan = qMin(length, MaxHeaderSize);
 
-    if (readDataIntoBuffer() <= 0) {
-        transferTimerId = startTimer(TransferTimeout);
+    const char *tokenEnd = static_cast<const char *>(memchr(data, SeparatorToken, scan));
+    const char *sizeEnd = tokenEnd ? static_cast<const char *>(
+            memchr(tokenEnd + 1, SeparatorToken, scan - (tokenEnd + 1 - data))) : 0;
+
+    if (!sizeEnd) {
+        /* the header is not complete yet, unless it is garbage */
+        if (length >= MaxHeaderSize)
+            abort();
         return false;
     }
 
-    if (buffer == "PING ") {
-        currentDataType = Ping;
-    } else if (buffer == "PONG ") {
-        currentDataType = Pong;
-    } else if (buffer == "MESSAGE ") {
-        currentDataType = PlainText;
-    } else if (buffer == "GREETING ") {
-        currentDataType = Greeting;
-    } else {
+    const int tokenLength = tokenEnd - data;
+    DataType type = Undefined;
+    for (int i = 0; i < headerTokenCount; i++) {
+        if (headerTokens[i].length == tokenLength
+                && memcmp(headerTokens[i].name, data, tokenLength) == 0) {
+            type = headerTokens[i].type;
+            break;
+        }
+    }
+
+    qint64 number = 0;
+    for (const char *c = tokenEnd + 1; c < sizeEnd; c++) {
+        if (*c < '0' || *c > '9') {
+            type = Undefined;
+            break;
+        }
+        number = number * 10 + (*c - '0');
+    }
+
+    const int maxSize = (type == Binary) ? MaxBinarySize : MaxBufferSize;
+    if (type == Undefined || sizeEnd == tokenEnd + 1 || number <= 0 || number > maxSize) {
         currentDataType = Undefined;
         abort();
         return false;
     }
 
-    buffer.clear();
-    numBytesForCurrentDataType = dataLengthForCurrentDataType();
+    currentDataType = type;
+    numBytesForCurrentDataType = int(number);
+    bufferPos += sizeEnd + 1 - data;
     return true;
 }
 
-bool Connection::hasEnoughData()
+bool Connection::hasEnoughData() const
 {
-    if (transferTimerId) {
-        QObject::killTimer(transferTimerId);
-        transferTimerId = 0;
-    }
-
-    if (numBytesForCurrentDataType <= 0)
-        numBytesForCurrentDataType = dataLengthForCurrentDataType();
-
-    if (bytesAvailable() < numBytesForCurrentDataType
-            || numBytesForCurrentDataType <= 0) {
-        transferTimerId = startTimer(TransferTimeout);
-        return false;
-    }
-
-    return true;
+    return bufferEnd - bufferPos >= numBytesForCurrentDataType;
 }
 
-void Connection::processData()
+bool Connection::processData()
 {
-    buffer = read(numBytesForCurrentDataType);
-    if (buffer.size() != numBytesForCurrentDataType) {
-        abort();
-        return;
-    }
+    const char *data = buffer.constData() + bufferPos;
+    const int size = numBytesForCurrentDataType;
+
+    bufferPos += size;
 
     switch (currentDataType) {
     case PlainText:
-        emit newMessage(username, QString::fromUtf8(buffer));
+        emit newMessage(username, QString::fromUtf8(data, size));
+        break;
+    case Binary:
+        emit newBinaryMessage(username, QByteArray(data, size));
         break;
     case Ping:
         write("PONG 1 p");
@@ -266,13 +348,64 @@ void Connection::processData()
         pongTime.restart();
         break;
     case Greeting:
-        qDebug() << Q_FUNC_INFO << QString::fromUtf8(buffer);
-        break;
+        if (state != ReadingGreeting) {
+            qDebug() << Q_FUNC_INFO << QString::fromUtf8(data, size);
+            break;
+        }
+
+        readGreeting(QString::fromUtf8(data, size));
+
+        if (!isValid()) {
+            abort();
+            return false;
+        }
+
+        if (!isGreetingMessageSent)
+            sendGreetingMessage();
+
+        pingTimer.start();
+        pongTime.start();
+        state = ReadyForUse;
+        currentDataType = Undefined;
+        numBytesForCurrentDataType = 0;
+        emit readyForUse();
+        return true;
     default:
         break;
     }
 
     currentDataType = Undefined;
     numBytesForCurrentDataType = 0;
-    buffer.clear();
+    return true;
+}
+
+void Connection::readGreeting(const QString &message)
+{
+    /* newer peers greet with "name@port" so we learn where their server
+       listens even when they are the ones connecting to us, answer them in
+       kind; a plain name comes from an older peer and gets a plain name */
+    QString greeting = message;
+    const int at = greeting.lastIndexOf('@');
+    bool ok = false;
+    const quint16 port = at > 0 ? greeting.mid(at + 1).toUShort(&ok) : 0;
+    if (ok && port) {
+        serverPort = port;
+        greeting.truncate(at);
+        portInGreeting = true;
+    }
+
+    username = greeting + '@' + peerAddress().toString() + ':'
+               + QString::number(peerServerPort());
+    key = PeerKey(peerAddress(), peerServerPort());
+}
+
+void Connection::resetTransferTimer(bool start)
+{
+    if (transferTimerId) {
+        killTimer(transferTimerId);
+        transferTimerId = 0;
+    }
+
+    if (start)
+        transferTimerId = startTimer(TransferTimeout);
 }
@@ -48,6 +48,26 @@
 #include <QTimer>
 
 static const int MaxBufferSize = 1024000;
+static const int MaxBinarySize = 64 * 1024 * 1024;
+
+/* identifies a peer by its address and the port its server listens on */
+struct PeerKey {
+    PeerKey() : port(0) {}
+    PeerKey(const QHostAddress &a, quint16 p) : address(a), port(p) {}
+
+    QHostAddress address;
+    quint16 port;
+};
+
+inline bool operator==(const PeerKey &a, const PeerKey &b)
+{
+    return a.port == b.port && a.address == b.address;
+}
+
+inline uint qHash(const PeerKey &key)
+{
+    return qHash(key.address) ^ (uint(key.port) << 16 | key.port);
+}
 
 class Connection : public QTcpSocket
 {
@@ -64,6 +84,7 @@ public:
         Ping,
         Pong,
         Greeting,
+        Binary,
         Undefined
     };
 
@@ -71,11 +92,29 @@ public:
 
     QString name() const;
     void setGreetingMessage(const QString &message);
+
+    /* our own server port, appended to the greeting as "name@port" only
+       when the peer is known to understand it; older peers take the whole
+       greeting as the user name */
+    void setAnnouncedServerPort(quint16 port);
+    void setPortInGreeting(bool enabled);
     bool sendMessage(const QString &message);
+    bool sendBinary(const QByteArray &data);
+
+    /* writes a frame built with encodeMessage(), lets a caller encode once
+       and hand the same buffer to many connections */
+    bool sendFrame(const QByteArray &frame);
+    static QByteArray encodeMessage(const QString &message);
+    static QByteArray encodeBinary(const QByteArray &data);
+
+    /* port the remote server listens on, as announced in its greeting */
+    quint16 peerServerPort() const;
+    PeerKey peerKey() const;
 
 signals:
     void readyForUse();
     void newMessage(const QString &from, const QString &message);
+    void newBinaryMessage(const QString &from, const QByteArray &data);
 
 protected:
     void timerEvent(QTimerEvent *timerEvent);
@@ -86,17 +125,27 @@ private slots:
     void sendGreetingMessage();
 
 private:
-    int readDataIntoBuffer(int maxSize = MaxBufferSize);
-    int dataLengthForCurrentDataType();
+    int readDataIntoBuffer();
     bool readProtocolHeader();
-    bool hasEnoughData();
-    void processData();
+    bool hasEnoughData() const;
+    bool processData();
+    void readGreeting(const QString &message);
+    void resetTransferTimer(bool start);
 
     QString greetingMessage;
+    quint16 announcedServerPort;
+    bool portInGreeting;
     QString username;
+    quint16 serverPort;
+    /* remembered at greeting time, the socket forgets its peer on disconnect */
+    PeerKey key;
     QTimer pingTimer;
     QTime pongTime;
+    /* received bytes, frames are parsed in place from bufferPos up to
+       bufferEnd; the array keeps its size so the storage is reused */
     QByteArray buffer;
+    int bufferPos;
+    int bufferEnd;
     ConnectionState state;
     DataType currentDataType;
     int numBytesForCurrentDataType;
@@ -44,8 +44,15 @@
 #include "connection.h"
 #include "peermanager.h"
 
-static const qint32 BroadcastInterval = 2000;
-static const unsigned broadcastPort = 45000;
+/* announces start fast and back off exponentially, a peer that joins later
+   announces itself at the fast rate and gets connected to by everyone, so
+   established peers do not need to keep shouting */
+static const qint32 MinBroadcastInterval = 1000;
+static const qint32 MaxBroadcastInterval = 64000;
+static const quint16 DefaultBroadcastPort = 45000;
+/* appended to a second announce, older peers drop datagrams with more
+   than one '@' so they only ever see the plain "name@port" one */
+static const char GreetingVersion[] = "2";
 
 PeerManager::PeerManager(Client *client)
     : QObject(client)
@@ -78,12 +85,21 @@ PeerManager::PeerManager(Client *client)
     updateAddresses();
     serverPort = 0;
 
+    /* PLEXY_BBCONN_PORT moves discovery off the shared port, 0 picks a
+       free one so tests don't meet a running desktop */
+    bool ok = false;
+    const int port = qgetenv("PLEXY_BBCONN_PORT").toInt(&ok);
+    broadcastPort = (ok && port >= 0 && port <= 0xffff) ? quint16(port) : DefaultBroadcastPort;
+
     broadcastSocket.bind(QHostAddress::Any, broadcastPort, QUdpSocket::ShareAddress
                          | QUdpSocket::ReuseAddressHint);
+    if (!broadcastPort)
+        broadcastPort = broadcastSocket.localPort();
     connect(&broadcastSocket, SIGNAL(readyRead()),
             this, SLOT(readBroadcastDatagram()));
 
-    broadcastTimer.setInterval(BroadcastInterval);
+    currentInterval = MinBroadcastInterval;
+    broadcastTimer.setSingleShot(true);
     connect(&broadcastTimer, SIGNAL(timeout()),
             this, SLOT(sendBroadcastDatagram()));
 }
@@ -100,7 +116,23 @@ QByteArray PeerManager::userName() const
 
 void PeerManager::startBroadcasting()
 {
-    broadcastTimer.start();
+    resetBroadcastInterval();
+}
+
+void PeerManager::resetBroadcastInterval()
+{
+    currentInterval = MinBroadcastInterval;
+    broadcastTimer.start(0);
+}
+
+quint16 PeerManager::discoveryPort() const
+{
+    return broadcastPort;
+}
+
+int PeerManager::broadcastInterval() const
+{
+    return currentInterval;
 }
 
 bool PeerManager::isLocalHostAddress(const QHostAddress &address)
@@ -112,21 +144,67 @@ bool PeerManager::isLocalHostAddress(const QHostAddress &address)
     return false;
 }
 
+void PeerManager::setMulticastGroup(const QHostAddress &group)
+{
+#if QT_VERSION >= 0x040800
+    if (!multicastGroup.isNull())
+        broadcastSocket.leaveMulticastGroup(multicastGroup);
+
+    multicastGroup = group;
+    if (!multicastGroup.isNull()) {
+        broadcastSocket.setSocketOption(QAbstractSocket::MulticastTtlOption, 1);
+        if (!broadcastSocket.joinMulticastGroup(multicastGroup)) {
+            qWarning() << Q_FUNC_INFO << "Failed to join" << multicastGroup.toString();
+            multicastGroup.clear();
+        }
+    }
+    resetBroadcastInterval();
+#else
+    Q_UNUSED(group);
+    qWarning() << Q_FUNC_INFO << "Multicast discovery requires Qt 4.8";
+#endif
+}
+
 void PeerManager::sendBroadcastDatagram()
 {
     QByteArray datagram(username);
     datagram.append('@');
     datagram.append(QByteArray::number(serverPort));
 
+    /* the versioned announce goes first so newer peers usually see it
+       before they connect */
+    QList<QByteArray> datagrams;
+    datagrams << datagram + '@' + GreetingVersion << datagram;
+
     bool validBroadcastAddresses = true;
-    foreach (QHostAddress address, broadcastAddresses) {
-        if (broadcastSocket.writeDatagram(datagram, address,
-                                          broadcastPort) == -1)
-            validBroadcastAddresses = false;
+    foreach (const QByteArray &data, datagrams) {
+        if (!multicastGroup.isNull()) {
+            if (broadcastSocket.writeDatagram(data, multicastGroup,
+                                              broadcastPort) == -1)
+                validBroadcastAddresses = false;
+        } else {
+            foreach (QHostAddress address, broadcastAddresses) {
+                if (broadcastSocket.writeDatagram(data, address,
+                                                  broadcastPort) == -1)
+                    validBroadcastAddresses = false;
+            }
+        }
     }
 
     if (!validBroadcastAddresses)
         updateAddresses();
+
+    /* connections deleted before they finished their handshake */
+    QHash<PeerKey, QPointer<Connection> >::iterator it = pendingConnections.begin();
+    while (it != pendingConnections.end()) {
+        if (it.value().isNull())
+            it = pendingConnections.erase(it);
+        else
+            ++it;
+    }
+
+    broadcastTimer.start(currentInterval);
+    currentInterval = qMin(currentInterval * 2, MaxBroadcastInterval);
 }
 
 void PeerManager::readBroadcastDatagram()
@@ -140,24 +218,59 @@ void PeerManager::readBroadcastDatagram()
                                          &senderIp, &senderPort) == -1)
             continue;
 
-        QList<QByteArray> list = datagram.split('@');
-        if (list.size() != 2)
+        const QList<QByteArray> fields = datagram.split('@');
+        if (fields.size() != 2 && fields.size() != 3)
             continue;
 
-        int senderServerPort = list.at(1).toInt();
-        if (isLocalHostAddress(senderIp) && senderServerPort == serverPort)
+        bool ok = false;
+        const quint16 senderServerPort = fields.at(1).toUShort(&ok);
+        if (!ok || (isLocalHostAddress(senderIp) && senderServerPort == serverPort))
             continue;
 
-        if (!client->hasConnection(senderIp)) {
-            Connection *connection = new Connection(this);
-            emit newConnection(connection);
-            connection->connectToHost(senderIp, senderServerPort);
+        const PeerKey key(senderIp, senderServerPort);
+        if (fields.size() == 3) {
+            if (fields.at(2) != GreetingVersion)
+                continue;
+            portGreetingPeers.insert(key);
         }
+
+        if (client->hasConnection(senderIp, senderServerPort) || pendingConnections.value(key))
+            continue;
+
+        Connection *connection = new Connection(this);
+        pendingConnections.insert(key, connection);
+        connect(connection, SIGNAL(readyForUse()), this, SLOT(pendingConnectionFinished()));
+        connect(connection, SIGNAL(error(QAbstractSocket::SocketError)),
+                this, SLOT(pendingConnectionFinished()));
+        connect(connection, SIGNAL(disconnected()), this, SLOT(pendingConnectionFinished()));
+        emit newConnection(connection);
+        connection->setPortInGreeting(portGreetingPeers.contains(key));
+        connection->connectToHost(senderIp, senderServerPort);
+    }
+}
+
+void PeerManager::pendingConnectionFinished()
+{
+    Connection *connection = qobject_cast<Connection *>(sender());
+    if (!connection)
+        return;
+
+    /* once ready the client tracks it, after an error the next announce
+       may try again */
+    disconnect(connection, 0, this, SLOT(pendingConnectionFinished()));
+    QHash<PeerKey, QPointer<Connection> >::iterator it = pendingConnections.begin();
+    while (it != pendingConnections.end()) {
+        if (it.value() == connection)
+            it = pendingConnections.erase(it);
+        else
+            ++it;
     }
 }
 
 void PeerManager::updateAddresses()
 {
+    const QList<QHostAddress> oldAddresses = ipAddresses;
+
     broadcastAddresses.clear();
     ipAddresses.clear();
     foreach (QNetworkInterface interface, QNetworkInterface::allInterfaces()) {
@@ -169,4 +282,10 @@ void PeerManager::updateAddresses()
             }
         }
     }
+
+    /* we moved to another network, nobody there knows us yet */
+    if (ipAddresses != oldAddresses) {
+        currentInterval = MinBroadcastInterval;
+        portGreetingPeers.clear();
+    }
 }
@@ -42,13 +42,17 @@
 #define PEERMANAGER_H
 
 #include <QByteArray>
+#include <QHash>
 #include <QList>
 #include <QObject>
+#include <QPointer>
+#include <QSet>
 #include <QTimer>
 #include <QUdpSocket>
 
+#include "connection.h"
+
 class Client;
-class Connection;
 
 class PeerManager : public QObject
 {
@@ -60,14 +64,23 @@ public:
     void setServerPort(int port);
     QByteArray userName() const;
     void startBroadcasting();
+    void resetBroadcastInterval();
+    int broadcastInterval() const;
+    /* the udp port announces are sent to and read from */
+    quint16 discoveryPort() const;
     bool isLocalHostAddress(const QHostAddress &address);
 
+    /* announce to a multicast group instead of every broadcast address,
+       a null address goes back to broadcasting */
+    void setMulticastGroup(const QHostAddress &group);
+
 signals:
     void newConnection(Connection *connection);
 
 private slots:
     void sendBroadcastDatagram();
     void readBroadcastDatagram();
+    void pendingConnectionFinished();
 
 private:
     void updateAddresses();
@@ -75,8 +88,15 @@ private:
     Client *client;
     QList<QHostAddress> broadcastAddresses;
     QList<QHostAddress> ipAddresses;
+    QHostAddress multicastGroup;
     QUdpSocket broadcastSocket;
+    quint16 broadcastPort;
     QTimer broadcastTimer;
+    int currentInterval;
+    /* outgoing connections still doing their handshake */
+    QHash<PeerKey, QPointer<Connection> > pendingConnections;
+    /* peers that announced they understand a "name@port" greeting */
+    QSet<PeerKey> portGreetingPeers;
     QByteArray username;
     int serverPort;
 };
@@ -0,0 +1,161 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+
+#include "testconnection.h"
+#include <connection.h>
+#include <server.h>
+
+void TestConnection::onNewConnection(Connection *connection)
+{
+    mPeer = connection;
+    connect(mPeer, SIGNAL(newMessage(QString, QString)),
+            this, SLOT(onNewMessage(QString, QString)));
+    connect(mPeer, SIGNAL(newBinaryMessage(QString, QByteArray)),
+            this, SLOT(onNewBinaryMessage(QString, QByteArray)));
+}
+
+void TestConnection::onNewMessage(const QString &, const QString &message)
+{
+    mReceived++;
+    mBytesReceived += message.size();
+    if (mMessages.size() < 16)
+        mMessages.append(message);
+}
+
+void TestConnection::onNewBinaryMessage(const QString &, const QByteArray &data)
+{
+    mReceived++;
+    mBytesReceived += data.size();
+    if (mBinaries.size() < 16)
+        mBinaries.append(data);
+}
+
+bool TestConnection::waitForMessages(int count, int timeout)
+{
+    QElapsedTimer timer;
+    timer.start();
+    while (mReceived < count && timer.elapsed() < timeout)
+        qApp->processEvents(QEventLoop::AllEvents, 10);
+    return mReceived >= count;
+}
+
+void TestConnection::init()
+{
+    mPeer = 0;
+    mReceived = 0;
+    mBytesReceived = 0;
+    mMessages.clear();
+    mBinaries.clear();
+
+    mServer = new Server(this);
+    connect(mServer, SIGNAL(newConnection(Connection*)),
+            this, SLOT(onNewConnection(Connection*)));
+
+    mClient = new Connection(this);
+    QSignalSpy ready(mClient, SIGNAL(readyForUse()));
+    mClient->connectToHost(QHostAddress::LocalHost, mServer->serverPort());
+
+    QElapsedTimer timer;
+    timer.start();
+    while (ready.count() == 0 && timer.elapsed() < 5000)
+        qApp->processEvents(QEventLoop::AllEvents, 10);
+
+    QVERIFY(mPeer);
+    QCOMPARE(ready.count(), 1);
+}
+
+void TestConnection::cleanup()
+{
+    delete mClient;
+    delete mServer;
+}
+
+void TestConnection::fragmentedFrames()
+{
+    /* deliver a frame a few bytes at a time, the header split mid token */
+    QByteArray frame = "MESSAGE 11 hello world" "MESSAGE 3 abc";
+    for (int i = 0; i < frame.size(); i += 3) {
+        mClient->write(frame.mid(i, 3));
+        mClient->flush();
+        QTest::qWait(5);
+    }
+
+    QVERIFY(waitForMessages(2));
+    QCOMPARE(mMessages.at(0), QString("hello world"));
+    QCOMPARE(mMessages.at(1), QString("abc"));
+}
+
+void TestConnection::binaryRoundTrip()
+{
+    QByteArray payload;
+    payload.resize(3 * 1024 * 1024);
+    for (int i = 0; i < payload.size(); i++)
+        payload[i] = char(i * 31);
+
+    QVERIFY(mClient->sendBinary(payload));
+    QVERIFY(mClient->sendMessage(QString::fromUtf8("after the image")));
+
+    QVERIFY(waitForMessages(2));
+    QCOMPARE(mBinaries.count(), 1);
+    QVERIFY(mBinaries.first() == payload);
+    QCOMPARE(mMessages.first(), QString("after the image"));
+}
+
+void TestConnection::invalidHeader()
+{
+    QSignalSpy closed(mPeer, SIGNAL(disconnected()));
+    mClient->write("BOGUS 5 hello");
+    mClient->flush();
+
+    QElapsedTimer timer;
+    timer.start();
+    while (closed.count() == 0 && timer.elapsed() < 5000)
+        qApp->processEvents(QEventLoop::AllEvents, 10);
+
+    QCOMPARE(mReceived, 0);
+    QVERIFY(mPeer->state() == QAbstractSocket::UnconnectedState);
+}
+
+void TestConnection::textThroughput()
+{
+    const QString message(1024, QChar('m'));
+    const int count = 2000;
+
+    QBENCHMARK {
+        mReceived = 0;
+        for (int i = 0; i < count; i++)
+            mClient->sendMessage(message);
+        QVERIFY(waitForMessages(count));
+    }
+}
+
+void TestConnection::binaryThroughput()
+{
+    const QByteArray payload(1024 * 1024, 'b');
+    const int count = 32;
+
+    QBENCHMARK {
+        mReceived = 0;
+        for (int i = 0; i < count; i++)
+            mClient->sendBinary(payload);
+        QVERIFY(waitForMessages(count));
+    }
+}
+
+QTEST_MAIN(TestConnection)
@@ -0,0 +1,52 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+
+#include <QtTest/QtTest>
+
+class Connection;
+
+class TestConnection: public QObject
+{
+    Q_OBJECT
+
+public slots:
+    void onNewConnection(Connection *connection);
+    void onNewMessage(const QString &from, const QString &message);
+    void onNewBinaryMessage(const QString &from, const QByteArray &data);
+
+private slots:
+    void init();
+    void cleanup();
+    void fragmentedFrames();
+    void binaryRoundTrip();
+    void invalidHeader();
+    void textThroughput();
+    void binaryThroughput();
+
+private:
+    bool waitForMessages(int count, int timeout = 10000);
+
+    class Server *mServer;
+    Connection *mClient;
+    Connection *mPeer;
+    QStringList mMessages;
+    QList<QByteArray> mBinaries;
+    qint64 mBytesReceived;
+    int mReceived;
+};
@@ -0,0 +1,200 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+
+#include "testpeers.h"
+#include <client.h>
+#include <connection.h>
+#include <server.h>
+
+/* the peers are simulated with bare Server objects on localhost ports,
+   their connections answer the greeting on their own */
+static const int PeerCount = 200;
+
+void TestPeers::onNewConnection(Connection *connection)
+{
+    mConnections.append(connection);
+    connect(connection, SIGNAL(newMessage(QString, QString)),
+            this, SLOT(onNewMessage(QString, QString)));
+}
+
+void TestPeers::onNewMessage(const QString &, const QString &)
+{
+    mMessages++;
+}
+
+void TestPeers::onNewParticipant(const QString &)
+{
+    mParticipants++;
+}
+
+bool TestPeers::waitFor(const int *counter, int count, int timeout)
+{
+    QElapsedTimer timer;
+    timer.start();
+    while (*counter < count && timer.elapsed() < timeout)
+        qApp->processEvents(QEventLoop::AllEvents, 10);
+    return *counter >= count;
+}
+
+void TestPeers::announce(int peer, bool versioned)
+{
+    QByteArray datagram = "peer" + QByteArray::number(peer) + '@'
+        + QByteArray::number(mPeers.at(peer)->serverPort());
+    if (versioned)
+        datagram += "@2";
+    mAnnouncer->writeDatagram(datagram, QHostAddress::LocalHost, mClient->discoveryPort());
+}
+
+/* the peer side of the client's connection to a simulated peer */
+Connection *TestPeers::connectionTo(int peer) const
+{
+    Server *server = mPeers.at(peer);
+    Q_FOREACH(Connection *connection, mConnections) {
+        if (connection && connection->parent() == server
+                && connection->state() == QAbstractSocket::ConnectedState)
+            return connection;
+    }
+    return 0;
+}
+
+void TestPeers::initTestCase()
+{
+    mParticipants = 0;
+    mMessages = 0;
+
+    // a free port instead of 45000, a desktop may be running on this host
+    qputenv("PLEXY_BBCONN_PORT", "0");
+    mClient = new Client();
+    qputenv("PLEXY_BBCONN_PORT", QByteArray());
+    QVERIFY(mClient->discoveryPort() != 0);
+    connect(mClient, SIGNAL(newParticipant(QString)), this, SLOT(onNewParticipant(QString)));
+
+    for (int i = 0; i < PeerCount; i++) {
+        Server *server = new Server(this);
+        connect(server, SIGNAL(newConnection(Connection*)),
+                this, SLOT(onNewConnection(Connection*)));
+        mPeers.append(server);
+    }
+
+    mAnnouncer = new QUdpSocket(this);
+}
+
+void TestPeers::cleanupTestCase()
+{
+    delete mClient;
+    qDeleteAll(mPeers);
+}
+
+void TestPeers::discoverPeers()
+{
+    for (int i = 0; i < PeerCount; i++)
+        announce(i);
+
+    QVERIFY(waitFor(&mParticipants, PeerCount));
+    QCOMPARE(mClient->peerCount(), PeerCount);
+
+    for (int i = 0; i < PeerCount; i++)
+        QVERIFY(mClient->hasConnection(QHostAddress::LocalHost, mPeers.at(i)->serverPort()));
+}
+
+void TestPeers::duplicateAnnounces()
+{
+    /* peers keep announcing, none of that may open a second connection */
+    for (int round = 0; round < 3; round++) {
+        for (int i = 0; i < PeerCount; i++)
+            announce(i);
+        QTest::qWait(200);
+    }
+
+    QCOMPARE(mParticipants, PeerCount);
+    QCOMPARE(mClient->peerCount(), PeerCount);
+}
+
+void TestPeers::reconnectAfterDrop()
+{
+    Connection *connection = connectionTo(0);
+    QVERIFY(connection);
+    connection->abort();
+
+    QElapsedTimer timer;
+    timer.start();
+    while (mClient->peerCount() == PeerCount && timer.elapsed() < 5000)
+        qApp->processEvents(QEventLoop::AllEvents, 10);
+    QCOMPARE(mClient->peerCount(), PeerCount - 1);
+
+    /* the finished handshake must not keep the peer blocked */
+    announce(0);
+    QVERIFY(waitFor(&mParticipants, PeerCount + 1));
+    QCOMPARE(mClient->peerCount(), PeerCount);
+}
+
+void TestPeers::greetingFallback()
+{
+    /* a plain announce gets a plain greeting, the peer sees our client
+       port; a versioned one gets "name@port" and the real server port */
+    QVERIFY(connectionTo(1));
+    QVERIFY(connectionTo(1)->peerServerPort() != mClient->serverPort());
+
+    Connection *connection = connectionTo(2);
+    QVERIFY(connection);
+    connection->abort();
+    QTest::qWait(200);
+
+    const int participants = mParticipants;
+    announce(2, true);
+    QVERIFY(waitFor(&mParticipants, participants + 1));
+
+    connection = connectionTo(2);
+    QVERIFY(connection);
+    QCOMPARE(connection->peerServerPort(), mClient->serverPort());
+}
+
+void TestPeers::fanOut()
+{
+    mMessages = 0;
+    mClient->sendMessage("hello everyone");
+    QVERIFY(waitFor(&mMessages, PeerCount));
+
+    QTest::qWait(100);
+    QCOMPARE(mMessages, PeerCount);
+}
+
+void TestPeers::fanOutBenchmark()
+{
+    const QString message(512, QChar('f'));
+
+    QBENCHMARK {
+        mMessages = 0;
+        for (int i = 0; i < 10; i++)
+            mClient->sendMessage(message);
+        QVERIFY(waitFor(&mMessages, 10 * PeerCount));
+    }
+}
+
+void TestPeers::lookupBenchmark()
+{
+    const quint16 port = mPeers.last()->serverPort();
+
+    QBENCHMARK {
+        for (int i = 0; i < 1000; i++)
+            mClient->hasConnection(QHostAddress::LocalHost, port);
+    }
+}
+
+QTEST_MAIN(TestPeers)
@@ -0,0 +1,57 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+
+#include <QtTest/QtTest>
+
+class Client;
+class Connection;
+class Server;
+
+class TestPeers: public QObject
+{
+    Q_OBJECT
+
+public slots:
+    void onNewConnection(Connection *connection);
+    void onNewMessage(const QString &from, const QString &message);
+    void onNewParticipant(const QString &nick);
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void discoverPeers();
+    void duplicateAnnounces();
+    void reconnectAfterDrop();
+    void greetingFallback();
+    void fanOut();
+    void fanOutBenchmark();
+    void lookupBenchmark();
+
+private:
+    bool waitFor(const int *counter, int count, int timeout = 20000);
+    void announce(int peer, bool versioned = false);
+    Connection *connectionTo(int peer) const;
+
+    Client *mClient;
+    QList<Server *> mPeers;
+    QList<QPointer<Connection> > mConnections;
+    QUdpSocket *mAnnouncer;
+    int mParticipants;
+    int mMessages;
+};
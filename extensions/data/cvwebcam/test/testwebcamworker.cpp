@@ -0,0 +1,132 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+#include "testwebcamworker.h"
+#include "webcamworker.h"
+
+static const int ReplayTimeout = 20000;
+
+void TestWebCamWorker::onFrameGrabbed(int frame)
+{
+    mFrames.append(frame);
+}
+
+void TestWebCamWorker::onFaceMoved(const QVariantMap &data)
+{
+    mFaces.append(qMakePair(mFrames.isEmpty() ? -1 : mFrames.last(), data));
+}
+
+void TestWebCamWorker::onReplayFinished()
+{
+    mFinished = true;
+}
+
+void TestWebCamWorker::init()
+{
+    mFrames.clear();
+    mFaces.clear();
+    mFinished = false;
+    loadFaces();
+}
+
+void TestWebCamWorker::loadFaces()
+{
+    mDrawnFaces.clear();
+
+    QFile file(FIXTURE_DIR "/moving-face/faces.txt");
+    QVERIFY(file.open(QIODevice::ReadOnly | QIODevice::Text));
+    while (!file.atEnd()) {
+        const QByteArray line = file.readLine().trimmed();
+        if (line.isEmpty() || line.startsWith('#'))
+            continue;
+        const QList<QByteArray> fields = line.split(' ');
+        QCOMPARE(fields.count(), 5);
+        QCOMPARE(fields.at(0).toInt(), mDrawnFaces.count());
+        mDrawnFaces.append(QRect(fields.at(1).toInt(), fields.at(2).toInt(),
+                                 fields.at(3).toInt(), fields.at(4).toInt()));
+    }
+}
+
+bool TestWebCamWorker::replay(QObject *worker, const QString &path)
+{
+    connect(worker, SIGNAL(frameGrabbed(int)), this, SLOT(onFrameGrabbed(int)));
+    connect(worker, SIGNAL(faceMoved(QVariantMap)), this, SLOT(onFaceMoved(QVariantMap)));
+    connect(worker, SIGNAL(replayFinished()), this, SLOT(onReplayFinished()));
+    QMetaObject::invokeMethod(worker, "startReplay", Q_ARG(QString, path));
+
+    QElapsedTimer timer;
+    timer.start();
+    while (!mFinished && timer.elapsed() < ReplayTimeout)
+        qApp->processEvents(QEventLoop::AllEvents, 10);
+    return mFinished;
+}
+
+void TestWebCamWorker::missingReplay()
+{
+    WebCamWorker worker;
+    QVERIFY(replay(&worker, FIXTURE_DIR "/does-not-exist"));
+    QVERIFY(mFrames.isEmpty());
+    QVERIFY(mFaces.isEmpty());
+}
+
+void TestWebCamWorker::replayFrames()
+{
+    /* without a cascade nothing is detected, but every frame is read in order */
+    WebCamWorker worker;
+    QVERIFY(replay(&worker, FIXTURE_DIR "/moving-face"));
+
+    QCOMPARE(mFrames.count(), mDrawnFaces.count());
+    for (int i = 0; i < mFrames.count(); i++)
+        QCOMPARE(mFrames.at(i), i);
+    QVERIFY(mFaces.isEmpty());
+}
+
+void TestWebCamWorker::replayFace()
+{
+    if (!QFile::exists(CASCADE_FILE))
+        QSKIP("the OpenCV frontal face cascade is not installed", SkipAll);
+
+    WebCamWorker worker;
+    worker.setCascade(CASCADE_FILE);
+    worker.setDetectInterval(4);
+    QVERIFY(replay(&worker, FIXTURE_DIR "/moving-face"));
+
+    QCOMPARE(mFrames.count(), mDrawnFaces.count());
+    QVERIFY(!mFaces.isEmpty());
+
+    /* the reported centre stays on the drawn face as it moves */
+    int lastX = -1;
+    for (int i = 0; i < mFaces.count(); i++) {
+        const int frame = mFaces.at(i).first;
+        const QVariantMap &data = mFaces.at(i).second;
+        QVERIFY(frame >= 0 && frame < mDrawnFaces.count());
+
+        const QRect drawn = mDrawnFaces.at(frame);
+        const QPoint centre(data["x"].toInt(), data["y"].toInt());
+        QVERIFY2(drawn.contains(centre), qPrintable(QString("frame %1: (%2, %3) is off the face")
+                 .arg(frame).arg(centre.x()).arg(centre.y())));
+
+        const int radius = data["z"].toInt();
+        QVERIFY(radius > drawn.width() / 4 && radius < drawn.height());
+
+        QVERIFY(centre.x() >= lastX - 4);
+        lastX = centre.x();
+    }
+}
+
+QTEST_MAIN(TestWebCamWorker)
@@ -0,0 +1,51 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+#include <QtTest/QtTest>
+
+/*
+ * Replays fixtures/moving-face, a face drawn 8 px further right on every
+ * frame, through WebCamWorker and checks the frames and face positions
+ * it reports against fixtures/moving-face/faces.txt.
+ */
+class TestWebCamWorker: public QObject
+{
+    Q_OBJECT
+
+public slots:
+    void onFrameGrabbed(int frame);
+    void onFaceMoved(const QVariantMap &data);
+    void onReplayFinished();
+
+private slots:
+    void init();
+
+    void missingReplay();
+    void replayFrames();
+    void replayFace();
+
+private:
+    bool replay(QObject *worker, const QString &path);
+    void loadFaces();
+
+    QList<int> mFrames;
+    /* the frame each reported face belongs to, and the report */
+    QList<QPair<int, QVariantMap> > mFaces;
+    QList<QRect> mDrawnFaces;
+    bool mFinished;
+};
@@ -24,8 +24,6 @@
 #include <backdropinterface.h>
 #include <abstractplugininterface.h>
 #include <datainterface.h>
-#include <cv.h>
-#include <highgui.h>
 
 class VISIBLE_SYM WebCamData : public PlexyDesk::DataPlugin
 {
@@ -38,15 +36,15 @@ public:
     QVariantMap readAll();
 
 public Q_SLOTS:
+    /* a path, or a map with "replay", "fps" and "detect_interval", replays
+       a video file or an image directory instead of the camera */
     void pushData(QVariant &data);
 
 private Q_SLOTS:
-    void grab();
-private:
-    QRect detectFace(const char *faceData);
-    void trackFace();
-    void updateHugeImage(const IplImage *);
+    void onFaceMoved(const QVariantMap &data);
+    void onFaceLost();
 
+private:
     class Private;
     Private *const d;
 };
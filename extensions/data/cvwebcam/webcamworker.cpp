@@ -0,0 +1,339 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+#include "webcamworker.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QTimer>
+
+/* the detector runs on frames this many times smaller */
+static const int DetectScale = 2;
+/* capture interval while no face is tracked */
+static const int IdleInterval = 200;
+/* CamShift results smaller than this are taken as a lost face */
+static const int MinTrackSize = 8;
+
+WebCamWorker::WebCamWorker(QObject *parent) : QObject(parent),
+    mTimer(new QTimer(this)),
+    mCapture(0),
+    mReplayIndex(0),
+    mReplayFrame(0),
+    mReplay(false),
+    mFrameCount(0),
+    mCascade(0),
+    mStorage(cvCreateMemStorage(0)),
+    mHistogram(0),
+    mFrameSize(cvSize(0, 0)),
+    mGray(0),
+    mSmall(0),
+    mHsv(0),
+    mHue(0),
+    mMask(0),
+    mProb(0),
+    mTracking(false),
+    mFramesSinceDetect(0),
+    mDetectInterval(15),
+    mFrameInterval(1000 / 30)
+{
+    int bins = 30;
+    float range[] = { 0, 180 };
+    float *ranges = range;
+    mHistogram = cvCreateHist(1, &bins, CV_HIST_ARRAY, &ranges, 1);
+
+    mTimer->setSingleShot(true);
+    connect(mTimer, SIGNAL(timeout()), this, SLOT(grab()));
+}
+
+WebCamWorker::~WebCamWorker()
+{
+    // the owner stops us on our own thread first, the timer is idle here
+    releaseCapture();
+    releaseBuffers();
+    cvReleaseHist(&mHistogram);
+    cvReleaseMemStorage(&mStorage);
+    if (mCascade)
+        cvReleaseHaarClassifierCascade(&mCascade);
+}
+
+void WebCamWorker::setCascade(const QString &path)
+{
+    if (mCascade)
+        cvReleaseHaarClassifierCascade(&mCascade);
+    mCascade = (CvHaarClassifierCascade *)cvLoad(QFile::encodeName(path).constData());
+    if (!mCascade)
+        qDebug() << Q_FUNC_INFO << ": " << "Error incorrect Haar classifier cascade" << path;
+}
+
+void WebCamWorker::setDetectInterval(int interval)
+{
+    mDetectInterval = qMax(1, interval);
+}
+
+void WebCamWorker::setFrameRate(int fps)
+{
+    mFrameInterval = 1000 / qMax(1, fps);
+}
+
+void WebCamWorker::startCamera()
+{
+    stop();
+    mCapture = cvCaptureFromCAM(-1);
+    if (!mCapture) {
+        qDebug() << Q_FUNC_INFO << ":" << "Capture from webcame failed";
+        return;
+    }
+    mTimer->start(0);
+}
+
+void WebCamWorker::startReplay(const QString &path)
+{
+    stop();
+    mReplay = true;
+
+    QFileInfo info(path);
+    if (info.isDir()) {
+        QDir dir(path);
+        const QStringList filters = QStringList() << "*.png" << "*.jpg" << "*.jpeg" << "*.bmp" << "*.pgm" << "*.ppm";
+        Q_FOREACH(const QString &file, dir.entryList(filters, QDir::Files, QDir::Name))
+            mReplayFiles << dir.absoluteFilePath(file);
+    } else {
+        mCapture = cvCaptureFromFile(QFile::encodeName(path).constData());
+    }
+
+    if (!mCapture && mReplayFiles.isEmpty()) {
+        qDebug() << Q_FUNC_INFO << ":" << "Nothing to replay in" << path;
+        mReplay = false;
+        Q_EMIT replayFinished();
+        return;
+    }
+    mTimer->start(0);
+}
+
+void WebCamWorker::stop()
+{
+    mTimer->stop();
+    releaseCapture();
+    mReplay = false;
+    mTracking = false;
+    mFrameCount = 0;
+}
+
+void WebCamWorker::releaseCapture()
+{
+    if (mCapture)
+        cvReleaseCapture(&mCapture);
+    if (mReplayFrame)
+        cvReleaseImage(&mReplayFrame);
+    mReplayFiles.clear();
+    mReplayIndex = 0;
+}
+
+IplImage *WebCamWorker::nextFrame()
+{
+    if (mCapture)
+        return cvQueryFrame(mCapture);
+
+    if (mReplayIndex >= mReplayFiles.count())
+        return 0;
+
+    if (mReplayFrame)
+        cvReleaseImage(&mReplayFrame);
+    mReplayFrame = cvLoadImage(QFile::encodeName(mReplayFiles.at(mReplayIndex++)).constData(),
+         CV_LOAD_IMAGE_COLOR);
+    return mReplayFrame;
+}
+
+void WebCamWorker::grab()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    IplImage *frame = nextFrame();
+    if (!frame) {
+        if (mReplay) {
+            stop();
+            Q_EMIT replayFinished();
+        } else {
+            mTimer->start(IdleInterval);
+        }
+        return;
+    }
+
+    Q_EMIT frameGrabbed(mFrameCount++);
+    ensureBuffers(frame);
+
+    const bool wasTracking = mTracking;
+    if (!mTracking || ++mFramesSinceDetect >= mDetectInterval) {
+        // a failed re-detection keeps the track, CamShift decides when it is lost
+        if (detect(frame) || !mTracking)
+            mFramesSinceDetect = 0;
+    }
+
+    if (mTracking)
+        mTracking = track(frame);
+
+    if (wasTracking && !mTracking)
+        Q_EMIT faceLost();
+
+    // replays run as fast as they decode, the camera slows down while
+    // nobody is in front of it; the time this frame took counts against
+    // the interval, a frame over budget grabs the next one right away
+    int interval = 0;
+    if (!mReplay)
+        interval = mTracking ? mFrameInterval : IdleInterval;
+    mTimer->start(qMax(0, interval - int(timer.elapsed())));
+}
+
+void WebCamWorker::ensureBuffers(const IplImage *frame)
+{
+    const CvSize size = cvGetSize(frame);
+    if (size.width == mFrameSize.width && size.height == mFrameSize.height)
+        return;
+
+    releaseBuffers();
+    mFrameSize = size;
+    mGray = cvCreateImage(size, 8, 1);
+    mSmall = cvCreateImage(cvSize(size.width / DetectScale, size.height / DetectScale), 8, 1);
+    mHsv = cvCreateImage(size, 8, 3);
+    mHue = cvCreateImage(size, 8, 1);
+    mMask = cvCreateImage(size, 8, 1);
+    mProb = cvCreateImage(size, 8, 1);
+    mTracking = false;
+}
+
+void WebCamWorker::releaseBuffers()
+{
+    IplImage **images[] = { &mGray, &mSmall, &mHsv, &mHue, &mMask, &mProb };
+    for (unsigned int i = 0; i < sizeof(images) / sizeof(images[0]); i++) {
+        if (*images[i])
+            cvReleaseImage(images[i]);
+    }
+    mFrameSize = cvSize(0, 0);
+}
+
+void WebCamWorker::updateHueImage(const IplImage *frame)
+{
+    cvCvtColor(frame, mHsv, CV_BGR2HSV);
+    cvInRangeS(mHsv, cvScalar(0, 55, MIN(65, 256), 0),
+     cvScalar(180, 256, MAX(65, 255), 0), mMask);
+    cvSplit(mHsv, mHue, 0, 0, 0);
+}
+
+bool WebCamWorker::detect(IplImage *frame)
+{
+    if (!mCascade)
+        return false;
+
+    cvCvtColor(frame, mGray, CV_BGR2GRAY);
+    cvResize(mGray, mSmall, CV_INTER_LINEAR);
+    cvEqualizeHist(mSmall, mSmall);
+
+    cvClearMemStorage(mStorage);
+    const int faceSize = mSmall->width / 5;
+    CvSeq *faces = cvHaarDetectObjects(mSmall, mCascade, mStorage, 1.1, 6,
+         CV_HAAR_DO_CANNY_PRUNING | CV_HAAR_FIND_BIGGEST_OBJECT,
+         cvSize(faceSize, faceSize));
+    if (!faces || !faces->total)
+        return false;
+
+    const CvRect *rect = (CvRect *)cvGetSeqElem(faces, 0);
+    mFace = cvRect(rect->x * DetectScale, rect->y * DetectScale,
+         rect->width * DetectScale, rect->height * DetectScale);
+
+    // rebuild the hue model of the face, CamShift follows it from here
+    float max = 0.f;
+    updateHueImage(frame);
+    cvSetImageROI(mHue, mFace);
+    cvSetImageROI(mMask, mFace);
+    cvCalcHist(&mHue, mHistogram, 0, mMask);
+    cvGetMinMaxHistValue(mHistogram, 0, &max, 0, 0);
+    cvConvertScale(mHistogram->bins, mHistogram->bins, max ? 255.0 / max : 0, 0);
+    cvResetImageROI(mHue);
+    cvResetImageROI(mMask);
+
+    mTracking = true;
+    return true;
+}
+
+CvRect WebCamWorker::searchWindow() const
+{
+    // the face moves little between frames, look at most half its size away
+    const int x = qMax(0, mFace.x - mFace.width / 2);
+    const int y = qMax(0, mFace.y - mFace.height / 2);
+    const int right = qMin(mFrameSize.width, mFace.x + mFace.width + mFace.width / 2);
+    const int bottom = qMin(mFrameSize.height, mFace.y + mFace.height + mFace.height / 2);
+    return cvRect(x, y, qMax(0, right - x), qMax(0, bottom - y));
+}
+
+void WebCamWorker::setRoi(const CvRect &rect)
+{
+    cvSetImageROI(mHsv, rect);
+    cvSetImageROI(mHue, rect);
+    cvSetImageROI(mMask, rect);
+    cvSetImageROI(mProb, rect);
+}
+
+void WebCamWorker::resetRoi()
+{
+    cvResetImageROI(mHsv);
+    cvResetImageROI(mHue);
+    cvResetImageROI(mMask);
+    cvResetImageROI(mProb);
+}
+
+bool WebCamWorker::track(IplImage *frame)
+{
+    const CvRect window = searchWindow();
+    if (window.width < MinTrackSize || window.height < MinTrackSize)
+        return false;
+
+    // only the pixels around the last position are converted and searched
+    cvSetImageROI(frame, window);
+    setRoi(window);
+    updateHueImage(frame);
+    cvCalcBackProject(&mHue, mProb, mHistogram);
+    cvAnd(mProb, mMask, mProb, 0);
+
+    CvConnectedComp comps;
+    CvBox2D box;
+    const CvRect local = cvRect(mFace.x - window.x, mFace.y - window.y, mFace.width, mFace.height);
+    cvCamShift(mProb, local,
+     cvTermCriteria(CV_TERMCRIT_EPS | CV_TERMCRIT_ITER, 10, 1),
+     &comps, &box);
+
+    resetRoi();
+    cvResetImageROI(frame);
+
+    if (comps.rect.width < MinTrackSize || comps.rect.height < MinTrackSize)
+        return false;
+
+    mFace = cvRect(comps.rect.x + window.x, comps.rect.y + window.y, comps.rect.width, comps.rect.height);
+
+    const int radius = cvRound((mFace.width + mFace.height) * 0.25);
+    QVariantMap data;
+    data["z"] = QVariant(radius);
+    data["x"] = QVariant(cvRound(mFace.x + mFace.width * 0.5));
+    data["y"] = QVariant(cvRound(mFace.y + mFace.height * 0.5));
+    data["angle"] = QVariant(box.angle);
+    Q_EMIT faceMoved(data);
+    return true;
+}
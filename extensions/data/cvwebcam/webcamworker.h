@@ -0,0 +1,102 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+#ifndef WEBCAM_WORKER_H
+#define WEBCAM_WORKER_H
+
+#include <QObject>
+#include <QStringList>
+#include <QVariantMap>
+
+#include <cv.h>
+#include <highgui.h>
+
+class QTimer;
+
+/* Grabs frames and follows a face on a thread of its own. A Haar cascade
+   looks for the face on a downscaled gray frame every few frames, CamShift
+   follows it inside a window around the last position in between. All
+   images and the detector storage are allocated once per frame size. */
+class WebCamWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    WebCamWorker(QObject *parent = 0);
+    virtual ~WebCamWorker();
+
+public Q_SLOTS:
+    void setCascade(const QString &path);
+    /* run the full detector every interval frames while a face is tracked */
+    void setDetectInterval(int interval);
+    void setFrameRate(int fps);
+
+    void startCamera();
+    /* reads a video file, or every image of a directory in name order */
+    void startReplay(const QString &path);
+    void stop();
+
+Q_SIGNALS:
+    /* before the frame is searched, a faceMoved() that follows belongs to it */
+    void frameGrabbed(int frame);
+    void faceMoved(const QVariantMap &data);
+    void faceLost();
+    void replayFinished();
+
+private Q_SLOTS:
+    void grab();
+
+private:
+    IplImage *nextFrame();
+    void releaseCapture();
+    void ensureBuffers(const IplImage *frame);
+    void releaseBuffers();
+    void updateHueImage(const IplImage *frame);
+    bool detect(IplImage *frame);
+    bool track(IplImage *frame);
+    CvRect searchWindow() const;
+    void setRoi(const CvRect &rect);
+    void resetRoi();
+
+    QTimer *mTimer;
+    CvCapture *mCapture;
+    QStringList mReplayFiles;
+    int mReplayIndex;
+    IplImage *mReplayFrame;
+    bool mReplay;
+    int mFrameCount;
+
+    CvHaarClassifierCascade *mCascade;
+    CvMemStorage *mStorage;
+    CvHistogram *mHistogram;
+    CvSize mFrameSize;
+    IplImage *mGray;
+    IplImage *mSmall;
+    IplImage *mHsv;
+    IplImage *mHue;
+    IplImage *mMask;
+    IplImage *mProb;
+
+    CvRect mFace;
+    bool mTracking;
+    int mFramesSinceDetect;
+    int mDetectInterval;
+    int mFrameInterval;
+};
+
+#endif
@@ -0,0 +1,143 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+#include "ircbacklog.h"
+
+IrcBacklog::IrcBacklog(int linesPerChannel, int maxBytes) :
+    mLinesPerChannel(qMax(1, linesPerChannel)),
+    mMaxBytes(maxBytes),
+    mBytes(0)
+{
+}
+
+void IrcBacklog::setLimits(int linesPerChannel, int maxBytes)
+{
+    linesPerChannel = qMax(1, linesPerChannel);
+
+    if (linesPerChannel != mLinesPerChannel) {
+        QHash<QString, Ring>::iterator it = mChannels.begin();
+        for (; it != mChannels.end(); ++it) {
+            Ring &ring = it.value();
+            while (ring.count > linesPerChannel)
+                dropOldest(ring);
+
+            /* re-pack the surviving messages into a ring of the new size */
+            QVector<Message> entries(linesPerChannel);
+            for (int i = 0; i < ring.count; i++)
+                entries[i] = ring.entries[(ring.head + i) % ring.entries.size()];
+            ring.entries = entries;
+            ring.head = 0;
+        }
+    }
+
+    mLinesPerChannel = linesPerChannel;
+    mMaxBytes = maxBytes;
+    shrinkToBudget();
+}
+
+void IrcBacklog::append(const QString &channel, const Message &message)
+{
+    Ring &ring = mChannels[channel];
+    if (ring.entries.isEmpty())
+        ring.entries.resize(mLinesPerChannel);
+
+    if (ring.count == ring.entries.size())
+        dropOldest(ring);
+
+    const int size = messageBytes(message);
+    ring.entries[(ring.head + ring.count) % ring.entries.size()] = message;
+    ring.count++;
+    ring.bytes += size;
+    mBytes += size;
+
+    shrinkToBudget();
+}
+
+QList<IrcBacklog::Message> IrcBacklog::messages(const QString &channel) const
+{
+    QList<Message> rv;
+    QHash<QString, Ring>::const_iterator it = mChannels.constFind(channel);
+    if (it == mChannels.constEnd())
+        return rv;
+
+    const Ring &ring = it.value();
+    rv.reserve(ring.count);
+    for (int i = 0; i < ring.count; i++)
+        rv.append(ring.entries.at((ring.head + i) % ring.entries.size()));
+
+    return rv;
+}
+
+QStringList IrcBacklog::channels() const
+{
+    return mChannels.keys();
+}
+
+void IrcBacklog::removeChannel(const QString &channel)
+{
+    mBytes -= mChannels.value(channel).bytes;
+    mChannels.remove(channel);
+}
+
+int IrcBacklog::count(const QString &channel) const
+{
+    return mChannels.value(channel).count;
+}
+
+int IrcBacklog::byteSize() const
+{
+    return mBytes;
+}
+
+int IrcBacklog::messageBytes(const Message &message)
+{
+    return int(sizeof(Message)) + (message.nick.size() + message.text.size()) * int(sizeof(QChar));
+}
+
+void IrcBacklog::dropOldest(Ring &ring)
+{
+    if (ring.count == 0)
+        return;
+
+    Message &oldest = ring.entries[ring.head];
+    const int size = messageBytes(oldest);
+    ring.bytes -= size;
+    mBytes -= size;
+    /* release the strings now instead of when the slot is reused */
+    oldest = Message();
+
+    ring.head = (ring.head + 1) % ring.entries.size();
+    ring.count--;
+}
+
+void IrcBacklog::shrinkToBudget()
+{
+    while (mMaxBytes > 0 && mBytes > mMaxBytes) {
+        Ring *largest = 0;
+        QHash<QString, Ring>::iterator it = mChannels.begin();
+        for (; it != mChannels.end(); ++it) {
+            if (!largest || it.value().bytes > largest->bytes)
+                largest = &it.value();
+        }
+
+        if (!largest || largest->count == 0)
+            break;
+
+        dropOldest(*largest);
+    }
+}
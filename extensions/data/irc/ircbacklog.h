@@ -0,0 +1,83 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+#ifndef IRC_BACKLOG_H
+#define IRC_BACKLOG_H
+
+#include <QDateTime>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/*!
+   \class IrcBacklog
+
+   \brief Per channel message history with a bounded memory footprint
+
+   Every channel keeps its messages in a fixed size ring so appending never
+   reallocates once the ring is full. On top of the per channel line limit
+   the whole store is capped in bytes, when that cap is hit the oldest
+   message of the largest channel is dropped first.
+ **/
+class IrcBacklog
+{
+public:
+    struct Message {
+        QDateTime time;
+        QString nick;
+        QString text;
+    };
+
+    explicit IrcBacklog(int linesPerChannel = 500, int maxBytes = 4 * 1024 * 1024);
+
+    void setLimits(int linesPerChannel, int maxBytes);
+
+    void append(const QString &channel, const Message &message);
+
+    /* oldest first */
+    QList<Message> messages(const QString &channel) const;
+
+    QStringList channels() const;
+
+    void removeChannel(const QString &channel);
+
+    int count(const QString &channel) const;
+
+    int byteSize() const;
+
+private:
+    struct Ring {
+        Ring() : head(0), count(0), bytes(0) {}
+        QVector<Message> entries;
+        int head;
+        int count;
+        int bytes;
+    };
+
+    static int messageBytes(const Message &message);
+    void dropOldest(Ring &ring);
+    void shrinkToBudget();
+
+    QHash<QString, Ring> mChannels;
+    int mLinesPerChannel;
+    int mMaxBytes;
+    int mBytes;
+};
+
+#endif
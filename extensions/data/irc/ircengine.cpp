@@ -17,12 +17,54 @@
 *  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
 *******************************************************************************/
 #include "ircengine.h"
-#include <desktopwidget.h>
-#include <plexyconfig.h>
+#include "ircbacklog.h"
 
+static QVariantMap messageToMap(const IrcBacklog::Message &message)
+{
+    QVariantMap rv;
+    rv["time"] = message.time;
+    rv["nick"] = message.nick;
+    rv["text"] = message.text;
+    return rv;
+}
 
-IRCData::IRCData(QObject *object)
+static QStringList toStringList(const QVariant &value)
 {
+    if (value.type() == QVariant::StringList || value.type() == QVariant::List)
+        return value.toStringList();
+    return QStringList() << value.toString();
+}
+
+class IRCData::Private
+{
+public:
+    Private() {
+    }
+    ~Private() {
+    }
+
+    IrcData *mIrc;
+    IrcBacklog mBacklog;
+    QTimer mUpdateTimer;
+    /* messages received since the last sourceUpdated(), per channel */
+    QHash<QString, QVariantList> mPending;
+    QStringList mChannels;
+    int mMaxPending;
+};
+
+IRCData::IRCData(QObject *object) : PlexyDesk::DataSource(object), d(new Private)
+{
+    d->mIrc = new IrcData(this);
+    d->mMaxPending = 500;
+
+    d->mUpdateTimer.setSingleShot(true);
+    d->mUpdateTimer.setInterval(250);
+
+    connect(&d->mUpdateTimer, SIGNAL(timeout()), this, SLOT(flushUpdates()));
+    connect(d->mIrc, SIGNAL(connectResponse(ConnectResponseType, QString)),
+            this, SLOT(onConnectResponse(ConnectResponseType, QString)));
+    connect(d->mIrc, SIGNAL(messageReceived(QString, QString, QString)),
+            this, SLOT(onMessageReceived(QString, QString, QString)));
 }
 
 void IRCData::init()
@@ -31,12 +73,123 @@ void IRCData::init()
 
 IRCData::~IRCData()
 {
+    delete d;
+}
+
+void IRCData::setArguments(QVariant args)
+{
+    QVariantMap arg = args.toMap();
+
+    if (arg.contains("update_interval"))
+        d->mUpdateTimer.setInterval(qMax(0, arg["update_interval"].toInt()));
+
+    if (arg.contains("backlog_lines") || arg.contains("backlog_bytes")) {
+        const int lines = arg.value("backlog_lines", 500).toInt();
+        d->mBacklog.setLimits(lines, arg.value("backlog_bytes", 4 * 1024 * 1024).toInt());
+        d->mMaxPending = lines;
+    }
+
+    if (arg.contains("server")) {
+        const QString nick = arg.value("nick", "plexydesk").toString();
+        d->mIrc->setServer(arg["server"].toString(), arg.value("port", 6667).toInt());
+        d->mIrc->connectToServer();
+        d->mIrc->setNick(nick);
+        d->mIrc->setUser(arg.value("user", nick).toString(), 0, "*",
+                arg.value("realname", nick).toString());
+        /* rejoin what we had when switching servers */
+        Q_FOREACH(const QString &channel, d->mChannels)
+            d->mIrc->joinChannel(channel);
+    }
+
+    if (arg.contains("join")) {
+        Q_FOREACH(const QString &channel, toStringList(arg["join"])) {
+            if (channel.isEmpty() || d->mChannels.contains(channel))
+                continue;
+            d->mChannels.append(channel);
+            d->mIrc->joinChannel(channel);
+        }
+    }
+
+    if (arg.contains("part")) {
+        Q_FOREACH(const QString &channel, toStringList(arg["part"])) {
+            d->mChannels.removeAll(channel);
+            d->mBacklog.removeChannel(channel);
+            d->mPending.remove(channel);
+            d->mIrc->partChannel(channel);
+        }
+    }
+
+    if (arg.contains("message") && arg.contains("target")) {
+        const QString target = arg["target"].toString();
+        const QString text = arg["message"].toString();
+        d->mIrc->sendMessage(target, text);
+        /* servers do not echo our own messages back */
+        Q_FOREACH(const QString &line, text.split('\n', QString::SkipEmptyParts))
+            onMessageReceived(target, d->mIrc->nick(), line);
+    }
+}
+
+QVariantMap IRCData::readAll()
+{
+    QVariantMap dataMap;
+    QVariantMap channels;
+
+    Q_FOREACH(const QString &channel, d->mBacklog.channels()) {
+        QVariantList list;
+        Q_FOREACH(const IrcBacklog::Message &message, d->mBacklog.messages(channel))
+            list.append(messageToMap(message));
+        channels[channel] = list;
+    }
+
+    dataMap["channels"] = channels;
+    dataMap["connected"] = d->mIrc->isConnected();
+    dataMap["pending_lines"] = d->mIrc->pendingLines();
+
+    return dataMap;
 }
 
-void IRCData::pushData(QVariant &str)
+void IRCData::onConnectResponse(ConnectResponseType response, QString error)
 {
+    QVariantMap dataMap;
+    dataMap["connected"] = (response == ConnectOK);
+    if (response != ConnectOK)
+        dataMap["error"] = error;
+
+    Q_EMIT sourceUpdated(dataMap);
 }
 
-void IRCData::loadCallback(int id, bool stat)
+void IRCData::onMessageReceived(const QString &target, const QString &nick, const QString &text)
 {
+    /* private messages are filed under the sender */
+    const QString channel = (target == d->mIrc->nick()) ? nick : target;
+
+    IrcBacklog::Message message;
+    message.time = QDateTime::currentDateTime();
+    message.nick = nick;
+    message.text = text;
+    d->mBacklog.append(channel, message);
+
+    QVariantList &pending = d->mPending[channel];
+    if (pending.count() >= d->mMaxPending)
+        pending.removeFirst();
+    pending.append(messageToMap(message));
+
+    if (!d->mUpdateTimer.isActive())
+        d->mUpdateTimer.start();
+}
+
+void IRCData::flushUpdates()
+{
+    if (d->mPending.isEmpty())
+        return;
+
+    QVariantMap updates;
+    QHash<QString, QVariantList>::const_iterator it = d->mPending.constBegin();
+    for (; it != d->mPending.constEnd(); ++it)
+        updates[it.key()] = it.value();
+    d->mPending.clear();
+
+    QVariantMap dataMap;
+    dataMap["updates"] = updates;
+    Q_EMIT sourceUpdated(dataMap);
 }
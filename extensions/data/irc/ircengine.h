@@ -19,12 +19,28 @@
 #ifndef IRC_DATA_H
 #define IRC_DATA_H
 
+#include <QtCore>
 #include <plexy.h>
-#include <backdropinterface.h>
-#include <abstractplugininterface.h>
-#include <datainterface.h>
+#include <datasource.h>
+#include <irc.h>
 
-class VISIBLE_SYM IRCData : public PlexyDesk::DataPlugin
+/*!
+   \class IRCData
+
+   \brief IRC data source
+
+   Arguments are passed as a QVariantMap to setArguments():
+   "server", "port", "nick", "user" and "realname" connect to a server,
+   "join" and "part" take a channel name or a list of them and "target"
+   with "message" sends a message. "update_interval" (msec), "backlog_lines"
+   and "backlog_bytes" tune the update rate and the history kept per channel.
+
+   Incoming messages are not forwarded one by one, they are collected and
+   delivered together through sourceUpdated() at most once every
+   update_interval, under the "updates" key as a map of channel to the list
+   of new messages. readAll() returns the full backlog of every channel.
+ **/
+class IRCData : public PlexyDesk::DataSource
 {
     Q_OBJECT
 
@@ -32,14 +48,19 @@ public:
     IRCData(QObject *object = 0);
     virtual ~IRCData();
     void init();
-public slots:
-    /* ID tells you the Qhttp id which youare pocessing
-     */
-    void pushData(QVariant &);
-    void loadCallback(int ID, bool status);
-signals:
-    void data(QVariant &);
-};
+    QVariantMap readAll();
 
+public Q_SLOTS:
+    void setArguments(QVariant args);
+
+private Q_SLOTS:
+    void onConnectResponse(ConnectResponseType response, QString error);
+    void onMessageReceived(const QString &target, const QString &nick, const QString &text);
+    void flushUpdates();
+
+private:
+    class Private;
+    Private *const d;
+};
 
 #endif
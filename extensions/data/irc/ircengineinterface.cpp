@@ -18,22 +18,13 @@
 *******************************************************************************/
 #include "ircengine.h"
 #include "ircengineinterface.h"
-#include <desktopwidget.h>
-#include <plexyconfig.h>
 
-#include <QtPlugin>
-
-IRCInterface::IRCInterface(QObject *object)
+QSharedPointer<PlexyDesk::DataSource> IRCInterface::model()
 {
-}
+    QSharedPointer<PlexyDesk::DataSource> obj =
+            QSharedPointer<PlexyDesk::DataSource>(new IRCData(), &QObject::deleteLater);
 
-PlexyDesk::DataPlugin *IRCInterface::instance()
-{
-    /* this is the plugin we are returning since plexy core
-       or other plugins will expect this pointer
-     */
-    return new IRCData();
+    return obj;
 }
 
-Q_EXPORT_PLUGIN2(IRCInterface, IRCInterface)
-
+Q_EXPORT_PLUGIN2(ircengine, IRCInterface)
@@ -21,26 +21,19 @@
 
 #include <QtCore>
 #include <plexy.h>
-#include <backdropinterface.h>
-#include <abstractplugininterface.h>
-#include <QtNetwork>
-#include <datainterface.h>
-#include <dataplugin.h>
+#include <dataplugininterface.h>
 
-class IRCInterface : public PlexyDesk::DataInterface
+class IRCInterface : public QObject, public PlexyDesk::DataPluginInterface
 {
     Q_OBJECT
-    Q_INTERFACES(PlexyDesk::AbstractPluginInterface)
+    Q_INTERFACES(PlexyDesk::DataPluginInterface)
 
 public :
-        IRCInterface(QObject *object = 0);
-    virtual ~IRCInterface() {
-    }
+    virtual ~IRCInterface() {}
 
     /* this will return a valid data plugin pointer*/
-    PlexyDesk::DataPlugin *instance();
+    QSharedPointer<PlexyDesk::DataSource> model();
 
 };
 
-
 #endif
@@ -0,0 +1,192 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+
+#include "testircengine.h"
+#include <irc.h>
+#include <ircbacklog.h>
+#include <ircengine.h>
+
+LoopbackIrcServer::LoopbackIrcServer(QObject *parent) :
+    QTcpServer(parent), mClient(0)
+{
+    connect(this, SIGNAL(newConnection()), this, SLOT(onNewConnection()));
+    listen(QHostAddress::LocalHost);
+    clock.start();
+}
+
+void LoopbackIrcServer::sendLine(const QByteArray &line)
+{
+    sendRaw(line + "\r\n");
+}
+
+void LoopbackIrcServer::sendRaw(const QByteArray &data)
+{
+    QVERIFY(mClient);
+    mClient->write(data);
+    mClient->flush();
+}
+
+void LoopbackIrcServer::onNewConnection()
+{
+    mClient = nextPendingConnection();
+    connect(mClient, SIGNAL(readyRead()), this, SLOT(onReadyRead()));
+}
+
+void LoopbackIrcServer::onReadyRead()
+{
+    mBuffer += mClient->readAll();
+    int end;
+    while ((end = mBuffer.indexOf("\r\n")) != -1) {
+        lines.append(mBuffer.left(end));
+        arrivals.append(clock.elapsed());
+        mBuffer.remove(0, end + 2);
+    }
+}
+
+static bool waitFor(const QList<QByteArray> &list, int count, int timeout = 5000)
+{
+    QElapsedTimer timer;
+    timer.start();
+    while (list.count() < count && timer.elapsed() < timeout)
+        QTest::qWait(10);
+    return list.count() >= count;
+}
+
+void TestIrcEngine::backlogIsBounded()
+{
+    IrcBacklog backlog(10, 0);
+    for (int i = 0; i < 25; i++) {
+        IrcBacklog::Message message;
+        message.nick = "nick";
+        message.text = QString::number(i);
+        backlog.append("#plexydesk", message);
+    }
+
+    QList<IrcBacklog::Message> messages = backlog.messages("#plexydesk");
+    QCOMPARE(messages.count(), 10);
+    QCOMPARE(messages.first().text, QString("15"));
+    QCOMPARE(messages.last().text, QString("24"));
+
+    backlog.setLimits(4, 0);
+    messages = backlog.messages("#plexydesk");
+    QCOMPARE(messages.count(), 4);
+    QCOMPARE(messages.first().text, QString("21"));
+
+    backlog.removeChannel("#plexydesk");
+    QCOMPARE(backlog.byteSize(), 0);
+}
+
+void TestIrcEngine::backlogByteBudget()
+{
+    IrcBacklog backlog(1000, 64 * 1024);
+    const QString text(200, QChar('x'));
+
+    for (int i = 0; i < 2000; i++) {
+        IrcBacklog::Message message;
+        message.nick = "nick";
+        message.text = text;
+        backlog.append(i % 3 ? "#busy" : "#quiet", message);
+    }
+
+    QVERIFY(backlog.byteSize() <= 64 * 1024);
+    QVERIFY(backlog.count("#quiet") > 0);
+    QVERIFY(backlog.count("#busy") > 0);
+}
+
+void TestIrcEngine::floodControl()
+{
+    LoopbackIrcServer server;
+    IrcData irc;
+    irc.setServer("127.0.0.1", server.serverPort());
+    irc.setFloodControl(100, 500);
+    irc.connectToServer();
+
+    for (int i = 0; i < 20; i++)
+        irc.sendMessage("#plexydesk", QString("line %1").arg(i));
+
+    /* the first five fit in the window and go out as one burst */
+    QVERIFY(waitFor(server.lines, 5));
+    QTest::qWait(30);
+    QCOMPARE(server.lines.count(), 5);
+    QCOMPARE(irc.pendingLines(), 15);
+
+    /* the rest trickle out one per penalty period */
+    QVERIFY(waitFor(server.lines, 20));
+    QCOMPARE(server.lines.last(), QByteArray("PRIVMSG #plexydesk :line 19"));
+    QVERIFY(server.arrivals.last() - server.arrivals.first() >= 15 * 100 - 50);
+}
+
+void TestIrcEngine::pingIsAnsweredFirst()
+{
+    LoopbackIrcServer server;
+    IrcData irc;
+    irc.setServer("127.0.0.1", server.serverPort());
+    irc.setFloodControl(2000, 2000);
+    irc.connectToServer();
+
+    irc.sendMessage("#plexydesk", "first");
+    irc.sendMessage("#plexydesk", "second");
+    QVERIFY(waitFor(server.lines, 1));
+
+    /* the pong does not wait for the flood timer, "second" still does */
+    server.sendLine("PING :loopback");
+    QVERIFY(waitFor(server.lines, 2, 1000));
+    QCOMPARE(server.lines.at(1), QByteArray("PONG :loopback"));
+    QCOMPARE(irc.pendingLines(), 1);
+
+    QVERIFY(waitFor(server.lines, 3));
+    QCOMPARE(server.lines.at(2), QByteArray("PRIVMSG #plexydesk :second"));
+}
+
+void TestIrcEngine::batchedUpdates()
+{
+    LoopbackIrcServer server;
+    IRCData engine;
+    QSignalSpy spy(&engine, SIGNAL(sourceUpdated(QVariantMap)));
+
+    QVariantMap args;
+    args["server"] = "127.0.0.1";
+    args["port"] = server.serverPort();
+    args["nick"] = "plexytest";
+    args["join"] = QStringList() << "#a" << "#b" << "#c";
+    args["update_interval"] = 200;
+    engine.setArguments(args);
+
+    /* NICK, USER and three JOINs */
+    QVERIFY(waitFor(server.lines, 5));
+    spy.clear();
+
+    QByteArray burst;
+    for (int i = 0; i < 300; i++)
+        burst += ":someone!u@h PRIVMSG #" + QByteArray(1, 'a' + i % 3) + " :hello "
+            + QByteArray::number(i) + "\r\n";
+    server.sendRaw(burst);
+
+    QTest::qWait(500);
+    QCOMPARE(spy.count(), 1);
+
+    QVariantMap updates = spy.at(0).at(0).toMap()["updates"].toMap();
+    QCOMPARE(updates.count(), 3);
+    QCOMPARE(updates["#a"].toList().count(), 100);
+    QCOMPARE(updates["#c"].toList().last().toMap()["text"].toString(), QString("hello 299"));
+
+    QCOMPARE(engine.readAll()["channels"].toMap()["#b"].toList().count(), 100);
+}
+
+QTEST_MAIN(TestIrcEngine)
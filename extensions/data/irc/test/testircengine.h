@@ -0,0 +1,57 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+
+#include <QtTest/QtTest>
+#include <QtNetwork>
+
+/* minimal IRC server stand-in listening on the loopback interface */
+class LoopbackIrcServer : public QTcpServer
+{
+    Q_OBJECT
+
+public:
+    LoopbackIrcServer(QObject *parent = 0);
+
+    void sendLine(const QByteArray &line);
+    void sendRaw(const QByteArray &data);
+
+    QList<QByteArray> lines;
+    QList<qint64> arrivals;
+    QElapsedTimer clock;
+
+private Q_SLOTS:
+    void onNewConnection();
+    void onReadyRead();
+
+private:
+    QTcpSocket *mClient;
+    QByteArray mBuffer;
+};
+
+class TestIrcEngine: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void backlogIsBounded();
+    void backlogByteBudget();
+    void floodControl();
+    void pingIsAnsweredFirst();
+    void batchedUpdates();
+};
@@ -17,8 +17,12 @@
 *  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
 *******************************************************************************/
 #include "localphotos.h"
+#include <QApplication>
+#include <QDesktopWidget>
 #include <desktopwidget.h>
 #include <plexyconfig.h>
+#include <tickscheduler.h>
+#include "photoindexer.h"
 
 
 LPhotoData::LPhotoData(QObject *object)
@@ -26,79 +30,165 @@ LPhotoData::LPhotoData(QObject *object)
     m_dirpath = QDir::homePath();
     slideCount = 0;
     currentSlide = 0;
-    imageTimer = new QTimer(this);
-    connect(imageTimer, SIGNAL(timeout()), this, SLOT(nextImage()));
+    mTickId = 0;
+    mScanGeneration = 0;
+
+    // probing and decoding never touch the GUI thread
+    mThread = new QThread(this);
+    mIndexer = new PhotoIndexer();
+    mIndexer->moveToThread(mThread);
+    connect(mIndexer, SIGNAL(found(int, QStringList)), this, SLOT(onFound(int, QStringList)));
+    connect(mIndexer, SIGNAL(imageReady(QString, QImage)), this, SLOT(onImageReady(QString, QImage)));
+    mThread->start();
+
+    if (QApplication::desktop())
+        QMetaObject::invokeMethod(mIndexer, "setImageSize", Qt::QueuedConnection,
+             Q_ARG(QSize, QApplication::desktop()->screenGeometry().size()));
+
     init();
 }
 
 void LPhotoData::init()
 {
-    if (imageTimer->isActive())
-        imageTimer->stop();
+    PlexyDesk::TickScheduler::getInstance()->cancel(mTickId);
+    mTickId = 0;
 
     images.clear();
+    slideCount = 0;
+    currentSlide = 0;
+    mReady.clear();
+    mPending.clear();
+    mWaiting.clear();
+
+    // batches of the previous directory may still be queued to us
+    mScanGeneration++;
+    QMetaObject::invokeMethod(mIndexer, "scan", Qt::QueuedConnection,
+         Q_ARG(QString, m_dirpath), Q_ARG(int, mScanGeneration));
+}
 
-    QDir imgdir(m_dirpath);
-    imgdir.setFilter(QDir::Files | QDir::NoSymLinks);
+LPhotoData::~LPhotoData()
+{
+    PlexyDesk::TickScheduler::getInstance()->cancel(mTickId);
+    QMetaObject::invokeMethod(mIndexer, "stop", Qt::BlockingQueuedConnection);
+    mThread->quit();
+    mThread->wait();
+    delete mIndexer;
+}
 
-    QFileInfoList infolist = imgdir.entryInfoList();
+void LPhotoData::onFound(int generation, const QStringList &paths)
+{
+    if (generation != mScanGeneration)
+        return;
 
-    for (int i = 0; i < infolist.count(); i++) {
-        QImage test_img(infolist.at(i).filePath());
-        if (!test_img.isNull()) {
-            images << infolist.at(i).filePath();
-        }
-    }
+    const bool first = images.isEmpty();
+
+    images << paths;
     slideCount = images.count();
 
-    if (slideCount > 0) {
-        if (!imageTimer->isActive())
-            imageTimer->start(3000);
+    if (first) {
+        loadImages();
+        prefetch();
+        mTickId = PlexyDesk::TickScheduler::getInstance()->schedule(this, "nextImage", 3000);
     }
 }
 
-LPhotoData::~LPhotoData()
-{
-}
-
 void LPhotoData::nextImage()
 {
     if (slideCount > 0) {
-        loadImages();
         currentSlide++;
         if (currentSlide > slideCount - 1) {
             currentSlide = 0;
-            //imageTimer->stop();
         }
+        loadImages();
+        prefetch();
     }
 }
 
 void LPhotoData::pushData(QVariant &str)
 {
     qDebug() << "pushData: " << str.toString() << endl;
-    m_dirpath = str.toString();
+
+    if (str.type() == QVariant::Map) {
+        const QVariantMap args = str.toMap();
+        if (args.contains("size"))
+            QMetaObject::invokeMethod(mIndexer, "setImageSize", Qt::QueuedConnection,
+                 Q_ARG(QSize, args["size"].toSize()));
+        if (!args.contains("path"))
+            return;
+        m_dirpath = args["path"].toString();
+    } else {
+        m_dirpath = str.toString();
+    }
+
     init();
 }
 
+void LPhotoData::request(const QString &path)
+{
+    if (mReady.contains(path) || mPending.contains(path))
+        return;
+
+    mPending.insert(path);
+    QMetaObject::invokeMethod(mIndexer, "load", Qt::QueuedConnection, Q_ARG(QString, path));
+}
+
+/* keeps the next few slides decoded ahead of the timer, nothing more */
+void LPhotoData::prefetch()
+{
+    static const int PrefetchAhead = 3;
+
+    if (slideCount <= 0)
+        return;
+
+    QSet<QString> window;
+    for (int i = 0; i <= PrefetchAhead && i < slideCount; i++) {
+        const QString &path = images.at((currentSlide + i) % slideCount);
+        window.insert(path);
+        request(path);
+    }
+
+    QHash<QString, QImage>::iterator it = mReady.begin();
+    while (it != mReady.end()) {
+        if (!window.contains(it.key()))
+            it = mReady.erase(it);
+        else
+            ++it;
+    }
+}
+
 void LPhotoData::loadImages()
 {
-    QFile file(images.at(currentSlide));
+    if (slideCount <= 0)
+        return;
+
+    const QString path = images.at(currentSlide);
 
-    if (!file.open(QIODevice::ReadOnly)) {
-        qDebug() << "Invalid File" << endl;
+    if (!mReady.contains(path)) {
+        // still decoding, shown as soon as it arrives
+        mWaiting = path;
+        request(path);
         return;
     }
 
-    QByteArray img_data = file.readAll();
+    mWaiting.clear();
+    QVariant image = QVariant::fromValue(mReady.value(path));
+    emit data(image);
+}
 
-    QImage test_img(QImage::fromData(img_data));
+void LPhotoData::onImageReady(const QString &path, const QImage &image)
+{
+    mPending.remove(path);
 
-    if (!test_img.isNull()) {
-        QVariant image(img_data);
-        emit data(image);
-    } else {
-        qDebug() << "Invalid Image data" << endl;
+    if (image.isNull()) {
+        if (path == mWaiting)
+            mWaiting.clear();
+        return;
     }
+
+    mReady.insert(path, image);
+
+    if (path == mWaiting)
+        loadImages();
 }
 
 
@@ -25,6 +25,8 @@
 #include <abstractplugininterface.h>
 #include <datainterface.h>
 
+class PhotoIndexer;
+
 class VISIBLE_SYM LPhotoData : public PlexyDesk::DataPlugin
 {
     Q_OBJECT
@@ -36,17 +38,33 @@ public:
 public slots:
     void loadImages();
     void nextImage();
+    /* a directory, or a map with "path" and the display "size" */
     void pushData(QVariant &);
 signals:
+    /* the current slide as a QImage, already scaled to the display size */
     void data(QVariant &);
 
+private slots:
+    void onFound(int generation, const QStringList &paths);
+    void onImageReady(const QString &path, const QImage &image);
+
 private:
+    void request(const QString &path);
+    void prefetch();
+
     QBrush paint;
     QString m_dirpath;
     QStringList images;
     int slideCount;
     int currentSlide;
-    QTimer *imageTimer;
+    int mTickId;
+    int mScanGeneration;
+
+    QThread *mThread;
+    PhotoIndexer *mIndexer;
+    QHash<QString, QImage> mReady;
+    QSet<QString> mPending;
+    QString mWaiting;
 };
 
 
@@ -0,0 +1,126 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+#include "photoindexer.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QImageReader>
+
+/* entries probed per event loop pass, and paths reported per found() */
+static const int ChunkSize = 32;
+static const int BatchSize = 64;
+
+PhotoIndexer::PhotoIndexer(QObject *parent) : QObject(parent),
+    mIterator(0),
+    mGeneration(0),
+    mScanGeneration(0),
+    mCount(0),
+    mSize(1024, 768)
+{
+}
+
+PhotoIndexer::~PhotoIndexer()
+{
+    delete mIterator;
+}
+
+void PhotoIndexer::setImageSize(const QSize &size)
+{
+    if (size.isValid())
+        mSize = size;
+}
+
+void PhotoIndexer::scan(const QString &directory, int generation)
+{
+    stop();
+
+    mScanGeneration = generation;
+    mDirectory = directory;
+    mIterator = new QDirIterator(directory, QDir::Files | QDir::NoSymLinks | QDir::Readable);
+    QMetaObject::invokeMethod(this, "scanChunk", Qt::QueuedConnection, Q_ARG(int, mGeneration));
+}
+
+void PhotoIndexer::stop()
+{
+    delete mIterator;
+    mIterator = 0;
+    // chunks still queued for the old scan find a new generation and bail out
+    mGeneration++;
+    mBatch.clear();
+    mKeep.clear();
+    mCount = 0;
+}
+
+void PhotoIndexer::scanChunk(int generation)
+{
+    if (!mIterator || generation != mGeneration)
+        return;
+
+    for (int i = 0; i < ChunkSize; i++) {
+        if (!mIterator->hasNext()) {
+            flush();
+            // only a complete listing tells which thumbnails went stale
+            mCache.sweep(mDirectory, mKeep);
+            Q_EMIT finished(mScanGeneration, mCount);
+            stop();
+            return;
+        }
+
+        const QString path = mIterator->next();
+
+        // reads the header only, nothing gets decoded here
+        QImageReader reader(path);
+        if (!reader.canRead())
+            continue;
+
+        mKeep.insert(mCache.cacheFile(path, mIterator->fileInfo().lastModified().toTime_t(), mSize));
+        mBatch.append(path);
+        mCount++;
+        if (mBatch.count() >= BatchSize)
+            flush();
+    }
+
+    /* the first photos should not wait for a full batch */
+    if (mCount <= BatchSize)
+        flush();
+
+    QMetaObject::invokeMethod(this, "scanChunk", Qt::QueuedConnection, Q_ARG(int, mGeneration));
+}
+
+void PhotoIndexer::flush()
+{
+    if (mBatch.isEmpty())
+        return;
+
+    Q_EMIT found(mScanGeneration, mBatch);
+    mBatch.clear();
+}
+
+void PhotoIndexer::load(const QString &path)
+{
+    const QImage image = mCache.image(path, mSize);
+    if (image.isNull())
+        qDebug() << Q_FUNC_INFO << "Invalid Image data" << path;
+
+    Q_EMIT imageReady(path, image);
+}
+
+#include "photoindexer.moc"
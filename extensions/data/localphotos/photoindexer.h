@@ -0,0 +1,75 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+#ifndef PHOTO_INDEXER_H
+#define PHOTO_INDEXER_H
+
+#include <QObject>
+#include <QImage>
+#include <QSet>
+#include <QStringList>
+
+#include "thumbnailcache.h"
+
+class QDirIterator;
+
+/* Walks a photo directory and produces display sized images on a thread of
+   its own. The directory is read a few entries per event loop pass and only
+   the image header is probed, so thumbnail requests are served while a
+   large folder is still being indexed. */
+class PhotoIndexer : public QObject
+{
+    Q_OBJECT
+
+public:
+    PhotoIndexer(QObject *parent = 0);
+    virtual ~PhotoIndexer();
+
+public Q_SLOTS:
+    /* drops any running scan, found() starts over for the new directory and
+       carries the caller's generation so batches it queued before are told apart */
+    void scan(const QString &directory, int generation);
+    void stop();
+
+    void setImageSize(const QSize &size);
+    void load(const QString &path);
+
+Q_SIGNALS:
+    void found(int generation, const QStringList &paths);
+    void finished(int generation, int count);
+    void imageReady(const QString &path, const QImage &image);
+
+private Q_SLOTS:
+    void scanChunk(int generation);
+
+private:
+    void flush();
+
+    QDirIterator *mIterator;
+    QString mDirectory;
+    int mGeneration;
+    int mScanGeneration;
+    QStringList mBatch;
+    /* thumbnails this directory still needs, swept once the scan completes */
+    QSet<QString> mKeep;
+    int mCount;
+    QSize mSize;
+    ThumbnailCache mCache;
+};
+
+#endif
@@ -0,0 +1,179 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+#include "thumbnailcache.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDesktopServices>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QImageReader>
+
+/* a few hundred display sized photos */
+static const qint64 DefaultMaxSize = 256 * 1024 * 1024;
+
+static bool lessRecentlyUsed(const QFileInfo &a, const QFileInfo &b)
+{
+    return qMax(a.lastRead(), a.lastModified()) < qMax(b.lastRead(), b.lastModified());
+}
+
+ThumbnailCache::ThumbnailCache(const QString &directory) :
+    mMaxSize(DefaultMaxSize),
+    mSize(-1)
+{
+    setDirectory(directory.isEmpty() ? defaultDirectory() : directory);
+}
+
+QString ThumbnailCache::defaultDirectory()
+{
+    return QDesktopServices::storageLocation(QDesktopServices::CacheLocation)
+         + QLatin1String("/plexydesk/thumbnails");
+}
+
+void ThumbnailCache::setDirectory(const QString &directory)
+{
+    mDirectory = directory;
+    mSize = -1;
+    QDir().mkpath(mDirectory);
+}
+
+QString ThumbnailCache::directory() const
+{
+    return mDirectory;
+}
+
+void ThumbnailCache::setMaxSize(qint64 bytes)
+{
+    mMaxSize = qMax(qint64(0), bytes);
+    trim();
+}
+
+qint64 ThumbnailCache::maxSize() const
+{
+    return mMaxSize;
+}
+
+qint64 ThumbnailCache::size()
+{
+    if (mSize < 0) {
+        mSize = 0;
+        QDirIterator it(mDirectory, QDir::Files, QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            it.next();
+            mSize += it.fileInfo().size();
+        }
+    }
+    return mSize;
+}
+
+QString ThumbnailCache::directoryFor(const QString &photoDirectory) const
+{
+    const QByteArray hash = QCryptographicHash::hash(
+            QDir::cleanPath(photoDirectory).toUtf8(), QCryptographicHash::Sha1);
+    return mDirectory + QLatin1Char('/') + QString::fromLatin1(hash.toHex());
+}
+
+QString ThumbnailCache::cacheFile(const QString &path, qint64 mtime, const QSize &size) const
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(path.toUtf8());
+    hash.addData(QByteArray::number(mtime));
+    hash.addData(QByteArray::number(size.width()) + 'x' + QByteArray::number(size.height()));
+
+    return directoryFor(QFileInfo(path).absolutePath()) + QLatin1Char('/')
+         + QString::fromLatin1(hash.result().toHex());
+}
+
+void ThumbnailCache::sweep(const QString &directory, const QSet<QString> &keep)
+{
+    QDirIterator it(directoryFor(QFileInfo(directory).absoluteFilePath()), QDir::Files);
+    while (it.hasNext()) {
+        const QString file = it.next();
+        if (keep.contains(file))
+            continue;
+
+        const qint64 bytes = it.fileInfo().size();
+        if (QFile::remove(file) && mSize >= 0)
+            mSize -= bytes;
+    }
+}
+
+void ThumbnailCache::trim()
+{
+    if (mMaxSize <= 0 || size() <= mMaxSize)
+        return;
+
+    QFileInfoList files;
+    QDirIterator it(mDirectory, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        files.append(it.fileInfo());
+    }
+    qSort(files.begin(), files.end(), lessRecentlyUsed);
+
+    /* leave some room so the next few misses don't trim again */
+    const qint64 target = mMaxSize - mMaxSize / 8;
+    for (int i = 0; i < files.count() && mSize > target; i++) {
+        if (QFile::remove(files.at(i).absoluteFilePath()))
+            mSize -= files.at(i).size();
+    }
+}
+
+QImage ThumbnailCache::image(const QString &path, const QSize &size)
+{
+    const QFileInfo info(path);
+    if (!info.exists())
+        return QImage();
+
+    const QString cached = cacheFile(path, info.lastModified().toTime_t(), size);
+    QImage image(cached);
+    if (!image.isNull())
+        return image;
+
+    QImageReader reader(path);
+    const QSize original = reader.size();
+    if (original.isValid() && size.isValid() &&
+        (original.width() > size.width() || original.height() > size.height()))
+        reader.setScaledSize(original.scaled(size, Qt::KeepAspectRatio));
+
+    if (!reader.read(&image)) {
+        qDebug() << Q_FUNC_INFO << path << reader.errorString();
+        return QImage();
+    }
+
+    /* formats without scaled decoding come back full size */
+    if (size.isValid() && (image.width() > size.width() || image.height() > size.height()))
+        image = image.scaled(size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+
+    /* display sized png's are huge, only keep them for translucent photos */
+    QDir().mkpath(QFileInfo(cached).absolutePath());
+    if (!image.save(cached, image.hasAlphaChannel() ? "PNG" : "JPG", 90)) {
+        qDebug() << Q_FUNC_INFO << "Unable to write" << cached;
+        return image;
+    }
+
+    if (mSize >= 0)
+        mSize += QFileInfo(cached).size();
+    trim();
+
+    return image;
+}
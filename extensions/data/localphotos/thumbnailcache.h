@@ -0,0 +1,68 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+#ifndef THUMBNAIL_CACHE_H
+#define THUMBNAIL_CACHE_H
+
+#include <QImage>
+#include <QSet>
+#include <QSize>
+#include <QString>
+
+/* On disk cache of scaled down photos. Entries are keyed by the path, the
+   modification time and the requested size, so an edited photo or a new
+   display resolution simply misses. Misses decode straight to the target
+   size with QImageReader::setScaledSize, which lets the jpeg loader skip
+   most of the work. Thumbnails are filed by the photo's directory so a
+   rescan can sweep what that directory no longer needs, and the whole
+   cache is held under maxSize() by dropping the least recently used
+   files. Not thread safe, owned by the indexer thread. */
+class ThumbnailCache
+{
+public:
+    explicit ThumbnailCache(const QString &directory = QString());
+
+    void setDirectory(const QString &directory);
+    QString directory() const;
+
+    /* in bytes, 0 turns the limit off */
+    void setMaxSize(qint64 bytes);
+    qint64 maxSize() const;
+    qint64 size();
+
+    QImage image(const QString &path, const QSize &size);
+
+    /* where the thumbnail of that version of a photo is or would be */
+    QString cacheFile(const QString &path, qint64 mtime, const QSize &size) const;
+    /* drops every thumbnail filed for \a directory that is not in \a keep,
+       photos that were edited, removed or shown at another size */
+    void sweep(const QString &directory, const QSet<QString> &keep);
+
+    static QString defaultDirectory();
+
+private:
+    QString directoryFor(const QString &photoDirectory) const;
+    void trim();
+
+    QString mDirectory;
+    qint64 mMaxSize;
+    /* bytes on disk, -1 until the cache has been measured */
+    qint64 mSize;
+};
+
+#endif
@@ -0,0 +1,64 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+#include "metrics.h"
+#include "metricssampler.h"
+
+#include <tickscheduler.h>
+
+class MetricsData::Private
+{
+public:
+    Private() {
+    }
+    ~Private() {
+    }
+    QSharedPointer<MetricsSampler> mSampler;
+};
+
+MetricsData::MetricsData(QObject *object) : PlexyDesk::DataSource(object), d(new Private)
+{
+    d->mSampler = MetricsSampler::instance();
+    connect(d->mSampler.data(), SIGNAL(sampled(QVariantMap)), this, SLOT(onSampled(QVariantMap)));
+    d->mSampler->subscribe(this, 0);
+}
+
+MetricsData::~MetricsData()
+{
+    d->mSampler->unsubscribe(this);
+    delete d;
+}
+
+void MetricsData::setArguments(QVariant args)
+{
+    const QVariantMap map = args.toMap();
+    if (map.contains("interval"))
+        d->mSampler->subscribe(this, map["interval"].toInt());
+    if (map.contains("paused"))
+        PlexyDesk::TickScheduler::getInstance()->setPaused(this, map["paused"].toBool());
+}
+
+QVariantMap MetricsData::readAll()
+{
+    return d->mSampler->lastSample();
+}
+
+void MetricsData::onSampled(const QVariantMap &data)
+{
+    Q_EMIT sourceUpdated(data);
+}
@@ -0,0 +1,52 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+#ifndef METRICS_DATA_H
+#define METRICS_DATA_H
+
+#include <QtCore>
+#include <plexy.h>
+#include <datasource.h>
+
+/* System metrics as a data source: "cpu", "cpu_iowait" and "cores" in
+   percent, "memory" in kB, "load" as the 1, 5 and 15 minute averages and
+   "disks" in bytes per second. Send a map with "interval" in ms to change
+   how often this source wants to be updated and "paused" to stop asking
+   for updates while nothing shows them, all sources share a single
+   sampler. */
+class MetricsData : public PlexyDesk::DataSource
+{
+    Q_OBJECT
+
+public:
+    MetricsData(QObject *object = 0);
+    virtual ~MetricsData();
+    QVariantMap readAll();
+
+public Q_SLOTS:
+    void setArguments(QVariant args);
+
+private Q_SLOTS:
+    void onSampled(const QVariantMap &data);
+
+private:
+    class Private;
+    Private *const d;
+};
+
+#endif
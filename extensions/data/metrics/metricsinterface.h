@@ -16,43 +16,24 @@
 *  You should have received a copy of the GNU General Public License
 *  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
 *******************************************************************************/
-
-#ifndef V_PLAYER_H
-#define V_PLAYER_H
+#ifndef METRICS_DATA_I
+#define METRICS_DATA_I
 
 #include <QtCore>
-#include <QtGui>
 #include <plexy.h>
+#include <dataplugininterface.h>
 
-
-namespace PlexyDesk
-{
-class VISIBLE_SYM VPlayer : public QObject
+class MetricsInterface : public QObject, public PlexyDesk::DataPluginInterface
 {
     Q_OBJECT
-public:
-    VPlayer(QObject *parent = 0);
-    ~VPlayer();
-
-    void setFileName(const QString &Path);
-
-//        void fileName();
-
-public slots:
-    //void pull() {}
-    void decode();
-signals:
-    void videoDone();
-    void frameReady(QImage &img);
+    Q_INTERFACES(PlexyDesk::DataPluginInterface)
 
-protected:
-    void init();
+public :
+    virtual ~MetricsInterface() {}
 
+    /* this will return a valid data plugin pointer*/
+    QSharedPointer<PlexyDesk::DataSource> model();
 
-private:
-    class Private;
-    Private *const d;
 };
 
-}
 #endif
@@ -0,0 +1,425 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+#include "metricssampler.h"
+
+#include <tickscheduler.h>
+
+#include <QDebug>
+#include <QFile>
+#include <QWeakPointer>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <string.h>
+#include <unistd.h>
+
+/* large enough for /proc/stat on machines with a few hundred cores */
+static const int BufferSize = 64 * 1024;
+static const int DefaultInterval = 1000;
+
+static const char *const procFileNames[MetricsSampler::ProcFileCount] = {
+    "/stat",
+    "/meminfo",
+    "/loadavg",
+    "/diskstats"
+};
+
+static inline const char *skipSpaces(const char *p, const char *end)
+{
+    while (p < end && (*p == ' ' || *p == '\t'))
+        ++p;
+    return p;
+}
+
+static inline const char *skipToken(const char *p, const char *end)
+{
+    while (p < end && *p != ' ' && *p != '\t' && *p != '\n')
+        ++p;
+    return p;
+}
+
+static inline const char *nextLine(const char *p, const char *end)
+{
+    const char *nl = static_cast<const char *>(memchr(p, '\n', end - p));
+    return nl ? nl + 1 : end;
+}
+
+static inline const char *scanNumber(const char *p, const char *end, quint64 *value)
+{
+    p = skipSpaces(p, end);
+    quint64 v = 0;
+    while (p < end && *p >= '0' && *p <= '9')
+        v = v * 10 + (*p++ - '0');
+    *value = v;
+    return p;
+}
+
+static inline const char *scanDecimal(const char *p, const char *end, double *value)
+{
+    quint64 whole = 0;
+    p = scanNumber(p, end, &whole);
+    double v = double(whole);
+    if (p < end && *p == '.') {
+        double scale = 0.1;
+        for (++p; p < end && *p >= '0' && *p <= '9'; ++p, scale *= 0.1)
+            v += (*p - '0') * scale;
+    }
+    *value = v;
+    return p;
+}
+
+static inline bool startsWith(const char *p, const char *end, const char *prefix, int length)
+{
+    return end - p >= length && memcmp(p, prefix, length) == 0;
+}
+
+/* counters restart when a device or cpu comes back, never go negative */
+static inline quint64 delta(quint64 now, quint64 before)
+{
+    return now > before ? now - before : 0;
+}
+
+static double percent(quint64 part, quint64 total)
+{
+    return total ? (100.0 * part) / total : 0.0;
+}
+
+MetricsSampler::MetricsSampler(const QString &root, QObject *parent) : QObject(parent),
+    mRoot(root),
+    mBuffer(new char[BufferSize]),
+    mTickId(0),
+    mInterval(0)
+{
+    for (int i = 0; i < ProcFileCount; i++)
+        mFds[i] = -1;
+    openFiles();
+
+    connect(PlexyDesk::TickScheduler::getInstance(), SIGNAL(pausedChanged(QObject *, bool)),
+            this, SLOT(onClientPaused(QObject *)));
+}
+
+MetricsSampler::~MetricsSampler()
+{
+    if (mTickId)
+        PlexyDesk::TickScheduler::getInstance()->cancel(mTickId);
+    closeFiles();
+    delete [] mBuffer;
+}
+
+QSharedPointer<MetricsSampler> MetricsSampler::instance()
+{
+    // lives as long as some source holds it, the next one starts afresh
+    static QWeakPointer<MetricsSampler> shared;
+    QSharedPointer<MetricsSampler> sampler = shared.toStrongRef();
+    if (!sampler) {
+        const QByteArray root = qgetenv("PLEXY_METRICS_ROOT");
+        sampler = QSharedPointer<MetricsSampler>(root.isEmpty() ? new MetricsSampler()
+                : new MetricsSampler(QFile::decodeName(root)), &QObject::deleteLater);
+        shared = sampler;
+    }
+    return sampler;
+}
+
+QString MetricsSampler::root() const
+{
+    return mRoot;
+}
+
+void MetricsSampler::openFiles()
+{
+    for (int i = 0; i < ProcFileCount; i++) {
+        const QByteArray path = QFile::encodeName(mRoot + QLatin1String(procFileNames[i]));
+        mFds[i] = ::open(path.constData(), O_RDONLY);
+        if (mFds[i] < 0)
+            qDebug() << Q_FUNC_INFO << "Unable to open" << path;
+    }
+}
+
+void MetricsSampler::closeFiles()
+{
+    for (int i = 0; i < ProcFileCount; i++) {
+        if (mFds[i] >= 0)
+            ::close(mFds[i]);
+        mFds[i] = -1;
+    }
+}
+
+int MetricsSampler::readFile(ProcFile file)
+{
+    if (mFds[file] < 0)
+        return -1;
+
+    int length = 0;
+    while (length < BufferSize) {
+        const ssize_t rv = ::pread(mFds[file], mBuffer + length, BufferSize - length, length);
+        if (rv < 0 && errno == EINTR)
+            continue;
+        if (rv <= 0)
+            break;
+        length += rv;
+    }
+    return length;
+}
+
+void MetricsSampler::subscribe(QObject *client, int interval)
+{
+    if (!mClients.contains(client))
+        connect(client, SIGNAL(destroyed(QObject *)), this, SLOT(onClientDestroyed(QObject *)));
+    mClients[client] = interval > 0 ? interval : DefaultInterval;
+    updateTimer();
+}
+
+void MetricsSampler::unsubscribe(QObject *client)
+{
+    if (mClients.remove(client))
+        disconnect(client, SIGNAL(destroyed(QObject *)), this, SLOT(onClientDestroyed(QObject *)));
+    updateTimer();
+}
+
+void MetricsSampler::onClientDestroyed(QObject *client)
+{
+    mClients.remove(client);
+    updateTimer();
+}
+
+void MetricsSampler::onClientPaused(QObject *client)
+{
+    if (mClients.contains(client))
+        updateTimer();
+}
+
+int MetricsSampler::interval() const
+{
+    return mTickId ? mInterval : 0;
+}
+
+void MetricsSampler::updateTimer()
+{
+    PlexyDesk::TickScheduler *scheduler = PlexyDesk::TickScheduler::getInstance();
+
+    if (mClients.isEmpty()) {
+        scheduler->cancel(mTickId);
+        mTickId = 0;
+        return;
+    }
+
+    /* sources paused by their controller or view don't ask for samples */
+    int interval = INT_MAX;
+    QHash<QObject *, int>::const_iterator it;
+    for (it = mClients.constBegin(); it != mClients.constEnd(); ++it) {
+        if (!scheduler->isPaused(it.key()))
+            interval = qMin(interval, it.value());
+    }
+
+    if (interval == INT_MAX) {
+        if (mTickId)
+            scheduler->setPaused(this, true);
+        return;
+    }
+    scheduler->setPaused(this, false);
+
+    if (!mTickId || mInterval != interval) {
+        // ride along with the other periodic sources instead of our own timer
+        if (mTickId)
+            scheduler->setInterval(mTickId, interval);
+        else
+            mTickId = scheduler->schedule(this, "sample", interval);
+        mInterval = interval;
+        // the first sample only primes the counters, take it right away
+        if (!mClock.isValid())
+            sample();
+    }
+}
+
+QVariantMap MetricsSampler::lastSample() const
+{
+    return mLastSample;
+}
+
+void MetricsSampler::sample()
+{
+    QVariantMap data;
+    const qint64 elapsed = mClock.isValid() ? mClock.restart() : 0;
+    if (!mClock.isValid())
+        mClock.start();
+
+    int length = readFile(Stat);
+    if (length > 0)
+        parseStat(length, &data);
+
+    length = readFile(MemInfo);
+    if (length > 0)
+        parseMemInfo(length, &data);
+
+    length = readFile(LoadAvg);
+    if (length > 0)
+        parseLoadAvg(length, &data);
+
+    length = readFile(DiskStats);
+    if (length > 0)
+        parseDiskStats(length, elapsed, &data);
+
+    data["interval"] = elapsed;
+    mLastSample = data;
+    Q_EMIT sampled(data);
+}
+
+void MetricsSampler::parseStat(int length, QVariantMap *data)
+{
+    const char *p = mBuffer;
+    const char *end = mBuffer + length;
+    QVariantList cores;
+    int index = 0;
+
+    // the aggregate "cpu" line comes first, then "cpu0", "cpu1", ...
+    while (p < end && startsWith(p, end, "cpu", 3)) {
+        p = skipToken(p, end);
+
+        // user nice system idle iowait irq softirq steal
+        quint64 fields[8];
+        for (int i = 0; i < 8; i++)
+            p = scanNumber(p, end, &fields[i]);
+
+        CpuTimes now;
+        now.idle = fields[3];
+        now.iowait = fields[4];
+        now.busy = fields[0] + fields[1] + fields[2] + fields[5] + fields[6] + fields[7];
+
+        if (index >= mCpuTimes.count())
+            mCpuTimes.append(now);
+        const CpuTimes before = mCpuTimes.at(index);
+        mCpuTimes[index] = now;
+
+        const quint64 busy = delta(now.busy, before.busy);
+        const quint64 iowait = delta(now.iowait, before.iowait);
+        const quint64 total = busy + iowait + delta(now.idle, before.idle);
+
+        if (index == 0) {
+            (*data)["cpu"] = percent(busy, total);
+            (*data)["cpu_iowait"] = percent(iowait, total);
+        } else {
+            cores.append(percent(busy, total));
+        }
+
+        ++index;
+        p = nextLine(p, end);
+    }
+
+    (*data)["cores"] = cores;
+}
+
+void MetricsSampler::parseMemInfo(int length, QVariantMap *data)
+{
+    static const struct {
+        const char *key;
+        int length;
+        const char *name;
+    } fields[] = {
+        { "MemTotal:", 9, "total" },
+        { "MemFree:", 8, "free" },
+        { "MemAvailable:", 13, "available" },
+        { "Buffers:", 8, "buffers" },
+        { "Cached:", 7, "cached" },
+        { "SwapTotal:", 10, "swap_total" },
+        { "SwapFree:", 9, "swap_free" }
+    };
+    static const int fieldCount = sizeof(fields) / sizeof(fields[0]);
+
+    const char *p = mBuffer;
+    const char *end = mBuffer + length;
+    QVariantMap memory;
+
+    while (p < end) {
+        for (int i = 0; i < fieldCount; i++) {
+            if (startsWith(p, end, fields[i].key, fields[i].length)) {
+                quint64 value = 0;
+                scanNumber(p + fields[i].length, end, &value);
+                memory[QLatin1String(fields[i].name)] = value; // in kB
+                break;
+            }
+        }
+        p = nextLine(p, end);
+    }
+
+    (*data)["memory"] = memory;
+}
+
+void MetricsSampler::parseLoadAvg(int length, QVariantMap *data)
+{
+    const char *p = mBuffer;
+    const char *end = mBuffer + length;
+    QVariantList load;
+
+    for (int i = 0; i < 3; i++) {
+        double value = 0;
+        p = scanDecimal(skipSpaces(p, end), end, &value);
+        load.append(value);
+    }
+
+    (*data)["load"] = load;
+}
+
+void MetricsSampler::parseDiskStats(int length, qint64 elapsed, QVariantMap *data)
+{
+    const char *p = mBuffer;
+    const char *end = mBuffer + length;
+    QVariantMap disks;
+
+    while (p < end) {
+        quint64 major, minor;
+        p = scanNumber(p, end, &major);
+        p = scanNumber(p, end, &minor);
+        const char *name = skipSpaces(p, end);
+        p = skipToken(name, end);
+        const int nameLength = p - name;
+
+        // loop and ram devices only mirror traffic that is counted elsewhere
+        if (startsWith(name, end, "loop", 4) || startsWith(name, end, "ram", 3)) {
+            p = nextLine(p, end);
+            continue;
+        }
+
+        // reads merged sectors ms, writes merged sectors ms
+        quint64 fields[7];
+        for (int i = 0; i < 7; i++)
+            p = scanNumber(p, end, &fields[i]);
+
+        DiskCounters now;
+        now.sectorsRead = fields[2];
+        now.sectorsWritten = fields[6];
+
+        const QByteArray key(name, nameLength);
+        QHash<QByteArray, DiskCounters>::iterator it = mDisks.find(key);
+        if (it == mDisks.end()) {
+            mDisks.insert(key, now);
+        } else if (elapsed > 0) {
+            // sectors are always 512 bytes in diskstats
+            QVariantMap disk;
+            disk["read_bytes_per_sec"] = delta(now.sectorsRead, it->sectorsRead) * 512 * 1000 / quint64(elapsed);
+            disk["write_bytes_per_sec"] = delta(now.sectorsWritten, it->sectorsWritten) * 512 * 1000 / quint64(elapsed);
+            disks[QString::fromLatin1(name, nameLength)] = disk;
+            *it = now;
+        }
+
+        p = nextLine(p, end);
+    }
+
+    (*data)["disks"] = disks;
+}
@@ -0,0 +1,114 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+#ifndef METRICS_SAMPLER_H
+#define METRICS_SAMPLER_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QSharedPointer>
+#include <QString>
+#include <QVariantMap>
+#include <QVector>
+
+
+/* Reads cpu, memory, load and disk counters from procfs. The files stay
+   open and are re-read with pread() into one fixed buffer and parsed in
+   place, no line or field strings are built. All metrics sources in a
+   process share one sampler, which runs at the fastest interval any of
+   its clients asked for. It reads PLEXY_METRICS_ROOT instead of /proc
+   when set at the time it is created, the tests point it at fixtures. */
+class MetricsSampler : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum ProcFile {
+        Stat,
+        MemInfo,
+        LoadAvg,
+        DiskStats,
+        ProcFileCount
+    };
+
+    MetricsSampler(const QString &root = QLatin1String("/proc"), QObject *parent = 0);
+    virtual ~MetricsSampler();
+
+    static QSharedPointer<MetricsSampler> instance();
+
+    /* a directory laid out like /proc, fixed for the sampler's lifetime */
+    QString root() const;
+
+    void subscribe(QObject *client, int interval);
+    void unsubscribe(QObject *client);
+    int interval() const;
+
+    QVariantMap lastSample() const;
+
+public Q_SLOTS:
+    void sample();
+
+Q_SIGNALS:
+    void sampled(const QVariantMap &data);
+
+private Q_SLOTS:
+    void onClientDestroyed(QObject *client);
+    void onClientPaused(QObject *client);
+
+private:
+    struct CpuTimes
+    {
+        CpuTimes() : busy(0), idle(0), iowait(0) {
+        }
+        quint64 busy;
+        quint64 idle;
+        quint64 iowait;
+    };
+
+    struct DiskCounters
+    {
+        DiskCounters() : sectorsRead(0), sectorsWritten(0) {
+        }
+        quint64 sectorsRead;
+        quint64 sectorsWritten;
+    };
+
+    int readFile(ProcFile file);
+    void openFiles();
+    void closeFiles();
+    void updateTimer();
+
+    void parseStat(int length, QVariantMap *data);
+    void parseMemInfo(int length, QVariantMap *data);
+    void parseLoadAvg(int length, QVariantMap *data);
+    void parseDiskStats(int length, qint64 elapsed, QVariantMap *data);
+
+    QString mRoot;
+    int mFds[ProcFileCount];
+    char *mBuffer;
+    int mTickId;
+    int mInterval;
+    QHash<QObject *, int> mClients;
+    QVector<CpuTimes> mCpuTimes;
+    QHash<QByteArray, DiskCounters> mDisks;
+    QElapsedTimer mClock;
+    QVariantMap mLastSample;
+};
+
+#endif
@@ -0,0 +1,144 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+#include "testmetrics.h"
+#include "metrics.h"
+#include "metricssampler.h"
+
+void TestMetrics::init()
+{
+    mRoot = QDir::tempPath() + QString("/plexy_metrics_test_%1").arg(QCoreApplication::applicationPid());
+    QDir().mkpath(mRoot);
+    installFixture("stat", "0");
+    installFixture("meminfo");
+    installFixture("loadavg");
+    installFixture("diskstats", "0");
+}
+
+void TestMetrics::cleanup()
+{
+    QDir dir(mRoot);
+    Q_FOREACH(const QString &file, dir.entryList(QDir::Files))
+        dir.remove(file);
+    QDir().rmdir(mRoot);
+}
+
+void TestMetrics::installFixture(const QString &name, const QString &variant)
+{
+    QFile source(QString(FIXTURE_DIR "/") + name + (variant.isEmpty() ? QString() : "." + variant));
+    QVERIFY(source.open(QIODevice::ReadOnly));
+
+    // rewrite in place, the sampler keeps the file open
+    QFile target(mRoot + "/" + name);
+    QVERIFY(target.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    target.write(source.readAll());
+}
+
+void TestMetrics::parsesCounters()
+{
+    MetricsSampler sampler(mRoot);
+    sampler.sample();
+
+    installFixture("stat", "1");
+    installFixture("diskstats", "1");
+    QTest::qWait(50);
+    sampler.sample();
+
+    const QVariantMap data = sampler.lastSample();
+    QCOMPARE(data["cpu"].toDouble(), 60.0);
+    QCOMPARE(data["cpu_iowait"].toDouble(), 20.0);
+
+    const QVariantList cores = data["cores"].toList();
+    QCOMPARE(cores.count(), 2);
+    QCOMPARE(cores.at(0).toDouble(), 100.0);
+    QVERIFY(qAbs(cores.at(1).toDouble() - 100.0 * 150 / 550) < 0.01);
+
+    const QVariantMap memory = data["memory"].toMap();
+    QCOMPARE(memory["total"].toULongLong(), Q_UINT64_C(8000000));
+    QCOMPARE(memory["available"].toULongLong(), Q_UINT64_C(5000000));
+    QCOMPARE(memory["cached"].toULongLong(), Q_UINT64_C(2500000));
+    QCOMPARE(memory["swap_free"].toULongLong(), Q_UINT64_C(900000));
+
+    const QVariantList load = data["load"].toList();
+    QCOMPARE(load.count(), 3);
+    QVERIFY(qAbs(load.at(0).toDouble() - 0.52) < 0.001);
+    QVERIFY(qAbs(load.at(2).toDouble() - 2.0) < 0.001);
+
+    // 2000 sectors read and 4000 written in at least 50 ms
+    const QVariantMap disks = data["disks"].toMap();
+    QVERIFY(!disks.contains("loop0"));
+    QVERIFY(disks.contains("sda1"));
+    const QVariantMap sda = disks["sda"].toMap();
+    const qint64 interval = data["interval"].toLongLong();
+    QVERIFY(interval >= 50);
+    QCOMPARE(sda["read_bytes_per_sec"].toULongLong(), quint64(2000 * 512 * 1000 / interval));
+    QCOMPARE(sda["write_bytes_per_sec"].toULongLong(), quint64(4000 * 512 * 1000 / interval));
+}
+
+void TestMetrics::sharedSampler()
+{
+    // picked up when the shared sampler is created, sources can't move it
+    qputenv("PLEXY_METRICS_ROOT", QFile::encodeName(mRoot));
+    MetricsData *first = new MetricsData();
+    MetricsData *second = new MetricsData();
+
+    QSharedPointer<MetricsSampler> sampler = MetricsSampler::instance();
+    QCOMPARE(sampler->interval(), 1000);
+
+    QCOMPARE(sampler->root(), mRoot);
+
+    QVariantMap args;
+    args["root"] = QString("/elsewhere");
+    args["interval"] = 250;
+    second->setArguments(args);
+    QCOMPARE(sampler->interval(), 250);
+    QCOMPARE(sampler->root(), mRoot);
+
+    // a paused source stops asking for its faster interval
+    QVariantMap pause;
+    pause["paused"] = true;
+    second->setArguments(pause);
+    QCOMPARE(sampler->interval(), 1000);
+    pause["paused"] = false;
+    second->setArguments(pause);
+    QCOMPARE(sampler->interval(), 250);
+
+    // every source sees the same sample
+    QSignalSpy firstSpy(first, SIGNAL(sourceUpdated(QVariantMap)));
+    QSignalSpy secondSpy(second, SIGNAL(sourceUpdated(QVariantMap)));
+    sampler->sample();
+    QCOMPARE(firstSpy.count(), 1);
+    QCOMPARE(secondSpy.count(), 1);
+    QCOMPARE(first->readAll(), second->readAll());
+
+    delete second;
+    QCOMPARE(sampler->interval(), 1000);
+    delete first;
+    QCOMPARE(sampler->interval(), 0);
+    qputenv("PLEXY_METRICS_ROOT", QByteArray());
+}
+
+void TestMetrics::sampleBenchmark()
+{
+    MetricsSampler sampler(mRoot);
+    QBENCHMARK {
+        sampler.sample();
+    }
+}
+
+QTEST_MAIN(TestMetrics)
@@ -18,23 +18,25 @@
 *******************************************************************************/
 #include "rss.h"
 #include <desktopwidget.h>
+#include <feedengine.h>
 
 RssData::RssData(QObject *object)
 {
+    mEngine = new FeedEngine(this);
+    connect(mEngine, SIGNAL(itemsUpdated(QUrl, QVariantList, QVariantList)),
+     this, SLOT(onItemsUpdated(QUrl, QVariantList, QVariantList)));
+    connect(mEngine, SIGNAL(feedError(QUrl, QString)),
+     this, SLOT(onFeedError(QUrl, QString)));
+
+    // hourly, the engine asks with If-None-Match so an unchanged feed costs a 304
+    mEngine->setRefreshInterval(1000*60*60);
+
+    mEngine->addFeed(QUrl("http://labs.trolltech.com/blogs/feed"));
     init();
-    mRssTimer = new QTimer(this);
-    connect(mRssTimer, SIGNAL(timeout()), this, SLOT(fetch()));
-    mRssTimer->start(1000*60*60);
 }
 
 void RssData::init()
 {
-    mHttp = new QHttp(this);
-    connect(mHttp, SIGNAL(readyRead(const QHttpResponseHeader &)),
-     this, SLOT(readData(const QHttpResponseHeader &)));
-
-    connect(mHttp, SIGNAL(requestFinished(int, bool)),
-     this, SLOT(finished(int, bool)));
     fetch();
 }
 
@@ -43,97 +45,43 @@ RssData::~RssData()
 }
 
 /** This method will fetch the
- * rss feed from the given URL */
+ * rss feeds, only new and changed items are reported */
 void RssData::fetch()
 {
     qDebug() << "RSS: Fetching XML..." << endl;
 
-    mXml.clear();
-
-    QUrl url("mHttp://labs.trolltech.com/blogs/feed");
-
-    mHttp->setHost(url.host());
-    mConnectionId = mHttp->get(url.path());
+    mEngine->refreshAll();
 }
 
-void RssData::readData(const QHttpResponseHeader &resp)
+void RssData::onItemsUpdated(const QUrl &feed, const QVariantList &added, const QVariantList &changed)
 {
-    if (resp.statusCode() != 200) {
-        mHttp->abort();
-        qDebug() << "RSS: Error." << endl;
-    } else {
-        mXml.addData(mHttp->readAll());
-        parseXml();
-    }
+    QVariantMap update;
+    update["feed"] = feed;
+    update["added"] = added;
+    update["changed"] = changed;
+
+    QVariant rss(update);
+    emit data(rss);
 }
 
-void RssData::finished(int id, bool error)
+void RssData::onFeedError(const QUrl &feed, const QString &error)
 {
-    if (error) {
-        qDebug() << "RSS: Received error during HTTP fetch." << endl;
-    } else if (id == mConnectionId) {
-        qDebug() << "RSS: HTTP fetch Success." << endl;
-        QVariant rss(mRssEntries);
-        emit data(rss);
-    }
+    qDebug() << "RSS: Received error during HTTP fetch." << feed << error << endl;
 }
 
-/** This method will parse the
- * XML and add entries to the QList: mRssEntries*/
-void RssData::parseXml()
+void RssData::pushData(QVariant &var)
 {
-    while (!mXml.atEnd()) {
-        mXml.readNext();
-        if (mXml.isStartElement()) {
-            if (mXml.name() == "item") {
-                mLinkString = mXml.attributes().value("rss:about").toString();
-            }
-            mCurrentTag = mXml.name().toString();
-        } else if (mXml.isEndElement()) {
-            if (mXml.name() == "item") {
-                qDebug() << mTitleString << " : " << endl;
-
-                //mEntry.clear();
-
-                mEntry["title"] = mTitleString;
-                mEntry["link"] = mLinkString;
-                mEntry["description"] = mDescString;
-
-                QVariant rssitem(mEntry);
-
-                mRssEntries.append(rssitem);
-
-                mTitleString.clear();
-                mLinkString.clear();
-            }
-
-        } else if (mXml.isCharacters() && !mXml.isWhitespace()) {
-            if (mCurrentTag == "title") {
-                mTitleString += mXml.text().toString();
-            } else if (mCurrentTag == "link") {
-                mLinkString += mXml.text().toString();
-            } else if (mCurrentTag == "description") {
-                mDescString += mXml.text().toString();
-            }
-        }
-    }
-
-    if (mXml.error() && mXml.error() !=
-     QXmlStreamReader::PrematureEndOfDocumentError) {
-        qDebug() << "XML ERROR:" << mXml.lineNumber() << ": " <<
-        mXml.errorString();
-        mHttp->abort();
+    QStringList urls = var.toStringList();
+    if (urls.isEmpty())
         return;
-    }
 
-    //QVariant rss(mRssEntries);
-    //emit data(rss);
-}
+    Q_FOREACH(const QString &url, mEngine->feeds())
+        mEngine->removeFeed(QUrl(url));
 
-void RssData::pushData(QVariant &var)
-{
-    mHttp->abort();
-    init();
+    Q_FOREACH(const QString &url, urls)
+        mEngine->addFeed(QUrl(url));
+
+    fetch();
 }
 
 QGraphicsItem *RssData::item()
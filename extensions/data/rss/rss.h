@@ -23,12 +23,9 @@
 #include <plexy.h>
 #include <backdropinterface.h>
 #include <abstractplugininterface.h>
-//#include <QtNetwork>
-//#include <QBuffer>
-#include <QXmlStreamReader>
-#include <QHttp>
-#include <QMap>
-#include <QList>
+#include <QUrl>
+
+class FeedEngine;
 
 class VISIBLE_SYM RssData : public PlexyDesk::DataPlugin
 {
@@ -40,30 +37,20 @@ public:
     void init();
     virtual QGraphicsItem *item(); // {};
     virtual void render(QPainter *p, QRectF r); // {};
+    /* a feed url, or a list of them, replaces the feeds followed */
     virtual void pushData(QVariant &);
 
 public slots:
     void fetch();
-    void finished(int id, bool error);
-    void readData(const QHttpResponseHeader &);
+    void onItemsUpdated(const QUrl &feed, const QVariantList &added, const QVariantList &changed);
+    void onFeedError(const QUrl &feed, const QString &error);
 
 signals:
+    /* a map with the "feed" url and its "added" and "changed" items */
     void data(QVariant &);
 
 private:
-    void parseXml();
-
-    QXmlStreamReader mXml;
-    QString mCurrentTag;
-    QString mLinkString;
-    QString mTitleString;
-    QString mDescString;
-    QMap<QString, QVariant> mEntry;
-    QList<QVariant> mRssEntries;
-
-    QHttp *mHttp;
-    int mConnectionId;
-    QTimer *mRssTimer;
+    FeedEngine *mEngine;
 };
 
 
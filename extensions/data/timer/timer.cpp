@@ -18,8 +18,8 @@
 #include "timer.h"
 #include <desktopwidget.h>
 #include <plexyconfig.h>
-#include <QTimer>
 #include <controllerinterface.h>
+#include <tickscheduler.h>
 
 class TimerData::Private
 {
@@ -28,12 +28,12 @@ public:
     }
     ~Private() {
     }
-    QTimer *mTimer;
 };
 
 TimerData::TimerData(QObject *object) : PlexyDesk::DataSource(object), d(new Private)
 {
-    startTimer(1000);
+    // second boundaries are shared with every other one second source
+    PlexyDesk::TickScheduler::getInstance()->schedule(this, "onTick", 1000);
 }
 
 void TimerData::init()
@@ -60,7 +60,7 @@ QVariantMap TimerData::readAll()
     return dataMap;
 }
 
-void TimerData::timerEvent(QTimerEvent *event)
+void TimerData::onTick()
 {
     Q_EMIT sourceUpdated(readAll());
 }
@@ -35,11 +35,12 @@ public:
     void init();
     QVariantMap readAll();
 
-    void timerEvent ( QTimerEvent *event);
-
 public Q_SLOTS:
     void setArguments(QVariant sourceUpdated);
 
+private Q_SLOTS:
+    void onTick();
+
 private:
     class Private;
     Private *const d;
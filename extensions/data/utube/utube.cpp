@@ -18,26 +18,29 @@
 *******************************************************************************/
 #include "utube.h"
 #include <desktopwidget.h>
+#include <feedengine.h>
 
-#include <QTimer>
+#include <QNetworkProxy>
+
+static const char feedUrl[] =
+    "http://gdata.youtube.com/feeds/api/videos?vq=kbfx&max-results=20&orderby=viewCount&alt=rss";
 
 UtubeData::UtubeData(QObject *object)
 {
+    mEngine = new FeedEngine(this);
+    connect(mEngine, SIGNAL(itemsUpdated(QUrl, QVariantList, QVariantList)),
+     this, SLOT(onItemsUpdated(QUrl, QVariantList, QVariantList)));
+    connect(mEngine, SIGNAL(feedFinished(QUrl, bool)),
+     this, SLOT(onFeedFinished(QUrl, bool)));
+    connect(mEngine, SIGNAL(feedError(QUrl, QString)),
+     this, SLOT(onFeedError(QUrl, QString)));
+
+    mEngine->addFeed(QUrl(feedUrl));
     init();
-    mRssTimer = new QTimer(this);
-    connect(mRssTimer, SIGNAL(timeout()), this, SLOT(fetch()));
-    //mRssTimer->start( 1000*60*60 );
 }
 
 void UtubeData::init()
 {
-    mHttp = new QHttp(this);
-    connect(mHttp, SIGNAL(readyRead(const QHttpResponseHeader &)),
-     this, SLOT(readData(const QHttpResponseHeader &)));
-
-    connect(mHttp, SIGNAL(requestFinished(int, bool)),
-     this, SLOT(finished(int, bool)));
-
     if (PlexyDesk::Config::getInstance()->m_proxyOn) {
         QNetworkProxy NtProxy(PlexyDesk::Config::getInstance()->proxyType,
          PlexyDesk::Config::getInstance()->proxyURL,
@@ -46,7 +49,6 @@ void UtubeData::init()
          PlexyDesk::Config::getInstance()->proxyPasswd
          );
 
-        mHttp->setProxy(NtProxy);
         QNetworkProxy::setApplicationProxy(NtProxy);
         qDebug() << "UtubeData::init()" << "Proxy state"
                  << PlexyDesk::Config::getInstance()->m_proxyOn << endl;
@@ -65,104 +67,46 @@ void UtubeData::fetch()
 {
     qDebug() << "UTUBE: Fetching XML..." << endl;
 
-    mXml.clear();
-
-    //qDebug() << url.toString();
-
-    mHttp->setHost("gdata.youtube.com");
-    mConnectionId = mHttp->get(
-     QString("/feeds/api/videos?vq=%1&max-results=20&orderby=viewCount&alt=rss").
-         arg("kbfx"));
-
+    mEngine->refreshAll();
 }
 
-void UtubeData::readData(const QHttpResponseHeader &resp)
+void UtubeData::onItemsUpdated(const QUrl &feed, const QVariantList &added, const QVariantList &changed)
 {
-    if (resp.statusCode() != 200) {
-        mHttp->abort();
-        qDebug() << "UTUBE: Error." << endl;
-    } else {
-        mXml.addData(mHttp->readAll());
-        parseXml();
-    }
+    Q_FOREACH(const QVariant &item, added)
+        publish(item.toMap());
+    Q_FOREACH(const QVariant &item, changed)
+        publish(item.toMap());
 }
 
-void UtubeData::finished(int id, bool error)
+void UtubeData::publish(const QVariantMap &item)
 {
-    if (error) {
-        qDebug() << "UTUBE: Received error during HTTP fetch." << endl;
-        //mRssTimer->start( 2000 );
-        //fetch();
-    } else if (id == mConnectionId) {
-        qDebug() << "UTUBE: HTTP fetch Success." << endl;
-        //QVariant rss( mRssEntries );
-        //emit data( rss );
-        emit success();
-    }
+    const QString link = item["link"].toString();
+    const QStringList parts = link.split("v=");
+    if (parts.count() < 2)
+        return;
+
+    // the id ends where the next query item starts
+    const QString videoId = parts.at(1).section('&', 0, 0);
+
+    QVariantMap entry;
+    entry["title"] = item["title"];
+    entry["link"] = link;
+    entry["description"] = item["description"];
+    entry["thumb"] = "http://img.youtube.com/vi/" + videoId + "/1.jpg"; //97 130
+
+    dataItem = QVariant(entry);
+    emit dataReady();
 }
 
-/** This method will parse the
- * XML and add entries to the QList: mRssEntries*/
-void UtubeData::parseXml()
+void UtubeData::onFeedFinished(const QUrl &feed, bool modified)
 {
-    while (!mXml.atEnd()) {
-        mXml.readNext();
-        if (mXml.isStartElement()) {
-            //if (mXml.name() == "item"){
-            //mLinkString = mXml.attributes().value("rss:about").toString();
-            //}
-            mCurrentTag = mXml.name().toString();
-        } else if (mXml.isEndElement()) {
-            //qDebug() << mXml.name().toString()<<" ::: " << endl;
-            if (mXml.name() == "item") {
-
-                mVideoID = (mLinkString.split("v=")).at(1);
-                mThumbString = "http://img.youtube.com/vi/" + mVideoID + "/1.jpg";
-
-                //qDebug() << "UTUBE: " << mThumbString << " : " << endl;
-
-                //mEntry.clear();
-
-                mEntry["title"] = mTitleString;
-                mEntry["link"] = mLinkString;
-                mEntry["description"] = mDescString;
-                mEntry["thumb"] = mThumbString; //97 130
-
-                //mThumbString = mThumbString.split(QRegExp("\\s+"));
-
-                QVariant rssitem(mEntry);
-
-                //mRssEntries.append(rssitem);
-                dataItem = rssitem;
-                emit dataReady();
-
-                //mTitleString.clear();
-                //mLinkString.clear();
-                //mDescString.clear();
-                //mThumbString.clear();
-            }
-
-        } else if (mXml.isCharacters() && !mXml.isWhitespace()) {
-            if (mCurrentTag == "title") {
-                mTitleString = mXml.text().toString();
-            } else if (mCurrentTag == "link") {
-                mLinkString = mXml.text().toString();
-            } else if (mCurrentTag == "description") {
-                mDescString = mXml.text().toString();
-            }
-        }
-    }
-
-    if (mXml.error() && mXml.error() !=
-     QXmlStreamReader::PrematureEndOfDocumentError) {
-        qDebug() << "UTUBE: XML ERROR:" << mXml.lineNumber() << ": " <<
-        mXml.errorString();
-        mHttp->abort();
-        return;
-    }
+    qDebug() << "UTUBE: HTTP fetch Success." << feed << modified << endl;
+    emit success();
+}
 
-    //QVariant rss(mRssEntries);
-    //emit data(rss);
+void UtubeData::onFeedError(const QUrl &feed, const QString &error)
+{
+    qDebug() << "UTUBE: Received error during HTTP fetch." << feed << error << endl;
 }
 
 
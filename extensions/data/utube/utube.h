@@ -22,14 +22,13 @@
 #include <plexy.h>
 #include <backdropinterface.h>
 #include <abstractplugininterface.h>
-#include <QXmlStreamReader>
-#include <QHttp>
-#include <QMap>
-#include <QList>
+#include <QUrl>
 #include <QGraphicsItem>
 //plexy
 #include <datainterface.h>
 
+class FeedEngine;
+
 class UtubeData : public PlexyDesk::DataPlugin
 {
     Q_OBJECT
@@ -42,31 +41,18 @@ public:
 
 public slots:
     void fetch();
-    void finished(int id, bool error);
-    void readData(const QHttpResponseHeader &);
+    void onItemsUpdated(const QUrl &feed, const QVariantList &added, const QVariantList &changed);
+    void onFeedFinished(const QUrl &feed, bool modified);
+    void onFeedError(const QUrl &feed, const QString &error);
     void pushData(QVariant &) {
     }
 signals:
     void success();
 
 private:
-    void parseXml();
-
-    QXmlStreamReader mXml;
-    QString mCurrentTag;
-    QString mLinkString;
-    QString mTitleString;
-    QString mDescString;
-    QString mThumbString;
-
-    QString mVideoID;
-
-    QMap<QString, QVariant> mEntry;
-    QList<QVariant> mRssEntries;
+    void publish(const QVariantMap &item);
 
-    QHttp *mHttp;
-    int mConnectionId;
-    QTimer *mRssTimer;
+    FeedEngine *mEngine;
     QVariant dataItem;
 };
 
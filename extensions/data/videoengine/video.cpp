@@ -22,30 +22,40 @@
 #include <plexyconfig.h>
 
 
-VideoData::VideoData(QObject *object)
+VideoData::VideoData(QObject *object) : vplayer(0)
 {
 }
 
 void VideoData::pushData(QVariant &data)
 {
+    // a size is the view telling us what it paints the video at
+    if (data.type() == QVariant::Size) {
+        displaySize = data.toSize();
+        if (vplayer)
+            vplayer->setDisplaySize(displaySize);
+        return;
+    }
+
     init();
+    vplayer->setDisplaySize(displaySize);
     vplayer->setFileName(data.toString());
 }
 
 void VideoData::init()
 {
     vplayer = new PlexyDesk::VPlayer();
-    connect(vplayer, SIGNAL(frameReady(QImage&)), this, SLOT(grab(QImage&)));
+    connect(vplayer, SIGNAL(frameReady(PlexyDesk::VideoFrame)), this, SLOT(grab(PlexyDesk::VideoFrame)));
 }
 
 VideoData::~VideoData()
 {
 }
 
-void VideoData::grab(QImage &img)
+void VideoData::grab(const PlexyDesk::VideoFrame &frame)
 {
-    if (!img.isNull()) {
-        QVariant frame = img;
-        emit data(frame);
+    // the variant shares the pooled buffer, the pixels are not copied
+    if (!frame.isNull()) {
+        QVariant variant = QVariant::fromValue(frame);
+        emit data(variant);
     }
 }
@@ -40,13 +40,14 @@ public:
 
 public slots:
     void pushData(QVariant &);
-    void grab(QImage &);
+    void grab(const PlexyDesk::VideoFrame &frame);
 
 signals:
     void data(QVariant &);
 
 private:
     PlexyDesk::VPlayer *vplayer;
+    QSize displaySize;
 };
 
 
@@ -0,0 +1,308 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+
+#include "videoframe.h"
+#include "videoframepool.h"
+
+#include <QPainter>
+
+namespace PlexyDesk
+{
+
+VideoFrameStats::VideoFrameStats()
+{
+    reset();
+}
+
+void VideoFrameStats::record(Stage stage, qint64 latency, bool copied)
+{
+    QMutexLocker lock(&m_mutex);
+    m_frames[stage]++;
+    if (copied)
+        m_copies[stage]++;
+    m_totalLatency[stage] += latency;
+    m_maxLatency[stage] = qMax(m_maxLatency[stage], latency);
+}
+
+void VideoFrameStats::reset()
+{
+    QMutexLocker lock(&m_mutex);
+    for (int i = 0; i < StageCount; i++) {
+        m_frames[i] = 0;
+        m_copies[i] = 0;
+        m_totalLatency[i] = 0;
+        m_maxLatency[i] = 0;
+    }
+}
+
+int VideoFrameStats::frames(Stage stage) const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_frames[stage];
+}
+
+int VideoFrameStats::copies(Stage stage) const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_copies[stage];
+}
+
+qint64 VideoFrameStats::averageLatency(Stage stage) const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_frames[stage] ? m_totalLatency[stage] / m_frames[stage] : 0;
+}
+
+qint64 VideoFrameStats::maxLatency(Stage stage) const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_maxLatency[stage];
+}
+
+VideoFramePool::VideoFramePool(int size) : m_slots(new Slot[size]),
+    m_size(size),
+    m_aborted(false),
+    m_serial(0),
+    m_ref(1)
+{
+    for (int i = 0; i < m_size; i++)
+        m_free.enqueue(i);
+    m_clock.start();
+}
+
+VideoFramePool::~VideoFramePool()
+{
+    for (int i = 0; i < m_size; i++)
+        qFree(m_slots[i].data);
+    delete [] m_slots;
+}
+
+int VideoFramePool::acquire()
+{
+    QMutexLocker lock(&m_mutex);
+    while (m_free.isEmpty() && !m_aborted)
+        m_slotFree.wait(&m_mutex);
+
+    if (m_aborted)
+        return -1;
+    return m_free.dequeue();
+}
+
+void VideoFramePool::setAborted(bool aborted)
+{
+    QMutexLocker lock(&m_mutex);
+    m_aborted = aborted;
+    m_slotFree.wakeAll();
+}
+
+uchar *VideoFramePool::prepare(int slot, const QSize &size)
+{
+    // an acquired slot belongs to the caller alone, no locking needed
+    Slot &s = m_slots[slot];
+    if (s.size != size) {
+        qFree(s.data);
+        s.size = size;
+        s.bytesPerLine = size.width() * 4;
+        s.data = static_cast<uchar *>(qMalloc(s.bytesPerLine * size.height()));
+    }
+    return s.data;
+}
+
+int VideoFramePool::bytesPerLine(int slot) const
+{
+    return m_slots[slot].bytesPerLine;
+}
+
+VideoFrame VideoFramePool::publish(int slot, qint64 pts)
+{
+    Slot &s = m_slots[slot];
+    s.pts = pts;
+    s.decodedAt = elapsed();
+    m_mutex.lock();
+    s.serial = ++m_serial;
+    m_mutex.unlock();
+    return VideoFrame(this, slot);
+}
+
+qint64 VideoFramePool::elapsed() const
+{
+    return m_clock.elapsed();
+}
+
+VideoFrameStats *VideoFramePool::stats()
+{
+    return &m_stats;
+}
+
+void VideoFramePool::reset()
+{
+    m_stats.reset();
+    setAborted(false);
+}
+
+void VideoFramePool::release()
+{
+    setAborted(true);
+    deref();
+}
+
+void VideoFramePool::refSlot(int slot)
+{
+    // every slot held by a frame keeps the pool alive as well
+    if (m_slots[slot].ref.fetchAndAddOrdered(1) == 0)
+        m_ref.ref();
+}
+
+void VideoFramePool::derefSlot(int slot)
+{
+    if (m_slots[slot].ref.deref())
+        return;
+
+    m_mutex.lock();
+    m_free.enqueue(slot);
+    m_slotFree.wakeOne();
+    m_mutex.unlock();
+    deref();
+}
+
+void VideoFramePool::deref()
+{
+    if (!m_ref.deref())
+        delete this;
+}
+
+VideoFrame::VideoFrame() : m_pool(0), m_slot(-1)
+{
+}
+
+VideoFrame::VideoFrame(VideoFramePool *pool, int slot) : m_pool(pool), m_slot(slot)
+{
+    m_pool->refSlot(m_slot);
+}
+
+VideoFrame::VideoFrame(const VideoFrame &other) : m_pool(other.m_pool), m_slot(other.m_slot)
+{
+    if (m_pool)
+        m_pool->refSlot(m_slot);
+}
+
+VideoFrame::~VideoFrame()
+{
+    if (m_pool)
+        m_pool->derefSlot(m_slot);
+}
+
+VideoFrame &VideoFrame::operator=(const VideoFrame &other)
+{
+    if (other.m_pool)
+        other.m_pool->refSlot(other.m_slot);
+    if (m_pool)
+        m_pool->derefSlot(m_slot);
+    m_pool = other.m_pool;
+    m_slot = other.m_slot;
+    return *this;
+}
+
+bool VideoFrame::isNull() const
+{
+    return m_pool == 0;
+}
+
+QSize VideoFrame::size() const
+{
+    return m_pool ? m_pool->m_slots[m_slot].size : QSize();
+}
+
+qint64 VideoFrame::pts() const
+{
+    return m_pool ? m_pool->m_slots[m_slot].pts : 0;
+}
+
+quint64 VideoFrame::serial() const
+{
+    return m_pool ? m_pool->m_slots[m_slot].serial : 0;
+}
+
+QImage VideoFrame::image() const
+{
+    if (!m_pool)
+        return QImage();
+
+    const VideoFramePool::Slot &s = m_pool->m_slots[m_slot];
+    return QImage(s.data, s.size.width(), s.size.height(), s.bytesPerLine, QImage::Format_RGB32);
+}
+
+void VideoFrame::markStage(VideoFrameStats::Stage stage, bool copied) const
+{
+    if (!m_pool)
+        return;
+
+    m_pool->stats()->record(stage, m_pool->elapsed() - m_pool->m_slots[m_slot].decodedAt, copied);
+}
+
+VideoFrameSurface::VideoFrameSurface() : m_cacheSerial(0), m_painted(false)
+{
+}
+
+void VideoFrameSurface::setFrame(const VideoFrame &frame)
+{
+    m_frame = frame;
+    m_painted = false;
+}
+
+VideoFrame VideoFrameSurface::frame() const
+{
+    return m_frame;
+}
+
+void VideoFrameSurface::clear()
+{
+    m_frame = VideoFrame();
+    m_cache = QImage();
+    m_cacheSerial = 0;
+}
+
+QSize VideoFrameSurface::deviceSize(QPainter *painter, const QRectF &target)
+{
+    return painter->deviceTransform().mapRect(target).toAlignedRect().size();
+}
+
+void VideoFrameSurface::paint(QPainter *painter, const QRectF &target)
+{
+    if (m_frame.isNull())
+        return;
+
+    const QSize size = deviceSize(painter, target);
+    if (m_frame.size() == size) {
+        painter->drawImage(target, m_frame.image());
+        if (!m_painted)
+            m_frame.markStage(VideoFrameStats::Paint);
+    } else {
+        const bool rescale = m_cacheSerial != m_frame.serial() || m_cache.size() != size;
+        if (rescale) {
+            m_cache = m_frame.image().scaled(size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+            m_cacheSerial = m_frame.serial();
+        }
+        painter->drawImage(target, m_cache);
+        if (!m_painted)
+            m_frame.markStage(VideoFrameStats::Paint, rescale);
+    }
+    m_painted = true;
+}
+}
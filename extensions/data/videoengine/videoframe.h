@@ -0,0 +1,126 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+
+#ifndef PLEXY_VIDEO_FRAME_H
+#define PLEXY_VIDEO_FRAME_H
+
+#include "config.h"
+
+#include <QImage>
+#include <QMetaType>
+#include <QMutex>
+#include <QSize>
+
+#include <plexy.h>
+
+class QPainter;
+
+namespace PlexyDesk
+{
+class VideoFramePool;
+
+/* Copy and latency counters for each stage a frame passes through, the
+   latency is measured from the end of the color conversion */
+class VIDEOENGINE_EXPORT VideoFrameStats
+{
+public:
+    enum Stage {
+        Convert,
+        Present,
+        Paint,
+        StageCount
+    };
+
+    VideoFrameStats();
+
+    void record(Stage stage, qint64 latency, bool copied);
+    void reset();
+
+    int frames(Stage stage) const;
+    int copies(Stage stage) const;
+    qint64 averageLatency(Stage stage) const;
+    qint64 maxLatency(Stage stage) const;
+
+private:
+    mutable QMutex m_mutex;
+    int m_frames[StageCount];
+    int m_copies[StageCount];
+    qint64 m_totalLatency[StageCount];
+    qint64 m_maxLatency[StageCount];
+};
+
+/* A decoded frame living in one of the player's pooled buffers. Copies
+   of a VideoFrame share the buffer, it goes back to the decoder once the
+   last copy is destroyed. */
+class VIDEOENGINE_EXPORT VideoFrame
+{
+public:
+    VideoFrame();
+    VideoFrame(const VideoFrame &other);
+    ~VideoFrame();
+    VideoFrame &operator=(const VideoFrame &other);
+
+    bool isNull() const;
+    QSize size() const;
+    qint64 pts() const;
+    /* grows with every frame the pool hands out, lets consumers cache
+       whatever they derive from a frame */
+    quint64 serial() const;
+
+    /* wraps the pooled pixels without copying them, the image must not
+       outlive this frame */
+    QImage image() const;
+
+    void markStage(VideoFrameStats::Stage stage, bool copied = false) const;
+
+private:
+    friend class VideoFramePool;
+    VideoFrame(VideoFramePool *pool, int slot);
+
+    VideoFramePool *m_pool;
+    int m_slot;
+};
+
+/* Draws the latest frame into a painter. A frame that already has the
+   size it is painted at is drawn straight from the pool, otherwise it is
+   scaled once per frame into a cached surface. */
+class VIDEOENGINE_EXPORT VideoFrameSurface
+{
+public:
+    VideoFrameSurface();
+
+    void setFrame(const VideoFrame &frame);
+    VideoFrame frame() const;
+    void clear();
+
+    /* the target rect in device pixels, what the decoder should scale to */
+    static QSize deviceSize(QPainter *painter, const QRectF &target);
+    void paint(QPainter *painter, const QRectF &target);
+
+private:
+    VideoFrame m_frame;
+    QImage m_cache;
+    quint64 m_cacheSerial;
+    bool m_painted;
+};
+}
+
+Q_DECLARE_METATYPE(PlexyDesk::VideoFrame)
+
+#endif
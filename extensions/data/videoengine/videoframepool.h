@@ -0,0 +1,89 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+
+#ifndef PLEXY_VIDEO_FRAME_POOL_H
+#define PLEXY_VIDEO_FRAME_POOL_H
+
+#include "videoframe.h"
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QQueue>
+#include <QWaitCondition>
+
+namespace PlexyDesk
+{
+/* Fixed set of frame buffers shared by the decode thread and whoever holds
+   a VideoFrame. The pool deletes itself once its owner has called
+   release() and no frame refers to it any more. */
+class VideoFramePool
+{
+public:
+    VideoFramePool(int size);
+
+    /* blocks until a buffer is free, -1 once the pool is aborted */
+    int acquire();
+    void setAborted(bool aborted);
+    /* makes the acquired slot hold size pixels, reallocates if needed */
+    uchar *prepare(int slot, const QSize &size);
+    int bytesPerLine(int slot) const;
+    /* hands the filled slot out as a frame */
+    VideoFrame publish(int slot, qint64 pts);
+
+    qint64 elapsed() const;
+    VideoFrameStats *stats();
+    void reset();
+    void release();
+
+private:
+    friend class VideoFrame;
+
+    struct Slot
+    {
+        Slot() : data(0), bytesPerLine(0), pts(0), decodedAt(0), serial(0) {
+        }
+        uchar *data;
+        QSize size;
+        int bytesPerLine;
+        qint64 pts;
+        qint64 decodedAt;
+        quint64 serial;
+        QAtomicInt ref;
+    };
+
+    ~VideoFramePool();
+    void refSlot(int slot);
+    void derefSlot(int slot);
+    void deref();
+
+    Slot *m_slots;
+    int m_size;
+    QQueue<int> m_free;
+    QMutex m_mutex;
+    QWaitCondition m_slotFree;
+    bool m_aborted;
+    quint64 m_serial;
+    QAtomicInt m_ref;
+    QElapsedTimer m_clock;
+    VideoFrameStats m_stats;
+};
+}
+
+#endif
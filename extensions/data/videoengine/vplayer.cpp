@@ -17,152 +17,449 @@
 *  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
 *******************************************************************************/
 
-#include <QLabel>
-#include <QTimer>
+#include <QElapsedTimer>
 #include <QFile>
+#include <QMutex>
+#include <QQueue>
+#include <QThread>
+#include <QTimer>
 #include <QtDebug>
 
-#ifdef _MSC_VER
 extern "C" {
-#include <ffmpeg/avcodec.h>
-#include <ffmpeg/avformat.h>
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libswscale/swscale.h>
 }
+
+/* FFmpeg 0.8 is the oldest release with the demux and decode calls used
+   here, later releases dropped the older spellings one by one */
+#if !defined(AV_VERSION_INT)
+#error "VPlayer needs FFmpeg 0.8 (libavcodec 53.8) or newer"
+#elif LIBAVCODEC_VERSION_INT < AV_VERSION_INT(53, 8, 0)
+#error "VPlayer needs FFmpeg 0.8 (libavcodec 53.8) or newer"
+#endif
+
+#define PLEXY_AV_CODECPAR (LIBAVFORMAT_VERSION_INT >= AV_VERSION_INT(57, 33, 100))
+#define PLEXY_AV_SEND_RECEIVE (LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(57, 37, 100))
+#define PLEXY_AV_FRAME_ALLOC (LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(55, 28, 1))
+#define PLEXY_AV_PACKET_UNREF (LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(57, 12, 100))
+#define PLEXY_AV_NEEDS_REGISTER (LIBAVFORMAT_VERSION_INT < AV_VERSION_INT(58, 9, 100))
+
+/* avcodec_find_decoder() returns a const codec since FFmpeg 5 */
+#if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(59, 0, 100)
+typedef const AVCodec DecoderCodec;
+#else
+typedef AVCodec DecoderCodec;
+#endif
+
+#ifndef AV_PIX_FMT_RGB32
+#define AV_PIX_FMT_RGB32 PIX_FMT_RGB32
+#endif
+
+static inline void releasePacket(AVPacket *packet)
+{
+#if PLEXY_AV_PACKET_UNREF
+    av_packet_unref(packet);
 #else
-#include <ffmpeg/avcodec.h>
-#include <ffmpeg/avformat.h>
+    av_free_packet(packet);
 #endif
+}
 
+#include "videoframepool.h"
 #include "vplayer.h"
 
+/* frames decoded ahead of presentation, bounds both memory and latency */
+static const int PoolSize = 4;
+/* used when the stream carries neither timestamps nor a frame rate */
+static const qint64 DefaultFrameDuration = 40;
+
 namespace PlexyDesk
 {
 
+class VPlayer::DecodeThread : public QThread
+{
+public:
+    DecodeThread(VPlayer::Private *priv) : d(priv) {
+    }
+protected:
+    void run();
+private:
+    VPlayer::Private *d;
+};
+
 class VPlayer::Private
 {
 public:
-    Private() {
+    Private() : formatCtx(0), videoStream(-1), codecCtx(0), frame(0),
+        swsCtx(0), thread(0), presentTimer(0), pool(new VideoFramePool(PoolSize)),
+        endOfStream(false), done(true), clockBase(0), lastPts(0),
+        frameDuration(DefaultFrameDuration), presented(0), dropped(0) {
     }
     ~Private() {
+        // frames still held elsewhere keep the pool alive until they go
+        pool->release();
     }
-    AVFormatContext *pFormatCtx;
+
+    bool openFile();
+    void closeFile();
+    qint64 framePts();
+    bool queueFrame();
+    bool decode(AVPacket *packet);
+
+    VPlayer *q;
+    QString fileName;
+
+    // owned by the decode thread while it runs
+    AVFormatContext *formatCtx;
     int videoStream;
-    AVCodecContext *pCodecCtx;
-    AVCodec *pCodec;
-    AVFrame *pFrame;
-    AVFrame *pFrameRGB;
-    AVPacket packet;
-    int frameFinished;
-    int numBytes;
-    uint8_t *buffer;
-    QLabel *video;
-    QTimer *vidtimer;
-    QImage *currentFrame;
+    AVCodecContext *codecCtx;
+    AVFrame *frame;
+    SwsContext *swsCtx;
+    DecodeThread *thread;
+
+    QTimer *presentTimer;
+    QElapsedTimer clock;
+
+    VideoFramePool *pool;
+
+    // everything below is guarded by mutex
+    QMutex mutex;
+    QQueue<VideoFrame> readyFrames;
+    QSize displaySize;
+    bool endOfStream;
+    bool done;
+    qint64 clockBase;
+    qint64 lastPts;
+    qint64 frameDuration;
+    int presented;
+    int dropped;
 };
 
-VPlayer::VPlayer(QObject *parent) : QObject(parent), d(new Private)
+bool VPlayer::Private::openFile()
 {
-    init();
-    d->vidtimer = new QTimer(this);
-    connect(d->vidtimer, SIGNAL(timeout()), this, SLOT(decode()));
-    d->currentFrame = 0;
+    if (avformat_open_input(&formatCtx, QFile::encodeName(fileName).constData(), NULL, NULL) != 0) {
+        qDebug() << "VPlayer: avformat_open_input failed for" << fileName;
+        formatCtx = 0;
+        return false;
+    }
+
+    if (avformat_find_stream_info(formatCtx, NULL) < 0) {
+        qDebug() << "VPlayer: avformat_find_stream_info failed for" << fileName;
+        return false;
+    }
+
+    videoStream = -1;
+    for (unsigned int i = 0; i < formatCtx->nb_streams; i++) {
+#if PLEXY_AV_CODECPAR
+        const AVMediaType type = formatCtx->streams[i]->codecpar->codec_type;
+#else
+        const AVMediaType type = formatCtx->streams[i]->codec->codec_type;
+#endif
+        if (type == AVMEDIA_TYPE_VIDEO) {
+            videoStream = i;
+            break;
+        }
+    }
+
+    if (videoStream == -1) {
+        qDebug() << "VPlayer: no video stream in" << fileName;
+        return false;
+    }
+
+    AVStream *stream = formatCtx->streams[videoStream];
+#if PLEXY_AV_CODECPAR
+    DecoderCodec *codec = avcodec_find_decoder(stream->codecpar->codec_id);
+#else
+    DecoderCodec *codec = avcodec_find_decoder(stream->codec->codec_id);
+#endif
+    if (!codec) {
+        qDebug() << "VPlayer: no suitable codec found";
+        return false;
+    }
+
+#if PLEXY_AV_CODECPAR
+    // the stream no longer carries a context, decode into one of our own
+    codecCtx = avcodec_alloc_context3(codec);
+    if (!codecCtx || avcodec_parameters_to_context(codecCtx, stream->codecpar) < 0) {
+        qDebug() << "VPlayer: can't set up the codec context";
+        return false;
+    }
+#else
+    codecCtx = stream->codec;
+#endif
+
+    if (avcodec_open2(codecCtx, codec, NULL) < 0) {
+        qDebug() << "VPlayer: can't open codec";
+        return false;
+    }
+
+    AVRational rate = stream->avg_frame_rate;
+    if (!rate.num || !rate.den)
+        rate = stream->r_frame_rate;
+    frameDuration = (rate.num && rate.den) ? qint64(1000 / av_q2d(rate)) : DefaultFrameDuration;
+
+#if PLEXY_AV_FRAME_ALLOC
+    frame = av_frame_alloc();
+#else
+    frame = avcodec_alloc_frame();
+#endif
+    return frame != 0;
 }
 
-VPlayer::~VPlayer()
+void VPlayer::Private::closeFile()
 {
+    if (frame) {
+#if PLEXY_AV_FRAME_ALLOC
+        av_frame_free(&frame);
+#else
+        av_free(frame);
+#endif
+        frame = 0;
+    }
+    if (swsCtx) {
+        sws_freeContext(swsCtx);
+        swsCtx = 0;
+    }
+    if (codecCtx) {
+#if PLEXY_AV_CODECPAR
+        avcodec_free_context(&codecCtx);
+#else
+        avcodec_close(codecCtx);
+#endif
+        codecCtx = 0;
+    }
+    if (formatCtx)
+        avformat_close_input(&formatCtx);
+    videoStream = -1;
 }
 
-void VPlayer::decode()
+qint64 VPlayer::Private::framePts()
 {
-    if (av_read_frame(d->pFormatCtx, &d->packet) >= 0) {
-        if (d->packet.stream_index == d->videoStream) {
-            avcodec_decode_video(d->pCodecCtx, d->pFrame, &d->frameFinished, d->packet.data, d->packet.size);
+    const int64_t pts = frame->best_effort_timestamp;
+    if (pts == (int64_t)AV_NOPTS_VALUE)
+        return lastPts + frameDuration;
 
-            if (d->frameFinished) {
-                img_convert((AVPicture *)d->pFrameRGB, PIX_FMT_RGBA32, (AVPicture *)d->pFrame, PIX_FMT_YUV420P, d->pCodecCtx->width, d->pCodecCtx->height);
-                d->currentFrame = new QImage(d->pFrameRGB->data[0], d->pCodecCtx->width, d->pCodecCtx->height, QImage::Format_ARGB32);
-                //d->video->setPixmap(QPixmap::fromImage(*d->currentFrame));
-                emit frameReady(*d->currentFrame);
-                //      delete d->currentFrame;
-            } else {
-                qDebug("Video not ready");
-            }
+    AVStream *stream = formatCtx->streams[videoStream];
+    const int64_t start = stream->start_time == (int64_t)AV_NOPTS_VALUE ? 0 : stream->start_time;
+    return qint64((pts - start) * av_q2d(stream->time_base) * 1000);
+}
+
+bool VPlayer::Private::queueFrame()
+{
+    const int slot = pool->acquire();
+    if (slot < 0)
+        return false;
+
+    mutex.lock();
+    QSize target = displaySize;
+    mutex.unlock();
+    if (target.isEmpty())
+        target = QSize(codecCtx->width, codecCtx->height);
+
+    // the slot is ours until it is published, convert without the lock
+    const qint64 start = pool->elapsed();
+    uint8_t *dst[4] = { pool->prepare(slot, target), 0, 0, 0 };
+    int dstStride[4] = { pool->bytesPerLine(slot), 0, 0, 0 };
+    swsCtx = sws_getCachedContext(swsCtx, codecCtx->width, codecCtx->height, codecCtx->pix_fmt,
+         target.width(), target.height(), AV_PIX_FMT_RGB32, SWS_BILINEAR, NULL, NULL, NULL);
+    sws_scale(swsCtx, frame->data, frame->linesize, 0, codecCtx->height, dst, dstStride);
+
+    const VideoFrame videoFrame = pool->publish(slot, framePts());
+    pool->stats()->record(VideoFrameStats::Convert, pool->elapsed() - start, false);
+
+    QMutexLocker lock(&mutex);
+    lastPts = videoFrame.pts();
+    readyFrames.enqueue(videoFrame);
+    if (readyFrames.count() == 1)
+        QMetaObject::invokeMethod(q, "presentFrame", Qt::QueuedConnection);
+
+    return true;
+}
+
+/* feeds one packet and queues every frame it yields, a null packet drains
+   the frames the decoder still holds back; false once the pool aborted */
+bool VPlayer::Private::decode(AVPacket *packet)
+{
+#if PLEXY_AV_SEND_RECEIVE
+    // a broken packet is skipped, the next key frame recovers
+    if (avcodec_send_packet(codecCtx, packet) < 0 && packet)
+        return true;
+
+    while (avcodec_receive_frame(codecCtx, frame) == 0) {
+        if (!queueFrame())
+            return false;
+    }
+    return true;
+#else
+    AVPacket empty;
+    if (!packet) {
+        av_init_packet(&empty);
+        empty.data = 0;
+        empty.size = 0;
+    }
+
+    do {
+        int frameFinished = 0;
+        if (avcodec_decode_video2(codecCtx, frame, &frameFinished, packet ? packet : &empty) < 0)
+            return true;
+        if (!frameFinished)
+            return true;
+        if (!queueFrame())
+            return false;
+    } while (!packet);
+    return true;
+#endif
+}
+
+void VPlayer::DecodeThread::run()
+{
+    if (d->openFile()) {
+        AVPacket packet;
+        bool running = true;
+        while (running && av_read_frame(d->formatCtx, &packet) >= 0) {
+            if (packet.stream_index == d->videoStream)
+                running = d->decode(&packet);
+            releasePacket(&packet);
         }
-    } else {
-        emit videoDone();
-        d->vidtimer->stop();
+
+        if (running)
+            d->decode(0);
     }
 
-    av_free_packet(&d->packet);
+    d->closeFile();
+
+    QMutexLocker lock(&d->mutex);
+    d->endOfStream = true;
+    QMetaObject::invokeMethod(d->q, "presentFrame", Qt::QueuedConnection);
+}
+
+VPlayer::VPlayer(QObject *parent) : QObject(parent), d(new Private)
+{
+    init();
+    d->q = this;
+    d->thread = new DecodeThread(d);
+    d->presentTimer = new QTimer(this);
+    d->presentTimer->setSingleShot(true);
+    connect(d->presentTimer, SIGNAL(timeout()), this, SLOT(presentFrame()));
+}
+
+VPlayer::~VPlayer()
+{
+    stop();
+    delete d->thread;
+    delete d;
 }
 
 void VPlayer::init()
 {
+#if PLEXY_AV_NEEDS_REGISTER
     av_register_all();
-    // d->vidtimer->start(500);
+#endif
 }
 
-void VPlayer::setFileName(const QString &name)
+void VPlayer::stop()
 {
-    QFile *file = new QFile(name);
-    // init();
+    d->pool->setAborted(true);
+    d->thread->wait();
+    d->presentTimer->stop();
+    d->done = true;
 
-    if (file->exists()) {
-        qDebug() << "Loading Media from " << name << endl;
+    QMutexLocker lock(&d->mutex);
+    d->readyFrames.clear();
+}
 
-        if (av_open_input_file(&d->pFormatCtx, name.toLatin1(), NULL, 0, NULL)
-             != 0) {
-            qDebug() << "av_open_input_file" << "Failed" << endl;
-        }
+void VPlayer::setDisplaySize(const QSize &size)
+{
+    QMutexLocker lock(&d->mutex);
+    d->displaySize = size;
+}
 
-        if (av_find_stream_info(d->pFormatCtx) < 0) {
-            qDebug() << "av_find_stream_info" << "Failed" << endl;
-        }
+int VPlayer::presentedFrames() const
+{
+    QMutexLocker lock(&d->mutex);
+    return d->presented;
+}
 
-        dump_format(d->pFormatCtx, 0, name.toLatin1(), 0);
+int VPlayer::droppedFrames() const
+{
+    QMutexLocker lock(&d->mutex);
+    return d->dropped;
+}
 
-        d->videoStream = -1;
-        unsigned int i;
-        for (i = 0; i < d->pFormatCtx->nb_streams; i++) {
-            if (d->pFormatCtx->streams[i]->codec->codec_type == CODEC_TYPE_VIDEO) {
-                d->videoStream = i;
-                break;
-            }
-        }
+const VideoFrameStats *VPlayer::frameStats() const
+{
+    return d->pool->stats();
+}
 
-        if (d->videoStream  == -1) {
-            qDebug() << "Null Video" << endl;
-            return;
-        }
+void VPlayer::setFileName(const QString &name)
+{
+    stop();
 
-        d->pCodecCtx = d->pFormatCtx->streams[d->videoStream]->codec;
-        d->pCodec = avcodec_find_decoder(d->pCodecCtx->codec_id);
-        if (d->pCodec == NULL) {
-            qDebug("No Suitable Codec Found Sorry");
-        }
+    if (!QFile::exists(name)) {
+        qDebug("File Dose not Exisit");
+        return;
+    }
 
-        if (avcodec_open(d->pCodecCtx, d->pCodec) < 0) {
-            qDebug("Can't open Codec");  // Could not open codec
-        }
+    qDebug() << "Loading Media from " << name;
 
-        d->pFrame = avcodec_alloc_frame();
+    d->fileName = name;
+    d->pool->reset();
+    d->endOfStream = false;
+    d->done = false;
+    d->lastPts = 0;
+    d->presented = 0;
+    d->dropped = 0;
+    d->clock.invalidate();
 
-        d->pFrameRGB = avcodec_alloc_frame();
+    d->thread->start();
+}
 
-        d->numBytes = avpicture_get_size(PIX_FMT_RGBA32, d->pCodecCtx->width, d->pCodecCtx->height);
+void VPlayer::presentFrame()
+{
+    if (d->done)
+        return;
 
-        qDebug() << "Byte Allocatoin = " << d->numBytes << endl;
-        d->buffer = (uint8_t *)av_malloc(d->numBytes * sizeof(uint8_t));
+    QMutexLocker lock(&d->mutex);
+    if (d->readyFrames.isEmpty()) {
+        if (d->endOfStream) {
+            d->done = true;
+            lock.unlock();
+            emit videoDone();
+        }
+        // otherwise the decode thread calls back with the next frame
+        return;
+    }
 
-        avpicture_fill((AVPicture *)d->pFrameRGB, d->buffer, PIX_FMT_RGBA32, d->pCodecCtx->width, d->pCodecCtx->height);
+    // the clock starts with the first frame so opening the file is not counted
+    if (!d->clock.isValid()) {
+        d->clock.start();
+        d->clockBase = d->readyFrames.head().pts();
+    }
+    const qint64 now = d->clockBase + d->clock.elapsed();
 
-        i = 0;
-    } else {
-        qDebug("File Dose not Exisit");
+    // a frame is late when the one after it is already due
+    while (d->readyFrames.count() > 1 && d->readyFrames.at(1).pts() <= now) {
+        d->readyFrames.dequeue();
+        d->dropped++;
+    }
+
+    const qint64 due = d->readyFrames.head().pts() - now;
+    if (due > 0) {
+        d->presentTimer->start(int(due));
         return;
     }
 
-    delete file;
+    const VideoFrame frame = d->readyFrames.dequeue();
+    d->presented++;
+    lock.unlock();
+
+    frame.markStage(VideoFrameStats::Present);
+    emit frameReady(frame);
 
-    d->vidtimer->start(12);
+    lock.relock();
+    if (!d->readyFrames.isEmpty())
+        d->presentTimer->start(int(qMax(qint64(0), d->readyFrames.head().pts() - d->clockBase - d->clock.elapsed())));
+    else if (d->endOfStream)
+        d->presentTimer->start(0);
 }
 }
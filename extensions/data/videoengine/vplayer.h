@@ -21,14 +21,20 @@
 #define V_PLAYER_H
 
 #include "config.h"
+#include "videoframe.h"
 
 #include <QObject>
 #include <QImage>
+#include <QSize>
 
 #include <plexy.h>
 
 namespace PlexyDesk
 {
+/* Demuxing, decoding and color conversion run on a thread of their own,
+   which keeps a small pool of frame buffers filled ahead of time. Frames
+   are presented on the owner's thread when their PTS is due, late frames
+   are skipped. */
 class VIDEOENGINE_EXPORT VPlayer : public QObject
 {
     Q_OBJECT
@@ -37,16 +43,31 @@ public:
     VPlayer(QObject *parent = 0);
     ~VPlayer();
     void setFileName(const QString &Path);
-public slots:
-    void decode();
+    /* frames are scaled to this size while they are converted, an empty
+       size keeps the size of the stream */
+    void setDisplaySize(const QSize &size);
+    void stop();
+
+    int presentedFrames() const;
+    int droppedFrames() const;
+    /* per stage counters of the frames handed out by this player */
+    const VideoFrameStats *frameStats() const;
+
 signals:
     void videoDone();
-    void frameReady(QImage &img);
+    /* the frame shares the decoder's buffer, holding on to it keeps the
+       buffer out of the pool */
+    void frameReady(const PlexyDesk::VideoFrame &frame);
 
 protected:
     void init();
+
+private slots:
+    void presentFrame();
+
 private:
     class Private;
+    class DecodeThread;
     Private *const d;
 };
 
@@ -5,6 +5,7 @@
 
 #include <datasource.h>
 #include <pluginloader.h>
+#include <plexyconfig.h>
 #include <themepackloader.h>
 
 #include "fileiconwidget.h"
@@ -24,7 +25,7 @@ PlexyDesktopView::PlexyDesktopView(QGraphicsScene *parent_scene, QWidget *parent
     PlexyDesk::AbstractDesktopView(parent_scene, parent),
     d(new PrivatePlexyDesktopView)
 {
-    d->mThemeLoader = new PlexyDesk::ThemepackLoader("default", this);
+    d->mThemeLoader = new PlexyDesk::ThemepackLoader(PlexyDesk::Config::getInstance()->themepackName(), this);
     d->mHasSession = false;
 
     QString sessionData = d->mThemeLoader->loadSessionFromDisk();
@@ -120,7 +121,7 @@ void PlexyDesktopView::onTriggered(QAction *action)
 
 void PlexyDesktopView::contextMenuEvent(QContextMenuEvent *event)
 {
-    QList<QGraphicsItem *> items = scene()->items(event->pos());
+    QList<QGraphicsItem *> items = this->items(event->pos());
 
     if (items.count() == 1 && d->mMenu) {
         d->mMenu->popup(event->globalPos());
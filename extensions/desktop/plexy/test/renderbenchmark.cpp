@@ -0,0 +1,398 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+
+/* Usage:
+
+     plexy_render_benchmark [--theme name] [--session session.xml]
+         [--frames n] [--size WxH] [--scenarios idle,drag,dock,rotate,wallpaper]
+         [--wallpapers a.png,b.png] [Qt options]
+
+   Pixmaps are kept in client memory through the raster graphics system and
+   nothing is shown, so Qt builds with QPA run it with -platform minimal and
+   X11 builds only need a throwaway Xvfb, no GPU. Sessions and settings are
+   written to a scratch home, the user's desktop is not touched. */
+
+#include "renderbenchmark.h"
+
+#include <QApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QGraphicsScene>
+#include <QPainter>
+#include <QPixmapCache>
+#include <QTextStream>
+#include <QVariantMap>
+#include <QtDebug>
+
+#include <abstractdesktopwidget.h>
+#include <controllerinterface.h>
+#include <decodedimagecache.h>
+#include <ninepatch.h>
+#include <plexyconfig.h>
+#include <pluginloader.h>
+#include <shadowitem.h>
+#include <themepackloader.h>
+
+#include <plexydesktopview.h>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+using namespace PlexyDesk;
+
+static const int DragStep = 4;
+static const int RotationSteps = 18;
+
+static qint64 heapInUse()
+{
+#ifdef __GLIBC__
+    // mallinfo() counts in int and wraps past 2 GB, glibc 2.33 has size_t fields
+#if __GLIBC_PREREQ(2, 33)
+    return qint64(mallinfo2().uordblks);
+#else
+    return mallinfo().uordblks;
+#endif
+#else
+    return -1;
+#endif
+}
+
+static qint64 nsecsElapsed(const QElapsedTimer &timer)
+{
+#if QT_VERSION >= 0x040800
+    return timer.nsecsElapsed();
+#else
+    return timer.elapsed() * 1000000;
+#endif
+}
+
+static double percentile(const QVector<qint64> &sorted, double p)
+{
+    if (sorted.isEmpty())
+        return 0.0;
+    const int index = qMin(sorted.count() - 1, int(p * sorted.count()));
+    return sorted.at(index) / 1000000.0;
+}
+
+static void removeDir(const QString &path)
+{
+    QDir dir(path);
+    Q_FOREACH(const QFileInfo &info, dir.entryInfoList(QDir::AllEntries | QDir::Hidden | QDir::NoDotAndDotDot)) {
+        if (info.isDir() && !info.isSymLink())
+            removeDir(info.absoluteFilePath());
+        else
+            dir.remove(info.fileName());
+    }
+    dir.rmdir(path);
+}
+
+RenderBenchmark::RenderBenchmark(const QSize &size, QObject *parent) :
+    QObject(parent),
+    mSize(size),
+    mFrames(120),
+    mScene(new QGraphicsScene(this)),
+    mView(0),
+    mTarget(size, QImage::Format_ARGB32_Premultiplied),
+    mPixels(0)
+{
+    mScene->setSceneRect(QRectF(QPointF(0, 0), size));
+    connect(mScene, SIGNAL(changed(QList<QRectF>)), this, SLOT(onSceneChanged(QList<QRectF>)));
+}
+
+RenderBenchmark::~RenderBenchmark()
+{
+    delete mView;
+}
+
+bool RenderBenchmark::load(const QString &theme)
+{
+    Config::getInstance()->setThemepackName(theme);
+
+    ThemepackLoader loader(theme);
+    mBackgroundController = loader.desktopBackgroundController();
+    if (mWallpapers.isEmpty())
+        mWallpapers << loader.wallpaper() << Config::getInstance()->wallpaper();
+
+    mView = new PlexyDesktopView(mScene);
+    mView->resize(mSize);
+    mView->setSceneRect(mScene->sceneRect());
+    mView->layout(mScene->sceneRect());
+
+    // let the widgets finish loading before the first frame is timed
+    QCoreApplication::processEvents();
+    mDirty = QRegion();
+
+    if (widgets().isEmpty()) {
+        qWarning() << Q_FUNC_INFO << "theme" << theme << "did not load any widget";
+        return false;
+    }
+
+    return true;
+}
+
+void RenderBenchmark::setFrames(int frames)
+{
+    mFrames = qMax(1, frames);
+}
+
+void RenderBenchmark::setWallpapers(const QStringList &wallpapers)
+{
+    mWallpapers = wallpapers;
+}
+
+bool RenderBenchmark::run(const QString &scenario)
+{
+    // start every scenario from a fully painted frame
+    renderFrame(true);
+    mFrameTimes.clear();
+    mPixels = 0;
+
+    const qint64 heap = heapInUse();
+
+    if (scenario == QLatin1String("idle"))
+        idle();
+    else if (scenario == QLatin1String("drag"))
+        drag();
+    else if (scenario == QLatin1String("dock"))
+        dock();
+    else if (scenario == QLatin1String("rotate"))
+        rotate();
+    else if (scenario == QLatin1String("wallpaper"))
+        wallpaper();
+    else
+        return false;
+
+    report(scenario, heapInUse() - heap);
+    return true;
+}
+
+void RenderBenchmark::onSceneChanged(const QList<QRectF> &region)
+{
+    Q_FOREACH(const QRectF &rect, region)
+        mDirty += rect.toAlignedRect();
+}
+
+void RenderBenchmark::renderFrame(bool full)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    // deferred updates and animations run from the event loop, as in the view
+    QCoreApplication::processEvents();
+
+    const QRegion dirty = full ? QRegion(mTarget.rect()) : mDirty & mTarget.rect();
+    mDirty = QRegion();
+
+    QPainter painter(&mTarget);
+    Q_FOREACH(const QRect &rect, dirty.rects()) {
+        painter.setClipRect(rect);
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        painter.fillRect(rect, Qt::transparent);
+        painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+        mScene->render(&painter, rect, rect);
+        mPixels += rect.width() * rect.height();
+    }
+    painter.end();
+
+    mFrameTimes.append(nsecsElapsed(timer));
+}
+
+QList<AbstractDesktopWidget *> RenderBenchmark::widgets() const
+{
+    QList<AbstractDesktopWidget *> rv;
+    Q_FOREACH(QGraphicsItem *item, mScene->items()) {
+        if (item->parentItem() || item->zValue() < 0)
+            continue;
+
+        QGraphicsObject *object = item->toGraphicsObject();
+        if (AbstractDesktopWidget *widget = qobject_cast<AbstractDesktopWidget *>(object))
+            rv.append(widget);
+    }
+    return rv;
+}
+
+void RenderBenchmark::idle()
+{
+    for (int i = 0; i < mFrames; i++)
+        renderFrame(true);
+}
+
+void RenderBenchmark::drag()
+{
+    const QList<AbstractDesktopWidget *> list = widgets();
+    for (int i = 0; i < mFrames; i++) {
+        AbstractDesktopWidget *widget = list.at(i / 30 % list.count());
+        const bool start = i % 30 == 0;
+        const bool end = i % 30 == 29 || i == mFrames - 1;
+
+        if (start)
+            widget->setInMotion(true);
+        // back and forth, so the layout is the same for the next scenario
+        widget->moveBy(i % 30 < 15 ? DragStep : -DragStep, 0);
+        renderFrame();
+        if (end)
+            widget->setInMotion(false);
+    }
+}
+
+void RenderBenchmark::dock()
+{
+    const QList<AbstractDesktopWidget *> list = widgets();
+    for (int i = 0; i < mFrames; i++) {
+        AbstractDesktopWidget *widget = list.at(i / 2 % list.count());
+        widget->setState(i % 2 ? AbstractDesktopWidget::VIEW : AbstractDesktopWidget::DOCKED);
+        renderFrame();
+    }
+}
+
+void RenderBenchmark::rotate()
+{
+    const QList<AbstractDesktopWidget *> list = widgets();
+    for (int i = 0; i < mFrames; i++) {
+        AbstractDesktopWidget *widget = list.at(i / RotationSteps % list.count());
+        const int step = i % RotationSteps;
+
+        widget->setInMotion(step < RotationSteps - 1);
+        // half a turn, then snap back to the front
+        widget->setRotation(step == RotationSteps - 1 ? 0 : step * 180.0 / (RotationSteps - 1));
+        renderFrame();
+    }
+}
+
+void RenderBenchmark::wallpaper()
+{
+    ControllerPtr controller = mView->controllerByName(mBackgroundController);
+    if (!controller || mWallpapers.isEmpty()) {
+        qWarning() << Q_FUNC_INFO << "no background controller to change";
+        return;
+    }
+
+    for (int i = 0; i < mFrames; i++) {
+        QVariantMap args;
+        args[QLatin1String("background")] = mWallpapers.at(i % mWallpapers.count());
+        controller->revokeSession(args);
+        renderFrame();
+    }
+}
+
+void RenderBenchmark::report(const QString &scenario, qint64 heapDelta)
+{
+    QVector<qint64> sorted = mFrameTimes;
+    qSort(sorted);
+
+    QTextStream out(stdout);
+    out << qSetFieldWidth(10) << left << scenario << reset
+        << " frames " << sorted.count()
+        << " p50 " << percentile(sorted, 0.50) << "ms"
+        << " p90 " << percentile(sorted, 0.90) << "ms"
+        << " p99 " << percentile(sorted, 0.99) << "ms"
+        << " max " << percentile(sorted, 1.0) << "ms"
+        << " px/frame " << (sorted.isEmpty() ? 0 : mPixels / sorted.count())
+        << " heap ";
+    if (heapInUse() < 0)
+        out << "n/a";
+    else
+        out << heapDelta / 1024 << "KiB";
+    out << endl;
+
+    // QPixmapCache does not report its usage, list the caches that do
+    out << qSetFieldWidth(10) << left << "" << reset
+        << " pixmap cache limit " << QPixmapCache::cacheLimit() << "KiB"
+        << " decoded images " << DecodedImageCache::getInstance()->totalCost() / 1024 << "KiB"
+        << " shadow tiles " << ShadowItem::tileRenderCount()
+        << " nine-patches " << NinePatch::themeRenderCount()
+        << endl;
+}
+
+int main(int argc, char *argv[])
+{
+    // keep pixmaps in client memory, nothing here needs a server side surface
+    QApplication::setGraphicsSystem(QLatin1String("raster"));
+
+    const QString home = QDir::tempPath() + QLatin1String("/plexy-render-benchmark-")
+        + QString::number(QCoreApplication::applicationPid());
+    QDir().mkpath(home + QLatin1String("/.plexydesk"));
+    qputenv("HOME", QFile::encodeName(home));
+    qputenv("XDG_CONFIG_HOME", QFile::encodeName(home + QLatin1String("/.config")));
+
+    QApplication app(argc, argv);
+
+    QString theme = QLatin1String("default");
+    QString session;
+    QSize size(1920, 1080);
+    int frames = 120;
+    QStringList scenarios = QString("idle,drag,dock,rotate,wallpaper").split(QLatin1Char(','));
+    QStringList wallpapers;
+
+    const QStringList args = app.arguments();
+    for (int i = 1; i < args.count() - 1; i++) {
+        const QString &arg = args.at(i);
+        const QString value = args.at(i + 1);
+        if (arg == QLatin1String("--theme"))
+            theme = value;
+        else if (arg == QLatin1String("--session"))
+            session = value;
+        else if (arg == QLatin1String("--frames"))
+            frames = value.toInt();
+        else if (arg == QLatin1String("--size"))
+            size = QSize(value.section(QLatin1Char('x'), 0, 0).toInt(), value.section(QLatin1Char('x'), 1, 1).toInt());
+        else if (arg == QLatin1String("--scenarios"))
+            scenarios = value.split(QLatin1Char(','), QString::SkipEmptyParts);
+        else if (arg == QLatin1String("--wallpapers"))
+            wallpapers = value.split(QLatin1Char(','), QString::SkipEmptyParts);
+        else
+            continue;
+        i++;
+    }
+
+    if (!session.isEmpty() && !QFile::copy(session, home + QLatin1String("/.plexydesk/session.xml"))) {
+        qWarning() << "Can not read session" << session;
+        removeDir(home);
+        return 1;
+    }
+
+    PluginLoader::getInstanceWithPrefix(
+            QDir::toNativeSeparators(Config::getInstance()->plexydeskBasePath() +
+                QLatin1String("/share/plexy/ext/groups/")),
+            QDir::toNativeSeparators(Config::getInstance()->plexydeskBasePath() +
+                QLatin1String("/lib/plexyext/")));
+
+    int rv = 0;
+    {
+        RenderBenchmark benchmark(size.isValid() ? size : QSize(1920, 1080));
+        benchmark.setFrames(frames);
+        if (!wallpapers.isEmpty())
+            benchmark.setWallpapers(wallpapers);
+
+        if (!benchmark.load(theme)) {
+            rv = 1;
+        } else {
+            Q_FOREACH(const QString &scenario, scenarios) {
+                if (!benchmark.run(scenario)) {
+                    qWarning() << "Unknown scenario" << scenario;
+                    rv = 1;
+                }
+            }
+        }
+    }
+
+    removeDir(home);
+    return rv;
+}
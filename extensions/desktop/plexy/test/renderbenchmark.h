@@ -0,0 +1,85 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+
+#ifndef PLEXY_RENDER_BENCHMARK_H
+#define PLEXY_RENDER_BENCHMARK_H
+
+#include <QImage>
+#include <QObject>
+#include <QRegion>
+#include <QStringList>
+#include <QVector>
+
+class QGraphicsScene;
+class PlexyDesktopView;
+
+namespace PlexyDesk
+{
+class AbstractDesktopWidget;
+}
+
+/* Renders PlexyDesktopView frame by frame into a QImage, the way the view
+   would repaint its dirty region, while a script drags, docks and rotates
+   the widgets and swaps the wallpaper. Every scenario reports frame time
+   percentiles, heap growth and cache usage. */
+class RenderBenchmark : public QObject
+{
+    Q_OBJECT
+
+public:
+    RenderBenchmark(const QSize &size, QObject *parent = 0);
+    virtual ~RenderBenchmark();
+
+    bool load(const QString &theme);
+
+    void setFrames(int frames);
+    void setWallpapers(const QStringList &wallpapers);
+
+    /* idle, drag, dock, rotate and wallpaper */
+    bool run(const QString &scenario);
+
+private Q_SLOTS:
+    void onSceneChanged(const QList<QRectF> &region);
+
+private:
+    void idle();
+    void drag();
+    void dock();
+    void rotate();
+    void wallpaper();
+
+    void renderFrame(bool full = false);
+    void report(const QString &scenario, qint64 heapDelta);
+    QList<PlexyDesk::AbstractDesktopWidget *> widgets() const;
+
+    QSize mSize;
+    int mFrames;
+    QStringList mWallpapers;
+    QString mBackgroundController;
+
+    QGraphicsScene *mScene;
+    PlexyDesktopView *mView;
+    QImage mTarget;
+    QRegion mDirty;
+
+    QVector<qint64> mFrameTimes;
+    qint64 mPixels;
+};
+
+#endif
@@ -31,6 +31,8 @@
 #include <QColor>
 #include "socialqdbusplugindata.h"
 #include <QTimer>
+#include <tickscheduler.h>
+#include <decodedimagecache.h>
 namespace PlexyDesk
 {
 googleweatherWidget::googleweatherWidget (const QRectF &rect, QWidget *widget) :
@@ -38,6 +40,7 @@ googleweatherWidget::googleweatherWidget (const QRectF &rect, QWidget *widget) :
 {
     shade = 0;
     moveY = 0;
+    mPaintDecodes = 0;
     setPath(applicationDirPath() +"/theme/skins/default/widget/default/googleweather/");
     setDockImage(QPixmap(prefix + "icon.png"));
     drawWidget();
@@ -49,6 +52,9 @@ googleweatherWidget::googleweatherWidget (const QRectF &rect, QWidget *widget) :
     initTimer = 1;
     weather = new SocialQDBusPluginData();
 
+    // the forecast changes slowly, share a wake up with the other sources
+    TickScheduler::getInstance()->schedule(this, "refresh", 30*60*1000, 60*1000);
+    QTimer::singleShot(0, this, SLOT(refresh()));
 }
 googleweatherWidget::~googleweatherWidget ()
 {
@@ -58,6 +64,12 @@ void googleweatherWidget::setPath(QString str)
     prefix = str+"/";
 }
 //----------------------------------------
+void googleweatherWidget::refresh()
+{
+    initD = 0;
+    data();
+    update();
+}
 void googleweatherWidget::data()
 {
     initTimer = 0;
@@ -92,8 +104,28 @@ void googleweatherWidget::data()
             }
         }
         //unwrapping completed..
+        loadConditionImages();
     }
 }
+void googleweatherWidget::loadConditionImages()
+{
+    // decode the condition icons once per update, at the size they are drawn
+    DecodedImageCache *cache = DecodedImageCache::getInstance();
+    mCurrentImage = QImage();
+    mForecastImages.clear();
+    if (weatherValues.count() < 25)
+        return;
+
+    mCurrentImage = cache->scaled(prefix + weatherValues.at(20) + ".png",
+            QSize(100, 100), Qt::IgnoreAspectRatio);
+    for (int i = 21; i < 25; i++)
+        mForecastImages << cache->scaled(prefix + weatherValues.at(i) + ".png",
+                QSize(50, 50), Qt::IgnoreAspectRatio);
+}
+int googleweatherWidget::decodesInLastPaint() const
+{
+    return mPaintDecodes;
+}
 void googleweatherWidget::tempInCel(QPainter *p, QString temp, int x, int y, bool c, int size)
 {
     bool valid;
@@ -158,20 +190,18 @@ void googleweatherWidget::tempInCel(QPainter *p, QString temp, int x, int y, boo
 }
 void googleweatherWidget::drawSet(QPainter *p)
 {
-    QString current, humidity, temp, wind, image, curr_date;
+    QString current, humidity, temp, wind, curr_date;
     current = weatherValues.at(0);
     humidity = weatherValues.at(1);
     temp = weatherValues.at(2);
     wind = weatherValues.at(3);
     curr_date = weatherValues.at(25);
-    QStringList f_day, f_condition, f_lTemp, f_hTemp, f_image;
+    QStringList f_day, f_condition, f_lTemp, f_hTemp;
 
     f_day<<weatherValues.at(4)<<weatherValues.at(5)<<weatherValues.at(6)<<weatherValues.at(7);
     f_condition<<weatherValues.at(8)<<weatherValues.at(9)<<weatherValues.at(10)<<weatherValues.at(11);
     f_lTemp<<weatherValues.at(12)<<weatherValues.at(13)<<weatherValues.at(14)<<weatherValues.at(15);
     f_hTemp<<weatherValues.at(16)<<weatherValues.at(17)<<weatherValues.at(18)<<weatherValues.at(19);
-    f_image<<weatherValues.at(21)<<weatherValues.at(22)<<weatherValues.at(23)<<weatherValues.at(24);
-    image = weatherValues.at(20);
 
 
     p->setPen(QColor(255, 255, 255, 255));
@@ -196,7 +226,7 @@ void googleweatherWidget::drawSet(QPainter *p)
         p->drawText(clip.x()+250, view.y()+130, humidity);
         p->drawText(clip.x()+250, view.y()+145, wind);
         tempInCel(p, temp, 10, 120, true, 35);
-        p->drawImage(QRect(clip.x()+140, view.y()+55, 100, 100), QImage(prefix+image+".png"));
+        p->drawImage(QRect(clip.x()+140, view.y()+55, 100, 100), mCurrentImage);
         //-----------end of current conditions-----------
 
         //////////////// forecst information //////////////////////
@@ -219,7 +249,7 @@ void googleweatherWidget::drawSet(QPainter *p)
             p->setPen(QColor(56, 193, 124));
             p->drawText(clip.x()+70+(i-1)*130, view.y()+280, "Highest");
             tempInCel(p, f_hTemp.at(i), 70+(i-1)*130, 300, false, 10);
-            p->drawImage(QRect(clip.x()+20+(i-1)*130, view.y()+200, 50, 50), QImage(prefix+f_image.at(i)+".png"));
+            p->drawImage(QRect(clip.x()+20+(i-1)*130, view.y()+200, 50, 50), mForecastImages.value(i));
         }
 
         ///////////////// forecast information ///////////////////////
@@ -261,8 +291,8 @@ QString googleweatherWidget::getDay(QString day)
 }
 void googleweatherWidget::drawWidget()
 {
-    widgetBack = QImage (prefix + "background.png");
-    w_ImageDock = QImage (prefix + "weatherDock.png");
+    widgetBack = DecodedImageCache::getInstance()->image(prefix + "background.png");
+    w_ImageDock = DecodedImageCache::getInstance()->image(prefix + "weatherDock.png");
 }
 //---------------------------------------------------------------------
 void googleweatherWidget::drawItems()
@@ -274,6 +304,7 @@ void googleweatherWidget::setCity_UI(QPainter *p)
 }
 void googleweatherWidget::paintExtFace(QPainter *p, const QStyleOptionGraphicsItem *e, QWidget *widget)
 {
+    const int decodes = DecodedImageCache::getInstance()->decodeCount();
     QRectF r = e->exposedRect;
     p->setCompositionMode(QPainter::CompositionMode_Source);
     p->fillRect(rect(), Qt::transparent);
@@ -287,20 +318,12 @@ void googleweatherWidget::paintExtFace(QPainter *p, const QStyleOptionGraphicsIt
     //setCity_UI(p);
     drawSet(p);
     initTimer = 1;
+    mPaintDecodes = DecodedImageCache::getInstance()->decodeCount() - decodes;
 }
 void googleweatherWidget::paintExtDockFace(QPainter *p, const QStyleOptionGraphicsItem *e, QWidget *)
 {
     p->setRenderHints(QPainter::SmoothPixmapTransform |QPainter::Antialiasing |QPainter::HighQualityAntialiasing);
     p->setPen(QColor(15, 10, 220));
     p->setFont(QFont("Bitstream Charter", 12));
-    initD = 0;
-    if (DS_EXTF == 0 && initTimer == 1)
-    {
-        QTimer::singleShot(200, this, SLOT(data()));
-        //data();
-    }
-    else
-        DS_EXTF = 0;
-
 }
 }
@@ -39,20 +39,28 @@ public:
     void paintExtDockFace(QPainter *painter, const QStyleOptionGraphicsItem *, QWidget *);
     void setPath(QString);
     void drawWidget();
+
+    /* images decoded by the last paint, should stay 0 */
+    int decodesInLastPaint() const;
 public slots:
     void drawItems();
     void data();
+    void refresh();
 private:
     void tempInCel(QPainter *p, QString temp, int x, int y, bool c, int size);
     QString getDay(QString);
     void drawSet(QPainter *p);
     void setCity_UI(QPainter *p);
+    void loadConditionImages();
     QRectF clip;
     QRectF view;
     int shade;
     int moveY;
     QImage widgetBack;
     QImage w_ImageDock;
+    QImage mCurrentImage;
+    QList<QImage> mForecastImages;
+    int mPaintDecodes;
     QVariantMap weatherdata;
     SocialQDBusPluginData *weather;
     QStringList weatherKeys;
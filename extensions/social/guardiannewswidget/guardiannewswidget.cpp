@@ -1,6 +1,7 @@
 #include "guardiannewswidget.h"
 #include "socialqdbusplugindata.h"
 #include <pluginloader.h>
+#include <decodedimagecache.h>
 #include <QDate>
 #include <QPushButton>
 #include <QLineEdit>
@@ -58,6 +59,7 @@ GuardianNews::GuardianNews(QObject *object)
     base->move(20, 20);
     settings = this->makeLabel(10, 10, 440, 320, base);
     reported = false;
+    lastDrawDecodes = 0;
     newsParent = this->makeLabel(10, 10, 416, 630, 1.0);
     newsScroll = this->makeQScrollArea(2, 2, 416, 296, false, true, newsParent, base);
     //Default display activation
@@ -130,8 +132,33 @@ void GuardianNews::update()
         reported = false;
     //unwrapping completed..
     content_ID.clear();
+    layoutBodies();
 
 }
+void GuardianNews::layoutBodies()
+{
+    // decode every article image once, at the size it is shown, and work
+    // out the page heights here so drawBody never touches the disk
+    PlexyDesk::DecodedImageCache *cache = PlexyDesk::DecodedImageCache::getInstance();
+    bodyHeight.clear();
+    for (int i = 0; i < body.size(); i++)
+    {
+        QImage image;
+        if (image_Url.at(i) != "Invalid Content")
+            image = cache->scaled(image_Url.at(i), QSize(376, 376));
+
+        if (body.at(i) == "")
+            bodyHeight << 400;
+        else if (!image.isNull())
+            bodyHeight << 22*(((body.at(i).length())/60)+1)+image.height();
+        else
+            bodyHeight << 22*(((body.at(i).length())/60)+1)+60;
+    }
+}
+int GuardianNews::decodesInLastDraw() const
+{
+    return lastDrawDecodes;
+}
 void GuardianNews::drawLabels()
 {
     //qDebug()<<"drawing the labels";
@@ -221,16 +248,11 @@ void GuardianNews::bodyActivator(QString link)
 }
 void GuardianNews::drawBody(int i)
 {
-    int h;
-    if (body.at(i) != "") {
-        if (!QImage(image_Url.at(i)).isNull())
-            h = 22*(((body.at(i).length())/60)+1)+QImage(image_Url.at(i)).height();
-        else
-            h = 22*(((body.at(i).length())/60)+1)+60;
-    }
-    else{
-        h = 400;
-    }
+    PlexyDesk::DecodedImageCache *cache = PlexyDesk::DecodedImageCache::getInstance();
+    const int decodes = cache->decodeCount();
+    if (bodyHeight.size() != body.size())
+        layoutBodies();
+    int h = bodyHeight.at(i);
     newsScroll->hide();
     bodyParent = this->makeLabel(0, 0, 416, h, 1.0);
     newsScroll = this->makeQScrollArea(2, 2, 416, 296, false, true, bodyParent, base);
@@ -244,8 +266,7 @@ void GuardianNews::drawBody(int i)
     int local_y;
     if (image_Url.at(i) != "Invalid Content")
     {
-        QPixmap image = QPixmap::fromImage(QImage(image_Url.at(i)));
-        image = image.scaled(376, 376, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        QPixmap image = QPixmap::fromImage(cache->scaled(image_Url.at(i), QSize(376, 376)));
         body_P->setPixmap(image);
         local_y = image.height()+80;
     }
@@ -284,6 +305,7 @@ void GuardianNews::drawBody(int i)
     newsScroll->show();
 
     connect(body_b, SIGNAL(linkActivated(QString)), this, SLOT(bodyActivator(QString)));
+    lastDrawDecodes = cache->decodeCount() - decodes;
 }
 void GuardianNews::showCaptions()
 {
@@ -300,6 +322,7 @@ void GuardianNews::guardianSettings()
     webUrl.clear();
     doc_Type.clear();
     image_Url.clear();
+    bodyHeight.clear();
     ///---------clearing
     newsScroll->hide();
     newsParent->hide();
@@ -308,8 +331,8 @@ void GuardianNews::guardianSettings()
     base->move(0, 0);
     base->resize(460, 340);
     QLabel *banner = this->makeLabel(0, -65, 440, 200, settings);
-    QPixmap ban = QPixmap(imagePath+"banner.png");
-    ban = ban.scaled(440, 200, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    QPixmap ban = QPixmap::fromImage(PlexyDesk::DecodedImageCache::getInstance()->scaled(
+                imagePath+"banner.png", QSize(440, 200)));
     banner->setPixmap(ban);
     keyWord = new QLineEdit();
     QLabel *lbl = new QLabel();
@@ -26,6 +26,9 @@ public:
     virtual ~GuardianNews();
     virtual QGraphicsItem *item();     // {};
 
+    /* images decoded while drawing the last article, should stay 0 */
+    int decodesInLastDraw() const;
+
 public slots:
     void update();
     void bodyActivator(QString link);
@@ -45,8 +48,11 @@ private:
     bool reported;
     SocialQDBusPluginData *reporter;
     PlexyDesk::GuardianNewsWidget *widget;
+    QList<int> bodyHeight;
+    int lastDrawDecodes;
     //-------------private methods
     void drawLabels();
+    void layoutBodies();
     void drawBody(int i);
     void showCaptions();
     void resetBase();
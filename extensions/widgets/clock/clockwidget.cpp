@@ -30,14 +30,21 @@
 #include <QStyleOptionGraphicsItem>
 #include <QDateTime>
 #include <QDir>
+#include <QtCore/qmath.h>
 #include <plexyconfig.h>
 #include <svgprovider.h>
 
 ClockWidget::ClockWidget(const QRectF &rect)
-    : PlexyDesk::DesktopWidget(rect)
+    : PlexyDesk::DesktopWidget(rect),
+      mSecondValue(0.0),
+      mMinutesValue(0.0),
+      mHourValue(0.0),
+      mLayerScale(0.0)
 {
     setLabelName ("Clock");
     preRenderClockImages();
+
+    connect(PlexyDesk::Config::getInstance(), SIGNAL(themepackNameChanged()), this, SLOT(onThemeChanged()));
 }
 
 void ClockWidget::preRenderClockImages()
@@ -56,82 +63,155 @@ void ClockWidget::preRenderClockImages()
     delete svg;
 }
 
-void ClockWidget::updateTime(const QVariantMap &data)
+void ClockWidget::onThemeChanged()
 {
-    QTime time = data["currentTime"].toTime();
-    mSecondValue = 6.0 * time.second();
-    mMinutesValue = 6.0 * time.minute();
-    mHourValue = 30.0 * time.hour();
+    preRenderClockImages();
 
+    mFaceLayer = QPixmap();
+    mGlassLayer = QPixmap();
     update();
 }
 
+void ClockWidget::updateTime(const QVariantMap &data)
+{
+    QTime time = data["currentTime"].toTime();
+    const double second = 6.0 * time.second();
+    const double minute = 6.0 * time.minute();
+    const double hour = 30.0 * time.hour();
+
+    if (state() != VIEW) {
+        /* the rotated view prints the time as text, repaint it all */
+        mSecondValue = second;
+        mMinutesValue = minute;
+        mHourValue = hour;
+        update();
+        return;
+    }
+
+    /* only the hands that moved need repainting, old and new position */
+    if (second != mSecondValue) {
+        update(handRect(mClockSecondHand, mSecondValue, true));
+        mSecondValue = second;
+        update(handRect(mClockSecondHand, mSecondValue, true));
+    }
+
+    if (minute != mMinutesValue) {
+        update(handRect(mClockMinuteHand, mMinutesValue, false));
+        mMinutesValue = minute;
+        update(handRect(mClockMinuteHand, mMinutesValue, false));
+    }
+
+    if (hour != mHourValue) {
+        update(handRect(mClockHourHand, mHourValue, true));
+        mHourValue = hour;
+        update(handRect(mClockHourHand, mHourValue, true));
+    }
+}
+
 ClockWidget::~ClockWidget()
 {
 }
 
-void ClockWidget::paintFrontView(QPainter *p, const QRectF &r)
+QRectF ClockWidget::handRect(const QPixmap &hand, double angle, bool shadow) const
 {
-    p->setRenderHints(QPainter::SmoothPixmapTransform | QPainter::Antialiasing | QPainter::HighQualityAntialiasing);
-    p->setCompositionMode(QPainter::CompositionMode_Source);
-    p->fillRect(r, Qt::transparent);
-    p->setBackgroundMode(Qt::TransparentMode);
+    const QRectF bounds = boundingRect();
+    const float scaleFactorHorizontal = contentRect().width() / bounds.width();
+    const float scaleFactorVerticle = contentRect().height() / bounds.height();
 
-    p->drawPixmap(r.x(), r.y(), r.width(), r.height(), mClockBackFace);
-    float scaleFactorHorizontal = contentRect().width() / boundingRect().width();
-    float scaleFactorVerticle = contentRect().height() / boundingRect().height();
+    QRectF handArea(-(hand.width() / 2), 0, hand.width() / scaleFactorHorizontal, hand.height() / scaleFactorVerticle);
+    if (shadow)
+        handArea.adjust(0, 0, 2, 2);
 
-    /* Draw Minute Hand */
-    p->save();
-    p->setCompositionMode(QPainter::CompositionMode_SourceOver);
-    p->setRenderHint(QPainter::Antialiasing);
-    p->setRenderHint(QPainter::SmoothPixmapTransform);
-    p->translate( r.x() + (r.width() / 2), r.y() + (r.height() / 2));
-    p->rotate(180 + mMinutesValue);
-    p->drawPixmap(-(mClockMinuteHand.width() / 2) , 0, mClockMinuteHand.width() / scaleFactorHorizontal, mClockMinuteHand.height() / scaleFactorVerticle, mClockMinuteHand);
-    p->restore();
+    QTransform transform;
+    transform.translate(bounds.center().x(), bounds.center().y());
+    transform.rotate(180 + angle);
 
-    /* Draw Hour Hand */
-    p->save();
-    p->setCompositionMode(QPainter::CompositionMode_SourceOver);
-    p->setRenderHint(QPainter::Antialiasing);
-    p->setRenderHint(QPainter::SmoothPixmapTransform);
-    p->translate( r.x() + (r.width() / 2), r.y() + (r.height() / 2));
-    p->rotate(180 + mHourValue);
-    p->drawPixmap(-(mClockHourHand.width() / 2) , 0, mClockHourHand.width() / scaleFactorHorizontal, mClockHourHand.height() / scaleFactorVerticle, mClockHourHand);
-    p->setOpacity(0.2);
-    p->drawPixmap(-(mClockHourHand.width() / 2) + 2 , 2, mClockHourHand.width() / scaleFactorHorizontal, mClockHourHand.height() / scaleFactorVerticle, mClockHourHand);
-    p->restore();
+    /* leave room for the antialiased edge */
+    return transform.mapRect(handArea).adjusted(-2, -2, 2, 2);
+}
 
-    /* Draw Second Hand */
-    p->save();
-    p->setRenderHint(QPainter::Antialiasing);
-    p->setRenderHint(QPainter::SmoothPixmapTransform);
-    p->setCompositionMode(QPainter::CompositionMode_SourceOver);
-    p->translate( r.x() + (r.width() / 2), r.y() + (r.height() / 2));
-    p->rotate(180 + mSecondValue);
-    p->drawPixmap( -(mClockSecondHand.width() / 2) , 0 , mClockSecondHand.width() / scaleFactorHorizontal, mClockSecondHand.height() / scaleFactorVerticle, mClockSecondHand);
-    p->setOpacity(0.3);
-    p->drawPixmap( -(mClockSecondHand.width() / 2) + 2 , 2 , mClockSecondHand.width() / scaleFactorHorizontal, mClockSecondHand.height() / scaleFactorVerticle, mClockSecondHand);
-    p->restore();
+bool ClockWidget::ensureLayers(QPainter *p)
+{
+    const QSizeF size = boundingRect().size();
+    const QTransform device = p->deviceTransform();
+
+    /* cache at device resolution, but never blow up during zoom animations */
+    const qreal scale = qBound(qreal(1.0), qSqrt(device.m11() * device.m11() + device.m12() * device.m12()), qreal(4.0));
+
+    if (!mFaceLayer.isNull() && mLayerSize == size && qFuzzyCompare(mLayerScale, scale))
+        return true;
+
+    const QSize pixelSize = (size * scale).toSize();
+    if (pixelSize.isEmpty())
+        return false;
+
+    mLayerSize = size;
+    mLayerScale = scale;
+
+    const float scaleFactorHorizontal = contentRect().width() / size.width();
+    const float scaleFactorVerticle = contentRect().height() / size.height();
+    const QPointF center(size.width() / 2, size.height() / 2);
+
+    mFaceLayer = QPixmap(pixelSize);
+    mFaceLayer.fill(Qt::transparent);
+    QPainter face(&mFaceLayer);
+    face.setRenderHints(QPainter::SmoothPixmapTransform | QPainter::Antialiasing);
+    face.scale(scale, scale);
+    face.drawPixmap(QRectF(QPointF(0, 0), size), mClockBackFace, mClockBackFace.rect());
+    face.end();
+
+    /* the screw and the glass sit above the hands */
+    mGlassLayer = QPixmap(pixelSize);
+    mGlassLayer.fill(Qt::transparent);
+    QPainter glass(&mGlassLayer);
+    glass.setRenderHints(QPainter::SmoothPixmapTransform | QPainter::Antialiasing);
+    glass.scale(scale, scale);
+    glass.translate(center);
+    glass.drawPixmap(QRectF(-(mClockScrew.width() / 2), -(mClockScrew.height() / 2), mClockScrew.width() / scaleFactorHorizontal, mClockScrew.height() / scaleFactorVerticle), mClockScrew, mClockScrew.rect());
+    glass.drawPixmap(QRectF(-(mClockGlass.width() / 2), -(mClockGlass.height() / 2), mClockGlass.width() / scaleFactorHorizontal, mClockGlass.height() / scaleFactorVerticle), mClockGlass, mClockGlass.rect());
+    glass.end();
+
+    return true;
+}
+
+void ClockWidget::paintHand(QPainter *p, const QPixmap &hand, double angle, qreal shadowOpacity)
+{
+    const QRectF bounds = boundingRect();
+    const float scaleFactorHorizontal = contentRect().width() / bounds.width();
+    const float scaleFactorVerticle = contentRect().height() / bounds.height();
 
-    /* Draw the Clock Screw  */
     p->save();
-    p->setRenderHint(QPainter::Antialiasing);
-    p->setRenderHint(QPainter::SmoothPixmapTransform);
-    p->setCompositionMode(QPainter::CompositionMode_SourceOver);
-    p->translate(r.x() + (r.width() / 2) , r.y() + (r.height() / 2));
-    p->drawPixmap( -(mClockScrew.width() / 2) , -(mClockScrew.height() / 2), mClockScrew.width() / scaleFactorHorizontal, mClockScrew.height() / scaleFactorVerticle, mClockScrew);
+    p->translate(bounds.center());
+    p->rotate(180 + angle);
+    p->drawPixmap(-(hand.width() / 2) , 0, hand.width() / scaleFactorHorizontal, hand.height() / scaleFactorVerticle, hand);
+    if (shadowOpacity > 0.0) {
+        p->setOpacity(shadowOpacity);
+        p->drawPixmap(-(hand.width() / 2) + 2 , 2, hand.width() / scaleFactorHorizontal, hand.height() / scaleFactorVerticle, hand);
+    }
     p->restore();
+}
 
-    /* Draw Glass */
-    p->save();
-    p->setRenderHint(QPainter::Antialiasing);
-    p->setRenderHint(QPainter::SmoothPixmapTransform);
+void ClockWidget::paintFrontView(QPainter *p, const QRectF &r)
+{
+    p->setRenderHints(QPainter::SmoothPixmapTransform | QPainter::Antialiasing | QPainter::HighQualityAntialiasing);
+    p->setCompositionMode(QPainter::CompositionMode_Source);
+    p->fillRect(r, Qt::transparent);
     p->setCompositionMode(QPainter::CompositionMode_SourceOver);
-    p->translate(r.x() + (r.width() / 2) , r.y() + (r.height() / 2));
-    p->drawPixmap( -(mClockGlass.width() / 2) , -(mClockGlass.height() / 2), mClockGlass.width() / scaleFactorHorizontal, mClockGlass.height() / scaleFactorVerticle, mClockGlass);
-    p->restore();
+    p->setBackgroundMode(Qt::TransparentMode);
+
+    /* r is only the exposed part, lay the dial out on the whole item */
+    const QRectF bounds = boundingRect();
+    const bool layers = ensureLayers(p);
+
+    if (layers)
+        p->drawPixmap(bounds, mFaceLayer, mFaceLayer.rect());
+
+    paintHand(p, mClockMinuteHand, mMinutesValue, 0.0);
+    paintHand(p, mClockHourHand, mHourValue, 0.2);
+    paintHand(p, mClockSecondHand, mSecondValue, 0.3);
+
+    if (layers)
+        p->drawPixmap(bounds, mGlassLayer, mGlassLayer.rect());
 }
 
 void ClockWidget::paintDockView(QPainter *p, const QRectF &rect)
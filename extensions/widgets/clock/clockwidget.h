@@ -39,8 +39,14 @@ public:
 
     void updateTime(const QVariantMap &data);
 
+private Q_SLOTS:
+    void onThemeChanged();
+
 private:
     void preRenderClockImages();
+    bool ensureLayers(QPainter *p);
+    void paintHand(QPainter *p, const QPixmap &hand, double angle, qreal shadowOpacity);
+    QRectF handRect(const QPixmap &hand, double angle, bool shadow) const;
 
     double mSecondValue;
     double mMinutesValue;
@@ -54,6 +60,11 @@ private:
     QPixmap mClockScrew;
     QPixmap mClockGlass;
 
+    /* static layers cached at device resolution */
+    QPixmap mFaceLayer;
+    QPixmap mGlassLayer;
+    QSizeF mLayerSize;
+    qreal mLayerScale;
 };
 #endif
 
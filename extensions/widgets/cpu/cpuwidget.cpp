@@ -20,14 +20,17 @@
 #include <plexy.h>
 #include <config.h>
 #include "cpuwidget.h"
+#include <pluginloader.h>
 #include <QtCore>
 #include <QtGui>
 
 CpuWidget::CpuWidget(const QRectF &rect, QWidget *widget) :
-    PlexyDesk::AbstractDesktopWidget(rect, widget)
+    PlexyDesk::AbstractDesktopWidget(rect, widget),
+    mLayerScale(0.0),
+    mValueFont("Bitstream Charter", 12, QFont::Bold),
+    mLabelFont("Bitstream Charter", 10, QFont::Bold)
 {
-    shade = false;
-    getBaseData();
+    percen = 0;
 
     setPath("/usr/share/plexy/skins/default/cpu/");
     setDockBackground(QPixmap(prefix + "icon.png"));
@@ -37,10 +40,16 @@ CpuWidget::CpuWidget(const QRectF &rect, QWidget *widget) :
 void CpuWidget::setPath(QString str)
 {
     prefix = str + "/";
+
+    /* a new skin invalidates the cached layers */
+    if (!_cpu_bg.isNull()) {
+        loadImages();
+        update();
+    }
 }
 
 void
-CpuWidget::drawCpuWidget()
+CpuWidget::loadImages()
 {
     _cpu_bg = QImage(prefix + "background.png");
 
@@ -50,44 +59,138 @@ CpuWidget::drawCpuWidget()
     thedot = QPixmap(prefix + "dot.png");
 
     _meter_hand = QPixmap().fromImage(QImage(prefix + "needle.png"));
-    meter_timer = new QTimer(this);
-    connect(meter_timer, SIGNAL(timeout()), this, SLOT(drawMeter()));
-    meter_timer->start(1500);
+
+    mBackgroundLayer = QPixmap();
+    mGlossLayer = QPixmap();
+}
+
+void
+CpuWidget::drawCpuWidget()
+{
+    loadImages();
+
+    // the metrics engine samples /proc once for every widget that asks
+    metrics = PlexyDesk::PluginLoader::getInstance()->engine("metricsengine");
+    if (!metrics) {
+        qDebug() << Q_FUNC_INFO << "metricsengine not available";
+        return;
+    }
+
+    QVariantMap args;
+    args["interval"] = 1500;
+    metrics->setArguments(args);
+    connect(metrics.data(), SIGNAL(sourceUpdated(QVariantMap)), this, SLOT(onMetricsUpdated(QVariantMap)));
 }
 
 
 CpuWidget::~CpuWidget()
 {
+}
+
+void
+CpuWidget::viewActivityChanged(bool active)
+{
+    /* no controller here, the sampler stops once none of its sources is shown */
+    if (!metrics)
+        return;
+
+    QVariantMap args;
+    args["paused"] = !active;
+    metrics->setArguments(args);
+}
+
+
+QRectF
+CpuWidget::needleRect(double value) const
+{
+    QTransform transform;
+    transform.translate(_cpu_bg.width() / 2, _cpu_bg.width() / 2);
+    transform.rotate(230 + (2.6*value));
 
+    const QRectF needle(-(ceil(_meter_hand.width() / 2)), -(_meter_hand.height() - 15),
+                        _meter_hand.width(), _meter_hand.height());
+
+    /* leave room for the smoothed edge */
+    return transform.mapRect(needle).adjusted(-2, -2, 2, 2);
 }
 
 
 void
-CpuWidget::drawMeter()
+CpuWidget::onMetricsUpdated(const QVariantMap &data)
+{
+    if (!data.contains("cpu"))
+        return;
+
+    const double value = qRound(data["cpu"].toDouble());
+    if (value == percen)
+        return;
+
+    /* repaint the old and the new needle plus the reading, nothing else */
+    update(needleRect(percen));
+    percen = value;
+    update(needleRect(percen));
+    update(QRectF(70, 108, 64, 64));
+}
+
+
+bool
+CpuWidget::ensureLayers(QPainter *p)
 {
-    update();
-    getNxtData();
+    const QTransform device = p->deviceTransform();
+
+    /* cache at device resolution, but never blow up during zoom animations */
+    const qreal scale = qBound(qreal(1.0), qSqrt(device.m11() * device.m11() + device.m12() * device.m12()), qreal(4.0));
+
+    if (!mBackgroundLayer.isNull() && qFuzzyCompare(mLayerScale, scale))
+        return true;
+
+    if (_cpu_bg.isNull())
+        return false;
+
+    mLayerScale = scale;
+
+    const QSize pixelSize = (QSizeF(_cpu_bg.size()) * scale).toSize();
+
+    mBackgroundLayer = QPixmap(pixelSize);
+    mBackgroundLayer.fill(Qt::transparent);
+    QPainter bg(&mBackgroundLayer);
+    bg.setRenderHint(QPainter::SmoothPixmapTransform);
+    bg.scale(scale, scale);
+    bg.drawImage(QPointF(0, 0), _cpu_bg);
+    bg.end();
+
+    /* the dot, the gloss and the label sit above the needle */
+    mGlossLayer = QPixmap(pixelSize);
+    mGlossLayer.fill(Qt::transparent);
+    QPainter top(&mGlossLayer);
+    top.setRenderHints(QPainter::SmoothPixmapTransform | QPainter::Antialiasing | QPainter::HighQualityAntialiasing);
+    top.scale(scale, scale);
+    top.drawPixmap(QRect(_cpu_bg.width() / 2 - thedot.width() / 2, _cpu_bg.width() / 2 - thedot.height() / 2,
+                         thedot.width(), thedot.height()), thedot);
+    top.drawImage(QRect(10, 10, gloss.width(), gloss.height()), gloss);
+    top.setPen(QColor(255, 255, 255));
+    top.setFont(mLabelFont);
+    top.drawText(QRect(70, 130, 64, 64), Qt::AlignCenter, "CPU");
+    top.end();
+
+    return true;
 }
 
 
 void
 CpuWidget::paintExtFace(QPainter *p, const QStyleOptionGraphicsItem *e, QWidget *)
 {
-
     QRectF r = e->exposedRect;
     p->setCompositionMode(QPainter::CompositionMode_Source);
     p->fillRect(r, Qt::transparent);
-
-    p->drawImage(QRect(0, 0, _cpu_bg.width(), _cpu_bg.height()), _cpu_bg);
     p->setCompositionMode(QPainter::CompositionMode_SourceOver);
     p->setBackgroundMode(Qt::TransparentMode);
-    p->save();
-    p->setRenderHint(QPainter::SmoothPixmapTransform);
-    if (shade == 0) {
-        p->drawPixmap(_cpu_bg.rect(), QPixmap().fromImage(_cpu_bg));
-        shade = 1;
-    }
-    p->restore();
+
+    const bool layers = ensureLayers(p);
+    const QRectF layerRect(0, 0, _cpu_bg.width(), _cpu_bg.height());
+
+    if (layers)
+        p->drawPixmap(layerRect, mBackgroundLayer, mBackgroundLayer.rect());
 
     /*Draw Needle*/
 
@@ -101,30 +204,14 @@ CpuWidget::paintExtFace(QPainter *p, const QStyleOptionGraphicsItem *e, QWidget
              _meter_hand.height()), _meter_hand);
     p->restore();
 
-    p->save();
-
-    p->translate(_cpu_bg.width() / 2, _cpu_bg.width() / 2);
-    p->drawPixmap(QRect
-             (-(thedot.width() / 2), -(thedot.height() / 2),
-             thedot.width(), thedot.height()), QPixmap(thedot));
-    p->restore();
-
-    p->drawPixmap(QRect(10, 10, gloss.width(), gloss.height()),
-         QPixmap().fromImage(gloss));
-
-    p->save();
-
-    p->restore();
+    if (layers)
+        p->drawPixmap(layerRect, mGlossLayer, mGlossLayer.rect());
 
     p->setRenderHints(QPainter::SmoothPixmapTransform | QPainter::Antialiasing | QPainter::HighQualityAntialiasing);
 
     p->setPen(QColor(16, 90, 147));
-    p->setFont(QFont("Bitstream Charter", 12, QFont::Bold));
+    p->setFont(mValueFont);
     p->drawText(QRect(70, 108, 64, 64), Qt::AlignCenter, QString("%1").arg(percen) + "%");
-
-    p->setPen(QColor(255, 255, 255));
-    p->setFont(QFont("Bitstream Charter", 10, QFont::Bold));
-    p->drawText(QRect(70, 130, 64, 64), Qt::AlignCenter, "CPU");
 }
 
 
@@ -137,50 +224,3 @@ CpuWidget::paintExtDockFace(QPainter *p, const QStyleOptionGraphicsItem *e, QWid
        p->setFont(QFont("Bitstream Charter",15));
        p->drawText(QRect(8,5,64,64), Qt::AlignCenter ,"Cpu\n"+QString("%1").arg(percen)+"%" );*/
 }
-
-void
-CpuWidget::getBaseData()
-{
-    QFile file("/proc/stat");
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        qDebug() << "Error opening /proc/stat !";
-        return;
-    }
-
-    QTextStream in(&file);
-    QString line = in.readLine();
-
-    QStringList cpu_list = line.split(" ");
-
-    user_a = cpu_list.at(2).toLong();
-    nice_a = cpu_list.at(3).toLong();
-    sys_a = cpu_list.at(4).toLong();
-    idle_a = cpu_list.at(5).toLong();
-}
-
-void
-CpuWidget::getNxtData()
-{
-    QFile file("/proc/stat");
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        qDebug() << "Error opening /proc/stat !";
-        return;
-    }
-
-    QTextStream in(&file);
-    QString line = in.readLine();
-
-    QStringList cpu_list = line.split(" ");
-
-    user_b = cpu_list.at(2).toLong();
-    nice_b = cpu_list.at(3).toLong();
-    sys_b = cpu_list.at(4).toLong();
-    idle_b = cpu_list.at(5).toLong();
-
-    usage = (user_b - user_a) + (nice_b - nice_a) + (sys_b - sys_a);
-    total = usage + (idle_b - idle_a);
-
-    percen = (100 * usage) / total;
-
-    getBaseData();
-}
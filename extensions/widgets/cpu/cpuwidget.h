@@ -22,10 +22,9 @@
 
 #include <QtCore>
 #include <QtGui>
+#include <datasource.h>
 #include <desktopwidget.h>
 
-class QTimer;
-
 class CpuWidget : public PlexyDesk::AbstractDesktopWidget
 {
 
@@ -39,36 +38,35 @@ public:
     void paintExtDockFace(QPainter *painter, const QStyleOptionGraphicsItem *, QWidget *);
     void setPath(QString);
     void drawCpuWidget();
-    void getBaseData();
-    void getNxtData();
 
 public Q_SLOTS:
-    void drawMeter();
+    void onMetricsUpdated(const QVariantMap &data);
 
-private:
-    QTimer *meter_timer;
-    long user_a;
-    long nice_a;
-    long sys_a;
-    long idle_a;
+protected:
+    virtual void viewActivityChanged(bool active);
 
-    long user_b;
-    long nice_b;
-    long sys_b;
-    long idle_b;
+private:
+    void loadImages();
+    bool ensureLayers(QPainter *p);
+    QRectF needleRect(double value) const;
 
-    long usage;
-    long total;
+    QSharedPointer<PlexyDesk::DataSource> metrics;
 
     double percen;
 
-    int shade;
-
     QPixmap _meter_hand;
     QPixmap thedot;
     QImage _cpu_bg;
     QImage gloss;
 
+    /* static layers cached at device resolution */
+    QPixmap mBackgroundLayer;
+    QPixmap mGlossLayer;
+    qreal mLayerScale;
+
+    QFont mValueFont;
+    QFont mLabelFont;
+
     QString prefix;
     QPoint clickPos;
 };
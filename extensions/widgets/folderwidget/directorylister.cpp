@@ -0,0 +1,81 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+
+#include "directorylister.h"
+
+#include <QDir>
+#include <QDirIterator>
+
+/* entries read per event loop pass, each pass is reported as one found() */
+static const int ChunkSize = 128;
+
+DirectoryLister::DirectoryLister(QObject *parent) : QObject(parent),
+    mIterator(0),
+    mGeneration(0),
+    mCount(0)
+{
+}
+
+DirectoryLister::~DirectoryLister()
+{
+    delete mIterator;
+}
+
+void DirectoryLister::list(const QString &directory, int generation)
+{
+    stop();
+
+    mGeneration = generation;
+    mIterator = new QDirIterator(directory, QDir::NoDotAndDotDot | QDir::Files | QDir::Dirs);
+    QMetaObject::invokeMethod(this, "listChunk", Qt::QueuedConnection, Q_ARG(int, mGeneration));
+}
+
+void DirectoryLister::stop()
+{
+    delete mIterator;
+    mIterator = 0;
+    mCount = 0;
+}
+
+void DirectoryLister::listChunk(int generation)
+{
+    // a chunk queued for an older listing
+    if (!mIterator || generation != mGeneration)
+        return;
+
+    QStringList names;
+    for (int i = 0; i < ChunkSize && mIterator->hasNext(); i++) {
+        mIterator->next();
+        // the iterator already has the stat data, isDir() costs nothing here
+        const QFileInfo info = mIterator->fileInfo();
+        names.append(info.isDir() ? info.fileName() + QLatin1Char('/') : info.fileName());
+    }
+
+    mCount += names.count();
+    if (!names.isEmpty())
+        Q_EMIT found(mGeneration, names);
+
+    if (!mIterator->hasNext()) {
+        Q_EMIT finished(mGeneration, mCount);
+        stop();
+        return;
+    }
+
+    QMetaObject::invokeMethod(this, "listChunk", Qt::QueuedConnection, Q_ARG(int, mGeneration));
+}
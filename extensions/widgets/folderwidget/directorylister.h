@@ -0,0 +1,57 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+
+#ifndef DIRECTORY_LISTER_H
+#define DIRECTORY_LISTER_H
+
+#include <QObject>
+#include <QStringList>
+
+class QDirIterator;
+
+/* Reads a directory on a worker thread, a chunk of entries per event
+   loop pass, so the icon grid can show the first icons of a huge folder
+   straight away. Folder names in found() carry a trailing '/'. */
+class DirectoryLister : public QObject
+{
+    Q_OBJECT
+
+public:
+    DirectoryLister(QObject *parent = 0);
+    virtual ~DirectoryLister();
+
+public Q_SLOTS:
+    /* drops any running listing, generation is echoed back in found() */
+    void list(const QString &directory, int generation);
+    void stop();
+
+Q_SIGNALS:
+    void found(int generation, const QStringList &names);
+    void finished(int generation, int count);
+
+private Q_SLOTS:
+    void listChunk(int generation);
+
+private:
+    QDirIterator *mIterator;
+    int mGeneration;
+    int mCount;
+};
+
+#endif
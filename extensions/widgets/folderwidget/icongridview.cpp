@@ -0,0 +1,400 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+
+#include "icongridview.h"
+#include "directorylister.h"
+
+#include <QApplication>
+#include <QDir>
+#include <QFileIconProvider>
+#include <QFileInfo>
+#include <QFontMetrics>
+#include <QGraphicsSceneMouseEvent>
+#include <QHash>
+#include <QPainter>
+#include <QPixmapCache>
+#include <QThread>
+
+#include <algorithm>
+
+static const int CellWidth = 96;
+static const int CellHeight = 96;
+static const int IconSize = 64;
+
+struct GridEntry {
+    QString name;
+    bool dir;
+};
+
+/* folders first, then by name ignoring case, like the old list view */
+static bool entryLessThan(const GridEntry &a, const GridEntry &b)
+{
+    if (a.dir != b.dir)
+        return a.dir;
+    return QString::compare(a.name, b.name, Qt::CaseInsensitive) < 0;
+}
+
+/* the type icons are shared by every folder widget on the desktop. files
+   are keyed by suffix, the first file of a type asks the provider for the
+   icon QFileSystemModel would have shown, the rest reuse it */
+static QPixmap typePixmap(const QString &directory, const GridEntry &entry)
+{
+    const QString suffix = entry.dir ? QString() : QFileInfo(entry.name).suffix().toLower();
+    const QString key = QString("folderwidget:%1:%2:%3")
+        .arg(entry.dir ? "folder" : "file").arg(suffix).arg(IconSize);
+
+    QPixmap pixmap;
+    if (!QPixmapCache::find(key, &pixmap)) {
+        QFileIconProvider provider;
+        QIcon icon;
+        if (entry.dir)
+            icon = provider.icon(QFileIconProvider::Folder);
+        else if (suffix.isEmpty())
+            icon = provider.icon(QFileIconProvider::File);
+        else
+            icon = provider.icon(QFileInfo(QDir(directory), entry.name));
+        if (icon.isNull())
+            icon = provider.icon(entry.dir ? QFileIconProvider::Folder : QFileIconProvider::File);
+
+        pixmap = icon.pixmap(IconSize, IconSize);
+        QPixmapCache::insert(key, pixmap);
+    }
+    return pixmap;
+}
+
+class IconCell : public QGraphicsItem
+{
+public:
+    IconCell(QGraphicsItem *parent) : QGraphicsItem(parent), mSelected(false) {
+        setCacheMode(QGraphicsItem::DeviceCoordinateCache);
+        setAcceptedMouseButtons(Qt::NoButton);
+    }
+
+    void bind(const QString &directory, const GridEntry &entry, bool selected) {
+        const QFontMetrics metrics(QApplication::font());
+        mLabel = metrics.elidedText(entry.name, Qt::ElideMiddle, CellWidth - 8);
+        mPixmap = typePixmap(directory, entry);
+        mSelected = selected;
+        update();
+    }
+
+    void setSelected(bool selected) {
+        if (selected == mSelected)
+            return;
+        mSelected = selected;
+        update();
+    }
+
+    QRectF boundingRect() const {
+        return QRectF(0, 0, CellWidth, CellHeight);
+    }
+
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *, QWidget *) {
+        if (mSelected) {
+            painter->setRenderHint(QPainter::Antialiasing);
+            painter->setPen(Qt::NoPen);
+            painter->setBrush(QColor(0, 0, 0, 40));
+            painter->drawRoundedRect(boundingRect().adjusted(2, 2, -2, -2), 6, 6);
+        }
+
+        painter->drawPixmap((CellWidth - mPixmap.width()) / 2, 4, mPixmap);
+        painter->setPen(QColor(0, 0, 0));
+        painter->drawText(QRectF(4, IconSize + 8, CellWidth - 8, CellHeight - IconSize - 8),
+                Qt::AlignHCenter | Qt::AlignTop, mLabel);
+    }
+
+private:
+    QString mLabel;
+    QPixmap mPixmap;
+    bool mSelected;
+};
+
+class IconGridView::Private
+{
+public:
+    Private() : mGeneration(0), mSelected(-1), mPressed(-1) {}
+    ~Private() {}
+
+    int columns() const {
+        return qMax(1, int(mViewport.width()) / CellWidth);
+    }
+
+    QString mDirectory;
+    QList<GridEntry> mEntries;
+    QRectF mViewport;
+
+    QHash<int, IconCell *> mActiveCells;
+    QList<IconCell *> mFreeCells;
+
+    QThread *mThread;
+    DirectoryLister *mLister;
+    int mGeneration;
+    int mSelected;
+    int mPressed;
+};
+
+IconGridView::IconGridView(QGraphicsItem *parent) :
+    QGraphicsObject(parent),
+    d(new Private)
+{
+    setFlag(QGraphicsItem::ItemSendsGeometryChanges, true);
+    // cells scrolled half out must not draw over the frame around the grid
+    setFlag(QGraphicsItem::ItemClipsChildrenToShape, true);
+
+    d->mThread = new QThread(this);
+    d->mLister = new DirectoryLister();
+    d->mLister->moveToThread(d->mThread);
+    connect(d->mLister, SIGNAL(found(int, QStringList)), this, SLOT(onFound(int, QStringList)));
+    connect(d->mLister, SIGNAL(finished(int, int)), this, SLOT(onFinished(int, int)));
+    d->mThread->start(QThread::LowPriority);
+}
+
+IconGridView::~IconGridView()
+{
+    QMetaObject::invokeMethod(d->mLister, "stop", Qt::BlockingQueuedConnection);
+    d->mThread->quit();
+    d->mThread->wait();
+    delete d->mLister;
+    delete d;
+}
+
+void IconGridView::setDirectory(const QString &path)
+{
+    d->mDirectory = path;
+    d->mGeneration++;
+
+    prepareGeometryChange();
+    d->mEntries.clear();
+    d->mSelected = -1;
+    d->mPressed = -1;
+    rebindCells();
+    Q_EMIT countChanged(0);
+
+    QMetaObject::invokeMethod(d->mLister, "list", Qt::QueuedConnection,
+            Q_ARG(QString, path), Q_ARG(int, d->mGeneration));
+}
+
+QString IconGridView::directory() const
+{
+    return d->mDirectory;
+}
+
+void IconGridView::setViewport(const QRectF &rect)
+{
+    if (rect == d->mViewport)
+        return;
+
+    const int oldColumns = d->columns();
+    prepareGeometryChange();
+    d->mViewport = rect;
+
+    if (d->columns() != oldColumns)
+        rebindCells();
+    else
+        updateVisibleCells();
+}
+
+QRectF IconGridView::viewport() const
+{
+    return d->mViewport;
+}
+
+int IconGridView::count() const
+{
+    return d->mEntries.count();
+}
+
+int IconGridView::cellCount() const
+{
+    return d->mActiveCells.count() + d->mFreeCells.count();
+}
+
+QString IconGridView::pathAt(int index) const
+{
+    if (index < 0 || index >= d->mEntries.count())
+        return QString();
+    return QDir(d->mDirectory).absoluteFilePath(d->mEntries.at(index).name);
+}
+
+QRectF IconGridView::boundingRect() const
+{
+    const int columns = d->columns();
+    const int rows = (d->mEntries.count() + columns - 1) / columns;
+    return QRectF(0, 0, qMax(d->mViewport.width(), qreal(columns * CellWidth)),
+            qMax(d->mViewport.height(), qreal(rows * CellHeight)));
+}
+
+QPainterPath IconGridView::shape() const
+{
+    QPainterPath path;
+    path.addRect(d->mViewport.translated(-pos()));
+    return path;
+}
+
+void IconGridView::paint(QPainter *, const QStyleOptionGraphicsItem *, QWidget *)
+{
+    // the cells paint themselves
+}
+
+QVariant IconGridView::itemChange(GraphicsItemChange change, const QVariant &value)
+{
+    if (change == QGraphicsItem::ItemPositionHasChanged) {
+        updateVisibleCells();
+    }
+
+    return QGraphicsObject::itemChange(change, value);
+}
+
+void IconGridView::updateVisibleCells()
+{
+    const int count = d->mEntries.count();
+    const int columns = d->columns();
+    const QRectF visible = d->mViewport.translated(-pos());
+
+    int first = 0;
+    int last = -1;
+    if (count > 0 && visible.isValid()) {
+        const int firstRow = qMax(0, int(visible.top()) / CellHeight);
+        const int lastRow = qMax(0, int(visible.bottom() - 1) / CellHeight);
+        first = firstRow * columns;
+        last = qMin(count - 1, (lastRow + 1) * columns - 1);
+    }
+
+    // park what scrolled out before handing cells to what scrolled in
+    QHash<int, IconCell *>::iterator it = d->mActiveCells.begin();
+    while (it != d->mActiveCells.end()) {
+        if (it.key() < first || it.key() > last) {
+            it.value()->hide();
+            d->mFreeCells.append(it.value());
+            it = d->mActiveCells.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    for (int i = first; i <= last; i++) {
+        if (d->mActiveCells.contains(i))
+            continue;
+
+        IconCell *cell = d->mFreeCells.isEmpty() ? new IconCell(this) : d->mFreeCells.takeLast();
+        cell->setPos((i % columns) * CellWidth, (i / columns) * CellHeight);
+        cell->bind(d->mDirectory, d->mEntries.at(i), i == d->mSelected);
+        cell->show();
+        d->mActiveCells.insert(i, cell);
+    }
+}
+
+void IconGridView::rebindCells()
+{
+    // indices moved, every visible cell may show a different entry now
+    Q_FOREACH(IconCell *cell, d->mActiveCells) {
+        cell->hide();
+        d->mFreeCells.append(cell);
+    }
+    d->mActiveCells.clear();
+    updateVisibleCells();
+}
+
+void IconGridView::onFound(int generation, const QStringList &names)
+{
+    // a late batch from the previous directory
+    if (generation != d->mGeneration)
+        return;
+
+    QList<GridEntry> batch;
+    Q_FOREACH(const QString &name, names) {
+        GridEntry entry;
+        entry.dir = name.endsWith(QLatin1Char('/'));
+        entry.name = entry.dir ? name.left(name.length() - 1) : name;
+        batch.append(entry);
+    }
+    qSort(batch.begin(), batch.end(), entryLessThan);
+
+    const QString selectedPath = pathAt(d->mSelected);
+
+    prepareGeometryChange();
+    const int middle = d->mEntries.count();
+    d->mEntries.append(batch);
+    std::inplace_merge(d->mEntries.begin(), d->mEntries.begin() + middle,
+            d->mEntries.end(), entryLessThan);
+
+    if (!selectedPath.isEmpty()) {
+        const QString name = QFileInfo(selectedPath).fileName();
+        for (int i = 0; i < d->mEntries.count(); i++) {
+            if (d->mEntries.at(i).name == name) {
+                d->mSelected = i;
+                break;
+            }
+        }
+    }
+    d->mPressed = -1;
+
+    rebindCells();
+    Q_EMIT countChanged(d->mEntries.count());
+}
+
+void IconGridView::onFinished(int generation, int count)
+{
+    Q_UNUSED(count);
+    if (generation != d->mGeneration)
+        return;
+
+    Q_EMIT directoryLoaded(d->mDirectory);
+}
+
+int IconGridView::indexAt(const QPointF &pos) const
+{
+    if (pos.x() < 0 || pos.y() < 0)
+        return -1;
+
+    const int column = int(pos.x()) / CellWidth;
+    if (column >= d->columns())
+        return -1;
+
+    const int index = (int(pos.y()) / CellHeight) * d->columns() + column;
+    return index < d->mEntries.count() ? index : -1;
+}
+
+void IconGridView::mousePressEvent(QGraphicsSceneMouseEvent *event)
+{
+    if (event->button() != Qt::LeftButton) {
+        event->ignore();
+        return;
+    }
+
+    d->mPressed = indexAt(event->pos());
+
+    if (IconCell *cell = d->mActiveCells.value(d->mSelected))
+        cell->setSelected(false);
+    d->mSelected = d->mPressed;
+    if (IconCell *cell = d->mActiveCells.value(d->mSelected))
+        cell->setSelected(true);
+
+    event->accept();
+}
+
+void IconGridView::mouseReleaseEvent(QGraphicsSceneMouseEvent *event)
+{
+    const int index = indexAt(event->pos());
+    if (index >= 0 && index == d->mPressed)
+        Q_EMIT activated(pathAt(index));
+
+    d->mPressed = -1;
+    event->accept();
+}
@@ -0,0 +1,81 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+
+#ifndef ICON_GRID_VIEW_H
+#define ICON_GRID_VIEW_H
+
+#include <QGraphicsObject>
+#include <QStringList>
+
+/* A directory shown as a grid of icons, drawn natively in the scene.
+   Only the cells inside the viewport exist; cells leaving it while
+   scrolling are parked and rebound to the entries coming into view.
+   Entries are read incrementally on a worker thread. The bounding rect
+   covers the whole content so a ScrollWidget can clamp against it. */
+class IconGridView : public QGraphicsObject
+{
+    Q_OBJECT
+
+public:
+    IconGridView(QGraphicsItem *parent = 0);
+    virtual ~IconGridView();
+
+    void setDirectory(const QString &path);
+    QString directory() const;
+
+    /* the visible part of the grid, in parent coordinates */
+    void setViewport(const QRectF &rect);
+    QRectF viewport() const;
+
+    /* number of entries listed so far */
+    int count() const;
+    /* number of cell items currently alive, visible or parked */
+    int cellCount() const;
+
+    QString pathAt(int index) const;
+
+    virtual QRectF boundingRect() const;
+    virtual QPainterPath shape() const;
+    virtual void paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
+            QWidget *widget = 0);
+
+Q_SIGNALS:
+    void activated(const QString &path);
+    void countChanged(int count);
+    void directoryLoaded(const QString &path);
+
+protected:
+    virtual QVariant itemChange(GraphicsItemChange change, const QVariant &value);
+    virtual void mousePressEvent(QGraphicsSceneMouseEvent *event);
+    virtual void mouseReleaseEvent(QGraphicsSceneMouseEvent *event);
+
+private Q_SLOTS:
+    void onFound(int generation, const QStringList &names);
+    void onFinished(int generation, int count);
+
+private:
+    void updateVisibleCells();
+    void rebindCells();
+    int indexAt(const QPointF &pos) const;
+
+    class Private;
+    Private *const d;
+};
+
+#endif
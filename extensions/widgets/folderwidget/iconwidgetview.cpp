@@ -1,25 +1,21 @@
 #include "iconwidgetview.h"
 
-#include <QGraphicsProxyWidget>
-#include <QListView>
-#include <QFileSystemModel>
 #include <QPropertyAnimation>
 
 #include <desktopwidget.h>
 
+#include "icongridview.h"
+
 class IconWidgetView::PrivateIconWidgetView
 {
 public:
     PrivateIconWidgetView() {}
     ~PrivateIconWidgetView() {
-        delete mIconView;
         delete mInfoView;
         delete mSlideAnimation;
     }
 
-    QGraphicsProxyWidget *mWidgetProxy;
-    QListView *mIconView;
-    QFileSystemModel *mFileSystemModel;
+    IconGridView *mIconView;
     PlexyDesk::DesktopWidget *mInfoView;
     QPropertyAnimation *mSlideAnimation;
 };
@@ -28,24 +24,16 @@ IconWidgetView::IconWidgetView(const QRectF &rect, QGraphicsObject *parent) :
     PlexyDesk::ScrollWidget(rect, parent),
     d(new PrivateIconWidgetView)
 {
-    d->mWidgetProxy = new QGraphicsProxyWidget(this);
-    d->mIconView = new QListView;
-
-    d->mIconView->setViewMode(QListView::IconMode);
-    d->mIconView->setIconSize(QSize(64, 64));
-    d->mIconView->setUniformItemSizes(true);
-    d->mIconView->setGridSize(QSize(96, 96));
-    d->mIconView->setAcceptDrops(true);
-    d->mIconView->setDropIndicatorShown(false);
-    ///hack until we have our own painting
-    d->mIconView->setStyleSheet(" border : 0 ; background-color: transparent; color : #000000");
-
-
-    d->mWidgetProxy->setWidget(d->mIconView);
-
     QRectF iconViewRect = QRectF(12.0, 12.0, rect.width() - 24.0, rect.height() - 24.0);
     QRectF infoViewRect = QRectF(0.0,  0.0, rect.width(), 240);
 
+    // the grid scrolls inside the area the list view used to cover,
+    // added first so the info view still slides in above it
+    d->mIconView = new IconGridView();
+    d->mIconView->setPos(4.0, 28.0);
+    addWidget(d->mIconView);
+    d->mIconView->setViewport(QRectF(QPointF(4.0, 28.0), iconViewRect.size()));
+
     d->mInfoView = new PlexyDesk::DesktopWidget(infoViewRect, this);
     d->mInfoView->setPos(QPointF(0.0, rect.height() + 16));
     QPointF infoViewPos = d->mInfoView->pos();
@@ -53,14 +41,8 @@ IconWidgetView::IconWidgetView(const QRectF &rect, QGraphicsObject *parent) :
     d->mInfoView->enableWindowMode(false);
     d->mInfoView->setFlag(QGraphicsItem::ItemIsMovable, false);
 
-    d->mWidgetProxy->setPos(4.0, 28.0);
-    d->mWidgetProxy->resize(iconViewRect.size());
-
-    d->mFileSystemModel = new QFileSystemModel(d->mIconView);
-    d->mIconView->setModel(d->mFileSystemModel);
-
-    connect(d->mFileSystemModel, SIGNAL(directoryLoaded(QString)), this, SLOT (onDirLoaded(const QString)));
-    connect(d->mIconView, SIGNAL(clicked(QModelIndex)), this, SLOT(onClicked(QModelIndex)));
+    connect(d->mIconView, SIGNAL(directoryLoaded(QString)), this, SLOT (onDirLoaded(const QString)));
+    connect(d->mIconView, SIGNAL(activated(QString)), this, SLOT(onClicked(QString)));
     connect(d->mInfoView, SIGNAL(clicked()), this, SLOT(infoViewClicked()));
 
     d->mInfoView->enableDefaultBackground(true);
@@ -72,8 +54,6 @@ IconWidgetView::IconWidgetView(const QRectF &rect, QGraphicsObject *parent) :
     d->mSlideAnimation->setStartValue(infoViewPos);
     d->mSlideAnimation->setEndValue(QPointF(0.0, 140.0));
     d->mSlideAnimation->setEasingCurve(QEasingCurve::InCirc);
-
-    d->mWidgetProxy->show();
 }
 
 IconWidgetView::~IconWidgetView()
@@ -83,9 +63,7 @@ IconWidgetView::~IconWidgetView()
 
 void IconWidgetView::setDirectoryPath(const QString &path)
 {
-    d->mFileSystemModel->setFilter(QDir::NoDotAndDotDot | QDir::Files | QDir::Dirs);
-    d->mFileSystemModel->setRootPath(path);
-    d->mIconView->setRootIndex(d->mFileSystemModel->index(path));
+    d->mIconView->setDirectory(path);
 }
 
 void IconWidgetView::onDirLoaded(const QString &path)
@@ -93,7 +71,7 @@ void IconWidgetView::onDirLoaded(const QString &path)
     //qDebug() << Q_FUNC_INFO << path;
 }
 
-void IconWidgetView::onClicked(const QModelIndex &index)
+void IconWidgetView::onClicked(const QString &path)
 {
     d->mSlideAnimation->setDirection(QAbstractAnimation::Forward);
     d->mSlideAnimation->start();
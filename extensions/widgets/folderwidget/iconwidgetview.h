@@ -14,7 +14,7 @@ public:
 
 public Q_SLOTS:
     void onDirLoaded(const QString &path);
-    void onClicked(const QModelIndex & index);
+    void onClicked(const QString &path);
     void infoViewClicked();
 
 private:
@@ -26,23 +26,23 @@ VideoWidget::VideoWidget(const QRectF &rect, QWidget *widget) : DesktopWidget(re
 {
     setDockImage(QPixmap(applicationDirPath() + "/share/plexy/skins/widgets/base-widget/pila.png"));
     cover = QImage(200, 200, QImage::Format_ARGB32_Premultiplied);
-    video = QImage(200, 200, QImage::Format_ARGB32_Premultiplied);
+    mDisplaySize = displaySize();
+    connect(this, SIGNAL(rectChanged()), this, SLOT(onRectChanged()));
 }
 
 VideoWidget::~VideoWidget()
 {
 }
 
-void VideoWidget::setFrameImage(QImage &img)
+void VideoWidget::setFrame(const VideoFrame &frame)
 {
-    video = img;
+    video.setFrame(frame);
     update();
 }
 
 void VideoWidget::paintExtFace(QPainter *p, const QStyleOptionGraphicsItem *e, QWidget *widget)
 {
-    QRectF r = e->exposedRect;
-    p->drawImage(QRectF(20, 20, r.width() - 40, r.height() - 40), video);
+    video.paint(p, videoRect());
 }
 
 void VideoWidget::paintExtDockFace(QPainter *p, const QStyleOptionGraphicsItem *e, QWidget *widget)
@@ -61,4 +61,23 @@ void VideoWidget::setCoverPic(QImage img)
     cover = img;
 }
 
+QSize VideoWidget::displaySize() const
+{
+    return sceneTransform().mapRect(videoRect()).toAlignedRect().size();
+}
+
+void VideoWidget::onRectChanged()
+{
+    const QSize size = displaySize();
+    if (size != mDisplaySize) {
+        mDisplaySize = size;
+        emit displaySizeChanged(size);
+    }
+}
+
+QRectF VideoWidget::videoRect() const
+{
+    return rect().adjusted(20, 20, -20, -20);
+}
+
 } // namespace PlexyDesk
@@ -24,6 +24,7 @@
 #include <plexy.h>
 #include <datainterface.h>
 #include <desktopwidget.h>
+#include <videoframe.h>
 
 
 namespace PlexyDesk
@@ -36,16 +37,25 @@ public:
     virtual ~VideoWidget();
     void paintExtFace(QPainter *painter, const QStyleOptionGraphicsItem *, QWidget *);
     void paintExtDockFace(QPainter *painter, const QStyleOptionGraphicsItem *, QWidget *);
-    void setFrameImage(QImage &img);
+    void setFrame(const VideoFrame &frame);
     QRectF boundingRect() const;
     void setCoverPic(QImage img);
+    /* the video rect in scene pixels, what the decoder should scale to */
+    QSize displaySize() const;
 
 signals:
     void swtch();
+    void displaySizeChanged(const QSize &size);
+
+private slots:
+    void onRectChanged();
 
 private:
+    QRectF videoRect() const;
+
     QImage cover;
-    QImage video;
+    VideoFrameSurface video;
+    QSize mDisplaySize;
 };
 } // namespace PlexyDesk
 
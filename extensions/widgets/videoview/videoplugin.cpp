@@ -57,9 +57,20 @@ void VideoPlugin::searchImage()
     emit sendData(data);
 }
 
+void VideoPlugin::onDisplaySizeChanged(const QSize &size)
+{
+    QVariant data(size);
+    emit sendData(data);
+}
+
 
 void VideoPlugin::data(QVariant &data)
 {
+    if (data.userType() == qMetaTypeId<PlexyDesk::VideoFrame>()) {
+        widget->setFrame(data.value<PlexyDesk::VideoFrame>());
+        return;
+    }
+
     QImage wall = data.value<QImage>();
     search->setEnabled(true);
     flow->setPixmap(QPixmap::fromImage(wall));
@@ -74,6 +85,9 @@ QGraphicsItem *VideoPlugin::item()
     if (videoEngine) {
         connect(videoEngine, SIGNAL(data(QVariant&)), this, SLOT(data(QVariant&)));
         connect(this, SIGNAL(sendData(QVariant&)), videoEngine, SLOT(pushData(QVariant&)));
+        // the engine decodes straight to the size the widget shows
+        connect(widget, SIGNAL(displaySizeChanged(QSize)), this, SLOT(onDisplaySizeChanged(QSize)));
+        onDisplaySizeChanged(widget->displaySize());
     } else {
         qDebug() << "DataSource Was Null" << "VideoPlugin::VideoPlugin(QObject * object)" << endl;
     }
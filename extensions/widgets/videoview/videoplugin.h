@@ -38,6 +38,7 @@ public:
 public slots:
     void data(QVariant &);
     void searchImage();
+    void onDisplaySizeChanged(const QSize &size);
 
 signals:
     void change();
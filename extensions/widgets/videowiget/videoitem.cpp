@@ -26,10 +26,9 @@ VideoItem::VideoItem(const QRectF &rect, QWidget *widget) : DesktopWidget(rect,
 {
     vid = new VPlayer();
     vid->setFileName("/home/siraj/dwhelper/Java_Everywhere.flv");
-    connect(vid, SIGNAL(frameReady(QImage &)), this, SLOT(getImage(QImage &)));
+    connect(vid, SIGNAL(frameReady(PlexyDesk::VideoFrame)), this, SLOT(setFrame(PlexyDesk::VideoFrame)));
     connect(vid, SIGNAL(videoDone()), this, SLOT(loop()));
 
-    vidsurf = new QImage(320, 240, QImage::Format_RGB32);
     setCacheMode(NoCache);
     brush = QBrush(QColor(0, 0, 0));
     snapped = false;
@@ -41,18 +40,14 @@ VideoItem::VideoItem(const QRectF &rect, QWidget *widget) : DesktopWidget(rect,
 
 VideoItem::~VideoItem()
 {
-    if (vid) {
-        delete vid;
-    }
-
-    if (vidsurf) {
-        delete vidsurf;
-    }
+    // drop our frame before the player so its pool can go with it
+    vidsurf.clear();
+    delete vid;
 }
 void VideoItem::mouseDoubleClickEvent(QGraphicsSceneMouseEvent *event)
 {
-    if (vidsurf) {
-        snap = QPixmap().fromImage(*vidsurf);;
+    if (!vidsurf.frame().isNull()) {
+        snap = QPixmap::fromImage(vidsurf.frame().image());
         if (snapped == false)
             snapped = true;
         else
@@ -64,22 +59,14 @@ void VideoItem::mouseDoubleClickEvent(QGraphicsSceneMouseEvent *event)
 
 void VideoItem::loop()
 {
-    delete vid;
-    vid = new VPlayer();
     vid->setFileName("/home/siraj/dwhelper/Java_Everywhere.flv");
 }
 
-void VideoItem::getImage(QImage &img)
+void VideoItem::setFrame(const PlexyDesk::VideoFrame &frame)
 {
-    if (vidsurf) {
-        delete vidsurf;
-    }
-
-    vidsurf = &img;
-    // brush.setTextureImage(img);
+    vidsurf.setFrame(frame);
     update();
     frameno++;
-
 }
 
 void VideoItem::paintExtFace(QPainter *p, const QStyleOptionGraphicsItem *e, QWidget *widget)
@@ -92,8 +79,14 @@ void VideoItem::paintExtFace(QPainter *p, const QStyleOptionGraphicsItem *e, QWi
     p->setRenderHint(QPainter::SmoothPixmapTransform, false);
     p->setRenderHint(QPainter::Antialiasing, false);
     p->setRenderHint(QPainter::HighQualityAntialiasing, false);
-    if (vidsurf)
-        p->drawImage(QRect(23, 47, 347, 200), *vidsurf);
+    const QRectF target(23, 47, 347, 200);
+    const QSize size = VideoFrameSurface::deviceSize(p, target);
+    if (size != displaySize) {
+        // let the decoder scale to what ends up on screen
+        displaySize = size;
+        vid->setDisplaySize(size);
+    }
+    vidsurf.paint(p, target);
     // p->fillRect(QRect(30,30,320,240), brush);
     p->restore();
 
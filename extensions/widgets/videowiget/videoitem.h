@@ -23,7 +23,8 @@
 #include <QtGui>
 #include <plexy.h>
 #include <desktopwidget.h>
-#include "vplayer.h"
+#include <videoframe.h>
+#include <vplayer.h>
 
 namespace PlexyDesk
 {
@@ -40,13 +41,14 @@ public:
     virtual void mouseDoubleClickEvent(QGraphicsSceneMouseEvent *event);
     QRectF boundingRect() const;
 public slots:
-    void getImage(QImage &img);
+    void setFrame(const PlexyDesk::VideoFrame &frame);
     void loop();
 
 private:
     QImage dateImg;
     VPlayer *vid;
-    QImage *vidsurf;
+    VideoFrameSurface vidsurf;
+    QSize displaySize;
     QBrush brush;
     QPixmap snap;
     int frameno;
@@ -0,0 +1,304 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+#include "feedengine.h"
+#include "feedparser.h"
+#include "feedstore.h"
+
+#include <QHash>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QtDebug>
+
+#include <tickscheduler.h>
+
+static const int MaxRedirects = 3;
+
+struct FeedEngine::Feed {
+    QUrl url;
+    QUrl location;
+    QByteArray etag;
+    QByteArray lastModified;
+    FeedParser parser;
+    FeedStore store;
+    QNetworkReply *reply;
+    bool queued;
+    int redirects;
+};
+
+class FeedEngine::Private
+{
+public:
+    Private() : mMaxConcurrent(4), mStoreCapacity(200), mTickId(0) {}
+    ~Private() {
+        qDeleteAll(mFeeds);
+    }
+
+    Feed *feedFor(QNetworkReply *reply) const {
+        return mReplies.value(reply);
+    }
+
+    QNetworkAccessManager *mNetwork;
+    QHash<QString, Feed *> mFeeds;
+    QHash<QNetworkReply *, Feed *> mReplies;
+    QList<Feed *> mQueue;
+    int mMaxConcurrent;
+    int mStoreCapacity;
+    int mTickId;
+};
+
+FeedEngine::FeedEngine(QObject *parent) : QObject(parent), d(new Private)
+{
+    d->mNetwork = new QNetworkAccessManager(this);
+}
+
+FeedEngine::~FeedEngine()
+{
+    PlexyDesk::TickScheduler::getInstance()->cancel(d->mTickId);
+
+    Q_FOREACH(QNetworkReply *reply, d->mReplies.keys()) {
+        reply->disconnect(this);
+        reply->abort();
+        reply->deleteLater();
+    }
+    delete d;
+}
+
+QNetworkAccessManager *FeedEngine::networkAccessManager() const
+{
+    return d->mNetwork;
+}
+
+void FeedEngine::addFeed(const QUrl &url)
+{
+    const QString key = url.toString();
+    if (d->mFeeds.contains(key))
+        return;
+
+    Feed *feed = new Feed;
+    feed->url = url;
+    feed->location = url;
+    feed->store.setCapacity(d->mStoreCapacity);
+    feed->reply = 0;
+    feed->queued = false;
+    feed->redirects = 0;
+    d->mFeeds.insert(key, feed);
+}
+
+void FeedEngine::removeFeed(const QUrl &url)
+{
+    Feed *feed = d->mFeeds.take(url.toString());
+    if (!feed)
+        return;
+
+    d->mQueue.removeAll(feed);
+    if (feed->reply) {
+        d->mReplies.remove(feed->reply);
+        feed->reply->disconnect(this);
+        feed->reply->abort();
+        feed->reply->deleteLater();
+    }
+    delete feed;
+
+    startQueued();
+}
+
+QStringList FeedEngine::feeds() const
+{
+    return d->mFeeds.keys();
+}
+
+void FeedEngine::setMaxConcurrent(int count)
+{
+    d->mMaxConcurrent = qMax(1, count);
+    startQueued();
+}
+
+int FeedEngine::maxConcurrent() const
+{
+    return d->mMaxConcurrent;
+}
+
+int FeedEngine::activeCount() const
+{
+    return d->mReplies.count();
+}
+
+int FeedEngine::queuedCount() const
+{
+    return d->mQueue.count();
+}
+
+void FeedEngine::setStoreCapacity(int capacity)
+{
+    d->mStoreCapacity = qMax(1, capacity);
+    Q_FOREACH(Feed *feed, d->mFeeds)
+        feed->store.setCapacity(d->mStoreCapacity);
+}
+
+void FeedEngine::setRefreshInterval(int msecs)
+{
+    PlexyDesk::TickScheduler *scheduler = PlexyDesk::TickScheduler::getInstance();
+    scheduler->cancel(d->mTickId);
+    d->mTickId = 0;
+
+    // nobody cares if a feed is a little late, let it share a wake up
+    if (msecs > 0)
+        d->mTickId = scheduler->schedule(this, "refreshAll", msecs, msecs / 10);
+}
+
+void FeedEngine::refresh(const QUrl &url)
+{
+    Feed *feed = d->mFeeds.value(url.toString());
+    if (!feed || feed->reply || feed->queued)
+        return;
+
+    feed->queued = true;
+    d->mQueue.append(feed);
+    startQueued();
+}
+
+void FeedEngine::refreshAll()
+{
+    Q_FOREACH(Feed *feed, d->mFeeds) {
+        if (feed->reply || feed->queued)
+            continue;
+        feed->queued = true;
+        d->mQueue.append(feed);
+    }
+    startQueued();
+}
+
+void FeedEngine::startQueued()
+{
+    while (d->mReplies.count() < d->mMaxConcurrent && !d->mQueue.isEmpty()) {
+        Feed *feed = d->mQueue.takeFirst();
+        feed->queued = false;
+        feed->redirects = 0;
+        feed->location = feed->url;
+        start(feed);
+    }
+}
+
+void FeedEngine::start(Feed *feed)
+{
+    QNetworkRequest request(feed->location);
+    if (!feed->etag.isEmpty())
+        request.setRawHeader("If-None-Match", feed->etag);
+    if (!feed->lastModified.isEmpty())
+        request.setRawHeader("If-Modified-Since", feed->lastModified);
+
+    feed->parser.reset();
+    feed->store.beginRefresh();
+    feed->reply = d->mNetwork->get(request);
+    d->mReplies.insert(feed->reply, feed);
+
+    connect(feed->reply, SIGNAL(readyRead()), this, SLOT(onReadyRead()));
+    connect(feed->reply, SIGNAL(finished()), this, SLOT(onFinished()));
+}
+
+void FeedEngine::consume(Feed *feed)
+{
+    feed->parser.addData(feed->reply->readAll());
+
+    QVariantList added;
+    QVariantList changed;
+    Q_FOREACH(const FeedItem &item, feed->parser.takeItems()) {
+        switch (feed->store.update(item)) {
+        case FeedStore::Added:
+            added.append(item.toMap());
+            break;
+        case FeedStore::Changed:
+            changed.append(item.toMap());
+            break;
+        default:
+            break;
+        }
+    }
+
+    if (!added.isEmpty() || !changed.isEmpty())
+        Q_EMIT itemsUpdated(feed->url, added, changed);
+
+    if (feed->parser.hasError())
+        feed->reply->abort();
+}
+
+void FeedEngine::onReadyRead()
+{
+    QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
+    Feed *feed = d->feedFor(reply);
+    if (!feed)
+        return;
+
+    // only a 200 carries a document, the body of a 304 or a redirect is noise
+    if (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() != 200)
+        return;
+
+    consume(feed);
+}
+
+void FeedEngine::onFinished()
+{
+    QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
+    Feed *feed = d->feedFor(reply);
+    if (!feed)
+        return;
+
+    d->mReplies.remove(reply);
+    reply->deleteLater();
+
+    const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    const QUrl redirect = reply->attribute(QNetworkRequest::RedirectionTargetAttribute).toUrl();
+
+    if (feed->parser.hasError()) {
+        feed->reply = 0;
+        Q_EMIT feedError(feed->url, feed->parser.errorString());
+    } else if (reply->error() != QNetworkReply::NoError) {
+        feed->reply = 0;
+        Q_EMIT feedError(feed->url, reply->errorString());
+    } else if (redirect.isValid() && feed->redirects < MaxRedirects) {
+        feed->redirects++;
+        feed->location = feed->location.resolved(redirect);
+        start(feed);
+        return;
+    } else if (status == 304) {
+        feed->reply = 0;
+        Q_EMIT feedFinished(feed->url, false);
+    } else if (status == 200) {
+        // the last bytes can still turn out malformed or the document short
+        consume(feed);
+        feed->parser.finish();
+        feed->reply = 0;
+        if (feed->parser.hasError()) {
+            Q_EMIT feedError(feed->url, feed->parser.errorString());
+        } else {
+            feed->etag = reply->rawHeader("ETag");
+            feed->lastModified = reply->rawHeader("Last-Modified");
+            Q_EMIT feedFinished(feed->url, true);
+        }
+    } else {
+        feed->reply = 0;
+        Q_EMIT feedError(feed->url, QString("HTTP %1").arg(status));
+    }
+
+    startQueued();
+
+    if (d->mReplies.isEmpty() && d->mQueue.isEmpty())
+        Q_EMIT idle();
+}
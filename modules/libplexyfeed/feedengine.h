@@ -0,0 +1,88 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+#ifndef PLEXY_FEED_ENGINE_H
+#define PLEXY_FEED_ENGINE_H
+
+#include <QObject>
+#include <QStringList>
+#include <QUrl>
+#include <QVariantList>
+
+class QNetworkAccessManager;
+
+/*!
+   Follows any number of RSS/Atom feeds. Downloads are conditional
+   (If-None-Match / If-Modified-Since) and at most maxConcurrent() run at
+   once, the rest wait in a queue. Documents are parsed while they arrive
+   and every item is checked against a bounded per feed store, so
+   itemsUpdated() only ever carries what is new or has changed since the
+   last refresh.
+*/
+class FeedEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    FeedEngine(QObject *parent = 0);
+    virtual ~FeedEngine();
+
+    void addFeed(const QUrl &url);
+    void removeFeed(const QUrl &url);
+    QStringList feeds() const;
+
+    void setMaxConcurrent(int count);
+    int maxConcurrent() const;
+    int activeCount() const;
+    int queuedCount() const;
+
+    /* items remembered per feed before the oldest are forgotten */
+    void setStoreCapacity(int capacity);
+
+    /* refreshes every feed periodically, 0 turns it off */
+    void setRefreshInterval(int msecs);
+
+    QNetworkAccessManager *networkAccessManager() const;
+
+public Q_SLOTS:
+    void refresh(const QUrl &url);
+    void refreshAll();
+
+Q_SIGNALS:
+    void itemsUpdated(const QUrl &feed, const QVariantList &added, const QVariantList &changed);
+    /* modified is false when the server answered 304 */
+    void feedFinished(const QUrl &feed, bool modified);
+    void feedError(const QUrl &feed, const QString &error);
+    void idle();
+
+private Q_SLOTS:
+    void onReadyRead();
+    void onFinished();
+
+private:
+    struct Feed;
+
+    void startQueued();
+    void start(Feed *feed);
+    void consume(Feed *feed);
+
+    class Private;
+    Private *const d;
+};
+
+#endif
@@ -0,0 +1,154 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+#include "feedparser.h"
+
+#include <QHash>
+#include <QtDebug>
+
+QString FeedItem::key() const
+{
+    if (!id.isEmpty())
+        return id;
+    if (!link.isEmpty())
+        return link;
+    return title;
+}
+
+uint FeedItem::contentHash() const
+{
+    const QChar separator(0x1f);
+    return qHash(title + separator + link + separator + description + separator + published);
+}
+
+QVariantMap FeedItem::toMap() const
+{
+    QVariantMap map;
+    map["id"] = key();
+    map["title"] = title;
+    map["link"] = link;
+    map["description"] = description;
+    map["published"] = published;
+    return map;
+}
+
+FeedParser::FeedParser()
+{
+    reset();
+}
+
+void FeedParser::reset()
+{
+    mXml.clear();
+    mItems.clear();
+    mCurrent = FeedItem();
+    mCurrentTag.clear();
+    mInItem = false;
+    mError = false;
+}
+
+void FeedParser::addData(const QByteArray &data)
+{
+    if (mError)
+        return;
+
+    mXml.addData(data);
+    parse();
+}
+
+void FeedParser::finish()
+{
+    if (mXml.error() == QXmlStreamReader::PrematureEndOfDocumentError)
+        mError = true;
+}
+
+QList<FeedItem> FeedParser::takeItems()
+{
+    QList<FeedItem> items = mItems;
+    mItems.clear();
+    return items;
+}
+
+bool FeedParser::hasError() const
+{
+    return mError;
+}
+
+QString FeedParser::errorString() const
+{
+    return mXml.errorString();
+}
+
+void FeedParser::parse()
+{
+    while (!mXml.atEnd()) {
+        mXml.readNext();
+
+        if (mXml.isStartElement()) {
+            const QStringRef name = mXml.name();
+            if (name == "item" || name == "entry") {
+                mInItem = true;
+                mCurrent = FeedItem();
+                // RSS 1.0 names its items with rdf:about
+                const QXmlStreamAttributes attributes = mXml.attributes();
+                for (int i = 0; i < attributes.count(); i++) {
+                    if (attributes.at(i).name() == "about")
+                        mCurrent.link = attributes.at(i).value().toString();
+                }
+            } else if (mInItem && name == "link" && mXml.attributes().hasAttribute("href")) {
+                // atom links carry the url as an attribute
+                const QStringRef rel = mXml.attributes().value("rel");
+                if (rel.isEmpty() || rel == "alternate")
+                    mCurrent.link = mXml.attributes().value("href").toString();
+            }
+            mCurrentTag = name.toString();
+        } else if (mXml.isEndElement()) {
+            const QStringRef name = mXml.name();
+            if (mInItem && (name == "item" || name == "entry")) {
+                mCurrent.id = mCurrent.id.trimmed();
+                mCurrent.title = mCurrent.title.trimmed();
+                mCurrent.link = mCurrent.link.trimmed();
+                mCurrent.published = mCurrent.published.trimmed();
+                mItems.append(mCurrent);
+                mInItem = false;
+            }
+            mCurrentTag.clear();
+        } else if (mXml.isCharacters() && mInItem && !mXml.isWhitespace()) {
+            /* text may arrive in pieces when a chunk ends inside it */
+            const QString text = mXml.text().toString();
+            if (mCurrentTag == "title") {
+                mCurrent.title += text;
+            } else if (mCurrentTag == "link") {
+                mCurrent.link += text;
+            } else if (mCurrentTag == "guid" || mCurrentTag == "id") {
+                mCurrent.id += text;
+            } else if (mCurrentTag == "description" || mCurrentTag == "summary" ||
+                       mCurrentTag == "content" || mCurrentTag == "encoded") {
+                mCurrent.description += text;
+            } else if (mCurrentTag == "pubDate" || mCurrentTag == "updated" ||
+                       mCurrentTag == "published" || mCurrentTag == "date") {
+                mCurrent.published += text;
+            }
+        }
+    }
+
+    if (mXml.error() && mXml.error() != QXmlStreamReader::PrematureEndOfDocumentError) {
+        qDebug() << Q_FUNC_INFO << "XML ERROR:" << mXml.lineNumber() << ":" << mXml.errorString();
+        mError = true;
+    }
+}
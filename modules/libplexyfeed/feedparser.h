@@ -0,0 +1,74 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+#ifndef PLEXY_FEED_PARSER_H
+#define PLEXY_FEED_PARSER_H
+
+#include <QList>
+#include <QString>
+#include <QVariantMap>
+#include <QXmlStreamReader>
+
+/* one entry of a feed, whatever dialect it came from */
+struct FeedItem
+{
+    QString id;
+    QString title;
+    QString link;
+    QString description;
+    QString published;
+
+    /* guid or atom id, the link when the feed has none */
+    QString key() const;
+    /* changes whenever something a reader would see changes */
+    uint contentHash() const;
+    QVariantMap toMap() const;
+};
+
+/*!
+   Parses RSS 2.0, RSS 1.0 (RDF) and Atom as bytes arrive. addData() can be
+   called with arbitrary chunks of the document, items are handed out by
+   takeItems() as soon as their closing tag has been read.
+*/
+class FeedParser
+{
+public:
+    FeedParser();
+
+    void reset();
+    void addData(const QByteArray &data);
+    /* no more data will come, a document cut short is an error from here on */
+    void finish();
+
+    QList<FeedItem> takeItems();
+
+    bool hasError() const;
+    QString errorString() const;
+
+private:
+    void parse();
+
+    QXmlStreamReader mXml;
+    QList<FeedItem> mItems;
+    FeedItem mCurrent;
+    QString mCurrentTag;
+    bool mInItem;
+    bool mError;
+};
+
+#endif
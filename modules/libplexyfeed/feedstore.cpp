@@ -0,0 +1,85 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+#include "feedstore.h"
+
+FeedStore::FeedStore(int capacity) : mCapacity(qMax(1, capacity)), mRefresh(0)
+{
+}
+
+void FeedStore::setCapacity(int capacity)
+{
+    mCapacity = qMax(1, capacity);
+    trim();
+}
+
+int FeedStore::capacity() const
+{
+    return mCapacity;
+}
+
+int FeedStore::count() const
+{
+    return mEntries.count();
+}
+
+void FeedStore::beginRefresh()
+{
+    mRefresh++;
+}
+
+FeedStore::Change FeedStore::update(const FeedItem &item)
+{
+    const QString key = item.key();
+    const uint hash = item.contentHash();
+
+    QHash<QString, Entry>::iterator it = mEntries.find(key);
+    if (it != mEntries.end()) {
+        // seen again, it is the last one to forget now
+        mOrder.erase(it.value().position);
+        it.value().position = mOrder.insert(mOrder.end(), key);
+        it.value().refresh = mRefresh;
+
+        if (it.value().hash == hash)
+            return Unchanged;
+        it.value().hash = hash;
+        return Changed;
+    }
+
+    Entry entry;
+    entry.hash = hash;
+    entry.refresh = mRefresh;
+    entry.position = mOrder.insert(mOrder.end(), key);
+    mEntries.insert(key, entry);
+    trim();
+    return Added;
+}
+
+void FeedStore::clear()
+{
+    mEntries.clear();
+    mOrder.clear();
+}
+
+void FeedStore::trim()
+{
+    /* whatever the current document still lists stays, the store only
+       outgrows its capacity by the part of the feed beyond it */
+    while (mOrder.count() > mCapacity && mEntries.value(mOrder.first()).refresh != mRefresh)
+        mEntries.remove(mOrder.takeFirst());
+}
@@ -0,0 +1,70 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+#ifndef PLEXY_FEED_STORE_H
+#define PLEXY_FEED_STORE_H
+
+#include <QHash>
+#include <QLinkedList>
+
+#include "feedparser.h"
+
+/* Remembers what was already seen of one feed. Items are identified by
+   FeedItem::key(), and only a content hash is kept per item. Once the
+   store is full the keys seen least recently are forgotten, but never one
+   seen since the last beginRefresh(), so a feed longer than the capacity
+   does not report its tail as new on every refresh. */
+class FeedStore
+{
+public:
+    enum Change {
+        Unchanged,
+        Added,
+        Changed
+    };
+
+    explicit FeedStore(int capacity = 200);
+
+    void setCapacity(int capacity);
+    int capacity() const;
+    int count() const;
+
+    /* a new copy of the document starts, call before its first update() */
+    void beginRefresh();
+    Change update(const FeedItem &item);
+    void clear();
+
+private:
+    Q_DISABLE_COPY(FeedStore)
+
+    struct Entry {
+        uint hash;
+        int refresh;
+        /* where the key sits in mOrder, least recently seen first */
+        QLinkedList<QString>::iterator position;
+    };
+
+    void trim();
+
+    int mCapacity;
+    int mRefresh;
+    QHash<QString, Entry> mEntries;
+    QLinkedList<QString> mOrder;
+};
+
+#endif
@@ -0,0 +1,355 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+
+#include "testfeedengine.h"
+#include <feedengine.h>
+#include <feedparser.h>
+#include <feedstore.h>
+
+static QByteArray rssFeed(const QString &secondTitle = QString("Second"))
+{
+    return QString(
+        "<?xml version=\"1.0\"?>\n"
+        "<rss version=\"2.0\"><channel><title>PlexyDesk</title>\n"
+        "<item><title>First</title><link>http://plexydesk.org/1</link>"
+        "<guid>one</guid><description>first post</description></item>\n"
+        "<item><title>%1</title><link>http://plexydesk.org/2</link>"
+        "<guid>two</guid><description><![CDATA[second <b>post</b>]]></description></item>\n"
+        "<item><title>Third</title><link>http://plexydesk.org/3</link>"
+        "<description>no guid here</description></item>\n"
+        "</channel></rss>\n").arg(secondTitle).toUtf8();
+}
+
+static const char atomFeed[] =
+    "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+    "<feed xmlns=\"http://www.w3.org/2005/Atom\"><title>PlexyDesk</title>\n"
+    "<entry><title>Atom entry</title>"
+    "<link rel=\"edit\" href=\"http://plexydesk.org/edit/1\"/>"
+    "<link href=\"http://plexydesk.org/atom/1\"/>"
+    "<id>urn:plexydesk:1</id><updated>2012-01-01T00:00:00Z</updated>"
+    "<summary>an atom summary</summary></entry>\n"
+    "</feed>\n";
+
+static bool waitFor(const QSignalSpy &spy, int count, int timeout = 5000)
+{
+    QElapsedTimer timer;
+    timer.start();
+    while (spy.count() < count && timer.elapsed() < timeout)
+        QTest::qWait(10);
+    return spy.count() >= count;
+}
+
+LoopbackFeedServer::LoopbackFeedServer(QObject *parent) :
+    QTcpServer(parent), inFlight(0), maxInFlight(0), chunkSize(64)
+{
+    connect(this, SIGNAL(newConnection()), this, SLOT(onNewConnection()));
+    connect(&mTimer, SIGNAL(timeout()), this, SLOT(writeChunk()));
+    mTimer.setInterval(5);
+    listen(QHostAddress::LocalHost);
+}
+
+void LoopbackFeedServer::setFeed(const QString &path, const QByteArray &body, const QByteArray &etag)
+{
+    mFeeds[path] = qMakePair(body, etag);
+}
+
+QUrl LoopbackFeedServer::url(const QString &path) const
+{
+    return QUrl(QString("http://127.0.0.1:%1%2").arg(serverPort()).arg(path));
+}
+
+void LoopbackFeedServer::onNewConnection()
+{
+    while (hasPendingConnections()) {
+        QTcpSocket *socket = nextPendingConnection();
+        connect(socket, SIGNAL(readyRead()), this, SLOT(onReadyRead()));
+        connect(socket, SIGNAL(disconnected()), socket, SLOT(deleteLater()));
+    }
+}
+
+void LoopbackFeedServer::onReadyRead()
+{
+    QTcpSocket *socket = qobject_cast<QTcpSocket *>(sender());
+    QByteArray &buffer = mBuffers[socket];
+    buffer += socket->readAll();
+
+    const int end = buffer.indexOf("\r\n\r\n");
+    if (end < 0)
+        return;
+
+    const QByteArray request = buffer.left(end);
+    mBuffers.remove(socket);
+    requests.append(request);
+
+    inFlight++;
+    maxInFlight = qMax(maxInFlight, inFlight);
+
+    const QList<QByteArray> lines = request.split('\n');
+    const QString path = QString::fromLatin1(lines.first().split(' ').value(1));
+    QByteArray ifNoneMatch;
+    Q_FOREACH(const QByteArray &line, lines) {
+        const int colon = line.indexOf(':');
+        if (colon > 0 && line.left(colon).trimmed().toLower() == "if-none-match")
+            ifNoneMatch = line.mid(colon + 1).trimmed();
+    }
+
+    Response response;
+    response.socket = socket;
+    if (!mFeeds.contains(path)) {
+        response.data = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+    } else if (!ifNoneMatch.isEmpty() && ifNoneMatch == mFeeds[path].second) {
+        response.data = "HTTP/1.1 304 Not Modified\r\nETag: " + mFeeds[path].second +
+            "\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+    } else {
+        const QByteArray &body = mFeeds[path].first;
+        response.data = "HTTP/1.1 200 OK\r\nContent-Type: application/rss+xml\r\nETag: " +
+            mFeeds[path].second + "\r\nContent-Length: " + QByteArray::number(body.size()) +
+            "\r\nConnection: close\r\n\r\n" + body;
+    }
+
+    mResponses.append(response);
+    if (!mTimer.isActive())
+        mTimer.start();
+}
+
+void LoopbackFeedServer::writeChunk()
+{
+    QList<Response>::iterator it = mResponses.begin();
+    while (it != mResponses.end()) {
+        it->socket->write(it->data.left(chunkSize));
+        it->socket->flush();
+        it->data.remove(0, chunkSize);
+        if (it->data.isEmpty()) {
+            it->socket->disconnectFromHost();
+            inFlight--;
+            it = mResponses.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    if (mResponses.isEmpty())
+        mTimer.stop();
+}
+
+void TestFeedEngine::parsesRssInChunks()
+{
+    const QByteArray document = rssFeed();
+    FeedParser parser;
+    QList<FeedItem> items;
+
+    // worst case for an incremental parser, one byte per call
+    for (int i = 0; i < document.size(); i++) {
+        parser.addData(document.mid(i, 1));
+        items << parser.takeItems();
+    }
+
+    QVERIFY(!parser.hasError());
+    QCOMPARE(items.count(), 3);
+    QCOMPARE(items[0].title, QString("First"));
+    QCOMPARE(items[0].key(), QString("one"));
+    QCOMPARE(items[1].description, QString("second <b>post</b>"));
+    QCOMPARE(items[2].key(), QString("http://plexydesk.org/3"));
+}
+
+void TestFeedEngine::parsesAtom()
+{
+    FeedParser parser;
+    parser.addData(QByteArray(atomFeed));
+
+    const QList<FeedItem> items = parser.takeItems();
+    QCOMPARE(items.count(), 1);
+    QCOMPARE(items[0].title, QString("Atom entry"));
+    QCOMPARE(items[0].link, QString("http://plexydesk.org/atom/1"));
+    QCOMPARE(items[0].key(), QString("urn:plexydesk:1"));
+    QCOMPARE(items[0].published, QString("2012-01-01T00:00:00Z"));
+    QCOMPARE(items[0].description, QString("an atom summary"));
+}
+
+void TestFeedEngine::storeIsBounded()
+{
+    FeedStore store(3);
+    FeedItem item;
+    for (int i = 0; i < 5; i++) {
+        store.beginRefresh();
+        item.id = QString::number(i);
+        item.title = QString("title %1").arg(i);
+        QCOMPARE(store.update(item), FeedStore::Added);
+    }
+    QCOMPARE(store.count(), 3);
+
+    QCOMPARE(store.update(item), FeedStore::Unchanged);
+    item.title = "edited";
+    QCOMPARE(store.update(item), FeedStore::Changed);
+
+    // the oldest were forgotten
+    item.id = "0";
+    QCOMPARE(store.update(item), FeedStore::Added);
+}
+
+void TestFeedEngine::storeKeepsLongFeeds()
+{
+    FeedStore store(3);
+    FeedItem item;
+
+    // a feed twice the capacity, refreshed without changes
+    for (int refresh = 0; refresh < 2; refresh++) {
+        store.beginRefresh();
+        for (int i = 0; i < 6; i++) {
+            item.id = QString::number(i);
+            item.title = QString("title %1").arg(i);
+            QCOMPARE(store.update(item), refresh ? FeedStore::Unchanged : FeedStore::Added);
+        }
+    }
+    QCOMPARE(store.count(), 6);
+
+    // the items that fell off the feed make room for new ones
+    store.beginRefresh();
+    item.id = "new";
+    QCOMPARE(store.update(item), FeedStore::Added);
+    QCOMPARE(store.count(), 3);
+}
+
+void TestFeedEngine::incrementalUpdates()
+{
+    LoopbackFeedServer server;
+    server.chunkSize = 48;
+    server.setFeed("/rss", rssFeed(), "\"v1\"");
+
+    FeedEngine engine;
+    QSignalSpy updates(&engine, SIGNAL(itemsUpdated(QUrl, QVariantList, QVariantList)));
+    QSignalSpy finished(&engine, SIGNAL(feedFinished(QUrl, bool)));
+
+    engine.addFeed(server.url("/rss"));
+    engine.refresh(server.url("/rss"));
+    QVERIFY(waitFor(finished, 1));
+
+    // items were handed out while the document was still arriving
+    QVERIFY(updates.count() > 1);
+
+    int added = 0;
+    for (int i = 0; i < updates.count(); i++) {
+        added += updates.at(i).at(1).toList().count();
+        QVERIFY(updates.at(i).at(2).toList().isEmpty());
+    }
+    QCOMPARE(added, 3);
+}
+
+void TestFeedEngine::conditionalGet()
+{
+    LoopbackFeedServer server;
+    server.chunkSize = 4096;
+    server.setFeed("/rss", rssFeed(), "\"v1\"");
+
+    FeedEngine engine;
+    QSignalSpy updates(&engine, SIGNAL(itemsUpdated(QUrl, QVariantList, QVariantList)));
+    QSignalSpy finished(&engine, SIGNAL(feedFinished(QUrl, bool)));
+
+    engine.addFeed(server.url("/rss"));
+    engine.refresh(server.url("/rss"));
+    QVERIFY(waitFor(finished, 1));
+    QCOMPARE(finished.at(0).at(1).toBool(), true);
+    QCOMPARE(updates.count(), 1);
+
+    engine.refresh(server.url("/rss"));
+    QVERIFY(waitFor(finished, 2));
+
+    QCOMPARE(server.requests.count(), 2);
+    QVERIFY(server.requests.at(1).contains("\"v1\""));
+    QCOMPARE(finished.at(1).at(1).toBool(), false);
+    QCOMPARE(updates.count(), 1);
+}
+
+void TestFeedEngine::onlyChangedItems()
+{
+    LoopbackFeedServer server;
+    server.chunkSize = 4096;
+    server.setFeed("/rss", rssFeed(), "\"v1\"");
+
+    FeedEngine engine;
+    QSignalSpy updates(&engine, SIGNAL(itemsUpdated(QUrl, QVariantList, QVariantList)));
+    QSignalSpy finished(&engine, SIGNAL(feedFinished(QUrl, bool)));
+
+    engine.addFeed(server.url("/rss"));
+    engine.refresh(server.url("/rss"));
+    QVERIFY(waitFor(finished, 1));
+
+    server.setFeed("/rss", rssFeed("Second, edited"), "\"v2\"");
+    engine.refresh(server.url("/rss"));
+    QVERIFY(waitFor(finished, 2));
+
+    QCOMPARE(updates.count(), 2);
+    const QVariantList added = updates.at(1).at(1).toList();
+    const QVariantList changed = updates.at(1).at(2).toList();
+    QVERIFY(added.isEmpty());
+    QCOMPARE(changed.count(), 1);
+    QCOMPARE(changed.first().toMap()["title"].toString(), QString("Second, edited"));
+}
+
+void TestFeedEngine::truncatedDocument()
+{
+    LoopbackFeedServer server;
+    server.chunkSize = 4096;
+    const QByteArray document = rssFeed();
+    server.setFeed("/rss", document.left(document.indexOf("<item><title>Third")), "\"v1\"");
+
+    FeedEngine engine;
+    QSignalSpy finished(&engine, SIGNAL(feedFinished(QUrl, bool)));
+    QSignalSpy errors(&engine, SIGNAL(feedError(QUrl, QString)));
+
+    engine.addFeed(server.url("/rss"));
+    engine.refresh(server.url("/rss"));
+    QVERIFY(waitFor(errors, 1));
+    QCOMPARE(finished.count(), 0);
+
+    // the etag of a broken copy is not kept, the next refresh fetches it again
+    server.setFeed("/rss", document, "\"v1\"");
+    engine.refresh(server.url("/rss"));
+    QVERIFY(waitFor(finished, 1));
+    QCOMPARE(finished.at(0).at(1).toBool(), true);
+}
+
+void TestFeedEngine::boundedConcurrency()
+{
+    static const int FeedCount = 20;
+
+    LoopbackFeedServer server;
+    server.chunkSize = 256;
+
+    FeedEngine engine;
+    engine.setMaxConcurrent(3);
+    QSignalSpy finished(&engine, SIGNAL(feedFinished(QUrl, bool)));
+    QSignalSpy idle(&engine, SIGNAL(idle()));
+
+    for (int i = 0; i < FeedCount; i++) {
+        const QString path = QString("/feed/%1").arg(i);
+        server.setFeed(path, rssFeed(), "\"v1\"");
+        engine.addFeed(server.url(path));
+    }
+
+    engine.refreshAll();
+    QVERIFY(engine.activeCount() <= 3);
+    QCOMPARE(engine.activeCount() + engine.queuedCount(), FeedCount);
+
+    QVERIFY(waitFor(idle, 1, 20000));
+    QCOMPARE(finished.count(), FeedCount);
+    QVERIFY(server.maxInFlight <= 3);
+}
+
+QTEST_MAIN(TestFeedEngine)
@@ -0,0 +1,70 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+
+#include <QtTest/QtTest>
+#include <QtNetwork>
+
+/* serves canned feeds over HTTP on the loopback interface, a few bytes at a time */
+class LoopbackFeedServer : public QTcpServer
+{
+    Q_OBJECT
+
+public:
+    LoopbackFeedServer(QObject *parent = 0);
+
+    void setFeed(const QString &path, const QByteArray &body, const QByteArray &etag);
+    QUrl url(const QString &path) const;
+
+    QList<QByteArray> requests;
+    int inFlight;
+    int maxInFlight;
+    int chunkSize;
+
+private Q_SLOTS:
+    void onNewConnection();
+    void onReadyRead();
+    void writeChunk();
+
+private:
+    struct Response {
+        QTcpSocket *socket;
+        QByteArray data;
+    };
+
+    QHash<QString, QPair<QByteArray, QByteArray> > mFeeds;
+    QHash<QTcpSocket *, QByteArray> mBuffers;
+    QList<Response> mResponses;
+    QTimer mTimer;
+};
+
+class TestFeedEngine: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void parsesRssInChunks();
+    void parsesAtom();
+    void storeIsBounded();
+    void storeKeepsLongFeeds();
+    void incrementalUpdates();
+    void conditionalGet();
+    void onlyChangedItems();
+    void truncatedDocument();
+    void boundedConcurrency();
+};
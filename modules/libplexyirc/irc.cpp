@@ -1,31 +1,60 @@
 #include "irc.h"
 #include <QApplication>
-#include <QNetworkProxy>
+
+/* servers accept at most 512 bytes per message including CR LF, keep
+   enough room for the ":nick!user@host " prefix they add when relaying */
+static const int MaxTextBytes = 400;
+static const int MaxReadBuffer = 64 * 1024;
 
 IrcData::IrcData(QObject *p) : QObject(p)
 {
     this->Connected = 0;
+    service = 0;
+    port = 6667;
+    mMessageTime = 0;
+    mPenaltyMs = 2000;
+    mWindowMs = 10000;
+    mFloodTimer.setSingleShot(true);
+    connect(&mFloodTimer, SIGNAL(timeout()), SLOT(flushSendQueue()));
+    mClock.start();
 }
 
 IrcData::IrcData(QString server_arg, qint16 port_arg)
 {
     Connected = 0;
+    service = 0;
     server = server_arg;
     port = port_arg;
+    mMessageTime = 0;
+    mPenaltyMs = 2000;
+    mWindowMs = 10000;
+    mFloodTimer.setSingleShot(true);
+    connect(&mFloodTimer, SIGNAL(timeout()), SLOT(flushSendQueue()));
+    mClock.start();
 }
 
-void IrcData::connectToServer()
+IrcData::~IrcData()
 {
-    service = new QTcpSocket();
+    if (service)
+        service->abort();
+}
 
-    QNetworkProxy proxy;
-    proxy.setType(QNetworkProxy::HttpProxy);
-    proxy.setHostName("vsnlproxy.iitk.ac.in");
-    proxy.setPort(3128);
-    proxy.setUser("shankar");
-    proxy.setPassword("LINKINpark");
+void IrcData::setServer(const QString &server_arg, qint16 port_arg)
+{
+    server = server_arg;
+    port = port_arg;
+}
 
-    service->setProxy(proxy);
+void IrcData::connectToServer()
+{
+    if (service) {
+        service->abort();
+        service->deleteLater();
+    }
+
+    Connected = 0;
+    mReadBuffer.clear();
+    service = new QTcpSocket(this);
     service->connectToHost(server, port);
 
     connect(service, SIGNAL(error(QAbstractSocket::SocketError)), SLOT(errorHandler(QAbstractSocket::SocketError)));
@@ -36,96 +65,223 @@ void IrcData::connectToServer()
 
 void IrcData::setNick(QString nick)
 {
-    service->write(QString("NICK %1\r\n").arg(nick).toAscii());
+    mNick = nick;
+    enqueue(QString("NICK %1").arg(nick).toUtf8());
 }
 
 void IrcData::setUser(QString user, qint16 mode, QString unused, QString realName)
 {
-    service->write(QString("USER %1 %2 %3 :%4\r\n").arg(user).arg(mode).arg(unused).arg(realName).toAscii());
+    enqueue(QString("USER %1 %2 %3 :%4").arg(user).arg(mode).arg(unused).arg(realName).toUtf8());
 }
 
 void IrcData::joinChannel(QString channel)
 {
-    service->write(QString("JOIN %1\r\n").arg(channel).toAscii());
+    enqueue(QString("JOIN %1").arg(channel).toUtf8());
+}
+
+void IrcData::partChannel(const QString &channel)
+{
+    enqueue(QString("PART %1").arg(channel).toUtf8());
+}
+
+void IrcData::sendMessage(const QString &target, const QString &text)
+{
+    const QByteArray head = "PRIVMSG " + target.toUtf8() + " :";
+
+    Q_FOREACH(const QString &line, text.split('\n', QString::SkipEmptyParts)) {
+        QByteArray body = line.toUtf8();
+        while (!body.isEmpty()) {
+            int len = qMin(body.size(), MaxTextBytes);
+            /* never cut a UTF-8 sequence in half */
+            while (len < body.size() && len > 0 && (body.at(len) & 0xC0) == 0x80)
+                len--;
+            enqueue(head + body.left(len));
+            body.remove(0, len);
+        }
+    }
+}
+
+void IrcData::sendRaw(const QString &line)
+{
+    enqueue(line.toUtf8());
+}
+
+void IrcData::setFloodControl(int penaltyMs, int windowMs)
+{
+    mPenaltyMs = qMax(0, penaltyMs);
+    mWindowMs = qMax(mPenaltyMs, windowMs);
+}
+
+int IrcData::pendingLines() const
+{
+    return mSendQueue.count();
+}
+
+QString IrcData::nick() const
+{
+    return mNick;
+}
+
+void IrcData::enqueue(const QByteArray &line, bool urgent)
+{
+    /* a PONG held back by the flood timer can miss the server's ping
+       timeout, it goes out now and is only charged to the message clock */
+    if (urgent && service && Connected) {
+        const qint64 now = mClock.elapsed();
+        if (mMessageTime < now)
+            mMessageTime = now;
+        mMessageTime += mPenaltyMs;
+        service->write(line + "\r\n");
+        return;
+    }
+
+    if (urgent)
+        mSendQueue.prepend(line + "\r\n");
+    else
+        mSendQueue.enqueue(line + "\r\n");
+
+    if (!mFloodTimer.isActive())
+        flushSendQueue();
 }
 
-// void IrcData::init()
-// {
-//     service->write("NICK sharpBot\r\n");
-//     service->write("USER sharpBot 7 * :Mani Shankar's BOT\r\n");
-//     service->write("JOIN #plexydesk\r\n");
-// }
+void IrcData::flushSendQueue()
+{
+    if (!service || !Connected)
+        return;
+
+    const qint64 now = mClock.elapsed();
+    if (mMessageTime < now)
+        mMessageTime = now;
+
+    QByteArray chunk;
+    while (!mSendQueue.isEmpty() && mMessageTime + mPenaltyMs - now <= mWindowMs) {
+        chunk += mSendQueue.dequeue();
+        mMessageTime += mPenaltyMs;
+    }
+
+    if (!chunk.isEmpty())
+        service->write(chunk);
+
+    if (!mSendQueue.isEmpty())
+        mFloodTimer.start(int(mMessageTime + mPenaltyMs - now - mWindowMs));
+}
 
-int i = 1;
 void IrcData::parse()
 {
-    char buffer[1024];
-    char tempBuffer[1024];
-    bool append;
-    QString *currentLine;
-    QString *host;
-    while(service->readLine(buffer, sizeof(buffer)) > 0) {
-        if(QString(buffer).endsWith("\r\n")) {
-            if(append) {
-                currentLine = new QString(tempBuffer);
-                currentLine->append(QString(buffer));
-                append = 0;
-            }
-            else {
-                currentLine = new QString(buffer);
-            }
+    mReadBuffer += service->readAll();
+
+    int start = 0;
+    int end;
+    while ((end = mReadBuffer.indexOf('\n', start)) != -1) {
+        int len = end - start;
+        if (len > 0 && mReadBuffer.at(end - 1) == '\r')
+            len--;
+        if (len > 0)
+            processLine(QByteArray::fromRawData(mReadBuffer.constData() + start, len));
+        start = end + 1;
+    }
+    mReadBuffer.remove(0, start);
+
+    /* a server sending us an unterminated line this long is broken */
+    if (mReadBuffer.size() > MaxReadBuffer)
+        mReadBuffer.clear();
+}
+
+void IrcData::processLine(const QByteArray &line)
+{
+    QByteArray prefix;
+    int pos = 0;
+
+    if (line.startsWith(':')) {
+        pos = line.indexOf(' ');
+        if (pos == -1)
+            return;
+        prefix = line.mid(1, pos - 1);
+        pos++;
+    }
+
+    QList<QByteArray> params;
+    QByteArray command;
+    while (pos < line.size()) {
+        if (line.at(pos) == ':' && !command.isEmpty()) {
+            params.append(line.mid(pos + 1));
+            break;
         }
-        else{
-            for(int i = 0; i<1024; i++)
-                tempBuffer[i] = buffer[i];
-            append = 1;
-            continue;
+        int next = line.indexOf(' ', pos);
+        if (next == -1)
+            next = line.size();
+        if (next > pos) {
+            if (command.isEmpty())
+                command = line.mid(pos, next - pos).toUpper();
+            else
+                params.append(line.mid(pos, next - pos));
         }
-        QString *arg1;
-        QString *arg2;
-
-        if((currentLine->left(1)).compare(":")==0) {
-            currentLine->remove(0, 1);      // remove the prefix :
-            QRegExp argRegExp("([^\\s]*)[\\s].*");
-            int pos = argRegExp.indexIn(*currentLine);
-            if(pos>-1) {
-                arg1 = new QString(argRegExp.cap(1));
-            }
-            QString *restLine;
-            QRegExp restRegExp("[^\\s]*[\\s](.*)");
-            pos = restRegExp.indexIn(*currentLine);
-            if(pos>-1) {
-                restLine = new QString(restRegExp.cap(1));
-            }
-            pos = argRegExp.indexIn(*restLine);
-            if(pos>-1) {
-                arg2 = new QString(argRegExp.cap(1));
-            }
-            if(i==4 || i==5) {
-                host = new QString(*arg1);
-            }
-            if( arg1->compare(*host) == 0)
-            {
-                switch(arg2->toInt()) {
-                case 1: emit userResponse(UserOK, "User OK");
-                    emit nickResponse(NickOK, "Nick OK");
-                    break;
-                case 431: emit nickResponse(NoNickGiven, "No Nick Given");
-                    break;
-                case 433: emit nickResponse(NickInUse, "Nick in Use");
-                    break;
-                case 462: emit userResponse(UserAlreadyRegistered, "User already registered");
-                    break;
-                default: break;
-                }
+        pos = next + 1;
+    }
+
+    if (command.isEmpty())
+        return;
+
+    const QString nick = QString::fromUtf8(prefix.left(prefix.indexOf('!')));
+
+    if (command == "PING") {
+        /* answer ahead of everything else or the server drops us */
+        enqueue("PONG :" + params.value(0), true);
+    } else if (command == "PRIVMSG" || command == "NOTICE") {
+        if (params.count() >= 2)
+            emit messageReceived(QString::fromUtf8(params.at(0)), nick,
+                    QString::fromUtf8(params.at(1)));
+    } else if (command == "001") {
+        emit userResponse(UserOK, "User OK");
+        emit nickResponse(NickOK, "Nick OK");
+    } else if (command == "431") {
+        emit nickResponse(NoNickGiven, "No Nick Given");
+    } else if (command == "432") {
+        emit nickResponse(ErroneusNick, "Erroneus Nick");
+    } else if (command == "433") {
+        emit nickResponse(NickInUse, "Nick in Use");
+    } else if (command == "436") {
+        emit nickResponse(NickCollision, "Nick Collision");
+    } else if (command == "437") {
+        emit nickResponse(UnavailResource, "Nick/Channel is temporarily unavailable");
+    } else if (command == "484") {
+        emit nickResponse(Restricted, "Connection is restricted");
+    } else if (command == "462") {
+        emit userResponse(UserAlreadyRegistered, "User already registered");
+    } else if (command == "353") {
+        /* RPL_NAMREPLY: <me> <type> <channel> :<nick list> */
+        if (params.count() >= 4) {
+            QList<User> &users = mNames[QString::fromUtf8(params.at(2))];
+            Q_FOREACH(QByteArray name, params.at(3).split(' ')) {
+                if (name.isEmpty())
+                    continue;
+                if (name.at(0) == '@' || name.at(0) == '+')
+                    name.remove(0, 1);
+                users.append(User(QString::fromUtf8(name), QString(), QString()));
             }
         }
-        i++;
+    } else if (command == "366") {
+        /* RPL_ENDOFNAMES */
+        if (params.count() >= 2) {
+            const QString channel = QString::fromUtf8(params.at(1));
+            emit channelResponse(ChannelOK, QString(""), channel, mNames.take(channel));
+        }
+    } else if (command == "473") {
+        if (params.count() >= 2)
+            emit channelResponse(InviteRequired, "Invite only channel",
+                    QString::fromUtf8(params.at(1)), QList<User>());
+    } else if (command == "475" || command == "474") {
+        if (params.count() >= 2)
+            emit channelResponse(PrivateChannel, "Cannot join channel",
+                    QString::fromUtf8(params.at(1)), QList<User>());
     }
 }
 
 void IrcData::errorHandler(QAbstractSocket::SocketError err)
 {
+    Connected = 0;
+    mFloodTimer.stop();
+
     switch(err) {
     case QAbstractSocket::ConnectionRefusedError:
         emit(connectResponse(ConnectionRefusedError, "ConnectionRefusedError")); break;
@@ -165,6 +321,8 @@ void IrcData::setConnected()
 {
     emit(connectResponse(ConnectOK, "Connect OK"));
     Connected = 1;
+    /* NICK/USER/JOIN issued before the socket came up are waiting */
+    flushSendQueue();
 }
 
 bool IrcData::isConnected()
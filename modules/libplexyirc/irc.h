@@ -1,5 +1,7 @@
 #include <QtCore>
 #include <QTcpSocket>
+#include <QQueue>
+#include <QElapsedTimer>
 #include "user.h"
 
 #ifndef IRC_H
@@ -51,8 +53,14 @@ class IrcData : public QObject
 public:
     IrcData(QObject *p = 0);
     IrcData(QString server, qint16 port);
+    ~IrcData();
     bool isConnected();
 
+    /*!
+       Sets the server to use for the next connectToServer() call
+     */
+    void setServer(const QString &server, qint16 port);
+
     /*!
        Asynchonously emits connectResponse(ConnectResponseType response,QString error)
      */
@@ -73,6 +81,12 @@ public:
      */
     void joinChannel(QString channelName);
 
+    /*!
+       Leaves the channel, no response is emitted
+       \param channelName Channel name to leave
+     */
+    void partChannel(const QString &channelName);
+
     /*!
        Asynchronousy emits userResponse(UserResponseType,QString)
        \param user Username
@@ -82,6 +96,39 @@ public:
      */
     void setUser(QString user, qint16 mode, QString unused, QString realName);
 
+    /*!
+       Queues a PRIVMSG to a channel or a nick, long texts are split
+       into several lines so that each one fits in a single IRC message
+       \param target channel or nick to send the message to
+       \param text message text
+     */
+    void sendMessage(const QString &target, const QString &text);
+
+    /*!
+       Queues a raw protocol line, the CR LF terminator is appended
+       \param line the line to send
+     */
+    void sendRaw(const QString &line);
+
+    /*!
+       Configures the client side flood control. Every line sent adds
+       \a penaltyMs to the message clock and a line is written only if the
+       clock stays at most \a windowMs ahead of the wall clock, which
+       is the scheme servers use to decide when to drop a client for
+       flooding (RFC 1459, 8.10). Defaults are 2000 ms and 10000 ms.
+     */
+    void setFloodControl(int penaltyMs, int windowMs);
+
+    /*!
+       Number of lines waiting in the send queue
+     */
+    int pendingLines() const;
+
+    /*!
+       The nick last requested with setNick()
+     */
+    QString nick() const;
+
 signals:
 
     /*!
@@ -115,6 +162,14 @@ signals:
      */
     void userResponse(UserResponseType response, QString error);
 
+    /*!
+       Emitted for every PRIVMSG and NOTICE received
+       \param target channel the message was sent to, or our own nick for private messages
+       \param nick nick of the sender
+       \param text message text
+     */
+    void messageReceived(const QString &target, const QString &nick, const QString &text);
+
 public slots:
 
     /*!
@@ -132,11 +187,30 @@ public slots:
      */
     void parse();
 
+private slots:
+    /*!
+       Writes as many queued lines as the flood control allows and
+       schedules itself for the rest
+     */
+    void flushSendQueue();
+
 private:
+    void enqueue(const QByteArray &line, bool urgent = false);
+    void processLine(const QByteArray &line);
+
     QTcpSocket *service;
     QString server;
     qint16 port;
     bool Connected;
+
+    QString mNick;
+    QByteArray mReadBuffer;
+    QQueue<QByteArray> mSendQueue;
+    QTimer mFloodTimer;
+    QElapsedTimer mClock;
+    qint64 mMessageTime;
+    int mPenaltyMs;
+    int mWindowMs;
+    QHash<QString, QList<User> > mNames;
 };
 #endif
-
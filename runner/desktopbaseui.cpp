@@ -36,6 +36,16 @@
 
 using namespace PlexyDesk;
 
+/* Views for the screens other than the one the view plugin drives. They share
+   the plugin's scene and only show their own part of it, the widgets and the
+   session stay with the plugin view. */
+class ScreenView : public AbstractDesktopView
+{
+public:
+    ScreenView(QGraphicsScene *scene) : AbstractDesktopView(scene) {}
+    void layout(const QRectF &) {}
+};
+
 class DesktopBaseUi::DesktopBaseUiPrivate
 {
     public:
@@ -58,6 +68,7 @@ DesktopBaseUi::DesktopBaseUi(QWidget *parent) :
     setup();
 
     connect (d->mDesktopWidget, SIGNAL(resized(int)), this, SLOT(screenResized(int)));
+    connect (d->mDesktopWidget, SIGNAL(screenCountChanged(int)), this, SLOT(screenCountChanged(int)));
 }
 
 DesktopBaseUi::~DesktopBaseUi()
@@ -96,14 +107,39 @@ void DesktopBaseUi::setup()
         return;
     }
 
-    view->resize(desktopRect().size());
-    view->move(desktopRect().x(),
-               desktopRect().y());
+    // scene coordinates are desktop coordinates, each view shows one screen of it
+    scene->setSceneRect(desktopRect());
+
+    d->mDesktopView = view;
+    const int primary = d->mDesktopWidget->primaryScreen();
+    d->mViewList[primary] = view;
+    setupView(view, primary);
+
+    for (int i = 0; i < d->mDesktopWidget->screenCount(); i++) {
+        if (i != primary)
+            addScreen(i);
+    }
+
+    QWidget *parentWidget = qobject_cast<QWidget*>(parent());
+    if(parentWidget)
+        this->resize(desktopRect().size());
 
-    view->setSceneRect (desktopRect());
+    view->layout(d->mDesktopWidget->screenGeometry(primary));
+}
+
+void DesktopBaseUi::setupView(AbstractDesktopView *view, int screen)
+{
+    placeView(view, screen);
 
     view->setDragMode(QGraphicsView::RubberBandDrag);
 
+    // "none", "bsp" or "adaptive" (default)
+    const QString sceneIndex = d->mConfig->coreSettings()->value(QLatin1String("sceneIndex")).toString();
+    if (sceneIndex == QLatin1String("none"))
+        view->setIndexMethod(AbstractDesktopView::NoIndex);
+    else if (sceneIndex == QLatin1String("bsp"))
+        view->setIndexMethod(AbstractDesktopView::BspTreeIndex);
+
 #ifdef Q_WS_X11
     NETWinInfo info(QX11Info::display(), view->winId(), QX11Info::appRootWindow(), NET::WMDesktop );
     info.setDesktop(NETWinInfo::OnAllDesktops);
@@ -111,11 +147,10 @@ void DesktopBaseUi::setup()
 #endif
 
     //view->showLayer(QLatin1String("Widgets"));
-    d->mViewList[0] = view;
     QWidget *parentWidget = qobject_cast<QWidget*>(parent());
     if(parentWidget) {
-        this->resize(view->size());
         view->setParent(this);
+        placeView(view, screen);
 
 #ifdef Q_WS_MAC
         //TODO: until we write our own NSView we do this for mac (issue : 169)
@@ -131,40 +166,78 @@ void DesktopBaseUi::setup()
 #ifdef PLEXYNAME
     view->setWindowTitle(QString(PLEXYNAME));
 #endif
-
-    view->layout(desktopRect());
 }
 
-void DesktopBaseUi::screenResized(int screen)
+void DesktopBaseUi::placeView(AbstractDesktopView *view, int screen)
 {
-    if(!screen)
-        return;
-
-    QGraphicsView *view = d->mViewList[screen];
     QRect desktopScreenRect = d->mDesktopWidget->screenGeometry(screen);
 #ifdef Q_WS_WIN
     // A 1px hack to make the widget fullscreen and not covering the toolbar on Win
     desktopScreenRect.setHeight(desktopScreenRect.height()-1);
 #endif
 
+    // one backing store per screen, sized to that screen only
     view->resize(desktopScreenRect.size());
+    if (view->parentWidget())
+        view->move(desktopScreenRect.topLeft() - desktopRect().topLeft());
+    else
+        view->move(desktopScreenRect.topLeft());
+    view->setSceneRect(desktopScreenRect);
 }
 
-QRect DesktopBaseUi::desktopRect() const
+void DesktopBaseUi::addScreen(int screen)
 {
-   if (d->mDesktopWidget->screenCount() == 1) {
-        return d->mDesktopWidget->screenGeometry();
-   }
+    if (d->mViewList.contains(screen) || !d->mScene)
+        return;
 
-   int total_width = 0;
-   int total_height = 0;
+    AbstractDesktopView *view = new ScreenView(d->mScene);
+    d->mViewList[screen] = view;
+    setupView(view, screen);
+}
 
-   for (int i = 0 ; i < d->mDesktopWidget->screenCount(); i++) {
-        total_width += d->mDesktopWidget->screenGeometry(i).width();
-        total_height += d->mDesktopWidget->screenGeometry(i).height();
-   }
+void DesktopBaseUi::screenResized(int screen)
+{
+    AbstractDesktopView *view = d->mViewList.value(screen);
+    if (!view)
+        return;
+
+    if (d->mScene)
+        d->mScene->setSceneRect(desktopRect());
+    placeView(view, screen);
+
+    if (d->mDesktopView)
+        d->mDesktopView->updateScreenBackgrounds();
+}
+
+void DesktopBaseUi::screenCountChanged(int count)
+{
+    if (!d->mDesktopView)
+        return;
+
+    // the plugin view holds the widgets, it is never dropped with its screen
+    Q_FOREACH (int screen, d->mViewList.keys()) {
+        AbstractDesktopView *view = d->mViewList.value(screen);
+        if (screen >= count && view != d->mDesktopView)
+            delete d->mViewList.take(screen);
+    }
+
+    for (int i = 0; i < count; i++)
+        addScreen(i);
+
+    d->mScene->setSceneRect(desktopRect());
+    Q_FOREACH (int screen, d->mViewList.keys())
+        placeView(d->mViewList.value(screen), screen);
+
+    d->mDesktopView->updateScreenBackgrounds();
+}
+
+QRect DesktopBaseUi::desktopRect() const
+{
+   QRect rect;
+   for (int i = 0 ; i < d->mDesktopWidget->screenCount(); i++)
+        rect |= d->mDesktopWidget->screenGeometry(i);
 
-   return QRect (0, 0, total_width, total_height);
+   return rect;
 }
 
 QList<AbstractDesktopView *> DesktopBaseUi::views() const
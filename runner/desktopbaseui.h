@@ -20,10 +20,14 @@ public:
 
 public Q_SLOTS:
     void screenResized(int screen);
+    void screenCountChanged(int count);
 
 private:
     void setup_single();
     void setup();
+    void setupView(PlexyDesk::AbstractDesktopView *view, int screen);
+    void placeView(PlexyDesk::AbstractDesktopView *view, int screen);
+    void addScreen(int screen);
     class DesktopBaseUiPrivate;
     DesktopBaseUiPrivate *const d;
 };
@@ -30,10 +30,21 @@ extern "C" {
 }
 #include <QX11Info>
 
+static const int ThumbnailScale = 5;
+static const int MaxDamageRects = 16;
+
+/* under the raster graphics system QPixmap::fromX11Pixmap() copies the
+   whole window instead of wrapping the server pixmap */
+static bool wrapsServerPixmaps()
+{
+    static const bool wraps = QPixmap(1, 1).handle() != 0;
+    return wraps;
+}
+
 class PlexyWindows::Private
 {
 public:
-    Private() {
+    Private() : refreshes(0), rescaled(0) {
     }
     ~Private() {
     }
@@ -44,7 +55,16 @@ public:
     Pixmap pixmap;
     bool isRedirected;
     QPixmap plexypixmap;
+    /* window sized copy of the damaged areas when plexypixmap can't wrap */
+    QImage contents;
     XWindowChanges changeSet;
+
+    QPixmap thumbnail;
+    QRegion pendingDamage;
+    QTimer refreshTimer;
+    QElapsedTimer lastRefresh;
+    int refreshes;
+    qint64 rescaled;
 };
 
 PlexyWindows::PlexyWindows(Display *dsp, Window win, XWindowAttributes *attr, QWidget *parent, Qt::WindowFlags f  )
@@ -59,6 +79,10 @@ PlexyWindows::PlexyWindows(Display *dsp, Window win, XWindowAttributes *attr, QW
     d->damage = XDamageCreate (dsp, win, XDamageReportNonEmpty);
     d->isRedirected = false;
 
+    d->refreshTimer.setSingleShot(true);
+    d->refreshTimer.setInterval(66);
+    connect(&d->refreshTimer, SIGNAL(timeout()), this, SLOT(refreshThumbnail()));
+
     if (attr->map_state == IsViewable) {
         attr->map_state == IsUnmapped;
         Mapped(attr->override_redirect);
@@ -66,6 +90,13 @@ PlexyWindows::PlexyWindows(Display *dsp, Window win, XWindowAttributes *attr, QW
 
 }
 
+PlexyWindows::~PlexyWindows()
+{
+    ReleaseWindow();
+    XDamageDestroy(d->display, d->damage);
+    delete d;
+}
+
 void PlexyWindows::Destroyed ()
 {
 }
@@ -79,9 +110,14 @@ void PlexyWindows::Mapped (bool override_redirect)
         qDebug() << Q_FUNC_INFO << XGetAtomName(d->display, atoms[i]);
         //XGetWindowProperty(d->display, d->window, atoms[i], 32, 32, FALSE
     }
-    qDebug() << Q_FUNC_INFO <<  *atoms << num;
+    qDebug() << Q_FUNC_INFO << num;
+    if (atoms)
+        XFree(atoms);
     d->attrib.map_state = IsViewable;
     d->attrib.override_redirect = override_redirect;
+
+    // a remapped window gets a new backing pixmap
+    ReleaseWindow();
     bind();
 }
 
@@ -102,7 +138,10 @@ void PlexyWindows::bind()
                 qDebug()<<"Bad Pixmap not created"<<endl;
             } else {
                 qDebug()<<"Goodpixmap"<<endl;
-                d->plexypixmap = QPixmap::fromX11Pixmap(d->pixmap);
+                if (wrapsServerPixmaps())
+                    d->plexypixmap = QPixmap::fromX11Pixmap(d->pixmap);
+                d->pendingDamage = QRect(0, 0, d->attrib.width, d->attrib.height);
+                scheduleRefresh();
             }
         }
         XUngrabServer (d->display);
@@ -147,29 +186,168 @@ void PlexyWindows::Configured (bool isNotify, int x, int y, int width, int heigh
 
 void PlexyWindows::Damaged(XRectangle *rect)
 {
-    bind();
-    if (!rect) {
-        XRectangle allrect = { d->attrib.x, d->attrib.y, d->attrib.width, d->attrib.height };
-        Damaged (&allrect);
+    // the named pixmap stays valid until the window is resized or remapped
+    if (!d->pixmap)
+        bind();
+    if (!d->pixmap)
+        return;
+
+    if (rect)
+        d->pendingDamage += QRect(rect->x, rect->y, rect->width, rect->height);
+    else
+        d->pendingDamage += QRect(0, 0, d->attrib.width, d->attrib.height);
+
+    // rearm the report, the next damage has to reach us as well
+    XDamageSubtract(d->display, d->damage, None, None);
+    scheduleRefresh();
+}
+
+void PlexyWindows::scheduleRefresh()
+{
+    if (d->refreshTimer.isActive())
         return;
+
+    int wait = 0;
+    if (d->lastRefresh.isValid())
+        wait = qMax(qint64(0), d->refreshTimer.interval() - d->lastRefresh.elapsed());
+    d->refreshTimer.start(wait);
+}
+
+void PlexyWindows::refreshThumbnail()
+{
+    if (!d->pixmap || d->pendingDamage.isEmpty())
+        return;
+
+    const QSize size(qMax(1, d->attrib.width / ThumbnailScale),
+            qMax(1, d->attrib.height / ThumbnailScale));
+    if (d->thumbnail.size() != size) {
+        d->thumbnail = QPixmap(size);
+        d->thumbnail.fill(Qt::transparent);
+        d->pendingDamage = QRect(0, 0, d->attrib.width, d->attrib.height);
     }
 
-    if (d->pixmap) {
-        d->plexypixmap = QPixmap::fromX11Pixmap(d->pixmap);
-        //  update(QRect(rect->x,rect->y,rect->width,rect->height));
-        update();
-        qDebug()<<Q_FUNC_INFO<<endl;
+    const QRect window(0, 0, d->attrib.width, d->attrib.height);
+    if (d->plexypixmap.isNull() && d->contents.size() != window.size()) {
+        d->contents = QImage(window.size(), d->attrib.depth == 32
+                ? QImage::Format_ARGB32_Premultiplied : QImage::Format_RGB32);
+        d->contents.fill(0);
+    }
+
+    QVector<QRect> rects = d->pendingDamage.rects();
+    if (rects.count() > MaxDamageRects)
+        rects = QVector<QRect>() << d->pendingDamage.boundingRect();
+    d->pendingDamage = QRegion();
+
+    QRegion changed;
+    QPainter painter(&d->thumbnail);
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+    Q_FOREACH(const QRect &rect, rects) {
+        // snap to whole thumbnail pixels so neighbouring refreshes leave no seams
+        const QRect target = QRect(QPoint(rect.left() / ThumbnailScale, rect.top() / ThumbnailScale),
+                QPoint(rect.right() / ThumbnailScale, rect.bottom() / ThumbnailScale))
+            & d->thumbnail.rect();
+        if (target.isEmpty())
+            continue;
+
+        const QRect source(target.topLeft() * ThumbnailScale, target.size() * ThumbnailScale);
+        if (d->plexypixmap.isNull()) {
+            fetchContents(source & window);
+            painter.drawImage(target, d->contents, source);
+        } else {
+            painter.drawPixmap(target, d->plexypixmap, source);
+        }
+        changed += target;
+        d->rescaled += target.width() * target.height();
+    }
+    painter.end();
+
+    d->refreshes++;
+    d->lastRefresh.start();
+
+    const QPointF origin = boundingRect().topLeft();
+    Q_FOREACH(const QRect &rect, changed.rects())
+        update(QRectF(rect).translated(origin));
+}
+
+/* reads just \a rect of the server pixmap, the rest of contents is kept */
+void PlexyWindows::fetchContents(const QRect &rect)
+{
+    if (rect.isEmpty())
+        return;
+
+    XImage *image = XGetImage(d->display, d->pixmap, rect.x(), rect.y(),
+            rect.width(), rect.height(), AllPlanes, ZPixmap);
+    if (!image)
+        return;
+
+    // without an alpha channel the top byte is undefined, keep it opaque
+    const quint32 opaque = d->attrib.depth == 32 ? 0 : 0xff000000;
+    for (int y = 0; y < rect.height(); y++) {
+        quint32 *line = reinterpret_cast<quint32 *>(d->contents.scanLine(rect.y() + y)) + rect.x();
+        if (image->bits_per_pixel == 32) {
+            const quint32 *src = reinterpret_cast<const quint32 *>(image->data + y * image->bytes_per_line);
+            for (int x = 0; x < rect.width(); x++)
+                line[x] = src[x] | opaque;
+        } else {
+            for (int x = 0; x < rect.width(); x++)
+                line[x] = quint32(XGetPixel(image, x, y)) | opaque;
+        }
     }
+
+    XDestroyImage(image);
 }
 
 void PlexyWindows::paintFrontView(QPainter *painter, const QRectF &rect)
 {
-    AbstractDesktopWidget::paintFrontView(painter, rect);
-    painter->save();
-    float width = d->plexypixmap.width() / 5;
-    float height = d->plexypixmap.height() / 5;
-    painter->drawPixmap(rect.x(), rect.y(), width, height, d->plexypixmap);
-    painter->restore();
+    if (d->thumbnail.isNull())
+        return;
+
+    const QRectF bounds(boundingRect().topLeft(), d->thumbnail.size());
+    const QRectF target = rect & bounds;
+    painter->drawPixmap(target, d->thumbnail, target.translated(-bounds.topLeft()));
+}
+
+void PlexyWindows::paintRotatedView(QPainter *painter, const QRectF &rect)
+{
+    Q_UNUSED(painter);
+    Q_UNUSED(rect);
+}
+
+void PlexyWindows::paintDockView(QPainter *painter, const QRectF &rect)
+{
+    paintFrontView(painter, rect);
+}
+
+void PlexyWindows::paintEditMode(QPainter *painter, const QRectF &rect)
+{
+    Q_UNUSED(painter);
+    Q_UNUSED(rect);
+}
+
+void PlexyWindows::setRefreshInterval(int msecs)
+{
+    d->refreshTimer.setInterval(qMax(0, msecs));
+}
+
+int PlexyWindows::refreshInterval() const
+{
+    return d->refreshTimer.interval();
+}
+
+QPixmap PlexyWindows::thumbnail() const
+{
+    return d->thumbnail;
+}
+
+int PlexyWindows::refreshCount() const
+{
+    return d->refreshes;
+}
+
+qint64 PlexyWindows::rescaledArea() const
+{
+    return d->rescaled;
 }
 
 void PlexyWindows::ClientMessaged (Atom type, int format, long *data /*[5]*/)
@@ -183,19 +361,9 @@ void PlexyWindows::Resized(int x, int y, int width, int height, int border)
     qDebug()<<x<<y<<width<<height<<border<<endl;
     qDebug()<<d->attrib.width<<d->attrib.height<<d->attrib.border_width<<endl;
 
-    if (width != d->attrib.width || height != d->attrib.height || border != d->attrib.border_width || d->attrib.override_redirect) {
-        qDebug()<<Q_FUNC_INFO<<endl;
-        if (d->isRedirected) {
-            qDebug()<<Q_FUNC_INFO<<endl;
-            ReleaseWindow ();
-            d->pixmap = XCompositeNameWindowPixmap (d->display, d->window);
-            if (d->pixmap == None) {
-                return;
-            }
+    const bool rename = width != d->attrib.width || height != d->attrib.height
+        || border != d->attrib.border_width || d->attrib.override_redirect;
 
-            Damaged(NULL);
-        }
-    }
     d->attrib.height = height;
     d->attrib.width = width;
     d->attrib.border_width = border;
@@ -208,10 +376,24 @@ void PlexyWindows::Resized(int x, int y, int width, int height, int border)
     d->changeSet.x = x;
     d->changeSet.y = y;
     ////setRect(x, y, width, height);
+
+    // a resize reallocates the backing pixmap, name the new one
+    if (rename && d->isRedirected) {
+        qDebug()<<Q_FUNC_INFO<<endl;
+        ReleaseWindow ();
+        bind();
+    }
 }
 
 void PlexyWindows::ReleaseWindow ()
 {
+    d->refreshTimer.stop();
+    d->pendingDamage = QRegion();
+    d->thumbnail = QPixmap();
+    // drop the wrapper before the server pixmap goes away
+    d->plexypixmap = QPixmap();
+    d->contents = QImage();
+
     if (d->pixmap) {
         XFreePixmap(d->display, d->pixmap);
         d->pixmap = None;
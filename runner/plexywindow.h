@@ -32,10 +32,23 @@ class PlexyWindows : public PlexyDesk::AbstractDesktopWidget
     Q_OBJECT
 public:
     PlexyWindows(Display *d, Window w, XWindowAttributes *attr, QWidget *parent = 0, Qt::WindowFlags f = 0);
-    virtual ~PlexyWindows() {
-    }
+    virtual ~PlexyWindows();
 
     virtual void paintFrontView(QPainter *painter, const QRectF &rect);
+    virtual void paintRotatedView(QPainter *painter, const QRectF &rect);
+    virtual void paintDockView(QPainter *painter, const QRectF &rect);
+    virtual void paintEditMode(QPainter *painter, const QRectF &rect);
+
+    /* damage is collected and rescaled into the thumbnail at most once
+       per interval, 66ms by default */
+    void setRefreshInterval(int msecs);
+    int refreshInterval() const;
+
+    QPixmap thumbnail() const;
+    int refreshCount() const;
+    /* thumbnail pixels rescaled so far, for tests and profiling */
+    qint64 rescaledArea() const;
+
     void Destroyed ();
     void Mapped (bool override_redirect);
     void Unmapped ();
@@ -54,7 +67,14 @@ public:
     void ReleaseWindow ();
    // virtual QRectF boundingRect() const;
 
+private Q_SLOTS:
+    void refreshThumbnail();
+
 private:
+    void scheduleRefresh();
+    void fetchContents(const QRect &rect);
+
+
     class Private;
     Private *const d;
 };
@@ -0,0 +1,151 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+
+#include "testplexywindow.h"
+
+#include <QX11Info>
+
+#include <plexywindow.h>
+
+extern "C" {
+#include <X11/extensions/Xcomposite.h>
+}
+
+static const int ClientWidth = 400;
+static const int ClientHeight = 300;
+static const int RefreshInterval = 50;
+
+static QRgb thumbnailPixel(PlexyWindows *window, int x, int y)
+{
+    return window->thumbnail().toImage().pixel(x, y) & RGB_MASK;
+}
+
+void TestPlexyWindow::initTestCase()
+{
+    mDisplay = QX11Info::display();
+
+    int event, error;
+    if (!XCompositeQueryExtension(mDisplay, &event, &error))
+        QSKIP("the X server has no Composite extension", SkipAll);
+}
+
+void TestPlexyWindow::init()
+{
+    mClient = XCreateSimpleWindow(mDisplay, QX11Info::appRootWindow(), 10, 10,
+            ClientWidth, ClientHeight, 0, 0, 0x000000);
+    mGc = XCreateGC(mDisplay, mClient, 0, 0);
+    XMapWindow(mDisplay, mClient);
+    XSync(mDisplay, False);
+}
+
+void TestPlexyWindow::cleanup()
+{
+    XFreeGC(mDisplay, mGc);
+    XDestroyWindow(mDisplay, mClient);
+    XSync(mDisplay, False);
+}
+
+void TestPlexyWindow::paint(const QRect &rect, unsigned long pixel)
+{
+    XSetForeground(mDisplay, mGc, pixel);
+    XFillRectangle(mDisplay, mClient, mGc, rect.x(), rect.y(), rect.width(), rect.height());
+    XSync(mDisplay, False);
+}
+
+void TestPlexyWindow::damageIsCoalesced()
+{
+    XWindowAttributes attr;
+    XGetWindowAttributes(mDisplay, mClient, &attr);
+    PlexyWindows window(mDisplay, mClient, &attr);
+    window.setRefreshInterval(RefreshInterval);
+
+    // the first refresh after mapping covers the whole window
+    QTest::qWait(RefreshInterval * 2);
+    QCOMPARE(window.refreshCount(), 1);
+    QCOMPARE(window.thumbnail().size(), QSize(ClientWidth / 5, ClientHeight / 5));
+
+    // a burst of damage inside one interval is a single rescale
+    for (int i = 0; i < 100; i++) {
+        XRectangle rect = { short(i * 3), short(i * 2), 10, 10 };
+        window.Damaged(&rect);
+    }
+    QTest::qWait(RefreshInterval * 2);
+    QCOMPARE(window.refreshCount(), 2);
+}
+
+void TestPlexyWindow::onlyDamageIsRescaled()
+{
+    XWindowAttributes attr;
+    XGetWindowAttributes(mDisplay, mClient, &attr);
+    PlexyWindows window(mDisplay, mClient, &attr);
+    window.setRefreshInterval(RefreshInterval);
+    QTest::qWait(RefreshInterval * 2);
+
+    const qint64 full = window.rescaledArea();
+    QCOMPARE(full, qint64(ClientWidth / 5 * ClientHeight / 5));
+
+    // paint two areas but only report one of them
+    paint(QRect(100, 100, 50, 50), 0xff0000);
+    paint(QRect(300, 200, 50, 50), 0x00ff00);
+    XRectangle rect = { 100, 100, 50, 50 };
+    window.Damaged(&rect);
+    QTest::qWait(RefreshInterval * 2);
+
+    QCOMPARE(window.rescaledArea() - full, qint64(10 * 10));
+    QCOMPARE(thumbnailPixel(&window, 25, 25), qRgb(255, 0, 0) & RGB_MASK);
+    QCOMPARE(thumbnailPixel(&window, 65, 45), qRgb(0, 0, 0) & RGB_MASK);
+}
+
+void TestPlexyWindow::resizeRenamesPixmap()
+{
+    XWindowAttributes attr;
+    XGetWindowAttributes(mDisplay, mClient, &attr);
+    PlexyWindows window(mDisplay, mClient, &attr);
+    window.setRefreshInterval(RefreshInterval);
+    QTest::qWait(RefreshInterval * 2);
+
+    XResizeWindow(mDisplay, mClient, ClientWidth * 2, ClientHeight);
+    XSync(mDisplay, False);
+    window.Resized(10, 10, ClientWidth * 2, ClientHeight, 0);
+    paint(QRect(600, 0, 200, ClientHeight), 0x0000ff);
+    QTest::qWait(RefreshInterval * 2);
+
+    QCOMPARE(window.thumbnail().size(), QSize(ClientWidth * 2 / 5, ClientHeight / 5));
+    QCOMPARE(thumbnailPixel(&window, 150, 30), qRgb(0, 0, 255) & RGB_MASK);
+}
+
+void TestPlexyWindow::damageRefresh()
+{
+    XWindowAttributes attr;
+    XGetWindowAttributes(mDisplay, mClient, &attr);
+    PlexyWindows window(mDisplay, mClient, &attr);
+    window.setRefreshInterval(0);
+    QTest::qWait(10);
+
+    // a blinking cursor sized update, the common case for terminals and editors
+    int frame = 0;
+    QBENCHMARK {
+        paint(QRect(200, 150, 8, 16), frame++ % 2 ? 0xffffff : 0x000000);
+        XRectangle rect = { 200, 150, 8, 16 };
+        window.Damaged(&rect);
+        QCoreApplication::processEvents();
+    }
+}
+
+QTEST_MAIN(TestPlexyWindow)
@@ -0,0 +1,47 @@
+/*******************************************************************************
+* This file is part of PlexyDesk.
+*  Maintained by : Siraj Razick <siraj@kde.org>
+*  Authored By  :
+*
+*  PlexyDesk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  PlexyDesk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with PlexyDesk. If not, see <http://www.gnu.org/licenses/lgpl.html>
+*******************************************************************************/
+
+#include <QtTest/QtTest>
+
+extern "C" {
+#include <X11/Xlib.h>
+}
+
+/* Runs against a scripted client window, start it under Xvfb:
+   xvfb-run -s "+extension Composite" ./plexy_window_test */
+class TestPlexyWindow: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void init();
+    void cleanup();
+    void damageIsCoalesced();
+    void onlyDamageIsRescaled();
+    void resizeRenamesPixmap();
+    void damageRefresh();
+
+private:
+    void paint(const QRect &rect, unsigned long pixel);
+
+    Display *mDisplay;
+    Window mClient;
+    GC mGc;
+};
@@ -21,7 +21,7 @@
 #include "account.h"
 #include "accountmanager.h"
 #include "adaptors/accountadaptor.h" //TODO: remove this
-#include "storagelayerinterface.h"
+#include "storageworker.h"
 
 #include <QDebug>
 #include <QTimer>
@@ -30,10 +30,13 @@
 namespace PlexyDesk
 {
 
-SocialAccount::SocialAccount(const QString &accountId, QDBusConnection *dbusConnection, QObject *parent) : QObject(parent),
-                                                                                                           m_adapter(new SocialAccountAdaptor(this)),
-                                                                                                           m_id(accountId),
-                                                                                                           m_dbusConnection(dbusConnection)
+SocialAccount::SocialAccount(const QString &accountId, const QVariantMap &accountData,
+     QDBusConnection *dbusConnection, QObject *parent) : QObject(parent),
+                                                         m_adapter(new SocialAccountAdaptor(this)),
+                                                         m_id(accountId),
+                                                         m_dbusConnection(dbusConnection),
+                                                         m_accountData(accountData),
+                                                         m_removeRequest(0)
 {
     connect(this, SIGNAL(AccountPropertyChanged(const QString &)), this, SLOT(onAccountPropertyChanged(const QString &)));
     QTimer::singleShot(0, this, SLOT(loadAccountData()));
@@ -89,7 +92,8 @@ void SocialAccount::setParameters(const QVariantMap &set, const QStringList &unS
 
 void SocialAccount::loadAccountData()
 {
-    QVariantMap accountData = getAccount(m_id); //TODO: implement 'getAccount()' method
+    QVariantMap accountData = m_accountData;
+    m_accountData.clear();
 
     // Load property: valid
     m_valid = true;
@@ -166,18 +170,24 @@ void SocialAccount::loadAccountData()
     Q_EMIT ready(true);
 }
 
-QVariantMap SocialAccount::getAccount(const QString &accountHandle)
+void SocialAccount::removeAccount()
 {
-    //TODO: implement parameter support
-    StorageLayerInterface *storageLayer = (qobject_cast<SocialAccountsManager *> (parent()))->storageLayer();
-    return storageLayer->readAccount(accountHandle);
+    if (m_removeRequest)
+        return;
+
+    SocialStorageWorker *storage = (qobject_cast<SocialAccountsManager *> (parent()))->storage();
+    connect(storage, SIGNAL(finished(int, bool)), this, SLOT(onStorageRequestFinished(int, bool)));
+    m_removeRequest = storage->removeAccount(m_id);
 }
 
-void SocialAccount::removeAccount()
+void SocialAccount::onStorageRequestFinished(int request, bool success)
 {
-    //TODO: remove from storage layer
-    StorageLayerInterface *storageLayer = (qobject_cast<SocialAccountsManager *> (parent()))->storageLayer();
-    if (storageLayer->removeAccount(m_id))
+    if (request != m_removeRequest)
+        return;
+
+    disconnect(sender(), SIGNAL(finished(int, bool)), this, SLOT(onStorageRequestFinished(int, bool)));
+    m_removeRequest = 0;
+    if (success)
         emit Removed();
 }
 
@@ -215,8 +225,20 @@ QVariantMap SocialAccount::getParameters()
 
 void SocialAccount::onAccountPropertyChanged(const QString &property)
 {
-    StorageLayerInterface *storageLayer = (qobject_cast<SocialAccountsManager *> (parent()))->storageLayer();
-    qDebug() << "SocialAccount::onAccountPropertyChanged():update status" << storageLayer->updateAccount(m_id, property, this->property(property.toAscii()));
+    if (m_dirtyProperties.isEmpty())
+        QTimer::singleShot(0, this, SLOT(flushProperties()));
+
+    m_dirtyProperties[property] = this->property(property.toAscii());
+}
+
+void SocialAccount::flushProperties()
+{
+    if (m_dirtyProperties.isEmpty())
+        return;
+
+    SocialStorageWorker *storage = (qobject_cast<SocialAccountsManager *> (parent()))->storage();
+    storage->updateAccount(m_id, m_dirtyProperties);
+    m_dirtyProperties.clear();
 }
 
 }
@@ -40,7 +40,8 @@ class SocialAccount : public QObject
     Q_PROPERTY(bool VALID READ isValid WRITE setValid)
 
 public:
-    SocialAccount(const QString &accountId, QDBusConnection *dbusConnection, QObject *parent = 0);
+    SocialAccount(const QString &accountId, const QVariantMap &accountData,
+         QDBusConnection *dbusConnection, QObject *parent = 0);
     ~SocialAccount();
     //set methods
     void setDisplayName(const QString &displayName);
@@ -60,7 +61,6 @@ public:
     QVariantMap getParameters();
 
     QString id() const;
-    QVariantMap getAccount(const QString &accountHandle);
 
 private:
     //member valiables
@@ -76,6 +76,12 @@ private:
     bool m_hasBeenOnline;
     QVariantMap m_parameters;
     QString m_socialService;
+    //row read by the accounts manager, consumed by loadAccountData()
+    QVariantMap m_accountData;
+    //pending remove request on the storage worker, 0 when none
+    int m_removeRequest;
+    /* properties changed since the last flush, written in one transaction */
+    QVariantMap m_dirtyProperties;
 
     //loaded from storage layer
     QString socialService;
@@ -93,6 +99,8 @@ signals:
 private slots:
     void loadAccountData();
     void onAccountPropertyChanged(const QString &property);
+    void flushProperties();
+    void onStorageRequestFinished(int request, bool success);
 
 };
 }
@@ -22,6 +22,7 @@
 #include "accountmanager.h"
 #include "adaptors/accountmanageradaptor.h"
 #include "storagelayer.h"
+#include "storageworker.h"
 
 #include <QDBusMessage>
 #include <QDBusPendingReply>
@@ -40,6 +41,8 @@ struct CreateAccountRequestData
     QString userName;
     QVariantMap parameters;
     QDBusMessage message;
+    QString accountHandle;
+    QVariantMap accountData;
 
 };
 Q_DECLARE_METATYPE(CreateAccountRequestData);
@@ -51,8 +54,9 @@ namespace PlexyDesk
 
 SocialAccountsManager::SocialAccountsManager(QApplication *parent) : QObject(parent),
                                                                      m_adaptor(new SocialAccountsManagerAdaptor(this)),
-                                                                     m_storageLayer(new SocialStorageLayer(this)),
-                                                                     m_storageLayerOpened(false)
+                                                                     m_storage(new SocialStorageWorker(new SocialStorageLayer())),
+                                                                     m_storageLayerOpened(false),
+                                                                     m_requestData(0)
 {
     qRegisterMetaType<CreateAccountRequestData>();
     m_dbusConnection = new QDBusConnection(QDBusConnection::sessionBus());
@@ -62,18 +66,26 @@ SocialAccountsManager::SocialAccountsManager(QApplication *parent) : QObject(par
     loadAccounts();
 }
 
-StorageLayerInterface *SocialAccountsManager::storageLayer() const
+SocialAccountsManager::~SocialAccountsManager()
+{
+    // Lets queued writes reach the disk before the connection goes away.
+    m_storage->stop();
+    delete m_storage;
+}
+
+SocialStorageWorker *SocialAccountsManager::storage() const
 {
-    if (m_storageLayerOpened)
-        return m_storageLayer;
+    return m_storage;
 }
 
 void SocialAccountsManager::loadAccounts()
 {
     Q_ASSERT(false == m_storageLayerOpened);
-    connect(m_storageLayer, SIGNAL(opened(bool)), this, SLOT(onStorageLayerOpened(bool)));
-    m_storageLayer->open();
-
+    connect(m_storage, SIGNAL(opened(bool)), this, SLOT(onStorageLayerOpened(bool)));
+    connect(m_storage, SIGNAL(accountsLoaded(PlexyDesk::SocialAccountMap)),
+         this, SLOT(onAccountsLoaded(PlexyDesk::SocialAccountMap)));
+    connect(m_storage, SIGNAL(finished(int, bool)), this, SLOT(onStorageRequestFinished(int, bool)));
+    m_storage->start();
 }
 
 void SocialAccountsManager::onStorageLayerOpened(bool success)
@@ -83,31 +95,65 @@ void SocialAccountsManager::onStorageLayerOpened(bool success)
     if (success)
     {
         m_storageLayerOpened = true;
-        doLoadAccounts();
         return;
     }
 }
 
-void SocialAccountsManager::doLoadAccounts()
+void SocialAccountsManager::onAccountsLoaded(const PlexyDesk::SocialAccountMap &accounts)
 {
-    qDebug() << "SocialAccountsManager::doLoadAccounts()";
-    QStringList accounts = m_storageLayer->listAccounts();
-    qDebug() << "SocialAccountsManager::doLoadAccounts(): listAccounts value:" << accounts;
-    QStringList::const_iterator end( accounts.end() );
-    for ( QStringList::const_iterator itr( accounts.begin() ); itr != end; ++itr )
+    qDebug() << "SocialAccountsManager::onAccountsLoaded():" << accounts.count() << "accounts";
+    SocialAccountMap::const_iterator end(accounts.constEnd());
+    for (SocialAccountMap::const_iterator itr(accounts.constBegin()); itr != end; ++itr)
     {
-        QString accountHandle((*itr));
+        Q_ASSERT(!m_pendingAccounts.contains(itr.key()));
+        Q_ASSERT(!m_readyAccounts.contains(itr.key()));
+        Q_ASSERT(!m_validAccounts.contains(QDBusObjectPath(itr.key())));
+        Q_ASSERT(!m_invalidAccounts.contains(QDBusObjectPath(itr.key())));
+
+        addAccount(itr.key(), itr.value());
+    }
+}
+
+void SocialAccountsManager::addAccount(const QString &accountHandle, const QVariantMap &accountData)
+{
+    m_pendingAccounts.insert(accountHandle, new SocialAccount(accountHandle, accountData, m_dbusConnection, this));
+    connect(m_pendingAccounts.value(accountHandle), SIGNAL(ready(bool)),
+         this, SLOT(onAccountReady(bool)));
+}
+
+bool SocialAccountsManager::hasAccount(const QString &accountHandle) const
+{
+    if (m_pendingAccounts.contains(accountHandle) || m_readyAccounts.contains(accountHandle))
+        return true;
 
-        Q_ASSERT(!m_pendingAccounts.contains(accountHandle));
-        Q_ASSERT(!m_readyAccounts.contains(accountHandle));
-        Q_ASSERT(!m_validAccounts.contains(QDBusObjectPath(accountHandle)));
-        Q_ASSERT(!m_invalidAccounts.contains(QDBusObjectPath(accountHandle)));
+    foreach(CreateAccountRequestData *requestData, m_pendingWrites) {
+        if (requestData->accountHandle == accountHandle)
+            return true;
+    }
+    return false;
+}
 
-        m_pendingAccounts.insert(accountHandle, new SocialAccount(accountHandle, m_dbusConnection, this));
-        connect(m_pendingAccounts.value(accountHandle), SIGNAL(ready(bool)),
-             this, SLOT(onAccountReady(bool)));
+void SocialAccountsManager::onStorageRequestFinished(int request, bool success)
+{
+    // Only account creation waits on the storage worker here, accounts
+    // track their own update and remove requests.
+    CreateAccountRequestData *requestData = m_pendingWrites.take(request);
+    if (!requestData)
+        return;
 
+    if (!success)
+    {
+        QDBusMessage errorReply = requestData->message.createErrorReply(
+             "org.plexydesk.SocialAccountsManager.Error.NotImplemented", "Unable to store the account.");
+        m_dbusConnection->send(errorReply);
+        delete requestData;
+        return;
     }
+
+    //create the ACTUAL account object, the D-Bus reply is sent once it is ready
+    addAccount(requestData->accountHandle, requestData->accountData);
+    Q_ASSERT(!m_pendingAccountsRequestData.contains(requestData->accountHandle));
+    m_pendingAccountsRequestData.insert(requestData->accountHandle, requestData);
 }
 
 QDBusObjectPath SocialAccountsManager::createAccount(const QString &socialServiceName, const QString &displayName,
@@ -173,6 +219,7 @@ void SocialAccountsManager::doCreateAccount()
                  "SocialDaemon does not support the specified service.");
             m_dbusConnection->send(errorReply);
             delete m_requestData;
+            m_requestData = 0;
             return;
         }
     }
@@ -187,18 +234,15 @@ void SocialAccountsManager::doCreateAccount()
     accountHandle.append(objectPathEscape(m_requestData->userName));
 
     //chech if the account identifier is already available. If so append a number to make it unique
-    if (m_pendingAccounts.contains(accountHandle) || m_readyAccounts.contains(accountHandle))
+    if (hasAccount(accountHandle))
     {
+        const QString baseHandle(accountHandle);
         int i = 2;
-        while (true)
+        do
         {
-            accountHandle.append("_");
-            accountHandle.append(QString::number(i));
-
-            if (!m_pendingAccounts.contains(accountHandle) && m_readyAccounts.contains(accountHandle))
-                break;
+            accountHandle = baseHandle + "_" + QString::number(i);
             i++;
-        }
+        } while (hasAccount(accountHandle));
     }
 
     // Make a map containing all the data to be stored in the storage layer.
@@ -211,14 +255,11 @@ void SocialAccountsManager::doCreateAccount()
     accountData.insert("ENABLED", true); ////Newly created accounts ENABLED property set to true by default
     // accountData.insert("parameters", requestData->parameters); TODO: Implement parameter support
 
-    qDebug() << "SocialAccountsManager::doCreateAccount():write status:" <<m_storageLayer->writeAccount(accountHandle, accountData);
-
-    //create the ACTUAL account object
-    m_pendingAccounts.insert(accountHandle, new SocialAccount(accountHandle, m_dbusConnection, this));
-    connect(m_pendingAccounts.value(accountHandle), SIGNAL(ready(bool)),
-         this, SLOT(onAccountReady(bool)));
-    Q_ASSERT(!m_pendingAccountsRequestData.contains(accountHandle));
-    m_pendingAccountsRequestData.insert(accountHandle, m_requestData);
+    // The account object is created once the worker has stored it.
+    m_requestData->accountHandle = accountHandle;
+    m_requestData->accountData = accountData;
+    m_pendingWrites.insert(m_storage->writeAccount(accountHandle, accountData), m_requestData);
+    m_requestData = 0;
 }
 
 void SocialAccountsManager::onAccountReady(bool success)
@@ -18,6 +18,8 @@
  ***Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
  */
 
+#include "storageworker.h"
+
 #include <QApplication>
 #include <QDBusObjectPath>
 #include <QMap>
@@ -31,7 +33,7 @@ namespace PlexyDesk
 {
 class SocialAccountsManagerAdaptor;
 class SocialAccount;
-class StorageLayerInterface;
+class SocialStorageWorker;
 
 class SocialAccountsManager : public QObject, protected QDBusContext
 {
@@ -39,8 +41,9 @@ class SocialAccountsManager : public QObject, protected QDBusContext
 
 public:
     SocialAccountsManager(QApplication *parent = 0);
+    ~SocialAccountsManager();
     QDBusObjectPath getAccount(const QString &protocol, const QString &userName);
-    StorageLayerInterface *storageLayer() const;
+    SocialStorageWorker *storage() const;
     void loadAccounts();
 
 signals:
@@ -56,14 +59,17 @@ private:
     QMap<QString, SocialAccount *> m_pendingAccounts;
     QMap<QString, SocialAccount *> m_readyAccounts;
     QMap<QString, CreateAccountRequestData *> m_pendingAccountsRequestData;
+    /* accounts being written by the storage worker, keyed by request id */
+    QMap<int, CreateAccountRequestData *> m_pendingWrites;
     bool m_dbusObjectsRegistered;
     bool m_storageLayerOpened;
     SocialAccountsManagerAdaptor *m_adaptor;
     CreateAccountRequestData *m_requestData;
-    StorageLayerInterface *m_storageLayer;
+    SocialStorageWorker *m_storage;
 
     QString objectPathEscape(QString path) const;
-    void doLoadAccounts();
+    bool hasAccount(const QString &accountHandle) const;
+    void addAccount(const QString &accountHandle, const QVariantMap &accountData);
 
     //public slots
 public slots:
@@ -77,6 +83,8 @@ private slots:
     void doCreateAccount();
     void onAccountRemoved();
     void onStorageLayerOpened(bool success);
+    void onAccountsLoaded(const PlexyDesk::SocialAccountMap &accounts);
+    void onStorageRequestFinished(int request, bool success);
 
 };
 } //end of namespace PlexyDesk
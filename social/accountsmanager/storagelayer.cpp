@@ -23,52 +23,103 @@
 #include <QCryptographicHash>
 #include <QDebug>
 #include <QDir>
+#include <QSqlError>
 #include <QString>
 
+/* bump when the Accounts table changes, createTables() only runs when the
+   database is older than this */
+static const int SchemaVersion = 1;
+
+static QString columnForProperty(const QString &propertyName)
+{
+    if (propertyName == "USERNAME")
+        return "username";
+    if (propertyName == "PASSWORD")
+        return "password";
+    if (propertyName == "DISPLAY_NAME")
+        return "displayname";
+    if (propertyName == "VALID")
+        return "valid";
+    if (propertyName == "ENABLED")
+        return "enabled";
+    return QString();
+}
+
+static QVariant columnValue(const QString &propertyName, const QVariant &value)
+{
+    if (propertyName == "VALID" || propertyName == "ENABLED")
+        return value.toBool() ? 1 : 0;
+    return value.toString();
+}
+
 namespace PlexyDesk
 {
-SocialStorageLayer::SocialStorageLayer(QObject *parent) : StorageLayerInterface(parent)
+SocialStorageLayer::SocialStorageLayer(QObject *parent) : StorageLayerInterface(parent),
+    m_connectionName(QString("SocialStorageLayer-%1").arg(quintptr(this), 0, 16))
 {
 
 }
 
-bool SocialStorageLayer::writeAccount(const QString &id, const QVariantMap &data)
+SocialStorageLayer::~SocialStorageLayer()
+{
+    if (m_database.isOpen())
+        close();
+}
+
+void SocialStorageLayer::setDatabaseFile(const QString &fileName)
+{
+    m_databaseFile = fileName;
+}
+
+QSqlQuery &SocialStorageLayer::cachedQuery(const QString &sql)
+{
+    QHash<QString, QSqlQuery>::iterator it = m_queries.find(sql);
+    if (it == m_queries.end()) {
+        QSqlQuery query(m_database);
+        if (!query.prepare(sql))
+            qDebug() << "SocialStorageLayer::cachedQuery(): prepare failed:" << sql << query.lastError().text();
+        it = m_queries.insert(sql, query);
+    }
+    return it.value();
+}
+
+bool SocialStorageLayer::insertAccount(const QString &id, const QVariantMap &data)
 {
     //extract properties
-    QString serviceName, userName, displayName, password;
-    bool valid, enabled;
-    if (data.contains("SOCIAL_SERVICE"))
-        serviceName = data.value("SOCIAL_SERVICE").toString();
-    else
-        serviceName = "unknown";
-
-    if (data.contains("USERNAME"))
-        userName = data.value("USERNAME").toString();
-    else
-        userName = "unknown";
-
-    if (data.contains("DISPLAY_NAME"))
-        displayName = data.value("DISPLAY_NAME").toString();
-    else
-        displayName = "unknown";
-
-    if (data.contains("VALID"))
-        valid = data.value("VALID").toBool();
-    else
-        valid = false;
-
-    if (data.contains("ENABLED"))
-        enabled = data.value("ENABLED").toBool();
-    else
-        enabled = false;
-
-    if (data.contains("PASSWORD")) {
-        password = data.value("PASSWORD").toString(); //TODO: implement hashing
+    QSqlQuery &query = cachedQuery("INSERT INTO Accounts VALUES(?, ?, ?, ?, ?, ?, ?)");
+    query.addBindValue(id);
+    query.addBindValue(data.value("SOCIAL_SERVICE", "unknown").toString());
+    query.addBindValue(data.value("USERNAME", "unknown").toString());
+    query.addBindValue(data.value("DISPLAY_NAME", "unknown").toString());
+    query.addBindValue(data.value("VALID", false).toBool() ? 1 : 0);
+    query.addBindValue(data.value("ENABLED", false).toBool() ? 1 : 0);
+    query.addBindValue(data.value("PASSWORD").toString()); //TODO: implement hashing
+
+    const bool rv = query.exec();
+    query.finish();
+    return rv;
+}
+
+bool SocialStorageLayer::writeAccount(const QString &id, const QVariantMap &data)
+{
+    return insertAccount(id, data);
+}
+
+bool SocialStorageLayer::writeAccounts(const QMap<QString, QVariantMap> &accounts)
+{
+    if (!m_database.transaction())
+        return false;
+
+    QMap<QString, QVariantMap>::const_iterator it = accounts.constBegin();
+    for (; it != accounts.constEnd(); ++it) {
+        if (!insertAccount(it.key(), it.value())) {
+            qDebug() << "SocialStorageLayer::writeAccounts(): failed at" << it.key();
+            m_database.rollback();
+            return false;
+        }
     }
 
-    QSqlQuery query(QSqlDatabase::database());
-    return query.exec("INSERT INTO Accounts VALUES('" + id + "', '" + serviceName + "', '" +userName + "', '"
-         + displayName + "', " + QString(valid ? "1" : "0") + ", " + QString(enabled ? "1" : "0") + ", '" + password + "')");
+    return m_database.commit();
 }
 
 void SocialStorageLayer::setDatabasePath(const QString &path)
@@ -80,95 +131,169 @@ void SocialStorageLayer::setDatabasePath(const QString &path)
 
 }
 
-void SocialStorageLayer::createTables()
+bool SocialStorageLayer::createTables()
 {
-    QSqlQuery query(QSqlDatabase::database());
-    qDebug() << "statuse of create tables:" << query.exec("CREATE TABLE Accounts(id varchar(100) PRIMARY KEY, "
+    QSqlQuery query(m_database);
+    if (query.exec("PRAGMA user_version") && query.next() && query.value(0).toInt() >= SchemaVersion)
+        return true;
+
+    if (!query.exec("CREATE TABLE IF NOT EXISTS Accounts(id varchar(100) PRIMARY KEY, "
          "socialservice varchar(50), username varchar(30), "
          "displayname varchar(50), "
-         "valid boolean, enabled boolean, password varchar(50))");
+         "valid boolean, enabled boolean, password varchar(50))")) {
+        qDebug() << "SocialStorageLayer::createTables():" << query.lastError().text();
+        return false;
+    }
     //TODO: extend to accommodate parameter values
+
+    return query.exec(QString("PRAGMA user_version = %1").arg(SchemaVersion));
 }
 
 void SocialStorageLayer::open()
 {
     qDebug() << "SocialStorageLayer::open()";
-    QSqlDatabase databaseConnection = QSqlDatabase::addDatabase("QSQLITE");
-    QString dbPath(QDir::homePath() + "/.config/plexydesk/social/accountmanager/");
-    setDatabasePath(dbPath);
-    databaseConnection.setDatabaseName(dbPath + "socialdatabase.db");
-    if (!databaseConnection.open()) {
+    m_database = QSqlDatabase::addDatabase("QSQLITE", m_connectionName);
+
+    QString dbFile = m_databaseFile;
+    if (dbFile.isEmpty()) {
+        QString dbPath(QDir::homePath() + "/.config/plexydesk/social/accountmanager/");
+        setDatabasePath(dbPath);
+        dbFile = dbPath + "socialdatabase.db";
+    }
+
+    m_database.setDatabaseName(dbFile);
+    if (!m_database.open()) {
         qDebug() << "Unable to establish db connection";
         emit opened(false);
         return;
     }
 
-    createTables(); //Create the master table
+    /* the journal mode sticks to the file, synchronous is per connection.
+       WAL with NORMAL only syncs at checkpoints and readers never block
+       the writer */
+    QSqlQuery pragma(m_database);
+    pragma.exec("PRAGMA journal_mode=WAL");
+    pragma.exec("PRAGMA synchronous=NORMAL");
+
+    if (!createTables()) { //Create the master table
+        emit opened(false);
+        return;
+    }
+
     emit opened(true);
-    qDebug() << "emitted true for database opened()";
 }
 
 void SocialStorageLayer::close()
 {
-    QSqlDatabase::removeDatabase;
+    m_queries.clear();
+    m_database.close();
+    m_database = QSqlDatabase();
+    QSqlDatabase::removeDatabase(m_connectionName);
     emit closed();
 }
 
 QStringList SocialStorageLayer::listAccounts()
 {
-    qDebug() << "SocialStorageLayer::listAccounts()";
     QStringList listOfAccounts;
-    QSqlQuery query(QSqlDatabase::database());
-    qDebug() << "SocialStorageLayer::listAccounts(): query status:" << query.exec("SELECT id FROM Accounts");
+    QSqlQuery &query = cachedQuery("SELECT id FROM Accounts");
+    query.exec();
 
     while (query.next()) {
         listOfAccounts << query.value(0).toString();
     }
+    query.finish();
     return listOfAccounts;
 }
 
 QVariantMap SocialStorageLayer::readAccount(const QString &id)
 {
     QVariantMap accountData;
-    QSqlQuery query(QSqlDatabase::database());
-    query.exec("SELECT * FROM Accounts WHERE id='" + id + "'");
+    QSqlQuery &query = cachedQuery("SELECT socialservice, username, displayname, valid, enabled, password "
+         "FROM Accounts WHERE id=?");
+    query.addBindValue(id);
+    query.exec();
+
+    if (query.next()) {
+        accountData["SOCIAL_SERVICE"] = query.value(0).toString();
+        accountData["USERNAME"] = query.value(1).toString();
+        accountData["DISPLAY_NAME"] = query.value(2).toString();
+        accountData["VALID"] = query.value(3).toBool();
+        accountData["ENABLED"] = query.value(4).toBool();
+        accountData["PASSWORD"] = query.value(5).toString();
+    }
+    query.finish();
+    return accountData;
+}
+
+QMap<QString, QVariantMap> SocialStorageLayer::readAccounts()
+{
+    QMap<QString, QVariantMap> accounts;
+    QSqlQuery &query = cachedQuery("SELECT id, socialservice, username, displayname, valid, enabled, password "
+         "FROM Accounts");
+    query.exec();
 
     while (query.next()) {
+        QVariantMap accountData;
         accountData["SOCIAL_SERVICE"] = query.value(1).toString();
         accountData["USERNAME"] = query.value(2).toString();
         accountData["DISPLAY_NAME"] = query.value(3).toString();
         accountData["VALID"] = query.value(4).toBool();
         accountData["ENABLED"] = query.value(5).toBool();
         accountData["PASSWORD"] = query.value(6).toString();
+        accounts.insert(query.value(0).toString(), accountData);
     }
-    return accountData;
+    query.finish();
+    return accounts;
 }
 
 bool SocialStorageLayer::removeAccount(const QString &id)
 {
-    QString queryStr("DELETE FROM Accounts WHERE id='" + id + "'");
-    QSqlQuery query(QSqlDatabase::database());
-    return query.exec(queryStr);
+    QSqlQuery &query = cachedQuery("DELETE FROM Accounts WHERE id=?");
+    query.addBindValue(id);
+    const bool rv = query.exec();
+    query.finish();
+    return rv;
+}
+
+bool SocialStorageLayer::bindUpdate(const QString &id, const QString &propertyName, const QVariant &value)
+{
+    /* the column name comes from a fixed list, never from the caller */
+    const QString column = columnForProperty(propertyName);
+    if (column.isEmpty())
+        return false;
+
+    QSqlQuery &query = cachedQuery("UPDATE Accounts SET " + column + "=? WHERE id=?");
+    query.addBindValue(columnValue(propertyName, value));
+    query.addBindValue(id);
+    const bool rv = query.exec();
+    query.finish();
+    return rv;
 }
 
 bool SocialStorageLayer::updateAccount(const QString &id, const QString &propertyName, const QVariant &value)
 {
-    QString queryStr;
+    return bindUpdate(id, propertyName, value);
+}
 
-    if (propertyName == "USERNAME")
-        queryStr = "UPDATE Accounts SET username='" + value.toString() + "' WHERE id='" + id + "'";
-    else if (propertyName == "PASSWORD")
-        queryStr = "UPDATE Accounts SET password='" + value.toString() + "' WHERE id='" + id + "'";
-    else if (propertyName == "DISPLAY_NAME")
-        queryStr = "UPDATE Accounts SET displayname='" + value.toString() + "' WHERE id='" + id + "'";
-    else if (propertyName == "VALID")
-        queryStr = "UPDATE Accounts SET valid='" + QString(value.toBool() ? "1" : "0") + "' WHERE id='" + id + "'";
-    else if (propertyName == "ENABLED")
-        queryStr = "UPDATE Accounts SET enabled='" + QString(value.toBool() ? "1" : "0") + "' WHERE id='" + id + "'";
-    else
+bool SocialStorageLayer::updateAccount(const QString &id, const QVariantMap &properties)
+{
+    if (properties.isEmpty())
+        return true;
+
+    if (properties.count() == 1)
+        return bindUpdate(id, properties.constBegin().key(), properties.constBegin().value());
+
+    if (!m_database.transaction())
         return false;
 
-    QSqlQuery query(QSqlDatabase::database());
-    return query.exec(queryStr);
+    QVariantMap::const_iterator it = properties.constBegin();
+    for (; it != properties.constEnd(); ++it) {
+        if (!bindUpdate(id, it.key(), it.value())) {
+            m_database.rollback();
+            return false;
+        }
+    }
+
+    return m_database.commit();
 }
 }
@@ -18,8 +18,12 @@
  ***Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
  */
 
+#ifndef PLEXY_SOCIAL_STORAGE_LAYER_H
+#define PLEXY_SOCIAL_STORAGE_LAYER_H
+
 #include "storagelayerinterface.h"
 
+#include <QHash>
 #include <QObject>
 #include <QSqlDatabase>
 #include <QSqlQuery>
@@ -32,19 +36,38 @@ class SocialStorageLayer : public StorageLayerInterface
     Q_OBJECT;
 public:
     SocialStorageLayer(QObject *parent = 0);
+    ~SocialStorageLayer();
     void open();
     void close();
 
+    /* use a database file other than the one in the user's config dir,
+       must be called before open() */
+    void setDatabaseFile(const QString &fileName);
+
     QStringList listAccounts();
     QVariantMap readAccount(const QString &id);
+    QMap<QString, QVariantMap> readAccounts();
     bool removeAccount(const QString &id);
     bool writeAccount(const QString &id, const QVariantMap &data);
     bool updateAccount(const QString &id, const QString &propertyName, const QVariant &value);
+    bool writeAccounts(const QMap<QString, QVariantMap> &accounts);
+    bool updateAccount(const QString &id, const QVariantMap &properties);
 
 private:
     void setDatabasePath(const QString &path);
-    void createTables();
+    bool createTables();
+    QSqlQuery &cachedQuery(const QString &sql);
+    bool insertAccount(const QString &id, const QVariantMap &data);
+    bool bindUpdate(const QString &id, const QString &propertyName, const QVariant &value);
+
+    QString m_connectionName;
+    QString m_databaseFile;
+    QSqlDatabase m_database;
+    /* prepared statements keyed by their SQL text */
+    QHash<QString, QSqlQuery> m_queries;
 
     //QString generatePasswordHash();
 };
 }
+
+#endif
@@ -18,6 +18,10 @@
  ***Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
  */
 
+#ifndef PLEXY_SOCIAL_STORAGE_LAYER_INTERFACE_H
+#define PLEXY_SOCIAL_STORAGE_LAYER_INTERFACE_H
+
+#include <QMap>
 #include <QObject>
 #include <QString>
 #include <QVariant>
@@ -40,12 +44,21 @@ public:
 
     virtual QStringList listAccounts() = 0;
     virtual QVariantMap readAccount(const QString &id) = 0;
+    /* every stored account keyed by id, read with a single query */
+    virtual QMap<QString, QVariantMap> readAccounts() = 0;
     virtual bool removeAccount(const QString &id) = 0;
     virtual bool writeAccount(const QString &id, const QVariantMap &data) = 0;
     virtual bool updateAccount(const QString &id, const QString &propertyName, const QVariant &value) = 0;
 
+    /* writes all accounts in one transaction, either all or none are stored */
+    virtual bool writeAccounts(const QMap<QString, QVariantMap> &accounts) = 0;
+    /* applies all properties in one transaction */
+    virtual bool updateAccount(const QString &id, const QVariantMap &properties) = 0;
+
 signals:
     void opened(bool success);
     void closed();
 };
 }
+
+#endif
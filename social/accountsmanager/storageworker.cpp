@@ -0,0 +1,129 @@
+/* This file is part of telepathy-accountmanager-kwallet
+ *
+ * Copyright (C) 2008-2009 Collabora Ltd. <http://www.collabora.co.uk/>
+ * Mahesh Kaushalya 2008-2009 <wpmahesh@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ ***Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "storageworker.h"
+#include "storagelayerinterface.h"
+
+#include <QThread>
+
+namespace PlexyDesk
+{
+SocialStorageWorker::SocialStorageWorker(StorageLayerInterface *storage) : QObject(0),
+    m_thread(new QThread),
+    m_storage(storage),
+    m_lastRequest(0),
+    m_opened(false)
+{
+    qRegisterMetaType<SocialAccountMap>("PlexyDesk::SocialAccountMap");
+
+    /* the database connection belongs to the thread that opens it, so
+       the storage layer moves along with the worker before doOpen() */
+    m_storage->setParent(this);
+    moveToThread(m_thread);
+    m_thread->start();
+}
+
+SocialStorageWorker::~SocialStorageWorker()
+{
+    stop();
+    delete m_thread;
+}
+
+void SocialStorageWorker::start()
+{
+    QMetaObject::invokeMethod(this, "doOpen", Qt::QueuedConnection);
+}
+
+void SocialStorageWorker::stop()
+{
+    if (!m_thread->isRunning())
+        return;
+
+    QMetaObject::invokeMethod(this, "doClose", Qt::BlockingQueuedConnection);
+    m_thread->quit();
+    m_thread->wait();
+}
+
+int SocialStorageWorker::nextRequest()
+{
+    return ++m_lastRequest;
+}
+
+int SocialStorageWorker::writeAccount(const QString &id, const QVariantMap &data)
+{
+    const int request = nextRequest();
+    QMetaObject::invokeMethod(this, "doWrite", Qt::QueuedConnection,
+         Q_ARG(int, request), Q_ARG(QString, id), Q_ARG(QVariantMap, data));
+    return request;
+}
+
+int SocialStorageWorker::updateAccount(const QString &id, const QVariantMap &properties)
+{
+    const int request = nextRequest();
+    QMetaObject::invokeMethod(this, "doUpdate", Qt::QueuedConnection,
+         Q_ARG(int, request), Q_ARG(QString, id), Q_ARG(QVariantMap, properties));
+    return request;
+}
+
+int SocialStorageWorker::removeAccount(const QString &id)
+{
+    const int request = nextRequest();
+    QMetaObject::invokeMethod(this, "doRemove", Qt::QueuedConnection,
+         Q_ARG(int, request), Q_ARG(QString, id));
+    return request;
+}
+
+void SocialStorageWorker::doOpen()
+{
+    connect(m_storage, SIGNAL(opened(bool)), this, SLOT(onStorageOpened(bool)));
+    m_storage->open();
+}
+
+void SocialStorageWorker::onStorageOpened(bool success)
+{
+    m_opened = success;
+    emit opened(success);
+
+    if (success)
+        emit accountsLoaded(m_storage->readAccounts());
+}
+
+void SocialStorageWorker::doClose()
+{
+    if (m_opened)
+        m_storage->close();
+    m_opened = false;
+}
+
+void SocialStorageWorker::doWrite(int request, const QString &id, const QVariantMap &data)
+{
+    emit finished(request, m_storage->writeAccount(id, data));
+}
+
+void SocialStorageWorker::doUpdate(int request, const QString &id, const QVariantMap &properties)
+{
+    emit finished(request, m_storage->updateAccount(id, properties));
+}
+
+void SocialStorageWorker::doRemove(int request, const QString &id)
+{
+    emit finished(request, m_storage->removeAccount(id));
+}
+}
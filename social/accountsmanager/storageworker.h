@@ -0,0 +1,86 @@
+/* This file is part of telepathy-accountmanager-kwallet
+ *
+ * Copyright (C) 2008-2009 Collabora Ltd. <http://www.collabora.co.uk/>
+ * Mahesh Kaushalya 2008-2009 <wpmahesh@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ ***Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef PLEXY_SOCIAL_STORAGE_WORKER_H
+#define PLEXY_SOCIAL_STORAGE_WORKER_H
+
+#include <QMap>
+#include <QMetaType>
+#include <QObject>
+#include <QString>
+#include <QVariantMap>
+
+class QThread;
+
+namespace PlexyDesk
+{
+class StorageLayerInterface;
+
+typedef QMap<QString, QVariantMap> SocialAccountMap;
+
+/* Runs a storage layer on a thread of its own. The public methods only
+   queue a request and return its id, the result comes back through
+   finished() on the caller's thread. Requests are handled in the order
+   they were posted. */
+class SocialStorageWorker : public QObject
+{
+    Q_OBJECT;
+
+public:
+    /* takes ownership of storage, which must not have been opened yet */
+    SocialStorageWorker(StorageLayerInterface *storage);
+    ~SocialStorageWorker();
+
+    /* opens the database and loads every account, answered by opened()
+       and accountsLoaded() */
+    void start();
+    /* flushes the queue, closes the database and stops the thread */
+    void stop();
+
+    int writeAccount(const QString &id, const QVariantMap &data);
+    int updateAccount(const QString &id, const QVariantMap &properties);
+    int removeAccount(const QString &id);
+
+signals:
+    void opened(bool success);
+    void accountsLoaded(const PlexyDesk::SocialAccountMap &accounts);
+    void finished(int request, bool success);
+
+private slots:
+    void doOpen();
+    void onStorageOpened(bool success);
+    void doClose();
+    void doWrite(int request, const QString &id, const QVariantMap &data);
+    void doUpdate(int request, const QString &id, const QVariantMap &properties);
+    void doRemove(int request, const QString &id);
+
+private:
+    int nextRequest();
+
+    QThread *m_thread;
+    StorageLayerInterface *m_storage;
+    int m_lastRequest;
+    bool m_opened;
+};
+}
+
+Q_DECLARE_METATYPE(PlexyDesk::SocialAccountMap)
+
+#endif
@@ -0,0 +1,147 @@
+/* This file is part of telepathy-accountmanager-kwallet
+ *
+ * Copyright (C) 2008-2009 Collabora Ltd. <http://www.collabora.co.uk/>
+ * Mahesh Kaushalya 2008-2009 <wpmahesh@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ ***Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "teststoragelayer.h"
+#include "storagelayer.h"
+
+using namespace PlexyDesk;
+
+static const int ImportCount = 10000;
+
+static QVariantMap accountData(int i)
+{
+    QVariantMap data;
+    data["SOCIAL_SERVICE"] = "facebook";
+    data["USERNAME"] = QString("user%1").arg(i);
+    data["DISPLAY_NAME"] = QString("User %1").arg(i);
+    data["VALID"] = true;
+    data["ENABLED"] = (i % 2) == 0;
+    return data;
+}
+
+void TestStorageLayer::init()
+{
+    mDatabaseFile = QDir::tempPath() + QString("/plexy_storage_test_%1.db").arg(QCoreApplication::applicationPid());
+    QFile::remove(mDatabaseFile);
+
+    mStorage = new SocialStorageLayer();
+    mStorage->setDatabaseFile(mDatabaseFile);
+    QSignalSpy spy(mStorage, SIGNAL(opened(bool)));
+    mStorage->open();
+    QCOMPARE(spy.count(), 1);
+    QVERIFY(spy.first().first().toBool());
+}
+
+void TestStorageLayer::cleanup()
+{
+    mStorage->close();
+    delete mStorage;
+    QFile::remove(mDatabaseFile);
+    QFile::remove(mDatabaseFile + "-wal");
+    QFile::remove(mDatabaseFile + "-shm");
+}
+
+void TestStorageLayer::quotedIdentifiers()
+{
+    const QString id("/org/plexydesk/o'brien'); DROP TABLE Accounts; --");
+    QVariantMap data = accountData(1);
+    data["DISPLAY_NAME"] = "O'Brien";
+
+    QVERIFY(mStorage->writeAccount(id, data));
+    QCOMPARE(mStorage->listAccounts(), QStringList() << id);
+    QCOMPARE(mStorage->readAccount(id).value("DISPLAY_NAME").toString(), QString("O'Brien"));
+
+    QVERIFY(mStorage->updateAccount(id, "USERNAME", QVariant("it's me")));
+    QCOMPARE(mStorage->readAccount(id).value("USERNAME").toString(), QString("it's me"));
+
+    QVERIFY(mStorage->removeAccount(id));
+    QVERIFY(mStorage->listAccounts().isEmpty());
+}
+
+void TestStorageLayer::batchedUpdate()
+{
+    QVERIFY(mStorage->writeAccount("acc", accountData(0)));
+
+    QVariantMap changes;
+    changes["DISPLAY_NAME"] = "Renamed";
+    changes["ENABLED"] = false;
+    changes["VALID"] = false;
+    QVERIFY(mStorage->updateAccount("acc", changes));
+
+    const QVariantMap stored = mStorage->readAccount("acc");
+    QCOMPARE(stored.value("DISPLAY_NAME").toString(), QString("Renamed"));
+    QCOMPARE(stored.value("ENABLED").toBool(), false);
+    QCOMPARE(stored.value("VALID").toBool(), false);
+    QCOMPARE(stored.value("USERNAME").toString(), QString("user0"));
+}
+
+void TestStorageLayer::readAllAccounts()
+{
+    QMap<QString, QVariantMap> accounts;
+    for (int i = 0; i < 3; i++)
+        accounts.insert(QString("acc%1").arg(i), accountData(i));
+    QVERIFY(mStorage->writeAccounts(accounts));
+
+    const QMap<QString, QVariantMap> stored = mStorage->readAccounts();
+    QCOMPARE(stored.keys(), accounts.keys());
+    QCOMPARE(stored.value("acc2").value("USERNAME").toString(), QString("user2"));
+    QCOMPARE(stored.value("acc1").value("ENABLED").toBool(), false);
+}
+
+void TestStorageLayer::rejectsUnknownProperty()
+{
+    QVERIFY(mStorage->writeAccount("acc", accountData(0)));
+
+    /* one bad property rolls back the whole batch */
+    QVariantMap changes;
+    changes["DISPLAY_NAME"] = "Renamed";
+    changes["id=id; --"] = "x";
+    QVERIFY(!mStorage->updateAccount("acc", changes));
+    QCOMPARE(mStorage->readAccount("acc").value("DISPLAY_NAME").toString(), QString("User 0"));
+}
+
+void TestStorageLayer::bulkImportRollsBack()
+{
+    QVERIFY(mStorage->writeAccount("acc5", accountData(5)));
+
+    QMap<QString, QVariantMap> accounts;
+    for (int i = 0; i < 10; i++)
+        accounts.insert(QString("acc%1").arg(i), accountData(i));
+
+    /* acc5 already exists, nothing of the batch may be stored */
+    QVERIFY(!mStorage->writeAccounts(accounts));
+    QCOMPARE(mStorage->listAccounts(), QStringList() << "acc5");
+}
+
+void TestStorageLayer::bulkImport()
+{
+    int run = 0;
+    QBENCHMARK {
+        QMap<QString, QVariantMap> accounts;
+        for (int i = 0; i < ImportCount; i++)
+            accounts.insert(QString("/org/plexydesk/social/%1/%2").arg(run).arg(i), accountData(i));
+        QVERIFY(mStorage->writeAccounts(accounts));
+        run++;
+    }
+
+    QCOMPARE(mStorage->listAccounts().count(), ImportCount * run);
+}
+
+QTEST_MAIN(TestStorageLayer)
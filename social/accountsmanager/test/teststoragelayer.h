@@ -0,0 +1,46 @@
+/* This file is part of telepathy-accountmanager-kwallet
+ *
+ * Copyright (C) 2008-2009 Collabora Ltd. <http://www.collabora.co.uk/>
+ * Mahesh Kaushalya 2008-2009 <wpmahesh@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ ***Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <QtTest/QtTest>
+
+namespace PlexyDesk
+{
+class SocialStorageLayer;
+}
+
+class TestStorageLayer: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void quotedIdentifiers();
+    void batchedUpdate();
+    void readAllAccounts();
+    void rejectsUnknownProperty();
+    void bulkImportRollsBack();
+    void bulkImport();
+
+private:
+    QString mDatabaseFile;
+    PlexyDesk::SocialStorageLayer *mStorage;
+};